@@ -1,6 +1,17 @@
 #pragma once
 #include "rt/hittables/Scene.hpp"
 #include "rt/core/Camera.hpp"
+#include "rt/materials/MaterialTable.hpp"
+#include "rt/sampling/Sampler.hpp"
+#include "rt/io/HDRImage.hpp"
+#include "rt/io/ToneMap.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
 #include <vector>
 #include <string>
 
@@ -12,6 +23,23 @@ enum class SamplingStrategy {
 	LIGHT       ///< 仅光源采样 (NEE)
 };
 
+/**
+ * @brief 路径积分器的执行方式，几种方式对同一采样策略给出相同的估计。
+ */
+enum class IntegratorMode {
+	RECURSIVE, ///< 逐条路径递归追踪 (默认)
+	ITERATIVE, ///< 逐条路径在循环中追踪，携带吞吐量与累积辐射度，不随弹射次数加深调用栈
+	WAVEFRONT, ///< 波前：整批路径按阶段（生成、求交、着色、阴影、累加）推进，每个阶段是一个并行批处理内核
+};
+
+/**
+ * @brief 逐像素渲染（递归与迭代积分器）时像素分给线程的方式，两种方式的渲染结果逐位相同。
+ */
+enum class RenderSchedule {
+	SCANLINES, ///< 同一行上相邻的像素为一组，各组按行序动态分配给线程
+	TILES,	   ///< 方形图块按 Hilbert 曲线排序后分给各线程的队列，空闲线程窃取其他队列的图块 (默认)
+};
+
 /**
  * @brief 路径追踪渲染器类。
  * 
@@ -44,24 +72,261 @@ public:
 	 * @brief 设置采样策略。
 	 */
 	void set_sampling_strategy(SamplingStrategy strategy) {
-		m_strategy = strategy;
+		m_strategies.assign(1, strategy);
+	}
+
+	/**
+	 * @brief 在一趟渲染中同时估计多种采样策略，每种策略得到一幅图像。
+	 *
+	 * 像素与弹射的采样维度固定，各策略在同一顶点取到的光源样本与材质样本相同，只是权重不同：
+	 * 所有策略共用相机光线、主光线求交、沿材质采样方向的续接光线与阴影光线，每个顶点只为各策略分别计算权重，
+	 * 每幅图像与单独用该策略渲染（迭代积分器）的结果逐位相同，总耗时接近只渲染一种策略。
+	 * 同时估计多种策略时总是逐像素迭代推进路径，波前积分器的设置被忽略；自适应采样按第一种策略的方差决定采样数。
+	 *
+	 * @param strategies 采样策略，1 到 MAX_STRATEGIES 种，第一种是 render_framebuffer 返回的图像。
+	 * @throws std::invalid_argument 策略数不在范围内时抛出。
+	 */
+	void set_sampling_strategies(std::span<const SamplingStrategy> strategies);
+
+	/**
+	 * @brief 设置是否以光线包追踪相机主光线。
+	 *
+	 * 启用时（默认）一组相邻的 RayPacket::SIZE 个像素的主光线一起求交，之后的着色与弹射仍逐条进行；
+	 * 关闭时每条主光线单独调用 hit，用于对比与调试。
+	 */
+	void set_packet_tracing(const bool enabled) {
+		m_packet_tracing = enabled;
+	}
+
+	/**
+	 * @brief 设置路径积分器的执行方式。
+	 */
+	void set_integrator(const IntegratorMode mode) {
+		m_integrator = mode;
+	}
+
+	/**
+	 * @brief 设置着色使用的材质表，场景需要先用 Hittable::bind_materials 绑定到同一个材质表。
+	 *
+	 * 设置后内置材质按种类静态分发，波前积分器按材质编号（即按种类）排序着色；
+	 * 未设置时（默认）所有材质都通过虚函数调用。
+	 */
+	void set_material_table(std::shared_ptr<const MaterialTable> materials) {
+		m_materials = std::move(materials);
+	}
+
+	/**
+	 * @brief 设置逐像素渲染时的调度方式；波前积分器按批推进，不受影响。
+	 *
+	 * @param schedule 调度方式。
+	 * @param tile_size 图块边长，向上取整为 2 的幂。
+	 */
+	void set_schedule(const RenderSchedule schedule, const int tile_size = TILE_SIZE) {
+		m_schedule = schedule;
+		m_tile_size = tile_size;
+	}
+
+	/**
+	 * @brief 设置随机数种子。每个像素每个采样的随机数序列由种子、像素与采样序号决定，
+	 * 相同设置的两次渲染结果逐位相同，与线程数和调度顺序无关。
+	 */
+	void set_seed(const std::uint64_t seed) {
+		m_seed = seed;
+	}
+
+	/**
+	 * @brief 设置采样器类型。
+	 *
+	 * 低差异序列（SOBOL、PMJ02）的各维度用途固定：像素抖动占前 PIXEL_DIMENSIONS 维，
+	 * 之后每次弹射占 BOUNCE_DIMENSIONS 维，依次为俄罗斯轮盘赌、光源选择与光源表面点、BSDF 方向。
+	 */
+	void set_sampler(const SamplerType type) {
+		m_sampler_type = type;
+	}
+
+	/**
+	 * @brief 设置自适应采样。
+	 *
+	 * 启用后 samples_per_pixel 是全图平均每个像素的采样预算：每个像素先取 min_samples 个采样，之后每轮再取
+	 * ADAPTIVE_BATCH 个；像素亮度均值的置信区间半宽不超过均值的 relative_error 倍、且邻域内的像素也都满足时停止，
+	 * 省下的预算留给仍有噪声的像素，单个像素至多取 ADAPTIVE_MAX_FACTOR 倍的平均预算。
+	 *
+	 * @param relative_error 相对误差阈值，不大于 0 时关闭自适应采样（默认）。
+	 * @param min_samples 每个像素估计方差前的最少采样数。
+	 */
+	void set_adaptive_sampling(const float relative_error, const int min_samples = ADAPTIVE_MIN_SAMPLES) {
+		m_adaptive_error = relative_error;
+		m_adaptive_min_samples = std::max(min_samples, 2);
+	}
+
+	/**
+	 * @brief 设置渐进渲染的时间预算。
+	 *
+	 * 设置后渲染按轮次进行，每轮给全部像素追加 PROGRESSIVE_BATCH 个采样（自适应采样时按其轮次），
+	 * 达到目标采样数或用时超过预算时在当前轮次结束后停止，图像按各像素实际的采样数平均。
+	 *
+	 * @param seconds 时间预算（秒），不大于 0 时不限时（默认）。
+	 */
+	void set_time_budget(const double seconds) {
+		m_time_budget = seconds;
+	}
+
+	/**
+	 * @brief 设置检查点文件，使渲染可以被中断后继续。
+	 *
+	 * 设置后渲染按轮次进行：开始时若检查点存在则从中恢复，各像素从下一个采样序号继续追踪，直到目标采样数；
+	 * 每隔 interval 秒、收到 SIGTERM 时与渲染结束时写入检查点，其中保存累积的辐射度、各像素的采样数与采样器状态。
+	 * 收到 SIGTERM 后当前轮次结束即停止，仍然输出已累积的图像。检查点的图像尺寸、采样器类型或种子与当前设置不同时
+	 * 渲染抛出 std::runtime_error；场景与其他设置不会被检查，须由调用方保证一致。
+	 *
+	 * @param path 检查点文件路径，为空时关闭（默认）。
+	 * @param interval 定期写入检查点的间隔（秒）。
+	 */
+	void set_checkpoint(std::filesystem::path path, const double interval = CHECKPOINT_INTERVAL) {
+		m_checkpoint_path = std::move(path);
+		m_checkpoint_interval = interval;
+	}
+
+	/**
+	 * @brief 设置快照的采样数：渲染按轮次进行，每当采样数达到其中一个值时输出当时累积的图像，然后继续采样。
+	 *
+	 * 轮次在快照处截断，快照图像就是该采样数下的渐进结果，无需为每个采样数从头渲染一次。
+	 * 自适应采样时按仍在采样的像素的采样数计；大于目标采样数的快照，以及全部像素收敛、时间预算用完或收到 SIGTERM
+	 * 时尚未达到的快照不输出。
+	 *
+	 * @param sample_counts 快照的采样数，为空时关闭（默认）。
+	 */
+	void set_snapshots(std::vector<int> sample_counts) {
+		std::ranges::sort(sample_counts);
+		const auto [first, last] = std::ranges::unique(sample_counts);
+		sample_counts.erase(first, last);
+		std::erase_if(sample_counts, [](const int count) { return count <= 0; });
+		m_snapshots = std::move(sample_counts);
+	}
+
+	/**
+	 * @brief 设置 render 写出 PNG 时的色调映射，默认只做 gamma 2.0 校正与截断。
+	 */
+	void set_tone_mapping(const ToneMapSettings& settings) {
+		m_tone_mapping = settings;
+	}
+
+	/**
+	 * @brief 设置 render 是否同时写出线性辐射度的 HDR 文件（与 PNG 同名，扩展名为 .pfm 或 .exr），
+	 * 之后可以用 tone_map 以不同的曝光与色调映射重新生成 PNG 而无需重新渲染。
+	 */
+	void set_hdr_output(const HDRFormat format) {
+		m_hdr_format = format;
 	}
 
 // --- Constants ---
 	static constexpr double RAY_T_MIN = 0.001;         ///< 光线相交检测的最小 t 值（防止自相交）。
 	static constexpr int RR_START_BOUNCE = 3;          ///< 开始俄罗斯轮盘赌的弹射次数。
 	static constexpr float RR_MIN_PROBABILITY = 0.05F; ///< 俄罗斯轮盘赌的最小继续概率。
+	static constexpr double SHADOW_RAY_EPSILON = 1e-4; ///< 阴影光线在光源前按比例截断，避免光源自身被算作遮挡。
+	static constexpr int WAVEFRONT_BATCH_SIZE = 1 << 16; ///< 波前积分器每批同时推进的最大路径数。
+	static constexpr std::uint32_t PIXEL_DIMENSIONS = 2;  ///< 像素抖动占用的采样维度数。
+	static constexpr std::uint32_t BOUNCE_DIMENSIONS = 8; ///< 每次弹射占用的采样维度数。
+	static constexpr std::uint32_t RR_DIMENSION = 0;	  ///< 弹射内俄罗斯轮盘赌的维度。
+	static constexpr std::uint32_t LIGHT_DIMENSION = 1;	  ///< 弹射内光源采样的起始维度：光源选择，之后为光源表面点。
+	static constexpr std::uint32_t BSDF_DIMENSION = 6;	  ///< 弹射内 BSDF 方向的起始维度（二维）。
+	static constexpr int ADAPTIVE_MIN_SAMPLES = 16;		  ///< 自适应采样默认的每像素最少采样数。
+	static constexpr int ADAPTIVE_BATCH = 16;			  ///< 自适应采样每轮给未收敛像素追加的采样数。
+	static constexpr int ADAPTIVE_MAX_FACTOR = 8;		  ///< 单个像素的采样数上限相对平均预算的倍数。
+	static constexpr float ADAPTIVE_CONFIDENCE_Z = 1.96F; ///< 置信区间的正态分位数（95%）。
+	static constexpr float ADAPTIVE_MIN_LUMINANCE = 0.05F; ///< 暗于此亮度的像素按此亮度计算相对误差。
+	static constexpr int ADAPTIVE_WINDOW_RADIUS = 2;	  ///< 停止采样前须全部收敛的邻域半径（5×5 窗口）。
+	static constexpr int PROGRESSIVE_BATCH = 8;			  ///< 渐进渲染每轮给每个像素追加的采样数。
+	static constexpr double CHECKPOINT_INTERVAL = 300.0;  ///< 默认的检查点写入间隔（秒）。
+	static constexpr int TILE_SIZE = 16;				  ///< 默认的图块边长。
+	static constexpr int MAX_STRATEGIES = 3;			  ///< 一趟渲染至多同时估计的采样策略数。
+	static constexpr double PROGRESS_INTERVAL = 0.25;	  ///< 图块调度时打印进度的最短间隔（秒）。
 
 	/**
 	 * @brief 从相机视角渲染场景。
 	 * 
-	 * @param scene 要渲染的场景。
+	 * @param scene 要渲染的场景，可以是 Scene 或 BVH 等任意 Hittable。
+	 * @param lights 光源列表，用于光源采样。
 	 * @param cam 视角相机。
-	 * @param filename 输出图像的文件名。
+	 * @param filename 输出图像的文件名；启用自适应采样时，采样数热力图另存为文件名加 "_spp" 后缀的图像，
+	 * 设置了 HDR 输出时，线性辐射度另存为同名的 .pfm 或 .exr 文件。
+	 * 同时估计多种采样策略时，每种策略的图像在文件名后加 "_mis"、"_light" 或 "_material" 后缀。
+	 * 设置了快照时，每个快照的图像（与 HDR 文件）另存为文件名加 "_<采样数>" 后缀的文件。
 	 */
-	void render(const Scene& scene, const std::shared_ptr<Hittable>& lights, const Camera& cam, const std::string& filename);
+	void render(const Hittable& scene, const std::shared_ptr<Hittable>& lights, const Camera& cam, const std::string& filename);
+
+	/**
+	 * @brief 渲染到线性帧缓冲，不写出图像。
+	 *
+	 * @return 按行从上到下排列的像素颜色（各采样的平均值，未做 gamma 校正）。
+	 */
+	std::vector<glm::vec3> render_framebuffer(const Hittable& scene, const std::shared_ptr<Hittable>& lights,
+											  const Camera& cam);
+
+	/**
+	 * @brief 快照回调，参数为快照的采样数与当时各策略的线性帧缓冲。
+	 */
+	using SnapshotCallback = std::function<void(int samples, const std::vector<std::vector<glm::vec3>>& framebuffers)>;
+
+	/**
+	 * @brief 渲染到线性帧缓冲，每种采样策略一个，顺序与 set_sampling_strategies 相同。
+	 *
+	 * @param on_snapshot 每个快照调用一次，可以为空。
+	 */
+	std::vector<std::vector<glm::vec3>> render_framebuffers(const Hittable& scene,
+															const std::shared_ptr<Hittable>& lights, const Camera& cam,
+															const SnapshotCallback& on_snapshot = {});
+
+	/**
+	 * @brief 上一次渲染中每个像素实际追踪的采样数，按行从上到下排列。
+	 */
+	[[nodiscard]] const std::vector<int>& sample_counts() const {
+		return m_sample_counts;
+	}
+
+	/**
+	 * @brief 把上一次渲染的采样数写成热力图（PNG），颜色从黑经紫、红、橙到浅黄，按最大采样数归一化。
+	 */
+	void write_sample_heatmap(const std::string& filename) const;
 
 private:
+	/**
+	 * @brief 一趟渲染：对一组像素追踪序号连续的一段采样，颜色累加到帧缓冲。
+	 */
+	struct PixelPass {
+		std::span<const std::uint32_t> pixels;		 ///< 帧缓冲索引，按升序排列。
+		int first_sample = 0;						 ///< 第一个采样的序号。
+		int sample_count = 0;						 ///< 每个像素追踪的采样数。
+		std::vector<double>* luminance_sq = nullptr; ///< 非空时累加每个采样亮度的平方，用于估计方差。
+		bool report_progress = false;				 ///< 是否打印进度。
+	};
+
+	/**
+	 * @brief 一个路径顶点的采样结果：与递归估计完全相同，但不追踪任何光线，由积分器决定何时追踪。
+	 *
+	 * 每种采样策略至多一个样本，MIS 权重只依赖各策略的 PDF，在生成样本时即可确定；
+	 * 因此光源样本化为一条带权重的阴影光线，材质样本化为续接光线与吞吐量的乘数。
+	 */
+	struct PathVertex {
+		using StrategyValues = std::array<glm::vec3, MAX_STRATEGIES>;
+
+		glm::vec3 emitted = glm::vec3(0.0F);				 ///< 顶点自发光。
+		bool shadow = false;								 ///< 是否需要追踪阴影光线。
+		Ray shadow_ray = Ray(glm::vec3(0.0F), glm::vec3(0.0F)); ///< 指向光源采样点的阴影光线。
+		double shadow_t_max = 0.0;							 ///< 阴影光线的遮挡测试上界（光源之前）。
+		StrategyValues shadow_radiance{};					 ///< 各策略在阴影光线未被遮挡时的贡献，已含 MIS 权重。
+		std::uint32_t shadow_strategies = 0;				 ///< 使用光源样本的策略掩码。
+		bool extend = false;								 ///< 是否继续追踪材质采样光线。
+		Ray next = Ray(glm::vec3(0.0F), glm::vec3(0.0F));	 ///< 材质采样的续接光线。
+		StrategyValues weight{};							 ///< 各策略续接光线带回的辐射度的乘数，已含 MIS 权重。
+		std::uint32_t extend_strategies = 0;				 ///< 继续追踪续接光线的策略掩码。
+	};
+
+	/**
+	 * @brief 各采样策略的颜色，下标与 m_strategies 相同。
+	 */
+	using StrategyColors = PathVertex::StrategyValues;
+
 	/**
 	 * @brief 计算光线的颜色。
 	 * 
@@ -69,19 +334,192 @@ private:
 	 * @param world 场景。
 	 * @param lights 光源列表。
 	 * @param depth 当前递归深度。
+	 * @param sampler 当前采样的采样器。
 	 * @return glm::vec3 光线颜色。
 	 */
-	glm::vec3 m_ray_color(const Ray& r, const Scene& world, const std::shared_ptr<Hittable>& lights, int depth);
+	glm::vec3 m_ray_color(const Ray& r, const Hittable& world, const std::shared_ptr<Hittable>& lights, int depth,
+						  Sampler& sampler);
+
+	/**
+	 * @brief 计算击中点的出射辐射度：自发光加上按采样策略估计的散射光。
+	 *
+	 * @param r_in 入射光线。
+	 * @param hit_rec 最近击中。
+	 * @param world 场景。
+	 * @param lights 光源列表。
+	 * @param depth 当前递归深度（大于 0）。
+	 * @param sampler 当前采样的采样器。
+	 * @return glm::vec3 沿 r_in 反方向的辐射度。
+	 */
+	glm::vec3 m_shade(const Ray& r_in, const HitRecord& hit_rec, const Hittable& world,
+					  const std::shared_ptr<Hittable>& lights, int depth, Sampler& sampler);
+
+	/**
+	 * @brief 迭代积分器：从已知的第一个击中点出发，在循环中沿材质采样光线推进整条路径。
+	 *
+	 * 每个顶点的采样与 m_shade 相同，递归返回时乘上的权重改为前向累乘到吞吐量中，
+	 * 因此两者的估计完全一致，但调用栈深度不随 depth 增长。
+	 *
+	 * @param r_in 入射光线。
+	 * @param hit_rec 最近击中。
+	 * @param world 场景。
+	 * @param lights 光源列表。
+	 * @param depth 当前剩余深度（大于 0）。
+	 * @param sampler 当前采样的采样器。
+	 * @return glm::vec3 沿 r_in 反方向的辐射度。
+	 */
+	glm::vec3 m_shade_iterative(const Ray& r_in, const HitRecord& hit_rec, const Hittable& world,
+								const std::shared_ptr<Hittable>& lights, int depth, Sampler& sampler) const;
 
+	/**
+	 * @brief 同时估计全部采样策略的迭代积分器：各策略共用一条路径与每个顶点的阴影光线，分别累乘吞吐量。
+	 *
+	 * 某种策略的路径终止后（例如只做光源采样时不追踪续接光线），其余策略继续推进；
+	 * 只有仍在推进的策略需要的样本才会生成。
+	 *
+	 * @param colors [in/out] 各策略累加的辐射度。
+	 */
+	void m_shade_strategies(const Ray& r_in, const HitRecord& hit_rec, const Hittable& world,
+							const std::shared_ptr<Hittable>& lights, int depth, Sampler& sampler,
+							StrategyColors& colors) const;
 
 	/**
-	 * @brief 将像素的颜色写入图像数据缓冲区。
-	 * 
-	 * @param image_data 要写入的缓冲区。
-	 * @param index 缓冲区中的索引。
-	 * @param pixel_color 要写入的颜色。
+	 * @brief 未击中任何对象的光线的颜色（天空渐变或背景色）。
+	 */
+	[[nodiscard]] glm::vec3 m_miss_color(const Ray& r) const;
+
+	/**
+	 * @brief 以光线包追踪一组主光线，并把各通道的颜色累加到 colors。
+	 *
+	 * @param packet 主光线包。
+	 * @param world 场景。
+	 * @param lights 光源列表。
+	 * @param samplers 各通道的采样器，已定位到该通道像素的当前采样。
+	 * @param colors [in/out] 各通道每种策略累加的颜色。
+	 */
+	void m_trace_packet(const RayPacket& packet, const Hittable& world, const std::shared_ptr<Hittable>& lights,
+						const std::array<Sampler*, RayPacket::SIZE>& samplers,
+						std::array<StrategyColors, RayPacket::SIZE>& colors);
+
+	/**
+	 * @brief 击中点材质的自发光：有材质表时静态分发，否则通过虚函数。
+	 */
+	[[nodiscard]] glm::vec3 m_emitted(const Ray& r_in, const HitRecord& rec) const {
+		return m_materials ? m_materials->emitted(r_in, rec) : rec.mat_ptr->emitted(r_in, rec);
+	}
+
+	/**
+	 * @brief 击中点材质的散射：有材质表时静态分发，否则通过虚函数。
+	 */
+	bool m_scatter(const Ray& r_in, const HitRecord& rec, ScatterRecord& srec) const {
+		return m_materials ? m_materials->scatter(r_in, rec, srec) : rec.mat_ptr->scatter(r_in, rec, srec);
+	}
+
+	/**
+	 * @brief 击中点材质的 BRDF：有材质表时静态分发，否则通过虚函数。
+	 */
+	[[nodiscard]] glm::vec3 m_brdf(const Ray& r_in, const HitRecord& rec, const Ray& scattered) const {
+		return m_materials ? m_materials->brdf(r_in, rec, scattered) : rec.mat_ptr->brdf(r_in, rec, scattered);
+	}
+
+	/**
+	 * @brief 对击中点采样：自发光、俄罗斯轮盘赌、光源样本与材质样本及其 MIS 权重。
+	 *
+	 * 光源样本 (NEE) 只在光源列表中求交找到采样点，场景中光源之前是否有遮挡留给调用方用 occluded 查询。
+	 * 采样任务、样本结果与光源分布都是栈上的定长对象，每个顶点结束时随栈帧释放，不访问堆。
+	 *
+	 * @param r_in 入射光线。
+	 * @param hit_rec 最近击中。
+	 * @param lights 光源列表。
+	 * @param depth 当前递归深度（大于 0）。
+	 * @param sampler 当前采样的采样器。
+	 * @param vertex [out] 采样结果。
+	 * @param strategies 要计算的策略掩码，第 k 位对应 m_strategies[k]；只生成这些策略用到的样本。
+	 */
+	void m_sample_vertex(const Ray& r_in, const HitRecord& hit_rec, const std::shared_ptr<Hittable>& lights,
+						 int depth, Sampler& sampler, PathVertex& vertex, std::uint32_t strategies = 1U) const;
+
+	/**
+	 * @brief 生成像素的一条相机主光线，采样器须已定位到该像素的当前采样。
+	 */
+	[[nodiscard]] Ray m_primary_ray(const Camera& cam, std::uint32_t pixel, Sampler& sampler) const;
+
+	/**
+	 * @brief 每个像素至多追踪的采样数，也是低差异采样器构造时使用的采样数。
+	 */
+	[[nodiscard]] int m_max_samples_per_pixel() const {
+		return m_adaptive_error > 0 ? m_samples_per_pixel * ADAPTIVE_MAX_FACTOR : m_samples_per_pixel;
+	}
+
+	/**
+	 * @brief 按当前积分器执行一趟渲染。
+	 */
+	void m_render_pass(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+					   const PixelPass& pass, std::vector<glm::vec3>& framebuffer);
+
+	/**
+	 * @brief 渲染一组至多 RayPacket::SIZE 个像素的全部采样，每个采样的主光线组成一个光线包；颜色累加到 framebuffer。
+	 *
+	 * @param group 像素的帧缓冲索引。
+	 * @param samplers 各通道使用的采样器。
+	 */
+	void m_render_group(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+						const PixelPass& pass, std::span<const std::uint32_t> group,
+						const std::array<Sampler*, RayPacket::SIZE>& samplers, std::vector<glm::vec3>& framebuffer);
+
+	/**
+	 * @brief 逐像素渲染：同一行上相邻的像素组成一组，各组按行序动态分配给线程；颜色累加到 framebuffer。
+	 */
+	void m_render_scanlines(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+							const PixelPass& pass, std::vector<glm::vec3>& framebuffer);
+
+	/**
+	 * @brief 逐像素渲染：按图块调度，图块内按 Morton 顺序相邻的像素组成一组；颜色累加到 framebuffer。
+	 *
+	 * 进度只由 0 号线程在图块之间汇总打印，其余线程只在完成图块时写自己的计数。
+	 */
+	void m_render_tiles(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+						const PixelPass& pass, std::vector<glm::vec3>& framebuffer);
+
+	/**
+	 * @brief 波前积分器：每个采样轮次把全部像素的路径分批，按阶段推进；颜色累加到 framebuffer。
+	 */
+	void m_render_wavefront(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+							const PixelPass& pass, std::vector<glm::vec3>& framebuffer);
+
+	/**
+	 * @brief 渐进渲染：按轮次累加采样，直到达到目标采样数、时间预算用完或收到 SIGTERM，按需写入检查点。
+	 *
+	 * 自适应采样时每轮只渲染未收敛的像素，直到全部收敛或预算用完。轮次在快照的采样数处截断，达到时调用 on_snapshot。
+	 */
+	void m_render_progressive(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+							  const SnapshotCallback& on_snapshot);
+
+	/**
+	 * @brief 当前累积的各策略帧缓冲：辐射度之和除以各像素的采样数。
+	 */
+	[[nodiscard]] std::vector<std::vector<glm::vec3>> m_resolve() const;
+
+	/**
+	 * @brief 写出各策略的 PNG 与（设置了 HDR 输出时）HDR 文件。
+	 *
+	 * @param stem 不含扩展名的文件名，多种策略时各自再加策略后缀。
+	 * @param extension PNG 的扩展名。
+	 */
+	void m_write_images(const std::vector<std::vector<glm::vec3>>& framebuffers, const std::string& stem,
+						const std::string& extension) const;
+
+	/**
+	 * @brief 检查点存在时从中恢复累积数据。
+	 *
+	 * @throws std::runtime_error 检查点无法读取或与当前设置不一致时抛出。
+	 */
+	void m_restore_checkpoint();
+
+	/**
+	 * @brief 把当前累积的数据写入检查点。
 	 */
-	static void _write_color(std::vector<unsigned char>& image_data, int index, glm::vec3 pixel_color);
+	void m_save_checkpoint() const;
 
 	int _image_width;       ///< 图像宽度。
 	int _image_height;      ///< 图像高度。
@@ -89,7 +527,25 @@ private:
 	int m_max_depth;         ///< 最大递归深度。
 	glm::vec3 m_background_color = glm::vec3(0,0,0);
 	bool m_use_sky_gradient = true;
-	SamplingStrategy m_strategy = SamplingStrategy::MIS;
+	std::vector<SamplingStrategy> m_strategies{SamplingStrategy::MIS}; ///< 同时估计的采样策略，至少一种。
+	bool m_packet_tracing = true; ///< 是否以光线包追踪主光线。
+	IntegratorMode m_integrator = IntegratorMode::RECURSIVE; ///< 路径积分器的执行方式。
+	std::shared_ptr<const MaterialTable> m_materials; ///< 材质表，为空时通过虚函数着色。
+	std::uint64_t m_seed = 0; ///< 随机数种子。
+	SamplerType m_sampler_type = SamplerType::INDEPENDENT; ///< 采样器类型。
+	float m_adaptive_error = 0.0F; ///< 自适应采样的相对误差阈值，不大于 0 时关闭。
+	int m_adaptive_min_samples = ADAPTIVE_MIN_SAMPLES; ///< 自适应采样的每像素最少采样数。
+	double m_time_budget = 0.0; ///< 渐进渲染的时间预算（秒），不大于 0 时不限时。
+	std::filesystem::path m_checkpoint_path; ///< 检查点文件，为空时不写入。
+	double m_checkpoint_interval = CHECKPOINT_INTERVAL; ///< 检查点写入间隔（秒）。
+	ToneMapSettings m_tone_mapping; ///< 写出 PNG 时的色调映射。
+	HDRFormat m_hdr_format = HDRFormat::NONE; ///< 额外写出的 HDR 文件格式。
+	RenderSchedule m_schedule = RenderSchedule::TILES; ///< 逐像素渲染的调度方式。
+	int m_tile_size = TILE_SIZE; ///< 图块边长。
+	std::vector<int> m_snapshots; ///< 快照的采样数，升序。
+	std::vector<glm::vec3> m_radiance; ///< 各像素累积的辐射度之和，每种策略一层，层内按行从上到下排列。
+	std::vector<double> m_luminance_sq; ///< 各像素每个采样亮度的平方和。
+	std::vector<int> m_sample_counts; ///< 上一次渲染每个像素的采样数。
 };
 
 } // namespace rt
@@ -0,0 +1,253 @@
+#pragma once
+#include "rt/core/AABB.hpp"
+#include "rt/core/Ray.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 线性化（深度优先顺序）存储的 BVH 节点。
+ *
+ * 内部节点的左子节点紧跟在自身之后，右子节点的下标保存在 offset 中；
+ * 叶节点的 offset 为第一个图元的下标，count 为图元数量。
+ */
+struct BVHNode {
+	AABB bounds;		 ///< 节点包围盒。
+	std::uint32_t offset; ///< 叶节点：首个图元下标；内部节点：右子节点下标。
+	std::uint16_t count;  ///< 叶节点中的图元数量，内部节点为 0。
+	std::uint16_t axis;	 ///< 内部节点的划分轴，用于按光线方向决定遍历顺序。
+
+	[[nodiscard]] bool is_leaf() const { return count > 0; }
+};
+
+/**
+ * @brief BVH 构建算法。
+ */
+enum class BVHBuildMode {
+	SAH,		///< 完整扫描的 SAH（单线程，质量最高，构建最慢）
+	BINNED_SAH, ///< 按质心分桶的 SAH，使用 OpenMP 任务并行构建 (默认)
+	LBVH,		///< 基于 Morton 码排序的线性 BVH，构建最快，适合超大或逐帧重建的场景
+	LBVH_TREELET, ///< LBVH 构建后再做 treelet 重构优化，以少量构建时间换取更好的树质量
+};
+
+/**
+ * @brief 并行构建时使用的临时节点，子节点以下标引用，构建完成后再线性化为 BVHNode。
+ */
+struct BVHBuildNode {
+	AABB bounds;						   ///< 节点包围盒。
+	std::array<std::uint32_t, 2> children{}; ///< 子节点下标（叶节点无效）。
+	std::uint32_t first = 0;			   ///< 叶节点首个图元下标。
+	std::uint32_t count = 0;			   ///< 叶节点图元数，内部节点为 0。
+	std::uint16_t axis = 0;				   ///< 划分轴。
+};
+
+/**
+ * @brief 一次 BVH 构建的统计信息。
+ */
+struct BVHBuildStats {
+	double build_ms = 0.0;	///< 构建耗时（毫秒）。
+	float sah_cost = 0.0F;	///< 树的 SAH 代价，越低表示遍历越快。
+	size_t node_count = 0;	///< 节点总数。
+	size_t leaf_count = 0;	///< 叶节点数。
+	size_t prim_count = 0;	///< 图元数。
+	int max_depth = 0;		///< 节点的最大深度，根节点为 0。
+};
+
+/**
+ * @brief 与图元类型无关的二叉 BVH 拓扑。
+ *
+ * 只根据图元包围盒构建层次结构，并给出图元的重排顺序；图元数据由持有者按该顺序重排后保存，
+ * 这样同一套构建与遍历代码既可用于 Hittable 列表，也可用于网格三角形等紧凑图元。
+ */
+class BVHTree {
+public:
+	static constexpr int MAX_LEAF_SIZE = 4;		   ///< 叶节点允许的最大图元数。
+	static constexpr int MAX_DEPTH = 64;		   ///< 最大树深（同时是遍历栈大小）。
+	static constexpr float TRAVERSAL_COST = 1.0F;  ///< SAH 中遍历一个内部节点的相对代价。
+	static constexpr float INTERSECT_COST = 1.0F;  ///< SAH 中与一个图元求交的相对代价。
+	static constexpr int BIN_COUNT = 32;		   ///< 分桶 SAH 每个轴上的桶数。
+	static constexpr size_t MORTON64_THRESHOLD = size_t{1} << 16; ///< 图元数超过该值时 LBVH 使用 63 位 Morton 码。
+	static constexpr int TREELET_SIZE = 7;						 ///< treelet 优化中每个 treelet 的叶子数。
+
+	/**
+	 * @brief 使用表面积启发式 (SAH) 构建 BVH。
+	 *
+	 * @param prim_bounds 每个图元的包围盒。
+	 * @param mode 构建算法：完整扫描 SAH 在三个轴上对质心排序并尝试所有划分；
+	 *             分桶 SAH 只在桶边界处划分，并在多线程上并行分桶与构建子树；
+	 *             LBVH 将质心量化为 30/63 位 Morton 码，并行基数排序后直接生成层次结构。
+	 */
+	void build(std::span<const AABB> prim_bounds, BVHBuildMode mode = BVHBuildMode::BINNED_SAH);
+
+	/**
+	 * @brief 直接采用已线性化的节点（例如从缓存文件读取），不重新构建。
+	 *
+	 * 图元必须已按这些节点的叶子顺序排列，indices() 为恒等映射。
+	 *
+	 * @param nodes 深度优先顺序的节点。
+	 * @param prim_count 图元数。
+	 */
+	void assign(std::span<const BVHNode> nodes, size_t prim_count);
+
+	/**
+	 * @brief 拓扑不变、图元移动后重新拟合节点包围盒。
+	 *
+	 * 按深度从深到浅逐层更新，同一层的节点相互独立，使用 OpenMP 并行处理；代价为 O(n)，
+	 * 远低于重新构建，但图元移动较大时树的质量会下降，可用返回的 SAH 代价与 stats().sah_cost 比较来决定是否重建。
+	 *
+	 * @param prim_bounds 按叶子顺序排列的图元包围盒（第 i 个对应叶子槽位 i），数量必须与构建时相同。
+	 * @return 重新拟合后的 SAH 代价。
+	 */
+	float refit(std::span<const AABB> prim_bounds);
+
+	/**
+	 * @brief 最近一次构建的统计信息（耗时与 SAH 代价）。
+	 */
+	[[nodiscard]] const BVHBuildStats& stats() const { return _stats; }
+
+	/**
+	 * @brief 构建得到的图元顺序：第 i 个叶子槽位对应原始图元 indices()[i]。
+	 */
+	[[nodiscard]] const std::vector<std::uint32_t>& indices() const { return _indices; }
+
+	[[nodiscard]] const std::vector<BVHNode>& nodes() const { return _nodes; }
+
+	[[nodiscard]] bool empty() const { return _nodes.empty(); }
+
+	/**
+	 * @brief 根节点包围盒，空树返回空包围盒。
+	 */
+	[[nodiscard]] AABB bounds() const { return _nodes.empty() ? AABB() : _nodes[0].bounds; }
+
+	/**
+	 * @brief 计算整棵树的 SAH 代价（相对根节点表面积归一化），用于衡量树的质量。
+	 */
+	[[nodiscard]] float sah_cost() const;
+
+	/**
+	 * @brief 按最近击中语义遍历 BVH。
+	 *
+	 * 近的子节点先访问，t_max 随着击中不断收缩，被裁剪的子树不会再访问。
+	 *
+	 * @param r 光线。
+	 * @param t_min 有效区间下界。
+	 * @param t_max [in/out] 有效区间上界，叶回调击中后应将其更新为新的最近距离。
+	 * @param leaf 叶回调 bool(uint32_t first, uint32_t count, double& t_max)，
+	 *             对重排后的图元区间 [first, first + count) 求交，有击中时返回 true。
+	 * @param root 从该节点开始遍历，只访问其子树；光线包发散后逐条光线继续遍历时使用。
+	 * @return true 如果有任何叶回调报告击中。
+	 */
+	template <typename LeafFn>
+	bool intersect(const Ray& r, const double t_min, double& t_max, LeafFn&& leaf, const std::uint32_t root = 0) const {
+		if (_nodes.empty()) return false;
+
+		const glm::vec3 origin = r.origin();
+		const glm::vec3 inv_dir = 1.0F / r.direction();
+		const std::array<bool, 3> dir_neg = {inv_dir.x < 0, inv_dir.y < 0, inv_dir.z < 0};
+		const auto t_min_f = static_cast<float>(t_min);
+
+		std::array<std::uint32_t, MAX_DEPTH> stack{};
+		int stack_size = 0;
+		std::uint32_t node_idx = root;
+		bool hit_anything = false;
+
+		while (true) {
+			const BVHNode& node = _nodes[node_idx];
+			float t_entry = 0;
+			if (node.bounds.hit(origin, inv_dir, t_min_f, to_float_t(t_max), t_entry)) {
+				if (node.is_leaf()) {
+					if (leaf(node.offset, static_cast<std::uint32_t>(node.count), t_max)) hit_anything = true;
+				} else {
+					// 沿光线方向先访问近侧子节点，远侧子节点入栈
+					if (dir_neg[node.axis]) {
+						stack[stack_size++] = node_idx + 1;
+						node_idx = node.offset;
+					} else {
+						stack[stack_size++] = node.offset;
+						node_idx = node_idx + 1;
+					}
+					continue;
+				}
+			}
+			if (stack_size == 0) break;
+			node_idx = stack[--stack_size];
+		}
+		return hit_anything;
+	}
+
+	/**
+	 * @brief 按任意击中语义遍历 BVH，任一叶回调报告遮挡后立即返回。
+	 *
+	 * 不需要找最近击中，因此不按光线方向排序子节点，t_max 也保持不变。
+	 *
+	 * @param leaf 叶回调 bool(uint32_t first, uint32_t count)，区间内存在遮挡时返回 true。
+	 * @return true 如果光线在 [t_min, t_max] 内被遮挡。
+	 */
+	template <typename LeafFn>
+	bool occluded(const Ray& r, const double t_min, const double t_max, LeafFn&& leaf) const {
+		if (_nodes.empty()) return false;
+
+		const glm::vec3 origin = r.origin();
+		const glm::vec3 inv_dir = 1.0F / r.direction();
+		const auto t_min_f = static_cast<float>(t_min);
+		const float t_max_f = to_float_t(t_max);
+
+		std::array<std::uint32_t, MAX_DEPTH> stack{};
+		int stack_size = 0;
+		std::uint32_t node_idx = 0;
+
+		while (true) {
+			const BVHNode& node = _nodes[node_idx];
+			float t_entry = 0;
+			if (node.bounds.hit(origin, inv_dir, t_min_f, t_max_f, t_entry)) {
+				if (node.is_leaf()) {
+					if (leaf(node.offset, static_cast<std::uint32_t>(node.count))) return true;
+				} else {
+					stack[stack_size++] = node.offset;
+					node_idx = node_idx + 1;
+					continue;
+				}
+			}
+			if (stack_size == 0) break;
+			node_idx = stack[--stack_size];
+		}
+		return false;
+	}
+
+	/**
+	 * @brief 将 double 类型的光线参数转换为包围盒测试使用的 float，超出范围时取 float 最大值。
+	 */
+	static float to_float_t(const double t) {
+		constexpr auto FLOAT_MAX = static_cast<double>(std::numeric_limits<float>::max());
+		return t < FLOAT_MAX ? static_cast<float>(t) : std::numeric_limits<float>::infinity();
+	}
+
+private:
+	/**
+	 * @brief 将临时节点树按深度优先顺序写入 _nodes。
+	 */
+	void _flatten(const std::vector<BVHBuildNode>& build_nodes, std::uint32_t root);
+
+	void _update_stats(size_t prim_count, double build_ms);
+
+	/**
+	 * @brief 按深度对节点分组，供 refit 逐层并行更新；拓扑变化后需要重新计算。
+	 */
+	void _compute_levels();
+
+	void _build_full_sah(std::span<const AABB> prim_bounds, std::span<const glm::vec3> centroids);
+	void _build_binned_sah(std::span<const AABB> prim_bounds, std::span<const glm::vec3> centroids);
+	void _build_lbvh(std::span<const AABB> prim_bounds, std::span<const glm::vec3> centroids,
+					 bool optimize_treelets);
+
+	BVHBuildStats _stats;				   ///< 最近一次构建的统计信息。
+	std::vector<BVHNode> _nodes;		   ///< 深度优先顺序的节点数组，下标 0 为根节点。
+	std::vector<std::uint32_t> _indices; ///< 叶子槽位到原始图元下标的映射。
+	std::vector<std::uint32_t> _level_nodes;   ///< 按深度排序的节点下标，首次 refit 时计算。
+	std::vector<std::uint32_t> _level_offsets; ///< 每层在 _level_nodes 中的起始位置。
+};
+
+} // namespace rt
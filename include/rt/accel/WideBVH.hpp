@@ -0,0 +1,173 @@
+#pragma once
+#include "rt/accel/BVHTree.hpp"
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 8 叉 BVH 节点，子节点包围盒以 SoA 形式存放，便于一次 SIMD 指令测试全部 8 个子节点。
+ *
+ * 空槽位的包围盒为空（min = +inf, max = -inf），任何光线都不会与之相交。
+ */
+struct alignas(32) WideBVHNode {
+	static constexpr int WIDTH = 8; ///< 每个节点的子节点数。
+
+	std::array<float, WIDTH> min_x; ///< 子节点包围盒最小角点 x。
+	std::array<float, WIDTH> min_y; ///< 子节点包围盒最小角点 y。
+	std::array<float, WIDTH> min_z; ///< 子节点包围盒最小角点 z。
+	std::array<float, WIDTH> max_x; ///< 子节点包围盒最大角点 x。
+	std::array<float, WIDTH> max_y; ///< 子节点包围盒最大角点 y。
+	std::array<float, WIDTH> max_z; ///< 子节点包围盒最大角点 z。
+	std::array<std::uint32_t, WIDTH> child; ///< 内部子节点：节点下标；叶子：首个图元下标。
+	std::array<std::uint32_t, WIDTH> count; ///< 叶子的图元数，内部子节点为 0。
+};
+
+/**
+ * @brief 由二叉 BVH 折叠得到的 8 叉 BVH (BVH8)。
+ *
+ * 每个节点用 AVX2 一次完成 8 个子节点的 slab 测试，命中的子节点按进入距离排序后遍历，
+ * 减少二叉树遍历中的指针跳转与栈操作。运行时检测 CPU 是否支持 AVX2，不支持时使用标量实现。
+ * 图元顺序与源二叉树相同，叶回调与 BVHTree::intersect 一致。
+ */
+class WideBVH {
+public:
+	/// 遍历栈大小：8 叉树不比源二叉树深，每展开一层栈最多净增 WIDTH - 1 项，另加根节点一项。
+	static constexpr int STACK_SIZE = (WideBVHNode::WIDTH - 1) * BVHTree::MAX_DEPTH + 1;
+
+	/**
+	 * @brief 将二叉 BVH 折叠为 8 叉 BVH：反复展开面积最大的内部子节点，直到凑满 8 个子节点。
+	 *
+	 * @param tree 已构建的二叉 BVH。
+	 */
+	void build(const BVHTree& tree);
+
+	[[nodiscard]] bool empty() const { return _nodes.empty(); }
+	[[nodiscard]] const std::vector<WideBVHNode>& nodes() const { return _nodes; }
+
+	/**
+	 * @brief 是否使用 AVX2 节点测试（运行时检测结果）。
+	 */
+	[[nodiscard]] bool uses_avx2() const { return _use_avx2; }
+
+	/**
+	 * @brief 强制使用标量节点测试，用于对比与测试。
+	 */
+	void set_force_scalar(bool force_scalar);
+
+	/**
+	 * @brief 按最近击中语义遍历，参数与 BVHTree::intersect 相同。
+	 */
+	template <typename LeafFn>
+	bool intersect(const Ray& r, const double t_min, double& t_max, LeafFn&& leaf) const {
+		if (_nodes.empty()) return false;
+
+		const glm::vec3 origin = r.origin();
+		const glm::vec3 inv_dir = 1.0F / r.direction();
+		const auto t_min_f = static_cast<float>(t_min);
+
+		struct Entry {
+			std::uint32_t child; ///< 节点下标或叶子首个图元下标。
+			std::uint32_t count; ///< 叶子图元数，内部节点为 0。
+			float t;			 ///< 进入该子节点包围盒的距离。
+		};
+		std::array<Entry, STACK_SIZE> stack{};
+		int stack_size = 0;
+		stack[stack_size++] = {0, 0, t_min_f};
+		bool hit_anything = false;
+
+		while (stack_size > 0) {
+			const Entry entry = stack[--stack_size];
+			// 入栈后 t_max 可能已被更近的击中收缩，此时整棵子树都可以跳过
+			if (entry.t > BVHTree::to_float_t(t_max)) continue;
+
+			if (entry.count > 0) {
+				if (leaf(entry.child, entry.count, t_max)) hit_anything = true;
+				continue;
+			}
+
+			const WideBVHNode& node = _nodes[entry.child];
+			std::array<float, WideBVHNode::WIDTH> t_near{};
+			const unsigned mask = _use_avx2
+									  ? intersect_node_avx2(node, origin, inv_dir, t_min_f, BVHTree::to_float_t(t_max), t_near)
+									  : intersect_node_scalar(node, origin, inv_dir, t_min_f, BVHTree::to_float_t(t_max), t_near);
+
+			// 命中的子节点按距离从远到近入栈，使最近的子节点最先弹出
+			std::array<Entry, WideBVHNode::WIDTH> hits{};
+			int n_hits = 0;
+			for (int k = 0; k < WideBVHNode::WIDTH; ++k) {
+				if (!(mask & (1U << k))) continue;
+				Entry e{node.child[k], node.count[k], t_near[k]};
+				int pos = n_hits++;
+				while (pos > 0 && hits[pos - 1].t < e.t) {
+					hits[pos] = hits[pos - 1];
+					--pos;
+				}
+				hits[pos] = e;
+			}
+			assert(stack_size + n_hits <= STACK_SIZE);
+			for (int k = 0; k < n_hits; ++k)
+				stack[stack_size++] = hits[k];
+		}
+		return hit_anything;
+	}
+
+	/**
+	 * @brief 按任意击中语义遍历，参数与 BVHTree::occluded 相同；命中的子节点不排序，直接入栈。
+	 */
+	template <typename LeafFn>
+	bool occluded(const Ray& r, const double t_min, const double t_max, LeafFn&& leaf) const {
+		if (_nodes.empty()) return false;
+
+		const glm::vec3 origin = r.origin();
+		const glm::vec3 inv_dir = 1.0F / r.direction();
+		const auto t_min_f = static_cast<float>(t_min);
+		const float t_max_f = BVHTree::to_float_t(t_max);
+
+		std::array<std::uint32_t, STACK_SIZE> stack{};
+		int stack_size = 0;
+		stack[stack_size++] = 0;
+
+		while (stack_size > 0) {
+			const WideBVHNode& node = _nodes[stack[--stack_size]];
+			std::array<float, WideBVHNode::WIDTH> t_near{};
+			unsigned mask = _use_avx2 ? intersect_node_avx2(node, origin, inv_dir, t_min_f, t_max_f, t_near)
+									  : intersect_node_scalar(node, origin, inv_dir, t_min_f, t_max_f, t_near);
+			// 先测试命中的叶子，再把内部子节点入栈
+			for (; mask != 0; mask &= mask - 1) {
+				const int k = std::countr_zero(mask);
+				if (node.count[k] == 0) {
+					assert(stack_size < STACK_SIZE);
+					stack[stack_size++] = node.child[k];
+				} else if (leaf(node.child[k], node.count[k])) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief 标量实现：测试光线与节点的 8 个子包围盒，返回命中掩码并输出进入距离。
+	 */
+	static unsigned intersect_node_scalar(const WideBVHNode& node, const glm::vec3& origin, const glm::vec3& inv_dir,
+										  float t_min, float t_max, std::array<float, WideBVHNode::WIDTH>& t_near);
+
+	/**
+	 * @brief AVX2 实现，只能在 cpu_features().avx2 为真时调用。
+	 */
+	static unsigned intersect_node_avx2(const WideBVHNode& node, const glm::vec3& origin, const glm::vec3& inv_dir,
+										float t_min, float t_max, std::array<float, WideBVHNode::WIDTH>& t_near);
+
+private:
+	std::uint32_t _collapse(const std::vector<BVHNode>& binary, std::uint32_t binary_idx);
+
+	std::vector<WideBVHNode> _nodes; ///< 节点数组，下标 0 为根节点。
+	bool _use_avx2 = false;			 ///< 是否使用 AVX2 节点测试。
+	bool _force_scalar = false;		 ///< 是否强制使用标量节点测试，重新构建后保持不变。
+};
+
+} // namespace rt
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "rt/apps/Application.hpp"
+
+namespace rt {
+
+class AnimatedSpheresApp : public Application {
+public:
+	void run() override;
+	[[nodiscard]] std::string name() const override { return "Animated Spheres (BVH refit)"; }
+};
+
+} // namespace rt
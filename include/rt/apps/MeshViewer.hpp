@@ -0,0 +1,13 @@
+#pragma once
+
+#include "rt/apps/Application.hpp"
+
+namespace rt {
+
+class MeshViewerApp : public Application {
+public:
+	void run() override;
+	[[nodiscard]] std::string name() const override { return "Mesh Viewer (OBJ/PLY)"; }
+};
+
+} // namespace rt
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "rt/apps/Application.hpp"
+
+namespace rt {
+
+/**
+ * @brief 采样器收敛测量：在 CompareSampling 与 MirrorBox 的场景上，比较各采样器在不同采样数下相对参考图像的误差。
+ */
+class SamplerConvergenceApp : public Application {
+public:
+	void run() override;
+	[[nodiscard]] std::string name() const override { return "Sampler Convergence (error vs spp)"; }
+};
+
+} // namespace rt
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "rt/apps/Application.hpp"
+
+namespace rt {
+
+/**
+ * @brief 线程扩展性基准：同一场景分别用 1 到 128 个线程、扫描线与图块两种调度方式渲染，输出耗时、吞吐量、并行效率
+ * 以及相对扫描线调度的加速比。
+ */
+class ThreadScalingApp : public Application {
+public:
+	void run() override;
+	[[nodiscard]] std::string name() const override { return "Thread Scaling Benchmark"; }
+};
+
+} // namespace rt
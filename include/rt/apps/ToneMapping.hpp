@@ -0,0 +1,16 @@
+#pragma once
+
+#include "rt/apps/Application.hpp"
+
+namespace rt {
+
+/**
+ * @brief 色调映射后处理：读取渲染时保存的 HDR 文件（.pfm 或 .exr），以不同的曝光与算子生成 PNG，无需重新渲染。
+ */
+class ToneMappingApp : public Application {
+public:
+	void run() override;
+	[[nodiscard]] std::string name() const override { return "Tone Mapping (HDR file to PNG)"; }
+};
+
+} // namespace rt
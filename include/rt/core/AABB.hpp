@@ -0,0 +1,147 @@
+#pragma once
+#include "rt/core/Ray.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace rt {
+
+/**
+ * @brief 轴对齐包围盒 (Axis-Aligned Bounding Box)。
+ *
+ * 默认构造得到空包围盒（min 为 +inf，max 为 -inf），可以直接与其它包围盒或点合并。
+ */
+class AABB {
+public:
+	static constexpr float SLAB_ROBUST_SCALE = 1.0F + 2.0F * 3.0F * 0.5F * std::numeric_limits<float>::epsilon();
+
+	AABB() = default;
+
+	/**
+	 * @brief 由两个角点构造包围盒，角点顺序任意。
+	 *
+	 * @param a 第一个角点。
+	 * @param b 第二个角点。
+	 */
+	AABB(const glm::vec3& a, const glm::vec3& b) : _min(glm::min(a, b)), _max(glm::max(a, b)) {}
+
+	[[nodiscard]] const glm::vec3& min() const { return _min; }
+	[[nodiscard]] const glm::vec3& max() const { return _max; }
+
+	/**
+	 * @brief 包围盒是否为空（未包含任何点）。
+	 */
+	[[nodiscard]] bool empty() const { return _min.x > _max.x || _min.y > _max.y || _min.z > _max.z; }
+
+	/**
+	 * @brief 包围盒中心点。
+	 */
+	[[nodiscard]] glm::vec3 centroid() const { return 0.5F * (_min + _max); }
+
+	/**
+	 * @brief 包围盒的对角线向量。
+	 */
+	[[nodiscard]] glm::vec3 extent() const { return _max - _min; }
+
+	/**
+	 * @brief 包围盒的表面积，空包围盒返回 0。SAH 代价的基础量。
+	 */
+	[[nodiscard]] float surface_area() const {
+		if (empty()) return 0.0F;
+		const glm::vec3 d = extent();
+		return 2.0F * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	/**
+	 * @brief 返回跨度最大的轴 (0 = x, 1 = y, 2 = z)。
+	 */
+	[[nodiscard]] int longest_axis() const {
+		const glm::vec3 d = extent();
+		if (d.x > d.y && d.x > d.z) return 0;
+		return d.y > d.z ? 1 : 2;
+	}
+
+	/**
+	 * @brief 将一个点扩展进包围盒。
+	 */
+	void expand(const glm::vec3& p) {
+		_min = glm::min(_min, p);
+		_max = glm::max(_max, p);
+	}
+
+	/**
+	 * @brief 将另一个包围盒合并进当前包围盒。
+	 */
+	void expand(const AABB& box) {
+		_min = glm::min(_min, box._min);
+		_max = glm::max(_max, box._max);
+	}
+
+	/**
+	 * @brief 将厚度不足 delta 的维度向两侧扩展，避免平面物体（如 Quad）产生零厚度的包围盒。
+	 *
+	 * @param delta 最小厚度。
+	 */
+	[[nodiscard]] AABB padded(const float delta) const {
+		AABB box = *this;
+		for (int a = 0; a < 3; ++a) {
+			if (box._max[a] - box._min[a] < delta) {
+				box._min[a] -= 0.5F * delta;
+				box._max[a] += 0.5F * delta;
+			}
+		}
+		return box;
+	}
+
+	/**
+	 * @brief 使用预先计算的方向倒数进行 slab 相交测试。
+	 *
+	 * 遍历加速结构时每条光线只需计算一次 inv_dir，节点测试只剩乘加运算。
+	 *
+	 * @param origin 光线起点。
+	 * @param inv_dir 光线方向各分量的倒数。
+	 * @param t_min 有效区间下界。
+	 * @param t_max 有效区间上界。
+	 * @param t_entry [out] 光线进入包围盒时的 t 值，用于按距离排序遍历。
+	 * @return true 如果光线在 [t_min, t_max] 内与包围盒相交。
+	 */
+	[[nodiscard]] bool hit(const glm::vec3& origin, const glm::vec3& inv_dir, float t_min, float t_max,
+						   float& t_entry) const {
+		for (int a = 0; a < 3; ++a) {
+			const float t0 = (_min[a] - origin[a]) * inv_dir[a];
+			const float t1 = (_max[a] - origin[a]) * inv_dir[a];
+			const float t_near = std::min(t0, t1);
+			// 放大远端距离以抵消浮点舍入误差，保证保守相交 (PBRT: 1 + 2 * gamma(3))
+			const float t_far = std::max(t0, t1) * SLAB_ROBUST_SCALE;
+			// 写成 t > t_min 的形式，使 NaN（0 * inf）不会错误地收缩区间
+			t_min = t_near > t_min ? t_near : t_min;
+			t_max = t_far < t_max ? t_far : t_max;
+			if (t_max < t_min) return false;
+		}
+		t_entry = t_min;
+		return true;
+	}
+
+	/**
+	 * @brief 判断光线是否在 [t_min, t_max] 内与包围盒相交。
+	 */
+	[[nodiscard]] bool hit(const Ray& r, const double t_min, const double t_max) const {
+		float t_entry = 0;
+		return hit(r.origin(), 1.0F / r.direction(), static_cast<float>(t_min), static_cast<float>(t_max), t_entry);
+	}
+
+private:
+	glm::vec3 _min{std::numeric_limits<float>::infinity()};	 ///< 最小角点。
+	glm::vec3 _max{-std::numeric_limits<float>::infinity()}; ///< 最大角点。
+};
+
+/**
+ * @brief 返回同时包含两个包围盒的最小包围盒。
+ */
+inline AABB surrounding_box(const AABB& a, const AABB& b) {
+	AABB box = a;
+	box.expand(b);
+	return box;
+}
+
+} // namespace rt
@@ -0,0 +1,33 @@
+#pragma once
+
+// 为单个函数启用 AVX2/AVX-512 指令生成，使同一个二进制可以在运行时按 CPU 能力选择实现。
+#if defined(__GNUC__) || defined(__clang__)
+#define RT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define RT_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define RT_TARGET_AVX2
+#define RT_TARGET_AVX512
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RT_ARCH_X86 1
+#else
+#define RT_ARCH_X86 0
+#endif
+
+namespace rt {
+
+/**
+ * @brief 运行时检测到的 CPU SIMD 指令集支持情况。
+ */
+struct CpuFeatures {
+	bool avx2 = false;	  ///< 支持 AVX2 + FMA（且操作系统保存 YMM 寄存器）。
+	bool avx512f = false; ///< 支持 AVX-512F（且操作系统保存 ZMM 寄存器）。
+};
+
+/**
+ * @brief 获取当前 CPU 的 SIMD 支持情况，首次调用时检测并缓存。
+ */
+const CpuFeatures& cpu_features();
+
+} // namespace rt
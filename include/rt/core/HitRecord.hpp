@@ -1,5 +1,6 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <memory>
 #include "rt/core/Ray.hpp"
 
@@ -11,9 +12,12 @@ class Material; // Forward declaration
  * @brief 记录光线与物体相交的信息。
  */
 struct HitRecord {
+	static constexpr std::uint32_t NO_MATERIAL_ID = UINT32_MAX; ///< 图元未绑定材质表时的材质编号。
+
 	glm::vec3 p;                       ///< 相交点。
 	glm::vec3 normal;                  ///< 相交点处的表面法线。
-	std::shared_ptr<Material> mat_ptr; ///< 相交物体的材质指针。
+	const Material* mat_ptr = nullptr; ///< 相交物体的材质，不持有所有权（由图元或场景持有），复制记录时没有原子引用计数。
+	std::uint32_t material_id = NO_MATERIAL_ID; ///< 材质在 MaterialTable 中的编号，未绑定时只能通过 mat_ptr 虚调用。
 	double t;                          ///< 相交点处的光线参数 t。
 	double u;                          ///< 纹理坐标 u。
 	double v;                          ///< 纹理坐标 v。
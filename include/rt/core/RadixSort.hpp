@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 基数排序的临时缓冲区，反复排序时复用以避免每次分配。
+ */
+struct RadixSortBuffers {
+	static constexpr int RADIX_BITS = 8;				 ///< 每趟处理的位数。
+	static constexpr int RADIX_SIZE = 1 << RADIX_BITS; ///< 每趟的桶数。
+
+	std::vector<std::uint64_t> keys;							 ///< 分散写入的 key。
+	std::vector<std::uint32_t> values;							 ///< 分散写入的 value。
+	std::vector<std::array<std::size_t, RADIX_SIZE>> offsets; ///< 每个线程的直方图与写入位置。
+};
+
+/**
+ * @brief 并行 LSD 基数排序 (key, value) 对，只排序 key 的低 key_bits 位。
+ *
+ * 每趟中各线程先统计自己区间的直方图，再按 (桶, 线程) 顺序计算前缀和后分散写入，保持稳定性；
+ * 所有 key 在某一趟的数位都相同时跳过该趟的分散写入。
+ *
+ * @param keys 排序键，排序后按升序排列。
+ * @param values 与 keys 一一对应的值，随 key 一起移动。
+ * @param key_bits 参与排序的低位数。
+ */
+void radix_sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, int key_bits);
+
+/**
+ * @brief 使用给定临时缓冲区的 radix_sort。
+ *
+ * 排序时 keys、values 会与缓冲区交换存储，缓冲区预留与 keys 相同的容量即可在反复排序时不再分配。
+ */
+void radix_sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, int key_bits,
+				RadixSortBuffers& buffers);
+
+} // namespace rt
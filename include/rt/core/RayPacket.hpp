@@ -0,0 +1,107 @@
+#pragma once
+#include "rt/core/AABB.hpp"
+#include "rt/core/HitRecord.hpp"
+#include "rt/core/Ray.hpp"
+#include <array>
+#include <cstdint>
+
+namespace rt {
+
+/**
+ * @brief 一起遍历场景的一组光线（光线包），按 SoA 布局存放，每个分量恰好占一个 AVX2 寄存器。
+ *
+ * 同一扫描线上相邻像素的相机主光线高度相干：一起遍历时 BVH 节点只需读取一次，
+ * 包围盒与图元测试可以一条指令处理全部通道，虚函数调用也从每条光线一次变为每个光线包一次。
+ */
+struct alignas(32) RayPacket {
+	static constexpr int SIZE = 8;								  ///< 每个光线包的光线数。
+	static constexpr std::uint32_t FULL_MASK = (1U << SIZE) - 1U; ///< 全部通道有效时的掩码。
+
+	std::array<float, SIZE> origin_x{};	 ///< 起点 x。
+	std::array<float, SIZE> origin_y{};	 ///< 起点 y。
+	std::array<float, SIZE> origin_z{};	 ///< 起点 z。
+	std::array<float, SIZE> dir_x{};	 ///< 方向 x（未归一化）。
+	std::array<float, SIZE> dir_y{};	 ///< 方向 y。
+	std::array<float, SIZE> dir_z{};	 ///< 方向 z。
+	std::array<float, SIZE> inv_dir_x{}; ///< 方向 x 的倒数。
+	std::array<float, SIZE> inv_dir_y{}; ///< 方向 y 的倒数。
+	std::array<float, SIZE> inv_dir_z{}; ///< 方向 z 的倒数。
+	std::uint32_t valid = 0;			 ///< 有效通道掩码，不足 SIZE 条光线时其余通道无效。
+
+	/**
+	 * @brief 写入一个通道的光线并标记为有效。
+	 */
+	void set(int lane, const Ray& r);
+
+	/**
+	 * @brief 取出一个通道的光线，用于回退到单光线求交与着色。
+	 */
+	[[nodiscard]] Ray ray(const int lane) const {
+		return {{origin_x[lane], origin_y[lane], origin_z[lane]}, {dir_x[lane], dir_y[lane], dir_z[lane]}};
+	}
+
+	/**
+	 * @brief 用一个包围盒同时测试 mask 中的全部通道。
+	 *
+	 * 支持 AVX2 时一次测试 8 条光线，否则逐通道调用 AABB::hit，两者语义一致。
+	 *
+	 * @param box 包围盒。
+	 * @param mask 参与测试的通道。
+	 * @param t_min 有效区间下界。
+	 * @param t_max 各通道的有效区间上界。
+	 * @return 在各自区间内与包围盒相交的通道掩码（mask 的子集）。
+	 */
+	[[nodiscard]] std::uint32_t intersect_box(const AABB& box, std::uint32_t mask, float t_min,
+											  const std::array<double, SIZE>& t_max) const;
+};
+
+/**
+ * @brief 光线包的最近击中结果，每个通道独立维护。
+ */
+struct PacketHitRecord {
+	std::array<double, RayPacket::SIZE> t_max{};	///< 各通道当前的区间上界，击中后收缩为最近击中距离。
+	std::array<HitRecord, RayPacket::SIZE> rec{};	///< 各通道的最近击中。
+	std::uint32_t hit_mask = 0;						///< 已有击中的通道。
+
+	/**
+	 * @brief 清空击中结果，并把各通道的区间上界设为 t_max。
+	 */
+	void reset(const double t_max_all) {
+		t_max.fill(t_max_all);
+		hit_mask = 0;
+	}
+};
+
+/**
+ * @brief 光线包的视锥，用区间算术一次性剔除整个光线包都不会穿过的包围盒 (Wald 2006)。
+ *
+ * 记录全部通道起点与方向倒数在每个轴上的取值范围。只有每个轴上所有方向同号时近/远平面才确定，
+ * 否则视锥无效，may_hit 总是返回 true，交给逐通道的 SIMD 测试处理。
+ */
+class PacketFrustum {
+public:
+	/**
+	 * @brief 由光线包中 mask 选中的通道构造视锥。
+	 */
+	PacketFrustum(const RayPacket& packet, std::uint32_t mask);
+
+	/**
+	 * @brief 保守测试：返回 false 时保证所有通道都不与包围盒在 [t_min, t_max] 内相交。
+	 *
+	 * @param box 包围盒。
+	 * @param t_min 有效区间下界。
+	 * @param t_max 全部通道区间上界的最大值。
+	 */
+	[[nodiscard]] bool may_hit(const AABB& box, float t_min, float t_max) const;
+
+	[[nodiscard]] bool valid() const { return _valid; }
+
+private:
+	glm::vec3 _origin_min{};  ///< 起点的最小值。
+	glm::vec3 _origin_max{};  ///< 起点的最大值。
+	glm::vec3 _inv_dir_min{}; ///< 方向倒数的最小值。
+	glm::vec3 _inv_dir_max{}; ///< 方向倒数的最大值。
+	bool _valid = false;	  ///< 各轴方向是否同号且有限。
+};
+
+} // namespace rt
@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 图块调度器：把图像划分为边长为 2 的幂的方形图块，分给各线程的双端队列并允许相互窃取。
+ *
+ * 图块按 Hilbert 曲线排序，图块内的像素按 Morton 顺序排列，相邻处理的像素与图块在屏幕上也相邻，
+ * 主光线访问的场景数据更集中。按曲线顺序切成连续的段分给各线程的队列：线程从自己队列的头部取图块，
+ * 队列空了再从其他线程队列的尾部窃取，被窃取的是离队列主人当前位置最远的图块。
+ * 队列内容在调度开始前确定，取图块只需对一个 64 位原子量（头、尾下标）做 CAS，不需要锁。
+ */
+class TileScheduler {
+public:
+	/**
+	 * @brief 构造函数，计算全部像素按图块与 Morton 顺序的排列。
+	 *
+	 * @param width 图像宽度。
+	 * @param height 图像高度。
+	 * @param tile_size 图块边长，向上取整为 2 的幂。
+	 */
+	TileScheduler(int width, int height, int tile_size);
+
+	/**
+	 * @brief 安排一趟渲染：按图块收集 pixels 中的像素，跳过没有像素的图块，再把图块分给 thread_count 个队列。
+	 *
+	 * @param pixels 要渲染的帧缓冲索引，按升序排列。
+	 * @param thread_count 队列数，通常为 omp_get_max_threads()。
+	 */
+	void assign(std::span<const std::uint32_t> pixels, int thread_count);
+
+	/**
+	 * @brief 为线程取下一个图块，先取自己的队列，再依次窃取其他队列。
+	 *
+	 * @param thread 线程编号，小于 assign 的 thread_count。
+	 * @param tile [out] 图块内要渲染的像素，按 Morton 顺序排列。
+	 * @return 全部图块都已取走时返回 false。
+	 */
+	bool next(int thread, std::span<const std::uint32_t>& tile);
+
+	/**
+	 * @brief 记录线程完成的像素数，只写该线程独占的缓存行。
+	 */
+	void finish(const int thread, const size_t pixels) {
+		_queues[thread].finished.fetch_add(pixels, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief 本趟已完成的像素数，用于打印进度。
+	 */
+	[[nodiscard]] size_t finished() const;
+
+	/**
+	 * @brief 本趟要渲染的像素数。
+	 */
+	[[nodiscard]] size_t pixel_count() const { return _pixels.size(); }
+
+	/**
+	 * @brief 全部像素按调度顺序的排列：图块按 Hilbert 曲线，图块内按 Morton 顺序。
+	 */
+	[[nodiscard]] std::span<const std::uint32_t> order() const { return _order; }
+
+private:
+	/**
+	 * @brief 一个线程的图块队列，独占缓存行，避免线程之间的伪共享。
+	 */
+	struct alignas(64) Queue {
+		std::atomic<std::uint64_t> range{0};	///< 高 32 位为头部下标，低 32 位为尾部下标（不含）。
+		std::atomic<size_t> finished{0};		///< 该线程完成的像素数。
+	};
+
+	std::vector<std::uint32_t> _order;		///< 全部像素按调度顺序的排列。
+	std::vector<std::uint32_t> _order_tiles; ///< 各图块在 _order 中的起始位置，末尾附加像素总数。
+	std::vector<std::uint32_t> _pixels;		///< 本趟要渲染的像素，按调度顺序排列。
+	std::vector<std::uint32_t> _tiles;		///< 本趟各图块在 _pixels 中的起始位置，末尾附加像素总数。
+	std::unique_ptr<Queue[]> _queues;		///< 各线程的图块队列。
+	int _queue_count = 0;					///< 队列数。
+};
+
+} // namespace rt
@@ -3,7 +3,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/norm.hpp>
-#include <random>
+#include "rt/sampling/Sampler.hpp"
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace rt {
@@ -22,98 +24,111 @@ inline double degrees_to_radians(const double degrees) {
 }
 
 /**
- * @brief 生成一个在 [0, 1) 范围内的随机双精度浮点数。
+ * @brief 线性 RGB 颜色的亮度（Rec. 709 系数）。
+ */
+inline float luminance(const glm::vec3& color) {
+	return 0.2126F * color.x + 0.7152F * color.y + 0.0722F * color.z;
+}
+
+/**
+ * @brief 从采样器取一个在 [0, 1) 范围内的随机数。
  *
+ * @param sampler 采样器。
  * @return double 随机数。
  */
-inline double random_double() {
-	thread_local std::uniform_real_distribution<double> distribution(0.0, 1.0);
-	thread_local std::mt19937 generator(std::random_device{}());
-	return distribution(generator);
+inline double random_double(Sampler& sampler) {
+	return sampler.get_1d();
 }
 
 /**
- * @brief 生成一个在 [min, max) 范围内的随机双精度浮点数。
+ * @brief 从采样器取一个在 [min, max) 范围内的随机数。
  *
+ * @param sampler 采样器。
  * @param min 最小值。
  * @param max 最大值。
  * @return double 随机数。
  */
-inline double random_double(const double min, const double max) {
-	return min + (max - min) * random_double();
+inline double random_double(Sampler& sampler, const double min, const double max) {
+	return min + (max - min) * random_double(sampler);
 }
 
-inline int random_int(const int min, const int max) {
-	return static_cast<int>(random_double(min, max + 1));
+/**
+ * @brief 从采样器取一个在 [min, max] 范围内的随机整数。
+ */
+inline int random_int(Sampler& sampler, const int min, const int max) {
+	// 单精度随机数乘以较大的区间长度时可能舍入到区间之外
+	return std::min(static_cast<int>(random_double(sampler, min, max + 1)), max);
 }
 
 /**
  * @brief 生成一个分量在 [0, 1) 范围内的随机向量。
  */
-inline glm::vec3 random_vec3() {
-	return {random_double(), random_double(), random_double()};
+inline glm::vec3 random_vec3(Sampler& sampler) {
+	const float x = sampler.get_1d();
+	const float y = sampler.get_1d();
+	return {x, y, sampler.get_1d()};
 }
 
 /**
  * @brief 生成一个分量在 [min, max) 范围内的随机向量。
  *
+ * @param sampler 采样器。
  * @param min 最小值。
  * @param max 最大值。
  */
-inline glm::vec3 random_vec3(const double min, const double max) {
-	return {random_double(min, max), random_double(min, max), random_double(min, max)};
+inline glm::vec3 random_vec3(Sampler& sampler, const double min, const double max) {
+	return glm::vec3(static_cast<float>(min)) + static_cast<float>(max - min) * random_vec3(sampler);
 }
 
 /**
  * @brief 生成一个随机的余弦方向向量。
  */
-inline glm::vec3 random_cosine_direction() {
-	auto r01 = random_double();
-	auto z = sqrt(1 - r01);
-
-	auto phi = 2 * PI * random_double();
-	auto x = cos(phi) * sqrt(r01);
-	auto y = sin(phi) * sqrt(r01);
+inline glm::vec3 random_cosine_direction(Sampler& sampler) {
+	const glm::vec2 u = sampler.get_2d();
+	const float z = std::sqrt(1 - u.x);
 
-	return {x, y, z};
+	const float phi = 2 * glm::pi<float>() * u.y;
+	const float r = std::sqrt(u.x);
+	return {std::cos(phi) * r, std::sin(phi) * r, z};
 }
 
 /**
  * @brief 生成一个指向球体表面的随机向量。返回局部坐标下的向量，z轴(0,0,1)指向球心方向。
  */
-inline glm::vec3 random_to_sphere(const double radius, const double distance_squared) {
-	auto z = random_double(std::sqrt(1 - radius * radius / distance_squared), 1);
-
-	auto phi = 2 * PI * random_double();
-	auto x = cos(phi) * sqrt(1 - z * z);
-	auto y = sin(phi) * sqrt(1 - z * z);
-
-	return {x, y, z};
+inline glm::vec3 random_to_sphere(Sampler& sampler, const double radius, const double distance_squared) {
+	const glm::vec2 u = sampler.get_2d();
+	const double cos_theta_max = std::sqrt(1 - radius * radius / distance_squared);
+	const double z = cos_theta_max + (1 - cos_theta_max) * u.x;
+
+	const double phi = 2 * PI * u.y;
+	const double r = std::sqrt(1 - z * z);
+	return {std::cos(phi) * r, std::sin(phi) * r, z};
 }
 
 /**
  * @brief 生成一个均匀分布在单位球体表面的随机向量。
  */
-inline glm::vec3 random_unit_to_sphere() {
-	auto z = random_double(-1, 1);
-	auto r = std::sqrt(1 - z * z);
-	auto phi = 2 * PI * random_double();
+inline glm::vec3 random_unit_to_sphere(Sampler& sampler) {
+	const glm::vec2 u = sampler.get_2d();
+	const float z = 1 - 2 * u.x;
+	const float r = std::sqrt(std::max(0.0F, 1 - z * z));
+	const float phi = 2 * glm::pi<float>() * u.y;
 	return {r * std::cos(phi), r * std::sin(phi), z};
 }
 
 /**
  * @brief 在单位球体内生成一个随机点。
  */
-inline glm::vec3 random_in_unit_sphere() {
-	auto r = static_cast<float>(std::cbrt(random_double()));
-	return r * random_unit_to_sphere();
+inline glm::vec3 random_in_unit_sphere(Sampler& sampler) {
+	const float r = std::cbrt(sampler.get_1d());
+	return r * random_unit_to_sphere(sampler);
 }
 
 /**
  * @brief 生成上半单位球面上的向量
  */
-inline glm::vec3 random_unit_vector_hemisphere() {
-	auto on_sphere = random_unit_to_sphere();
+inline glm::vec3 random_unit_vector_hemisphere(Sampler& sampler) {
+	auto on_sphere = random_unit_to_sphere(sampler);
 	return on_sphere.z >= 0 ? on_sphere : -on_sphere;
 }
 
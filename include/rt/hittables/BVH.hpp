@@ -0,0 +1,138 @@
+#pragma once
+#include "rt/accel/BVHTree.hpp"
+#include "rt/accel/WideBVH.hpp"
+#include "rt/hittables/Scene.hpp"
+#include <memory>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief BVH 遍历时使用的节点布局。
+ */
+enum class BVHLayout {
+	BINARY, ///< 二叉节点，逐个测试子节点包围盒
+	WIDE8,	///< 折叠为 8 叉节点，使用 AVX2 一次测试 8 个子包围盒 (默认)
+};
+
+/**
+ * @brief 一次 BVH::refit 的结果。
+ */
+struct BVHRefitStats {
+	double refit_ms = 0.0;	  ///< 耗时（毫秒），触发重建时包括重建时间。
+	float sah_cost = 0.0F;	  ///< 更新后的 SAH 代价。
+	float degradation = 1.0F; ///< 重新拟合后的 SAH 代价与最近一次完整构建时之比。
+	bool rebuilt = false;	  ///< 是否因质量下降触发了完整重建。
+};
+
+/**
+ * @brief 基于包围体层次结构 (BVH) 的加速结构。
+ *
+ * 与 Scene 一样实现 Hittable 接口，可以直接替代 Scene 交给 SoftTracer 渲染，
+ * 但求交只访问光线穿过的子树，复杂度约为 O(log n)。
+ */
+class BVH : public Hittable {
+public:
+	static constexpr float DEFAULT_REBUILD_THRESHOLD = 1.5F; ///< refit 默认的自动重建阈值。
+	static constexpr int PACKET_FALLBACK_LANES = 2; ///< 光线包在子树中的活跃通道不超过该数量时改为逐条光线遍历。
+
+	/**
+	 * @brief 从场景中的对象列表构建 BVH。
+	 *
+	 * @param scene 场景，构建后场景本身不再被引用。
+	 * @param mode 构建算法。
+	 * @param layout 遍历使用的节点布局。
+	 */
+	explicit BVH(const Scene& scene, BVHBuildMode mode = BVHBuildMode::BINNED_SAH,
+				 BVHLayout layout = BVHLayout::WIDE8) :
+		BVH(scene.objects, mode, layout) {}
+
+	/**
+	 * @brief 从对象列表构建 BVH。
+	 *
+	 * @param objects 可被光线击中的对象列表。
+	 * @param mode 构建算法。
+	 * @param layout 遍历使用的节点布局。
+	 */
+	explicit BVH(std::vector<shared_ptr<Hittable>> objects, BVHBuildMode mode = BVHBuildMode::BINNED_SAH,
+				 BVHLayout layout = BVHLayout::WIDE8);
+
+	/**
+	 * @brief 对象移动后更新 BVH，用于拓扑不变的动画帧序列。
+	 *
+	 * 重新读取各对象的包围盒并自底向上并行拟合节点包围盒，不改变树的拓扑；
+	 * SAH 代价相对最近一次完整构建增长超过 rebuild_threshold 倍时，自动按原构建算法完整重建。
+	 * 调用期间不能有其他线程在遍历该 BVH。
+	 */
+	BVHRefitStats refit();
+
+	/**
+	 * @brief 设置自动重建阈值：SAH 代价与完整构建时之比超过该值时 refit 改为重建，不大于 1 时每次都重建。
+	 */
+	void set_rebuild_threshold(const float threshold) { _rebuild_threshold = threshold; }
+	[[nodiscard]] float rebuild_threshold() const { return _rebuild_threshold; }
+
+	/**
+	 * @brief 查找光线在区间 [t_min, t_max] 内的最近击中，结果与 Scene::hit 的线性遍历一致。
+	 */
+	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+
+	/**
+	 * @brief 任意击中查询，找到第一个遮挡对象即停止遍历。
+	 */
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override;
+
+	/**
+	 * @brief 光线包遍历二叉节点：先用视锥整体剔除，再用 SIMD 逐通道测试包围盒，叶子中的对象整包求交。
+	 *
+	 * 活跃通道随遍历逐渐减少，子树中只剩不超过 PACKET_FALLBACK_LANES 条光线时，
+	 * 这些光线改为从该节点开始逐条遍历，避免为少数通道支付整包测试的代价。
+	 */
+	std::uint32_t hit_packet(const RayPacket& packet, std::uint32_t active, double t_min,
+							 PacketHitRecord& hits) const override;
+
+	[[nodiscard]] AABB bounding_box() const override { return _tree.bounds(); }
+	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override;
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override;
+	void bind_materials(MaterialTable& table) override;
+
+	/**
+	 * @brief 获取底层的 BVH 拓扑，用于统计与调试。
+	 */
+	[[nodiscard]] const BVHTree& tree() const { return _tree; }
+
+	/**
+	 * @brief 8 叉布局的节点数据，layout 为 BINARY 时为空。
+	 */
+	[[nodiscard]] const WideBVH& wide_tree() const { return _wide; }
+
+	/**
+	 * @brief 强制 8 叉遍历使用标量节点测试，用于对比与测试。
+	 */
+	void set_force_scalar(const bool force_scalar) { _wide.set_force_scalar(force_scalar); }
+
+	/**
+	 * @brief 构建耗时与树质量 (SAH 代价) 等统计信息。
+	 */
+	[[nodiscard]] const BVHBuildStats& build_stats() const { return _tree.stats(); }
+
+	/**
+	 * @brief 按叶节点顺序排列的对象列表。
+	 */
+	[[nodiscard]] const std::vector<shared_ptr<Hittable>>& objects() const { return _objects; }
+
+private:
+	/**
+	 * @brief 按当前对象包围盒完整构建，并把对象按叶子顺序重排。
+	 */
+	void _build();
+
+	std::vector<shared_ptr<Hittable>> _objects; ///< 按 BVH 叶子顺序重排后的对象列表。
+	BVHTree _tree;								///< 层次结构拓扑。
+	WideBVH _wide;								///< 折叠后的 8 叉节点，仅在 WIDE8 布局下构建。
+	BVHBuildMode _mode;							///< 构建算法，自动重建时沿用。
+	BVHLayout _layout;							///< 节点布局。
+	float _rebuild_threshold = DEFAULT_REBUILD_THRESHOLD; ///< 自动重建阈值。
+};
+
+} // namespace rt
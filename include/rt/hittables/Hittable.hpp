@@ -1,10 +1,16 @@
 #pragma once
 #include "rt/core/Ray.hpp"
 #include "rt/core/HitRecord.hpp"
+#include "rt/core/AABB.hpp"
+#include "rt/core/RayPacket.hpp"
+#include "rt/sampling/Sampler.hpp"
+#include <cstdint>
 #include <glm/glm.hpp>
 
 namespace rt {
 
+class MaterialTable;
+
 /**
  * @brief 描述可被光线击中的对象的抽象基类。
  */
@@ -31,6 +37,39 @@ public:
 	 */
 	virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const = 0;
 
+	/**
+	 * @brief 判断光线在 [t_min, t_max] 内是否被对象遮挡（任意击中）。
+	 *
+	 * 用于阴影光线：只需要可见性，找到第一个遮挡即可返回，不计算最近击中，也不填写 HitRecord。
+	 *
+	 * @param r 待测试的光线。
+	 * @param t_min 有效范围的最小 t 值。
+	 * @param t_max 有效范围的最大 t 值。
+	 * @return true 如果范围内存在任意击中。
+	 */
+	[[nodiscard]] virtual bool occluded(const Ray& r, double t_min, double t_max) const = 0;
+
+	/**
+	 * @brief 光线包求交：对 active 中的每条光线查找比 hits.t_max 更近的击中，并更新 hits。
+	 *
+	 * 默认实现逐通道调用 hit；Sphere、Quad 用 SIMD 一次测试全部通道，BVH 与 Scene 把整个光线包交给子对象。
+	 *
+	 * @param packet 光线包。
+	 * @param active 参与求交的通道掩码。
+	 * @param t_min 有效击中范围的最小 t 值。
+	 * @param hits [in/out] 各通道的区间上界与最近击中，击中的通道会被更新。
+	 * @return 本次调用中找到更近击中的通道掩码。
+	 */
+	virtual std::uint32_t hit_packet(const RayPacket& packet, std::uint32_t active, double t_min,
+									 PacketHitRecord& hits) const;
+
+	/**
+	 * @brief 获取对象的轴对齐包围盒。
+	 *
+	 * 加速结构（如 BVH）依据包围盒组织对象，包围盒必须完整包含对象的几何体。
+	 */
+	[[nodiscard]] virtual AABB bounding_box() const = 0;
+
 	/**
 	 * @brief 计算从给定原点沿指定方向采样到该对象的概率密度函数 (PDF) 值。
 	 *
@@ -43,8 +82,17 @@ public:
 	 * @brief 从给定的原点产生指向该对象的随机方向。
 	 *
 	 * @param origin 采样的原点。
+	 * @param sampler 提供随机数的采样器。
+	 */
+	[[nodiscard]] virtual glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const = 0;
+
+	/**
+	 * @brief 把对象使用的材质注册到材质表，并记下编号，之后的击中记录会带上 material_id。
+	 *
+	 * 重新绑定到另一个材质表会覆盖之前的编号，渲染时必须使用最后一次绑定的材质表。
+	 * 默认实现不做任何事，击中记录保持 NO_MATERIAL_ID，着色时回退到虚函数。
 	 */
-	[[nodiscard]] virtual glm::vec3 random(const glm::vec3& origin) const = 0;
+	virtual void bind_materials(MaterialTable& /*table*/) {}
 };
 
 } // namespace rt
@@ -0,0 +1,107 @@
+#pragma once
+#include "rt/hittables/Hittable.hpp"
+#include "rt/materials/Material.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace rt {
+
+/**
+ * @brief 一个实例的紧凑记录：世界到物体空间的 3x4 仿射逆变换与底层加速结构 (BLAS) 编号，共 64 字节。
+ *
+ * 只保存逆变换：光线变换到物体空间后直接交给 BLAS 求交，光线方向不归一化，因此两个空间中的 t 相同；
+ * 法线用逆变换的转置变回世界空间。
+ */
+struct alignas(64) InstanceRecord {
+	static constexpr std::uint32_t NO_MATERIAL = std::numeric_limits<std::uint32_t>::max(); ///< 使用 BLAS 自身的材质。
+
+	std::array<float, 12> world_to_object{}; ///< 按行存放的 3x4 逆变换矩阵。
+	std::uint32_t blas_id = 0;				 ///< BLAS 编号。
+	std::uint32_t material_id = NO_MATERIAL; ///< 覆盖材质编号。
+	std::uint32_t instance_id = 0;			 ///< 实例在添加顺序中的编号。
+	std::uint32_t reserved = 0;				 ///< 保留，使记录恰好占一个缓存行。
+
+	/**
+	 * @brief 由物体到世界空间的仿射变换构造记录。
+	 */
+	static InstanceRecord make(const glm::mat4& object_to_world, std::uint32_t blas_id,
+							   std::uint32_t material_id = NO_MATERIAL, std::uint32_t instance_id = 0);
+
+	[[nodiscard]] glm::vec3 point_to_object(const glm::vec3& p) const;
+	[[nodiscard]] glm::vec3 vector_to_object(const glm::vec3& v) const;
+
+	/**
+	 * @brief 法线变回世界空间：乘以逆变换线性部分的转置并归一化。
+	 */
+	[[nodiscard]] glm::vec3 normal_to_world(const glm::vec3& n) const;
+
+	/**
+	 * @brief 物体到世界空间的变换，由逆变换求逆得到，只在采样等非热点路径使用。
+	 */
+	[[nodiscard]] glm::mat4 object_to_world() const;
+
+	/**
+	 * @brief 世界空间包围盒：将 BLAS 包围盒的 8 个角点变换到世界空间后取包围盒。
+	 */
+	[[nodiscard]] AABB world_bounds(const AABB& object_bounds) const;
+
+	/**
+	 * @brief 在物体空间中与 BLAS 求交，并把击中点与法线变回世界空间（不处理覆盖材质）。
+	 */
+	bool hit(const Hittable& blas, const Ray& r, double t_min, double t_max, HitRecord& rec) const;
+
+	[[nodiscard]] bool occluded(const Hittable& blas, const Ray& r, double t_min, double t_max) const {
+		return blas.occluded({point_to_object(r.origin()), vector_to_object(r.direction())}, t_min, t_max);
+	}
+
+	/**
+	 * @brief 按 BLAS 的采样分布计算概率密度，仅对相似变换（旋转、平移与均匀缩放）精确。
+	 */
+	[[nodiscard]] double pdf_value(const Hittable& blas, const glm::vec3& origin, const glm::vec3& v) const;
+	[[nodiscard]] glm::vec3 random(const Hittable& blas, const glm::vec3& origin, Sampler& sampler) const;
+};
+static_assert(sizeof(InstanceRecord) == 64);
+
+/**
+ * @brief 对共享 BLAS 施加仿射变换的单个实例。
+ *
+ * 同一个 BLAS（网格、BVH 或任意 Hittable）可以被多个实例引用而不复制几何数据。
+ * 少量实例可以直接放入 Scene 或 BVH；大量实例应使用 TLAS，每个实例只占一条 InstanceRecord。
+ */
+class Instance : public Hittable {
+public:
+	/**
+	 * @brief 构造实例。
+	 *
+	 * @param blas 被引用的底层对象。
+	 * @param object_to_world 物体到世界空间的仿射变换。
+	 * @param material 覆盖材质，为空时使用 BLAS 自身的材质。
+	 */
+	Instance(std::shared_ptr<Hittable> blas, const glm::mat4& object_to_world,
+			 std::shared_ptr<Material> material = nullptr);
+
+	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override {
+		return _record.occluded(*_blas, r, t_min, t_max);
+	}
+
+	[[nodiscard]] AABB bounding_box() const override { return _bounds; }
+	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override {
+		return _record.pdf_value(*_blas, origin, v);
+	}
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override {
+		return _record.random(*_blas, origin, sampler);
+	}
+	void bind_materials(MaterialTable& table) override;
+
+private:
+	std::shared_ptr<Hittable> _blas;	  ///< 被引用的底层对象。
+	std::shared_ptr<Material> _material; ///< 覆盖材质（可为空）。
+	std::uint32_t _material_id = HitRecord::NO_MATERIAL_ID; ///< 覆盖材质在材质表中的编号。
+	InstanceRecord _record;				  ///< 变换。
+	AABB _bounds;						  ///< 世界空间包围盒。
+};
+
+} // namespace rt
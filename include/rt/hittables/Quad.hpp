@@ -12,8 +12,20 @@ namespace rt {
  */
 class Quad : public Hittable {
 public:
+	static constexpr float QUAD_BOX_PADDING = 1e-4F; ///< 包围盒的最小厚度。
+
 	Quad(const glm::vec3& Q, const glm::vec3& u, const glm::vec3& v, std::shared_ptr<Material> m) :
-		_corner(Q), _u(u), _v(v), _mat_ptr(std::move(m)) {
+		_mat_ptr(std::move(m)) {
+		set_geometry(Q, u, v);
+	}
+
+	/**
+	 * @brief 重新设置角点与边向量，用于动画；之后需要调用包含该四边形的 BVH 的 refit。
+	 */
+	void set_geometry(const glm::vec3& Q, const glm::vec3& u, const glm::vec3& v) {
+		_corner = Q;
+		_u = u;
+		_v = v;
 		auto n = glm::cross(u, v);
 		_normal = glm::normalize(n);
 		_d_param = glm::dot(_normal, Q);
@@ -21,16 +33,45 @@ public:
 		_area = glm::length(n);
 	}
 
+	[[nodiscard]] const glm::vec3& corner() const { return _corner; }
+	[[nodiscard]] const glm::vec3& u() const { return _u; }
+	[[nodiscard]] const glm::vec3& v() const { return _v; }
+
 	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override;
 
+	/**
+	 * @brief 光线包求交，支持 AVX2 时 8 条光线一次与四边形求交。
+	 */
+	std::uint32_t hit_packet(const RayPacket& packet, std::uint32_t active, double t_min,
+							 PacketHitRecord& hits) const override;
+
+	[[nodiscard]] AABB bounding_box() const override;
 	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override;
-	[[nodiscard]] glm::vec3 random(const glm::vec3& origin) const override;
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override;
+	void bind_materials(MaterialTable& table) override;
 
 private:
-	glm::vec3 _corner;					///< 角点
-	glm::vec3 _u;						///< 边向量 u
-	glm::vec3 _v;						///< 边向量 v
+	/**
+	 * @brief 求光线与四边形在 [t_min, t_max] 内的交点。
+	 *
+	 * @param t [out] 交点的 t 值。
+	 * @param alpha [out] 交点沿 u 方向的平面坐标。
+	 * @param beta [out] 交点沿 v 方向的平面坐标。
+	 * @return true 如果范围内有交点。
+	 */
+	bool _intersect(const Ray& r, double t_min, double t_max, double& t, double& alpha, double& beta) const;
+
+	/**
+	 * @brief 由交点参数与平面坐标填写击中记录。
+	 */
+	void _set_hit_record(const Ray& r, double t, double alpha, double beta, HitRecord& rec) const;
+
+	glm::vec3 _corner{};				///< 角点
+	glm::vec3 _u{};						///< 边向量 u
+	glm::vec3 _v{};						///< 边向量 v
 	std::shared_ptr<Material> _mat_ptr; ///< 材质
+	std::uint32_t _material_id = HitRecord::NO_MATERIAL_ID; ///< 材质在材质表中的编号
 	glm::vec3 _normal{};				///< 法线方向
 	glm::vec3 _w{};						///< 法线归一化辅助向量
 	double _d_param{};					///< 平面方程中的 D 常数。
@@ -48,8 +48,21 @@ public:
 	 */
 	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
 
+	/**
+	 * @brief 判断光线是否被场景中的任意对象遮挡，遇到第一个遮挡即返回。
+	 */
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override;
+
+	/**
+	 * @brief 把整个光线包依次交给每个对象求交。
+	 */
+	std::uint32_t hit_packet(const RayPacket& packet, std::uint32_t active, double t_min,
+							 PacketHitRecord& hits) const override;
+
+	[[nodiscard]] AABB bounding_box() const override;
 	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override;
-	[[nodiscard]] glm::vec3 random(const glm::vec3& origin) const override;
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override;
+	void bind_materials(MaterialTable& table) override;
 
 	std::vector<shared_ptr<Hittable>> objects; ///< 场景中的对象列表。
 };
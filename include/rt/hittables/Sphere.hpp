@@ -34,14 +34,60 @@ public:
 	 * @return false 否则。
 	 */
 	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override;
 
+	/**
+	 * @brief 光线包求交，支持 AVX2 时 8 条光线一次与球体求交。
+	 */
+	std::uint32_t hit_packet(const RayPacket& packet, std::uint32_t active, double t_min,
+							 PacketHitRecord& hits) const override;
+
+	[[nodiscard]] AABB bounding_box() const override;
 	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override;
-	[[nodiscard]] glm::vec3 random(const glm::vec3& origin) const override;
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override;
+	void bind_materials(MaterialTable& table) override;
+
+	[[nodiscard]] const glm::vec3& center() const { return _center; }
+
+	/**
+	 * @brief 移动球心，用于动画；之后需要调用包含该球体的 BVH 的 refit。
+	 */
+	void set_center(const glm::vec3& center) { _center = center; }
+	[[nodiscard]] double radius() const { return _radius; }
+	[[nodiscard]] const std::shared_ptr<Material>& material() const { return _mat_ptr; }
+
+	/**
+	 * @brief 计算单位球面上一点的纹理坐标。
+	 *
+	 * @param p 单位球面上的点（即外法线）。
+	 * @param u [out] 经度方向的纹理坐标。
+	 * @param v [out] 纬度方向的纹理坐标。
+	 */
+	static void get_uv(const glm::vec3& p, double& u, double& v);
+
+	/**
+	 * @brief 按双精度求光线与球面在 [t_min, t_max] 内最近的交点参数；SIMD 单精度求交选出候选后用它确定交点。
+	 *
+	 * @param root [out] 交点的 t 值。
+	 * @return true 如果范围内有交点。
+	 */
+	static bool intersect(const glm::vec3& center, double radius, const Ray& r, double t_min, double t_max,
+						  double& root);
 
 private:
+	bool _intersect(const Ray& r, const double t_min, const double t_max, double& root) const {
+		return intersect(_center, _radius, r, t_min, t_max, root);
+	}
+
+	/**
+	 * @brief 由交点参数填写击中记录。
+	 */
+	void _set_hit_record(const Ray& r, double t, HitRecord& rec) const;
+
 	glm::vec3 _center{};   ///< 球心
 	double _radius;                     ///< 球体的半径。
 	std::shared_ptr<Material> _mat_ptr; ///< 球体的材质。
+	std::uint32_t _material_id = HitRecord::NO_MATERIAL_ID; ///< 材质在材质表中的编号。
 };
 
 } // namespace rt
@@ -0,0 +1,110 @@
+#pragma once
+#include "rt/hittables/Hittable.hpp"
+#include "rt/hittables/Sphere.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 以结构数组 (SoA) 形式连续存放的一组球体。
+ *
+ * 球心与半径以每 16 个为一块的 SoA 数据块连续存放，材质以编号引用材质表，求交时用 AVX-512 / AVX2 一次测试 16 / 8 个球体，
+ * 只对最终最近的球体计算法线与纹理坐标。适合作为 BVH 的叶子图元：先用 make_clusters
+ * 把大量小球按空间位置分成若干小组，再把各组交给 BVH，代替逐个 Sphere 对象的指针跳转与虚函数调用。
+ */
+class SphereSet : public Hittable {
+public:
+	static constexpr std::uint32_t SIMD_LANES = 16;	 ///< 数组按该长度填充，保证 SIMD 加载不越界。
+	static constexpr std::uint32_t CLUSTER_SIZE = 16;///< make_clusters 默认每组的球体数。
+
+	/**
+	 * @brief 构造空的球体集合，并按 CPU 能力选择求交指令集。
+	 */
+	SphereSet();
+
+	/**
+	 * @brief 添加一个球体。
+	 *
+	 * @param center 球心。
+	 * @param radius 半径。
+	 * @param mat 材质，相同的材质只在材质表中保存一次。
+	 */
+	void add(const glm::vec3& center, float radius, const std::shared_ptr<Material>& mat);
+
+	/**
+	 * @brief 将球体列表按空间位置分组，每组生成一个 SphereSet。
+	 *
+	 * 先对全部球体构建分桶 SAH BVH，再把图元数不超过 cluster_size 的最大子树作为一组。
+	 *
+	 * @param spheres 球体列表。
+	 * @param cluster_size 每组最多的球体数。
+	 * @return 可直接加入 Scene 或 BVH 的对象列表。
+	 */
+	static std::vector<std::shared_ptr<Hittable>> make_clusters(const std::vector<std::shared_ptr<Sphere>>& spheres,
+														   std::uint32_t cluster_size = CLUSTER_SIZE);
+
+	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override;
+
+	[[nodiscard]] AABB bounding_box() const override { return _bounds; }
+	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override;
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override;
+	void bind_materials(MaterialTable& table) override;
+
+	[[nodiscard]] std::uint32_t size() const { return _count; }
+
+	/**
+	 * @brief 强制使用标量求交，用于对比与测试。
+	 */
+	void set_force_scalar(bool force_scalar);
+
+private:
+	/**
+	 * @brief 求交使用的指令集。
+	 */
+	enum class Kernel { SCALAR, AVX2, AVX512 };
+
+	/**
+	 * @brief 按 CPU 能力选择最宽的可用指令集。
+	 */
+	static Kernel _detect_kernel();
+
+	/**
+	 * @brief 找到 [t_min, t_max] 内最近的球体。
+	 *
+	 * SIMD 单精度测试只筛选候选，每个候选再按 Sphere 的双精度求根确认，hit 与 occluded 共用同一结果。
+	 *
+	 * @param any_hit 为 true 时找到任意击中即返回。
+	 * @param t [out] 击中距离。
+	 * @return 击中球体的下标，未击中时返回 -1。
+	 */
+	[[nodiscard]] std::int64_t _closest(const Ray& r, double t_min, double t_max, bool any_hit, double& t) const;
+
+	[[nodiscard]] Sphere _sphere(std::uint32_t idx) const;
+
+	/**
+	 * @brief SIMD_LANES 个球体的 SoA 数据块，未使用的通道球心为 NaN。
+	 */
+	struct alignas(64) Block {
+		std::array<float, SIMD_LANES> center_x; ///< 球心 x。
+		std::array<float, SIMD_LANES> center_y; ///< 球心 y。
+		std::array<float, SIMD_LANES> center_z; ///< 球心 z。
+		std::array<float, SIMD_LANES> radius;	///< 半径。
+	};
+
+	[[nodiscard]] glm::vec3 _center(std::uint32_t idx) const;
+	[[nodiscard]] float _radius(std::uint32_t idx) const;
+
+	std::vector<Block> _blocks;						///< 球体数据，每块 SIMD_LANES 个球体。
+	std::vector<std::uint32_t> _material_ids;		///< 每个球体在材质表中的编号。
+	std::vector<std::shared_ptr<Material>> _materials; ///< 材质表。
+	std::vector<std::uint32_t> _table_ids;				///< 每个材质在 MaterialTable 中的编号，未绑定时为空。
+	std::uint32_t _count = 0;							///< 球体数量（不含填充）。
+	AABB _bounds;										///< 所有球体的包围盒。
+	Kernel _kernel = Kernel::SCALAR;					///< 求交使用的指令集。
+};
+
+} // namespace rt
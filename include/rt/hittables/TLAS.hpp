@@ -0,0 +1,96 @@
+#pragma once
+#include "rt/accel/BVHTree.hpp"
+#include "rt/accel/WideBVH.hpp"
+#include "rt/hittables/BVH.hpp"
+#include "rt/hittables/Instance.hpp"
+#include <memory>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 两级加速结构中的顶层 (TLAS)：在大量实例之上构建的 BVH。
+ *
+ * 几何体只在 BLAS 中保存一份，每个实例只占一条 64 字节的 InstanceRecord（加上顶层 BVH 的节点），
+ * 而不是每个副本一个 Hittable 对象与 shared_ptr。遍历顶层 BVH 到达叶子时，光线变换到实例的物体空间，
+ * 再交给该实例引用的 BLAS 求交。
+ *
+ * 用法：add_blas 注册底层对象，add_instance 添加实例，全部添加后调用 build。
+ */
+class TLAS : public Hittable {
+public:
+	/**
+	 * @brief 构造空的顶层结构。
+	 *
+	 * @param layout 顶层 BVH 遍历使用的节点布局。
+	 */
+	explicit TLAS(BVHLayout layout = BVHLayout::WIDE8) : _layout(layout) {}
+
+	/**
+	 * @brief 注册一个 BLAS。
+	 *
+	 * @return BLAS 编号，用于 add_instance。
+	 */
+	std::uint32_t add_blas(std::shared_ptr<Hittable> blas);
+
+	/**
+	 * @brief 注册一个覆盖材质，使同一 BLAS 的不同实例可以使用不同材质。
+	 *
+	 * @return 材质编号，用于 add_instance。
+	 */
+	std::uint32_t add_material(std::shared_ptr<Material> material);
+
+	/**
+	 * @brief 添加一个实例，添加后需要重新调用 build。
+	 *
+	 * @param blas_id add_blas 返回的编号。
+	 * @param object_to_world 物体到世界空间的仿射变换。
+	 * @param material_id add_material 返回的编号，默认使用 BLAS 自身的材质。
+	 * @return 实例编号（添加顺序），即 InstanceRecord::instance_id。
+	 */
+	std::uint32_t add_instance(std::uint32_t blas_id, const glm::mat4& object_to_world,
+							   std::uint32_t material_id = InstanceRecord::NO_MATERIAL);
+
+	/**
+	 * @brief 在全部实例的世界空间包围盒上构建顶层 BVH，并把实例记录按叶子顺序重排。
+	 *
+	 * WIDE8 布局下折叠完成后释放二叉节点，只保留遍历所需的 8 叉节点。
+	 */
+	void build(BVHBuildMode mode = BVHBuildMode::BINNED_SAH);
+
+	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override;
+
+	[[nodiscard]] AABB bounding_box() const override { return _bounds; }
+	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override;
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override;
+	void bind_materials(MaterialTable& table) override;
+
+	[[nodiscard]] size_t instance_count() const { return _instances.size(); }
+	[[nodiscard]] size_t blas_count() const { return _blas.size(); }
+
+	/**
+	 * @brief 按叶子顺序排列的实例记录。
+	 */
+	[[nodiscard]] const std::vector<InstanceRecord>& instances() const { return _instances; }
+
+	/**
+	 * @brief 实例记录与顶层 BVH 节点占用的字节数，不含 BLAS。
+	 */
+	[[nodiscard]] size_t memory_bytes() const;
+
+	[[nodiscard]] const BVHBuildStats& build_stats() const { return _stats; }
+
+private:
+	std::vector<std::shared_ptr<Hittable>> _blas;		///< 底层对象。
+	std::vector<std::shared_ptr<Material>> _materials; ///< 覆盖材质表。
+	std::vector<std::uint32_t> _table_ids;			///< 覆盖材质在 MaterialTable 中的编号，未绑定时为空。
+	std::vector<InstanceRecord> _instances;			///< 实例记录，build 后按叶子顺序排列。
+	BVHLayout _layout;								///< 顶层节点布局。
+	BVHTree _tree;									///< 顶层 BVH 拓扑，WIDE8 布局下构建后释放。
+	WideBVH _wide;									///< 折叠后的 8 叉节点，仅在 WIDE8 布局下构建。
+	AABB _bounds;									///< 全部实例的包围盒。
+	BVHBuildStats _stats;							///< 顶层 BVH 的构建统计。
+};
+
+} // namespace rt
@@ -0,0 +1,153 @@
+#pragma once
+#include "rt/accel/BVHTree.hpp"
+#include "rt/accel/WideBVH.hpp"
+#include "rt/hittables/Hittable.hpp"
+#include "rt/materials/Material.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 网格顶点与索引缓冲的只读视图。
+ *
+ * 缓冲可以来自 vector，也可以直接指向内存映射的缓存文件；owner 持有底层内存，保证视图在网格存活期间有效。
+ */
+struct MeshBuffers {
+	std::span<const glm::vec3> positions;	///< 顶点位置。
+	std::span<const glm::vec3> normals;		///< 顶点法线（可为空）。
+	std::span<const glm::vec2> uvs;			///< 顶点纹理坐标（可为空）。
+	std::span<const std::uint32_t> indices; ///< 三角形顶点下标，每 3 个为一个三角形。
+	std::shared_ptr<const void> owner;		///< 底层内存的持有者。
+};
+
+/**
+ * @brief 共享顶点与索引缓冲的三角形网格。
+ *
+ * 顶点位置、法线与纹理坐标按唯一顶点存放，三角形只保存 3 个顶点下标，内存随顶点数增长，
+ * 而不是每个三角形一个 Hittable 对象。网格内部自带 BVH，叶节点中的三角形用防水 (watertight)
+ * 求交算法 [Woop et al. 2013] 以 4 路 SIMD 批量测试，共享边与顶点上的光线不会漏过。
+ */
+class TriangleMesh : public Hittable {
+public:
+	/**
+	 * @brief 构造网格并构建加速结构。
+	 *
+	 * @param positions 顶点位置。
+	 * @param indices 三角形顶点下标，每 3 个为一个三角形（逆时针为正面）。
+	 * @param mat 网格材质。
+	 * @param normals 顶点法线，为空时使用几何法线；非空时数量必须与 positions 相同。
+	 * @param uvs 顶点纹理坐标，为空时使用重心坐标；非空时数量必须与 positions 相同。
+	 * @param mode BVH 构建算法。
+	 */
+	TriangleMesh(std::vector<glm::vec3> positions, std::vector<std::uint32_t> indices, std::shared_ptr<Material> mat,
+				 std::vector<glm::vec3> normals = {}, std::vector<glm::vec2> uvs = {},
+				 BVHBuildMode mode = BVHBuildMode::BINNED_SAH);
+
+	/**
+	 * @brief 使用已按叶子顺序排列的缓冲与预先构建的 BVH 节点构造网格，不复制顶点与索引，也不重新构建 BVH。
+	 *
+	 * @param buffers 网格缓冲，三角形顺序必须与 nodes 的叶子顺序一致。
+	 * @param nodes 深度优先顺序的 BVH 节点。
+	 * @param mat 网格材质。
+	 */
+	TriangleMesh(MeshBuffers buffers, std::span<const BVHNode> nodes, std::shared_ptr<Material> mat);
+
+	/**
+	 * @brief 查找最近击中，顶点法线与纹理坐标按重心坐标插值写入 HitRecord。
+	 */
+	bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+	[[nodiscard]] bool occluded(const Ray& r, double t_min, double t_max) const override;
+
+	[[nodiscard]] AABB bounding_box() const override { return _tree.bounds(); }
+
+	/**
+	 * @brief 按面积均匀采样网格表面时的立体角概率密度，使网格可以作为面光源。
+	 */
+	[[nodiscard]] double pdf_value(const glm::vec3& origin, const glm::vec3& v) const override;
+	[[nodiscard]] glm::vec3 random(const glm::vec3& origin, Sampler& sampler) const override;
+	void bind_materials(MaterialTable& table) override;
+
+	[[nodiscard]] size_t triangle_count() const { return _indices.size() / 3; }
+	[[nodiscard]] size_t vertex_count() const { return _positions.size(); }
+
+	/**
+	 * @brief 按 BVH 叶子顺序重排后的三角形顶点下标。
+	 */
+	[[nodiscard]] std::span<const std::uint32_t> indices() const { return _indices; }
+	[[nodiscard]] std::span<const glm::vec3> positions() const { return _positions; }
+
+	/**
+	 * @brief 网格缓冲视图（三角形为叶子顺序），用于写入缓存文件。
+	 */
+	[[nodiscard]] MeshBuffers buffers() const { return {_positions, _normals, _uvs, _indices, _storage}; }
+
+	[[nodiscard]] const BVHTree& tree() const { return _tree; }
+	[[nodiscard]] const BVHBuildStats& build_stats() const { return _tree.stats(); }
+
+private:
+	/**
+	 * @brief 防水求交所需的逐光线预计算：按方向最大分量重排坐标轴并剪切，使光线沿 +z 方向。
+	 */
+	struct ShearedRay {
+		glm::vec3 origin; ///< 光线起点。
+		int kx;			  ///< 剪切空间 x 轴对应的原坐标轴。
+		int ky;			  ///< 剪切空间 y 轴对应的原坐标轴。
+		int kz;			  ///< 光线方向绝对值最大的坐标轴。
+		float sx;		  ///< 剪切系数 d[kx] / d[kz]。
+		float sy;		  ///< 剪切系数 d[ky] / d[kz]。
+		float sz;		  ///< 缩放系数 1 / d[kz]。
+
+		explicit ShearedRay(const Ray& r);
+	};
+
+	/**
+	 * @brief 一次三角形击中。
+	 */
+	struct TriangleHit {
+		float t = 0;			///< 光线参数。
+		float b1 = 0;			///< 第二个顶点的重心坐标。
+		float b2 = 0;			///< 第三个顶点的重心坐标。
+		std::uint32_t tri = 0; ///< 三角形在叶子顺序中的下标。
+	};
+
+	/**
+	 * @brief 对叶子中的三角形 [first, first + count) 求交（count 不超过 4）。
+	 *
+	 * @param any_hit 为 true 时找到任意击中即返回。
+	 * @param t_max [in/out] 有效区间上界，击中后收缩为最近距离。
+	 * @param hit [out] 最近击中。
+	 */
+	bool _intersect_leaf(const ShearedRay& ray, std::uint32_t first, std::uint32_t count, float t_min, float& t_max,
+						 bool any_hit, TriangleHit& hit) const;
+
+	/**
+	 * @brief 单个三角形的防水求交，边界上的退化情况用双精度重新计算。
+	 */
+	bool _intersect_triangle(const ShearedRay& ray, std::uint32_t tri, float t_min, float t_max,
+							 TriangleHit& hit) const;
+
+	bool _closest_hit(const Ray& r, double t_min, double t_max, TriangleHit& hit) const;
+
+	[[nodiscard]] glm::vec3 _geometric_normal(std::uint32_t tri) const;
+
+	/**
+	 * @brief 缓冲与 BVH 就绪后构建 8 叉 BVH 与面积前缀和。
+	 */
+	void _finalize();
+
+	std::span<const glm::vec3> _positions;	///< 顶点位置。
+	std::span<const glm::vec3> _normals;	///< 顶点法线（可为空）。
+	std::span<const glm::vec2> _uvs;		///< 顶点纹理坐标（可为空）。
+	std::span<const std::uint32_t> _indices; ///< 按叶子顺序排列的三角形顶点下标。
+	std::shared_ptr<const void> _storage;	///< 缓冲的持有者（vector 或内存映射文件）。
+	std::shared_ptr<Material> _mat_ptr;	 ///< 网格材质。
+	std::uint32_t _material_id = HitRecord::NO_MATERIAL_ID; ///< 材质在材质表中的编号。
+	std::vector<float> _area_cdf;		 ///< 三角形面积的前缀和，用于按面积采样。
+	BVHTree _tree;						 ///< 三角形的二叉 BVH。
+	WideBVH _wide;						 ///< 遍历使用的 8 叉 BVH。
+};
+
+} // namespace rt
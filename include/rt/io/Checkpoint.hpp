@@ -0,0 +1,44 @@
+#pragma once
+#include "rt/sampling/Sampler.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 渐进渲染的检查点：各像素累积的辐射度、采样数，以及继续采样所需的采样器状态。
+ *
+ * 每个像素每个采样的随机数只取决于采样器类型、种子、像素与采样序号，因此采样器状态就是类型、种子与各像素已追踪的采样数；
+ * 从检查点继续时每个像素从下一个采样序号开始，与不中断的渲染得到相同的结果。
+ * 文件以本机字节序保存，头部记录类型大小与字节序，不一致时视为无效。
+ */
+struct RenderCheckpoint {
+	int width = 0;									///< 图像宽度。
+	int height = 0;									///< 图像高度。
+	int layers = 1;									///< 辐射度的层数，即同时估计的采样策略数。
+	SamplerType sampler = SamplerType::INDEPENDENT; ///< 采样器类型。
+	std::uint64_t seed = 0;							///< 随机数种子。
+	std::vector<glm::vec3> radiance;				///< 各像素累积的辐射度之和，每层按行从上到下排列。
+	std::vector<double> luminance_sq;				///< 各像素每个采样亮度的平方和，自适应采样据此估计方差。
+	std::vector<int> sample_counts;					///< 各像素已追踪的采样数。
+
+	/**
+	 * @brief 写入检查点，先写入临时文件再重命名，中途被终止也不会留下不完整的检查点。
+	 *
+	 * @return 写入成功返回 true。
+	 */
+	bool save(const std::filesystem::path& path) const;
+
+	/**
+	 * @brief 读取检查点。
+	 *
+	 * @return 文件不存在时返回空。
+	 * @throws std::runtime_error 文件无法读取、格式错误或已损坏时抛出。
+	 */
+	static std::optional<RenderCheckpoint> load(const std::filesystem::path& path);
+};
+
+} // namespace rt
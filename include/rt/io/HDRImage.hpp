@@ -0,0 +1,74 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <filesystem>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief HDR 文件格式。
+ */
+enum class HDRFormat {
+	NONE, ///< 不写出 HDR 文件。
+	PFM,  ///< Portable Float Map，每个通道 32 位浮点。
+	EXR,  ///< OpenEXR 扫描线图像，每个通道 32 位浮点。
+};
+
+/**
+ * @brief OpenEXR 的压缩方式。
+ */
+enum class ExrCompression {
+	NONE, ///< 不压缩。
+	ZIP,  ///< 每 16 行一块，字节重排与差分预测后用 zlib 压缩（无损）。
+};
+
+/**
+ * @brief 线性 RGB 浮点图像，用于保存未经色调映射的辐射度。
+ */
+struct HDRImage {
+	int width = 0;					///< 图像宽度。
+	int height = 0;					///< 图像高度。
+	std::vector<glm::vec3> pixels; ///< 线性 RGB，按行从上到下排列。
+
+	/**
+	 * @brief 写出 PFM 文件（小端序，按 PFM 约定从最下一行开始）。
+	 *
+	 * @return 写入成功返回 true。
+	 */
+	bool write_pfm(const std::filesystem::path& path) const;
+
+	/**
+	 * @brief 写出 OpenEXR 扫描线文件，通道 R、G、B 均为 32 位浮点，读回后逐位相同。
+	 *
+	 * @return 写入成功返回 true。
+	 */
+	bool write_exr(const std::filesystem::path& path, ExrCompression compression = ExrCompression::ZIP) const;
+
+	/**
+	 * @brief 按格式写出 HDR 文件，format 为 NONE 时不写出并返回 true。
+	 */
+	bool write(const std::filesystem::path& path, HDRFormat format) const;
+
+	/**
+	 * @brief 读取 PFM 文件，支持三通道与单通道（灰度复制到三个通道）、大端与小端。
+	 *
+	 * @throws std::runtime_error 文件无法读取或格式错误时抛出。
+	 */
+	static HDRImage read_pfm(const std::filesystem::path& path);
+
+	/**
+	 * @brief 读取 OpenEXR 扫描线文件，支持 16/32 位浮点的 R、G、B 通道与 NONE、ZIPS、ZIP 压缩。
+	 *
+	 * @throws std::runtime_error 文件无法读取、格式错误或使用了不支持的特性时抛出。
+	 */
+	static HDRImage read_exr(const std::filesystem::path& path);
+
+	/**
+	 * @brief 按扩展名（.pfm 或 .exr，不区分大小写）读取 HDR 文件。
+	 *
+	 * @throws std::runtime_error 扩展名不支持或读取失败时抛出。
+	 */
+	static HDRImage read(const std::filesystem::path& path);
+};
+
+} // namespace rt
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace rt {
+
+/**
+ * @brief 只读内存映射文件。
+ *
+ * 文件内容由操作系统按页按需调入，解析器可以直接在映射的字节上工作，不需要先把整个文件读入缓冲。
+ */
+class MappedFile {
+public:
+	/**
+	 * @brief 映射整个文件。
+	 *
+	 * @throws std::runtime_error 文件无法打开或映射时抛出。
+	 */
+	explicit MappedFile(const std::filesystem::path& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&&) = delete;
+	MappedFile& operator=(MappedFile&&) = delete;
+
+	[[nodiscard]] std::span<const std::byte> bytes() const { return {_data, _size}; }
+	[[nodiscard]] const std::byte* data() const { return _data; }
+	[[nodiscard]] size_t size() const { return _size; }
+
+private:
+	const std::byte* _data = nullptr; ///< 映射地址（空文件时为 nullptr）。
+	size_t _size = 0;				  ///< 文件字节数。
+#ifdef _WIN32
+	void* _file = nullptr;	  ///< 文件句柄。
+	void* _mapping = nullptr; ///< 映射对象句柄。
+#endif
+};
+
+} // namespace rt
@@ -0,0 +1,74 @@
+#pragma once
+#include "rt/accel/BVHTree.hpp"
+#include "rt/hittables/TriangleMesh.hpp"
+#include <filesystem>
+#include <memory>
+
+namespace rt {
+
+/**
+ * @brief 网格加载选项。
+ */
+struct MeshLoadOptions {
+	bool use_cache = true;								 ///< 存在有效缓存时直接映射缓存。
+	bool write_cache = true;							 ///< 解析源文件后写入缓存。
+	BVHBuildMode build_mode = BVHBuildMode::BINNED_SAH; ///< 解析源文件后构建 BVH 使用的算法。
+};
+
+/**
+ * @brief 一次网格加载的统计信息。
+ */
+struct MeshLoadStats {
+	double load_ms = 0.0;	   ///< 总耗时（毫秒），包括解析与 BVH 构建。
+	double parse_ms = 0.0;	   ///< 解析源文件或映射缓存的耗时（毫秒）。
+	size_t peak_memory = 0;	   ///< 加载完成时进程的峰值常驻内存（字节），平台不支持时为 0。
+	size_t vertex_count = 0;   ///< 顶点数。
+	size_t triangle_count = 0; ///< 三角形数。
+	bool from_cache = false;   ///< 是否直接映射了缓存文件。
+	bool cache_written = false; ///< 本次加载是否写入了新的缓存文件。
+};
+
+/**
+ * @brief 基于内存映射的网格加载器，支持 Wavefront OBJ 与二进制 PLY。
+ *
+ * OBJ 文本按行边界切分为若干块，由 OpenMP 线程并行解析；二进制 PLY 直接从映射的字节中解码。
+ * 首次加载后在源文件旁写入 `.rtmesh` 缓存，其中保存按叶子顺序排列的顶点、索引与 BVH 节点；
+ * 之后的加载直接映射缓存文件，网格缓冲指向映射内存，不再解析也不再构建二叉 BVH。
+ * 源文件的大小或修改时间变化时缓存自动失效。
+ */
+class MeshLoader {
+public:
+	/**
+	 * @brief 加载网格文件。
+	 *
+	 * @param path OBJ 或 PLY 文件路径，按扩展名区分格式。
+	 * @param mat 网格材质。
+	 * @param options 加载选项。
+	 * @param stats [out] 可选的统计信息。
+	 * @throws std::runtime_error 文件无法读取或格式错误时抛出。
+	 */
+	static std::shared_ptr<TriangleMesh> load(const std::filesystem::path& path, std::shared_ptr<Material> mat,
+											  const MeshLoadOptions& options = {}, MeshLoadStats* stats = nullptr);
+
+	/**
+	 * @brief 源文件对应的缓存文件路径。
+	 */
+	static std::filesystem::path cache_path(const std::filesystem::path& path);
+
+	/**
+	 * @brief 将网格写入缓存文件，先写入临时文件再重命名，避免留下不完整的缓存。
+	 *
+	 * @param mesh 网格。
+	 * @param source 源文件，用于记录大小与修改时间。
+	 * @param mode 网格 BVH 的构建算法，加载时与选项不一致则缓存失效。
+	 * @return 写入成功返回 true。
+	 */
+	static bool write_cache(const TriangleMesh& mesh, const std::filesystem::path& source, BVHBuildMode mode);
+
+	/**
+	 * @brief 进程的峰值常驻内存（字节），平台不支持时返回 0。
+	 */
+	static size_t peak_memory();
+};
+
+} // namespace rt
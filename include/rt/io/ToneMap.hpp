@@ -0,0 +1,41 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 色调映射算子，把曝光调整后的线性辐射度压缩到 [0, 1]。
+ */
+enum class ToneMapOperator {
+	CLAMP,	  ///< 不压缩，超过 1 的部分直接截断。
+	REINHARD, ///< 按亮度做 L / (1 + L)，保持色相。
+	ACES,	  ///< ACES 电影色调曲线的拟合（Narkowicz），逐通道应用。
+};
+
+/**
+ * @brief 由线性值到显示值的传递函数。
+ */
+enum class TransferFunction {
+	GAMMA_2, ///< 取平方根（gamma 2.0）。
+	SRGB,	 ///< sRGB 标准曲线。
+};
+
+/**
+ * @brief 色调映射参数。默认值与只做 gamma 2.0 校正和截断的输出逐字节相同。
+ */
+struct ToneMapSettings {
+	float exposure = 0.0F;									///< 曝光补偿（档），辐射度乘以 2^exposure。
+	ToneMapOperator tone_operator = ToneMapOperator::CLAMP; ///< 色调映射算子。
+	TransferFunction transfer = TransferFunction::GAMMA_2;	///< 传递函数。
+};
+
+/**
+ * @brief 把线性 RGB 像素转换为 8 位 RGB：曝光、色调映射、传递函数，再量化。各像素独立，按 OpenMP 并行。
+ *
+ * @return 每像素 3 字节，顺序与 pixels 相同。
+ */
+std::vector<unsigned char> tone_map(std::span<const glm::vec3> pixels, const ToneMapSettings& settings = {});
+
+} // namespace rt
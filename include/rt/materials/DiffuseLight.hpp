@@ -39,6 +39,8 @@ public:
 		return {0, 0, 0};
 	}
 
+	[[nodiscard]] const glm::vec3& emit() const { return _emit; }
+
 private:
 	glm::vec3 _emit;
 };
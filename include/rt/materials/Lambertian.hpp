@@ -23,6 +23,18 @@ public:
 		return {0, 0, 0};
 	}
 
+	[[nodiscard]] const glm::vec3& albedo() const { return _albedo; }
+
+	/**
+	 * @brief 散射内核，虚函数与 MaterialTable 共用。
+	 */
+	static void sample_scatter(const glm::vec3& albedo, const HitRecord& rec, ScatterRecord& srec);
+
+	/**
+	 * @brief BRDF 内核，虚函数与 MaterialTable 共用。
+	 */
+	[[nodiscard]] static glm::vec3 eval_brdf(const glm::vec3& albedo);
+
 private:
 	glm::vec3 _albedo; ///< 材质的反照率（颜色）。
 };
@@ -1,13 +1,13 @@
 #pragma once
 #include "rt/core/Ray.hpp"
 #include "rt/core/HitRecord.hpp"
-#include "rt/pdf/PDF.hpp"
+#include "rt/pdf/ScatterPDF.hpp"
 
 namespace rt {
 
 struct ScatterRecord {
 	glm::vec3 attenuation;		  ///< 衰减系数（颜色）。
-	std::shared_ptr<PDF> pdf_ptr; ///< 概率密度函数指针。
+	ScatterPDF pdf;				  ///< 散射方向的概率密度函数，按值保存。
 	bool is_specular = false;	  ///< 是否为镜面反射（Delta分布）。
 };
 
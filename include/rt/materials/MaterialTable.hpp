@@ -0,0 +1,96 @@
+#pragma once
+#include "rt/materials/Material.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace rt {
+
+/**
+ * @brief 编译后的材质表：按材质种类分组，参数以 SoA 数组保存，着色时按种类静态分发。
+ *
+ * 内置材质（Lambertian、Metal、DiffuseLight）的参数被复制进各自种类的数组，着色时用 switch 分发到
+ * 与虚函数实现共用的静态内核，不经过虚函数，也不对不发光的材质调用 emitted。其他 Material 子类（包括内置材质的
+ * 子类，它们可能覆盖了虚函数）归入 CUSTOM 种类，仍通过虚函数调用，作为自定义材质的扩展途径。
+ *
+ * 材质编号的高 4 位为种类、低 28 位为种类内的下标，因此按编号排序即按种类分组。
+ *
+ * 用法：创建材质表后调用场景的 Hittable::bind_materials 为每个图元分配编号，
+ * 再通过 SoftTracer::set_material_table 交给渲染器。
+ */
+class MaterialTable {
+public:
+	/**
+	 * @brief 材质种类。
+	 */
+	enum class Kind : std::uint8_t {
+		LAMBERTIAN,	   ///< 漫反射
+		METAL,		   ///< 金属
+		DIFFUSE_LIGHT, ///< 发光体
+		CUSTOM,		   ///< 其他材质，通过虚函数调用
+	};
+
+	static constexpr int KIND_SHIFT = 28;								 ///< 编号中种类所在的位。
+	static constexpr std::uint32_t INDEX_MASK = (1U << KIND_SHIFT) - 1U; ///< 编号中种类内下标的掩码。
+
+	/**
+	 * @brief 注册一个材质并返回其编号，同一材质重复注册返回同一编号。材质表持有其所有权。
+	 */
+	std::uint32_t add(const std::shared_ptr<Material>& material);
+
+	[[nodiscard]] static Kind kind(const std::uint32_t id) { return static_cast<Kind>(id >> KIND_SHIFT); }
+	[[nodiscard]] static std::uint32_t index(const std::uint32_t id) { return id & INDEX_MASK; }
+
+	/**
+	 * @brief 已注册的材质数。
+	 */
+	[[nodiscard]] size_t size() const { return _ids.size(); }
+
+	/**
+	 * @brief 等价于 rec.mat_ptr->scatter；rec 未绑定编号时回退到虚函数。
+	 */
+	bool scatter(const Ray& r_in, const HitRecord& rec, ScatterRecord& srec) const;
+
+	/**
+	 * @brief 等价于 rec.mat_ptr->brdf；rec 未绑定编号时回退到虚函数。
+	 */
+	[[nodiscard]] glm::vec3 brdf(const Ray& r_in, const HitRecord& rec, const Ray& scattered) const;
+
+	/**
+	 * @brief 等价于 rec.mat_ptr->emitted；只有发光体与自定义材质需要计算。
+	 */
+	[[nodiscard]] glm::vec3 emitted(const Ray& r_in, const HitRecord& rec) const;
+
+private:
+	/**
+	 * @brief Lambertian 的参数。
+	 */
+	struct LambertianParams {
+		std::vector<glm::vec3> albedo; ///< 反照率。
+	};
+
+	/**
+	 * @brief Metal 的参数。
+	 */
+	struct MetalParams {
+		std::vector<glm::vec3> albedo; ///< 反照率。
+		std::vector<double> fuzz;	   ///< 模糊度。
+	};
+
+	/**
+	 * @brief DiffuseLight 的参数。
+	 */
+	struct DiffuseLightParams {
+		std::vector<glm::vec3> emit; ///< 发光颜色。
+	};
+
+	LambertianParams _lambertian;					  ///< 漫反射材质参数。
+	MetalParams _metal;								  ///< 金属材质参数。
+	DiffuseLightParams _diffuse_light;				  ///< 发光材质参数。
+	std::vector<std::shared_ptr<Material>> _custom;	  ///< 自定义材质。
+	std::vector<std::shared_ptr<Material>> _owned;	  ///< 全部已注册材质，保证 HitRecord::mat_ptr 有效。
+	std::unordered_map<const Material*, std::uint32_t> _ids; ///< 材质到编号的映射，仅在注册时使用。
+};
+
+} // namespace rt
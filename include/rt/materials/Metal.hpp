@@ -24,6 +24,21 @@ public:
 		return {0, 0, 0};
 	}
 
+	[[nodiscard]] const glm::vec3& albedo() const { return _albedo; }
+	[[nodiscard]] double fuzz() const { return _fuzz; }
+
+	/**
+	 * @brief 散射内核，虚函数与 MaterialTable 共用。
+	 */
+	static void sample_scatter(const glm::vec3& albedo, double fuzz, const Ray& r_in, const HitRecord& rec,
+							   ScatterRecord& srec);
+
+	/**
+	 * @brief BRDF 内核，虚函数与 MaterialTable 共用。
+	 */
+	[[nodiscard]] static glm::vec3 eval_brdf(const glm::vec3& albedo, double fuzz, const Ray& r_in,
+											 const HitRecord& rec, const Ray& scattered);
+
 private:
 	glm::vec3 _albedo; ///< 材质的反照率（颜色）。
 	double _fuzz;	   ///< 模糊度参数，用于模糊反射。
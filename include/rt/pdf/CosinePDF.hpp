@@ -13,7 +13,7 @@ namespace rt {
  * 
  * 适用于 Lambertian 材质的采样。
  */
-class CosinePDF : public PDF {
+class CosinePDF final : public PDF {
 public:
 	/**
 	 * @brief 构造函数。
@@ -27,8 +27,8 @@ public:
 		return (cosine <= 0) ? 0 : cosine / PI;
 	}
 
-	[[nodiscard]] glm::vec3 generate() const override {
-		const auto dbg_mid = random_cosine_direction();
+	[[nodiscard]] glm::vec3 generate(Sampler& sampler) const override {
+		const auto dbg_mid = random_cosine_direction(sampler);
 		auto cosine_theta = glm::dot(glm::normalize(_uvw.transform_to_world(dbg_mid)), _uvw.w());
 		// fmt::println(stderr, 
 		// 	"CosinePDF::generate() - cosine_theta: {}\n  - return ({},{},{})", 
@@ -13,7 +13,7 @@ namespace rt {
  * 概率密度函数为: p(theta) = (n+1)/(2*pi) * cos(theta)^n
  * 其中 n 是幂次 (exponent)，控制波瓣的宽窄。
  */
-class CosinePowerPDF : public PDF {
+class CosinePowerPDF final : public PDF {
 public:
 	/**
 	 * @brief 构造函数。
@@ -39,9 +39,10 @@ public:
 		return (_exponent + 1) / (2 * PI) * pow(cosine, _exponent);
 	}
 
-	[[nodiscard]] glm::vec3 generate() const override {
-		const double r1 = random_double();
-		const double r2 = random_double();
+	[[nodiscard]] glm::vec3 generate(Sampler& sampler) const override {
+		const glm::vec2 u = sampler.get_2d();
+		const double r1 = u.x;
+		const double r2 = u.y;
 		const double phi = 2 * PI * r2;
 
 		// 根据分布生成 cos_theta
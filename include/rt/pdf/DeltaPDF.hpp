@@ -10,7 +10,7 @@ namespace rt {
  * 用于完美镜面反射等情况。
  * 在特定方向上概率为 1 (模拟 Dirac Delta)，其他方向为 0。
  */
-class DeltaPDF : public PDF {
+class DeltaPDF final : public PDF {
 public:
 	DeltaPDF(const glm::vec3& w)
 		: _w(glm::normalize(w)) {}
@@ -23,7 +23,7 @@ public:
 		return (COSINE > 0.9999) ? 1.0 : 0.0;
 	}
 
-	[[nodiscard]] glm::vec3 generate() const override {
+	[[nodiscard]] glm::vec3 generate(Sampler& /*sampler*/) const override {
 		return _w;
 	}
 
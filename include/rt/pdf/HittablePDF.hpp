@@ -1,27 +1,30 @@
 #pragma once
 
-#include <utility>
-
 #include "rt/pdf/PDF.hpp"
 #include "rt/hittables/Hittable.hpp"
 
 namespace rt {
 
-class HittablePDF : public PDF {
+/**
+ * @brief 朝一个 Hittable（通常是光源列表）采样方向的 PDF。
+ *
+ * 只在一次着色内使用，按值构造在栈上，不持有对象的所有权。
+ */
+class HittablePDF final : public PDF {
 public:
-	HittablePDF(std::shared_ptr<Hittable> p, const glm::vec3& origin) : _origin(origin), _hittable_ptr(std::move(p)) {}
+	HittablePDF(const Hittable& hittable, const glm::vec3& origin) : _origin(origin), _hittable_ptr(&hittable) {}
 
 	[[nodiscard]] double value(const glm::vec3& direction) const override {
 		return _hittable_ptr->pdf_value(_origin, direction);
 	}
 
-	[[nodiscard]] glm::vec3 generate() const override {
-		return _hittable_ptr->random(_origin);
+	[[nodiscard]] glm::vec3 generate(Sampler& sampler) const override {
+		return _hittable_ptr->random(_origin, sampler);
 	}
 
 private:
 	glm::vec3 _origin;							///< 采样的原点
-	std::shared_ptr<Hittable> _hittable_ptr;	///< 被采样的 Hittable 对象指针
+	const Hittable* _hittable_ptr;	///< 被采样的 Hittable 对象，生命周期由调用方保证
 };
 
 } // namespace rt
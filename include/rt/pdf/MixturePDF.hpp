@@ -26,11 +26,11 @@ public:
 		return 0.5 * _p[0]->value(direction) + 0.5 * _p[1]->value(direction);
 	}
 
-	[[nodiscard]] glm::vec3 generate() const override {
-		if (random_double() < 0.5) {
-			return _p[0]->generate();
+	[[nodiscard]] glm::vec3 generate(Sampler& sampler) const override {
+		if (random_double(sampler) < 0.5) {
+			return _p[0]->generate(sampler);
 		}
-		return _p[1]->generate();
+		return _p[1]->generate(sampler);
 	}
 
 private:
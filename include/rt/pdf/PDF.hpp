@@ -1,4 +1,5 @@
 #pragma once
+#include "rt/sampling/Sampler.hpp"
 #include <glm/glm.hpp>
 
 namespace rt {
@@ -28,9 +29,10 @@ public:
 	/**
 	 * @brief 根据 PDF 分布生成一个随机方向。
 	 *
+	 * @param sampler 提供随机数的采样器。
 	 * @return glm::vec3 生成的随机方向向量。
 	 */
-	[[nodiscard]] virtual glm::vec3 generate() const = 0;
+	[[nodiscard]] virtual glm::vec3 generate(Sampler& sampler) const = 0;
 };
 
 } // namespace rt
@@ -0,0 +1,59 @@
+#pragma once
+#include "rt/pdf/CosinePDF.hpp"
+#include "rt/pdf/CosinePowerPDF.hpp"
+#include "rt/pdf/DeltaPDF.hpp"
+#include "rt/pdf/UniformPDF.hpp"
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace rt {
+
+/**
+ * @brief 材质散射方向的 PDF，按值保存具体的分布类型。
+ *
+ * 材质每次散射都会生成一个新的 PDF；用 std::variant 保存在 ScatterRecord 中而不是 make_shared，
+ * 弹射过程不再访问堆，多个线程也不会同时争用全局分配器。调用时按具体类型静态分发，没有虚函数调用。
+ */
+class ScatterPDF {
+public:
+	/**
+	 * @brief 空的 PDF，value 恒为 0。
+	 */
+	ScatterPDF() = default;
+
+	/**
+	 * @brief 由具体的分布类型构造。
+	 */
+	template <typename T>
+	ScatterPDF(T pdf) : _pdf(std::move(pdf)) {} // NOLINT(google-explicit-constructor)
+
+	[[nodiscard]] double value(const glm::vec3& direction) const {
+		return std::visit(
+			[&](const auto& pdf) -> double {
+				if constexpr (std::is_same_v<std::decay_t<decltype(pdf)>, std::monostate>)
+					return 0.0;
+				else
+					return pdf.value(direction);
+			},
+			_pdf);
+	}
+
+	[[nodiscard]] glm::vec3 generate(Sampler& sampler) const {
+		return std::visit(
+			[&](const auto& pdf) -> glm::vec3 {
+				if constexpr (std::is_same_v<std::decay_t<decltype(pdf)>, std::monostate>)
+					return {1, 0, 0};
+				else
+					return pdf.generate(sampler);
+			},
+			_pdf);
+	}
+
+	[[nodiscard]] bool empty() const { return std::holds_alternative<std::monostate>(_pdf); }
+
+private:
+	std::variant<std::monostate, CosinePDF, CosinePowerPDF, DeltaPDF, UniformPDF> _pdf;
+};
+
+} // namespace rt
@@ -8,7 +8,7 @@ namespace rt {
 /**
  * @brief 均匀分布的 PDF。
  */
-class UniformPDF : public PDF {
+class UniformPDF final : public PDF {
 public:
 	/**
 	 * @brief 构造函数。
@@ -23,8 +23,8 @@ public:
 		return 1 / (2 * PI);
 	}
 
-	[[nodiscard]] glm::vec3 generate() const override {
-		return _uvw.transform_to_world(random_unit_vector_hemisphere());
+	[[nodiscard]] glm::vec3 generate(Sampler& sampler) const override {
+		return _uvw.transform_to_world(random_unit_vector_hemisphere(sampler));
 	}
 
 private:
@@ -0,0 +1,130 @@
+#pragma once
+#include "rt/sampling/Sampler.hpp"
+#include <cstdint>
+
+namespace rt {
+
+/**
+ * @brief PCG32 伪随机数发生器（64 位 LCG 状态，XSH-RR 输出 32 位）。
+ *
+ * 状态只有 16 字节，每个数一次乘加，可以 O(log n) 跳过 n 个数。
+ */
+class PCG32 {
+public:
+	PCG32() = default;
+
+	/**
+	 * @brief 以序列编号与初始状态构造。不同序列编号的发生器产生互不相关的序列。
+	 */
+	PCG32(const std::uint64_t sequence, const std::uint64_t seed) { set_sequence(sequence, seed); }
+
+	void set_sequence(const std::uint64_t sequence, const std::uint64_t seed) {
+		_state = 0;
+		_inc = (sequence << 1U) | 1U;
+		next_uint();
+		_state += seed;
+		next_uint();
+	}
+
+	std::uint32_t next_uint() {
+		const std::uint64_t old_state = _state;
+		_state = old_state * MULTIPLIER + _inc;
+		const auto xorshifted = static_cast<std::uint32_t>(((old_state >> 18U) ^ old_state) >> 27U);
+		const auto rot = static_cast<std::uint32_t>(old_state >> 59U);
+		return (xorshifted >> rot) | (xorshifted << ((0U - rot) & 31U));
+	}
+
+	/**
+	 * @brief [0, 1) 内的单精度浮点数，取高 24 位，结果严格小于 1。
+	 */
+	float next_float() { return fixed_to_float(next_uint()); }
+
+	/**
+	 * @brief 跳过 delta 个数。
+	 */
+	void advance(std::uint64_t delta) {
+		// 积分器在一次弹射内只跳过几个数，逐步推进比跳跃算法的乘法链更短
+		if (delta <= SHORT_ADVANCE) {
+			for (; delta > 0; --delta)
+				_state = _state * MULTIPLIER + _inc;
+			return;
+		}
+
+		std::uint64_t cur_mult = MULTIPLIER;
+		std::uint64_t cur_plus = _inc;
+		std::uint64_t acc_mult = 1;
+		std::uint64_t acc_plus = 0;
+		while (delta > 0) {
+			if ((delta & 1U) != 0) {
+				acc_mult *= cur_mult;
+				acc_plus = acc_plus * cur_mult + cur_plus;
+			}
+			cur_plus = (cur_mult + 1) * cur_plus;
+			cur_mult *= cur_mult;
+			delta >>= 1U;
+		}
+		_state = acc_mult * _state + acc_plus;
+	}
+
+private:
+	static constexpr std::uint64_t MULTIPLIER = 0x5851f42d4c957f2dULL;
+	static constexpr std::uint64_t SHORT_ADVANCE = 8; ///< 不超过该步数时逐步推进。
+
+	std::uint64_t _state = 0x853c49e6748fea9bULL; ///< LCG 状态。
+	std::uint64_t _inc = 0xda3e39cb94b95bdbULL;	  ///< LCG 增量，决定序列编号，必须为奇数。
+};
+
+/**
+ * @brief 独立随机采样器：每个像素一条 PCG32 序列，每个采样从序列中按采样序号散列出的位置开始。
+ */
+class PCG32Sampler final : public Sampler {
+public:
+	/**
+	 * @brief 构造函数，定位到像素 0 的采样 0。
+	 *
+	 * @param seed 全局种子，不同种子给出互不相关的图像。
+	 */
+	explicit PCG32Sampler(const std::uint64_t seed = 0) : _seed(seed) { start_pixel_sample(0, 0, 0); }
+
+	void start_pixel_sample(const std::uint32_t pixel, const std::uint32_t sample_index,
+							const std::uint32_t dimension) override {
+		_pixel = pixel;
+		_sample_index = sample_index;
+		_rng.set_sequence(mix_bits(_seed ^ (std::uint64_t{pixel} << 32U)),
+						  mix_bits((_seed * 0x9e3779b97f4a7c15ULL) ^ sample_index));
+		_rng.advance(dimension);
+		_dimension = dimension;
+	}
+
+	void set_dimension(const std::uint32_t dimension) override {
+		// 向前跳过只需推进序列，向后则从采样的起点重新定位
+		if (dimension < _dimension) {
+			start_pixel_sample(_pixel, _sample_index, dimension);
+			return;
+		}
+		_rng.advance(dimension - _dimension);
+		_dimension = dimension;
+	}
+
+	[[nodiscard]] float get_1d() override {
+		++_dimension;
+		return _rng.next_float();
+	}
+
+	[[nodiscard]] glm::vec2 get_2d() override {
+		_dimension += 2;
+		const float x = _rng.next_float();
+		return {x, _rng.next_float()};
+	}
+
+	[[nodiscard]] std::uint32_t dimension() const override { return _dimension; }
+
+private:
+	std::uint64_t _seed;			 ///< 全局种子。
+	PCG32 _rng;						 ///< 当前采样的序列。
+	std::uint32_t _pixel = 0;		 ///< 当前像素。
+	std::uint32_t _sample_index = 0; ///< 当前采样序号。
+	std::uint32_t _dimension = 0;	 ///< 下一个维度。
+};
+
+} // namespace rt
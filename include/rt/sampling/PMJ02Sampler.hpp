@@ -0,0 +1,50 @@
+#pragma once
+#include "rt/sampling/Sampler.hpp"
+#include <cstdint>
+
+namespace rt {
+
+/**
+ * @brief 渐进多重抖动 (0,2) 序列 (PMJ02) 采样器（Christensen 等 2018）。
+ *
+ * 所有像素与维度共用一张预先生成的点表，任意 2 的幂个前缀点满足全部二维基本区间的分层。
+ * 每次取数由（种子，像素，维度）散列出一个置换，在每段 [2^j, 2^(j+1)) 内打乱采样顺序，
+ * 再对坐标做随机数字异或，二者都不破坏分层，同时使不同维度、不同像素互不相关。
+ * 打乱不依赖像素的采样总数，自适应采样在任意 2 的幂处停止时前缀仍然分层。
+ * 采样数超过点表大小时，超出的部分换一组散列值重复使用点表。
+ */
+class PMJ02Sampler final : public Sampler {
+public:
+	static constexpr std::uint32_t TABLE_SIZE = 1U << 12U; ///< 点表中的点数。
+
+	/**
+	 * @brief 构造函数，定位到像素 0 的采样 0。
+	 *
+	 * @param seed 全局种子。
+	 */
+	explicit PMJ02Sampler(std::uint64_t seed = 0);
+
+	void start_pixel_sample(const std::uint32_t pixel, const std::uint32_t sample_index,
+							const std::uint32_t dimension) override {
+		_pixel_hash = hash_combine(_seed, pixel);
+		_sample_index = sample_index;
+		_dimension = dimension;
+	}
+
+	void set_dimension(const std::uint32_t dimension) override { _dimension = dimension; }
+
+	[[nodiscard]] float get_1d() override;
+
+	[[nodiscard]] glm::vec2 get_2d() override;
+
+	[[nodiscard]] std::uint32_t dimension() const override { return _dimension; }
+
+private:
+	std::uint64_t _seed;				  ///< 全局种子。
+	const std::uint32_t* _table;		  ///< 点表，每个点两个 32 位定点坐标。
+	std::uint64_t _pixel_hash = 0;		  ///< 种子与当前像素的散列值。
+	std::uint32_t _sample_index = 0;	  ///< 当前采样序号。
+	std::uint32_t _dimension = 0;		  ///< 下一个维度。
+};
+
+} // namespace rt
@@ -0,0 +1,101 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+
+namespace rt {
+
+/**
+ * @brief 采样器的类型。
+ */
+enum class SamplerType {
+	INDEPENDENT, ///< 独立随机采样（PCG32），默认
+	SOBOL,		 ///< Owen 置乱的 Sobol 序列
+	PMJ02,		 ///< 渐进多重抖动 (0,2) 序列
+};
+
+/**
+ * @brief 采样器抽象基类：为一个像素的一个采样提供 [0, 1) 内的随机数序列。
+ *
+ * 每个采样的序列只由（种子，像素，采样序号）决定，与哪个线程、以什么顺序渲染无关，
+ * 因此同一设置下的渲染结果可以逐位复现。序列中的每个数称为一个维度，积分器按固定的顺序消耗维度。
+ */
+class Sampler {
+protected:
+	Sampler() = default;
+
+public:
+	Sampler(const Sampler&) = default;
+	Sampler(Sampler&&) = default;
+	Sampler& operator=(const Sampler&) = default;
+	Sampler& operator=(Sampler&&) = default;
+	virtual ~Sampler() = default;
+
+	/**
+	 * @brief 定位到某个像素的某个采样的序列。
+	 *
+	 * @param pixel 像素索引。
+	 * @param sample_index 像素内的采样序号。
+	 * @param dimension 从序列的第几个维度开始，用于在中断后继续同一条路径。
+	 */
+	virtual void start_pixel_sample(std::uint32_t pixel, std::uint32_t sample_index, std::uint32_t dimension) = 0;
+
+	/**
+	 * @brief 跳到当前采样的某个维度，之后的 get_1d / get_2d 从该维度开始。
+	 *
+	 * 积分器为每种用途（像素抖动、每次弹射的光源选择、光源表面点与 BSDF 方向）分配固定的维度，
+	 * 各用途实际消耗多少个数都不会影响其他用途取到的数。
+	 */
+	virtual void set_dimension(std::uint32_t dimension) = 0;
+
+	/**
+	 * @brief 下一个维度的随机数，范围 [0, 1)。
+	 */
+	[[nodiscard]] virtual float get_1d() = 0;
+
+	/**
+	 * @brief 下两个维度的随机数，各分量范围 [0, 1)。
+	 */
+	[[nodiscard]] virtual glm::vec2 get_2d() = 0;
+
+	/**
+	 * @brief 下一个将要使用的维度。
+	 */
+	[[nodiscard]] virtual std::uint32_t dimension() const = 0;
+};
+
+/**
+ * @brief 创建指定类型的采样器。
+ *
+ * @param type 采样器类型。
+ * @param seed 全局种子。
+ */
+std::unique_ptr<Sampler> make_sampler(SamplerType type, std::uint64_t seed);
+
+/**
+ * @brief 64 位整数的混合函数（MurmurHash3 的 fmix64），用于由像素与采样序号派生种子。
+ */
+inline std::uint64_t mix_bits(std::uint64_t v) {
+	v ^= v >> 33;
+	v *= 0xff51afd7ed558ccdULL;
+	v ^= v >> 33;
+	v *= 0xc4ceb9fe1a85ec53ULL;
+	v ^= v >> 33;
+	return v;
+}
+
+/**
+ * @brief 把两个值合并为一个散列值，用于由（种子，像素，维度）派生置乱种子。
+ */
+inline std::uint64_t hash_combine(const std::uint64_t a, const std::uint64_t b) {
+	return mix_bits(a ^ (b + 0x9e3779b97f4a7c15ULL + (a << 6U) + (a >> 2U)));
+}
+
+/**
+ * @brief [0, 2^32) 内的定点数转换为 [0, 1) 内的单精度浮点数，取高 24 位，结果严格小于 1。
+ */
+inline float fixed_to_float(const std::uint32_t v) {
+	return static_cast<float>(v >> 8U) * 0x1p-24F;
+}
+
+} // namespace rt
@@ -0,0 +1,46 @@
+#pragma once
+#include "rt/sampling/Sampler.hpp"
+#include <cstdint>
+
+namespace rt {
+
+/**
+ * @brief Owen 置乱的 Sobol 采样器。
+ *
+ * 每次取数都用 Sobol 序列的前两维生成一个一维或二维点，更高的维度不查表，而是由（种子，像素，维度）
+ * 散列出置乱种子：先对采样序号做嵌套均匀置换打乱顺序，再对点的坐标做 Owen 置乱。
+ * 置换只在按 2 的幂对齐的块内交换采样，因此任意 2^k 个连续采样仍构成 (0,k,2) 网，
+ * 各维度之间互不相关，像素之间的误差也不相关。
+ */
+class SobolSampler final : public Sampler {
+public:
+	/**
+	 * @brief 构造函数，定位到像素 0 的采样 0。
+	 *
+	 * @param seed 全局种子。
+	 */
+	explicit SobolSampler(const std::uint64_t seed = 0) : _seed(seed) { start_pixel_sample(0, 0, 0); }
+
+	void start_pixel_sample(const std::uint32_t pixel, const std::uint32_t sample_index,
+							const std::uint32_t dimension) override {
+		_pixel_hash = hash_combine(_seed, pixel);
+		_sample_index = sample_index;
+		_dimension = dimension;
+	}
+
+	void set_dimension(const std::uint32_t dimension) override { _dimension = dimension; }
+
+	[[nodiscard]] float get_1d() override;
+
+	[[nodiscard]] glm::vec2 get_2d() override;
+
+	[[nodiscard]] std::uint32_t dimension() const override { return _dimension; }
+
+private:
+	std::uint64_t _seed;			 ///< 全局种子。
+	std::uint64_t _pixel_hash = 0;	 ///< 种子与当前像素的散列值。
+	std::uint32_t _sample_index = 0; ///< 当前采样序号。
+	std::uint32_t _dimension = 0;	 ///< 下一个维度。
+};
+
+} // namespace rt
@@ -1,4 +1,6 @@
+#include "rt/apps/AnimatedSpheres.hpp"
 #include "rt/apps/CornerBox.hpp"
+#include "rt/apps/MeshViewer.hpp"
 #include "rt/apps/MirrorBox.hpp"
 #include "rt/apps/RandomSpheres.hpp"
 #include "rt/apps/SimpleLight.hpp"
@@ -6,6 +8,9 @@
 #include "rt/apps/MisComparison.hpp"
 #include "rt/apps/Playground.hpp"
 #include "rt/apps/CompareSampling.hpp"
+#include "rt/apps/ThreadScaling.hpp"
+#include "rt/apps/SamplerConvergence.hpp"
+#include "rt/apps/ToneMapping.hpp"
 
 #include <fmt/core.h>
 #include <iostream>
@@ -22,9 +27,14 @@ int main(int argc, char* argv[]) {
 
 	apps.push_back(std::make_unique<rt::CornerBoxApp>());
 	apps.push_back(std::make_unique<rt::MirrorBoxApp>());
+	apps.push_back(std::make_unique<rt::MeshViewerApp>());
 	apps.push_back(std::make_unique<rt::RandomSpheresApp>());
+	apps.push_back(std::make_unique<rt::AnimatedSpheresApp>());
 	apps.push_back(std::make_unique<rt::SimpleLightApp>());
 	apps.push_back(std::make_unique<rt::SimpleLightWrongApp>());
+	apps.push_back(std::make_unique<rt::ThreadScalingApp>());
+	apps.push_back(std::make_unique<rt::SamplerConvergenceApp>());
+	apps.push_back(std::make_unique<rt::ToneMappingApp>());
 
 	fmt::print("Available Applications:\n");
 	for (size_t i = 0; i < apps.size(); ++i) {
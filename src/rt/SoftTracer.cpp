@@ -2,227 +2,903 @@
 #include "rt/materials/Material.hpp"
 #include "rt/core/Utils.hpp"
 #include "rt/pdf/HittablePDF.hpp"
+#include "rt/io/Checkpoint.hpp"
+#include "rt/core/TileScheduler.hpp"
+#include "rt/core/RadixSort.hpp"
 #include <fmt/core.h>
 #include <omp.h>
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <csignal>
 #include <cstddef>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
 namespace rt {
 
+namespace {
+
+/**
+ * @brief 收到 SIGTERM 后置位，渐进渲染在当前轮次结束时写入检查点并停止；每次安装处理函数时清零。
+ */
+volatile std::sig_atomic_t termination_requested = 0;
+
+void request_termination(int /*signal*/) {
+	termination_requested = 1;
+}
+
+/**
+ * @brief 并行流压缩：按原顺序把 [0, n) 中满足 keep(k) 的元素依次交给 emit(dst, k)，返回保留的个数。
+ *
+ * 各线程先统计自己区间内保留的个数，前缀和得到各区间的写入起点后再并行写入，结果与串行收集相同。
+ * offsets 是复用的临时缓冲区，避免每次调用都分配。
+ */
+template <typename Keep, typename Emit>
+std::int64_t parallel_compact(const std::int64_t n, std::vector<std::int64_t>& offsets, const Keep& keep,
+							  const Emit& emit) {
+	offsets.assign(static_cast<size_t>(omp_get_max_threads()) + 1, 0);
+	std::int64_t total = 0;
+#pragma omp parallel default(shared)
+	{
+		const std::int64_t n_threads = omp_get_num_threads();
+		const std::int64_t tid = omp_get_thread_num();
+		const std::int64_t begin = n * tid / n_threads;
+		const std::int64_t end = n * (tid + 1) / n_threads;
+
+		std::int64_t count = 0;
+		for (std::int64_t k = begin; k < end; ++k)
+			if (keep(k)) ++count;
+		offsets[tid + 1] = count;
+
+#pragma omp barrier
+#pragma omp single
+		{
+			for (std::int64_t t = 0; t < n_threads; ++t)
+				offsets[t + 1] += offsets[t];
+			total = offsets[n_threads];
+		}
+
+		std::int64_t dst = offsets[tid];
+		for (std::int64_t k = begin; k < end; ++k)
+			if (keep(k)) emit(dst++, k);
+	}
+	return total;
+}
+
+} // namespace
+
 SoftTracer::SoftTracer(const int width, const int height, const int samples, const int depth) :
 	_image_width(width), _image_height(height), m_samples_per_pixel(samples), m_max_depth(depth) {}
 
-glm::vec3 SoftTracer::m_ray_color(const Ray& r_in, const Scene& world, const std::shared_ptr<Hittable>& lights,
-								  int depth) {
+glm::vec3 SoftTracer::m_ray_color(const Ray& r_in, const Hittable& world, const std::shared_ptr<Hittable>& lights,
+								  int depth, Sampler& sampler) {
 	// 如果递归深度耗尽，返回黑色
 	if (depth <= 0) return {0, 0, 0};
 
 	HitRecord hit_rec;
-	if (!world.hit(r_in, RAY_T_MIN, DOUBLE_INF, hit_rec)) {
-		// 如果没有击中任何对象，返回背景色
-		if (m_use_sky_gradient) {
-			glm::vec3 unit_direction = glm::normalize(r_in.direction());
-			auto t = 0.5 * (unit_direction.y + 1.0);
-			return static_cast<float>(1.0 - t) * glm::vec3(1.0, 1.0, 1.0) +
-				   static_cast<float>(t) * glm::vec3(0.5, 0.7, 1.0);
+	// 如果没有击中任何对象，返回背景色
+	if (!world.hit(r_in, RAY_T_MIN, DOUBLE_INF, hit_rec)) return m_miss_color(r_in);
+	return m_shade(r_in, hit_rec, world, lights, depth, sampler);
+}
+
+glm::vec3 SoftTracer::m_miss_color(const Ray& r) const {
+	if (m_use_sky_gradient) {
+		glm::vec3 unit_direction = glm::normalize(r.direction());
+		auto t = 0.5 * (unit_direction.y + 1.0);
+		return static_cast<float>(1.0 - t) * glm::vec3(1.0, 1.0, 1.0) + static_cast<float>(t) * glm::vec3(0.5, 0.7, 1.0);
+	}
+	return m_background_color;
+}
+
+void SoftTracer::m_trace_packet(const RayPacket& packet, const Hittable& world,
+								const std::shared_ptr<Hittable>& lights,
+								const std::array<Sampler*, RayPacket::SIZE>& samplers,
+								std::array<StrategyColors, RayPacket::SIZE>& colors) {
+	if (m_max_depth <= 0) return;
+	const bool multiple = m_strategies.size() > 1;
+
+	// 击中点按策略数分别着色；未击中时各策略都得到背景色
+	const auto shade = [&](const int lane, const Ray& r, const HitRecord& rec) {
+		if (multiple)
+			m_shade_strategies(r, rec, world, lights, m_max_depth, *samplers[lane], colors[lane]);
+		else
+			colors[lane][0] += m_shade(r, rec, world, lights, m_max_depth, *samplers[lane]);
+	};
+	const auto miss = [&](const int lane, const Ray& r) {
+		const glm::vec3 background = m_miss_color(r);
+		for (size_t k = 0; k < m_strategies.size(); ++k)
+			colors[lane][k] += background;
+	};
+
+	if (!m_packet_tracing) {
+		for (std::uint32_t m = packet.valid; m != 0; m &= m - 1) {
+			const int lane = std::countr_zero(m);
+			const Ray r = packet.ray(lane);
+			if (!multiple) {
+				colors[lane][0] += m_ray_color(r, world, lights, m_max_depth, *samplers[lane]);
+				continue;
+			}
+			HitRecord rec;
+			if (world.hit(r, RAY_T_MIN, DOUBLE_INF, rec))
+				shade(lane, r, rec);
+			else
+				miss(lane, r);
+		}
+		return;
+	}
+
+	// 只有主光线的求交整包进行；着色产生的次级光线方向发散，仍逐条递归追踪
+	PacketHitRecord hits;
+	hits.reset(DOUBLE_INF);
+	world.hit_packet(packet, packet.valid, RAY_T_MIN, hits);
+	for (std::uint32_t m = packet.valid; m != 0; m &= m - 1) {
+		const int lane = std::countr_zero(m);
+		const Ray r = packet.ray(lane);
+		if ((hits.hit_mask & (1U << lane)) != 0)
+			shade(lane, r, hits.rec[lane]);
+		else
+			miss(lane, r);
+	}
+}
+
+glm::vec3 SoftTracer::m_shade(const Ray& r_in, const HitRecord& hit_rec, const Hittable& world,
+							  const std::shared_ptr<Hittable>& lights, const int depth, Sampler& sampler) {
+	// 迭代积分器从第一个击中点接管整条路径
+	if (m_integrator == IntegratorMode::ITERATIVE) return m_shade_iterative(r_in, hit_rec, world, lights, depth, sampler);
+
+	PathVertex vertex;
+	m_sample_vertex(r_in, hit_rec, lights, depth, sampler, vertex);
+
+	glm::vec3 radiance = vertex.emitted;
+	// 光源采样只追踪阴影光线；材质采样以 depth - 1 继续递归
+	if (vertex.shadow && !world.occluded(vertex.shadow_ray, RAY_T_MIN, vertex.shadow_t_max))
+		radiance += vertex.shadow_radiance[0];
+	if (vertex.extend) radiance += vertex.weight[0] * m_ray_color(vertex.next, world, lights, depth - 1, sampler);
+	return radiance;
+}
+
+glm::vec3 SoftTracer::m_shade_iterative(const Ray& r_in, const HitRecord& hit_rec, const Hittable& world,
+										const std::shared_ptr<Hittable>& lights, int depth, Sampler& sampler) const {
+	glm::vec3 radiance(0.0F);
+	glm::vec3 throughput(1.0F);
+	Ray ray = r_in;
+	HitRecord rec = hit_rec;
+	PathVertex vertex;
+
+	while (true) {
+		m_sample_vertex(ray, rec, lights, depth, sampler, vertex);
+		radiance += throughput * vertex.emitted;
+		if (vertex.shadow && !world.occluded(vertex.shadow_ray, RAY_T_MIN, vertex.shadow_t_max))
+			radiance += throughput * vertex.shadow_radiance[0];
+		if (!vertex.extend) break;
+
+		// 递归版本在返回时乘上的权重，这里前向累乘到吞吐量；深度耗尽时与递归版本一样贡献为零
+		throughput *= vertex.weight[0];
+		if (--depth <= 0 || (throughput.x <= 0 && throughput.y <= 0 && throughput.z <= 0)) break;
+
+		ray = vertex.next;
+		if (!world.hit(ray, RAY_T_MIN, DOUBLE_INF, rec)) {
+			radiance += throughput * m_miss_color(ray);
+			break;
+		}
+	}
+	return radiance;
+}
+
+void SoftTracer::m_shade_strategies(const Ray& r_in, const HitRecord& hit_rec, const Hittable& world,
+									const std::shared_ptr<Hittable>& lights, int depth, Sampler& sampler,
+									StrategyColors& colors) const {
+	StrategyColors radiance{};
+	StrategyColors throughput{};
+	throughput.fill(glm::vec3(1.0F));
+	// 仍在推进的策略；每个策略的吞吐量与 m_shade_iterative 中的完全相同
+	auto active = static_cast<std::uint32_t>((1U << m_strategies.size()) - 1U);
+	Ray ray = r_in;
+	HitRecord rec = hit_rec;
+	PathVertex vertex;
+
+	const auto for_each = [](const std::uint32_t mask, auto&& f) {
+		for (std::uint32_t m = mask; m != 0; m &= m - 1)
+			f(std::countr_zero(m));
+	};
+
+	while (true) {
+		m_sample_vertex(ray, rec, lights, depth, sampler, vertex, active);
+		for_each(active, [&](const int k) { radiance[k] += throughput[k] * vertex.emitted; });
+		if (vertex.shadow && !world.occluded(vertex.shadow_ray, RAY_T_MIN, vertex.shadow_t_max))
+			for_each(vertex.shadow_strategies,
+					 [&](const int k) { radiance[k] += throughput[k] * vertex.shadow_radiance[k]; });
+		active &= vertex.extend_strategies;
+		if (active == 0) break;
+
+		for_each(active, [&](const int k) {
+			throughput[k] *= vertex.weight[k];
+			if (throughput[k].x <= 0 && throughput[k].y <= 0 && throughput[k].z <= 0) active &= ~(1U << k);
+		});
+		if (--depth <= 0 || active == 0) break;
+
+		ray = vertex.next;
+		if (!world.hit(ray, RAY_T_MIN, DOUBLE_INF, rec)) {
+			const glm::vec3 background = m_miss_color(ray);
+			for_each(active, [&](const int k) { radiance[k] += throughput[k] * background; });
+			break;
 		}
-		return m_background_color;
 	}
 
+	for (size_t k = 0; k < m_strategies.size(); ++k)
+		colors[k] += radiance[k];
+}
+
+void SoftTracer::m_sample_vertex(const Ray& r_in, const HitRecord& hit_rec, const std::shared_ptr<Hittable>& lights,
+								 const int depth, Sampler& sampler, PathVertex& vertex,
+								 const std::uint32_t strategies) const {
+	vertex = PathVertex();
+	vertex.emitted = m_emitted(r_in, hit_rec);
+
 	ScatterRecord srec; // 存储散射信息
 
-	// 材质不散射光线，则返回自发光颜色
-	if (!hit_rec.mat_ptr->scatter(r_in, hit_rec, srec) || depth == 1) return hit_rec.mat_ptr->emitted(r_in, hit_rec);
+	// 材质不散射光线，则只有自发光
+	if (!m_scatter(r_in, hit_rec, srec) || depth == 1) return;
 
-	auto scatter_pdf_ptr = srec.pdf_ptr; // 散射方向分布
-	auto mat_ptr = hit_rec.mat_ptr;		 // 击中物体的材质
+	// 本次弹射使用的维度块，各用途的维度固定，与前面的用途实际消耗了多少个数无关
+	const auto dimension = PIXEL_DIMENSIONS + static_cast<std::uint32_t>(m_max_depth - depth) * BOUNCE_DIMENSIONS;
 
 	float rr_factor = 1.0F;
 	// 俄罗斯轮盘赌 (Russian Roulette)
 	if (depth < m_max_depth - RR_START_BOUNCE) {
+		sampler.set_dimension(dimension + RR_DIMENSION);
 		float p = std::max(srec.attenuation.x, std::max(srec.attenuation.y, srec.attenuation.z));
 		p = std::clamp(p, RR_MIN_PROBABILITY, 1.0F); // 限制最小概率
-		if (random_double() > p) return hit_rec.mat_ptr->emitted(r_in, hit_rec);
+		if (sampler.get_1d() > p) return;
 		// 能量补偿
 		rr_factor = 1.0F / p;
 	}
 
-	std::shared_ptr<HittablePDF> light_pdf_ptr = nullptr;
+	// 光源分布与材质分布都按值构造在栈上，整个着色过程不访问堆
+	std::optional<HittablePDF> light_pdf;
 	if (lights) {
-		if (auto scene_ptr = std::dynamic_pointer_cast<Scene>(lights)) {
-			if (!scene_ptr->objects.empty()) light_pdf_ptr = std::make_shared<HittablePDF>(lights, hit_rec.p);
-		} else {
-			light_pdf_ptr = std::make_shared<HittablePDF>(lights, hit_rec.p);
+		const auto* scene_ptr = dynamic_cast<const Scene*>(lights.get());
+		if (!scene_ptr || !scene_ptr->objects.empty()) light_pdf.emplace(*lights, hit_rec.p);
+	}
+
+	// 每种策略使用哪些样本；各策略的样本来自固定的维度，同时估计多种策略时共用同一个光源样本与材质样本
+	std::uint32_t light_strategies = 0;
+	std::uint32_t mat_strategies = 0;
+	for (std::uint32_t m = strategies; m != 0; m &= m - 1) {
+		const int k = std::countr_zero(m);
+		const SamplingStrategy strategy = m_strategies[k];
+		bool use_light = strategy == SamplingStrategy::MIS || strategy == SamplingStrategy::LIGHT;
+		bool use_mat = strategy == SamplingStrategy::MIS || strategy == SamplingStrategy::MATERIAL;
+
+		// 如果没有光源，强制只使用材质采样
+		if (!light_pdf) {
+			use_light = false;
+			use_mat = true;
 		}
+
+		// 针对镜面反射（Delta分布）的处理：
+		// 镜面反射的 PDF 值为无穷大 (Dirac Delta)。
+		// 在数值上，这意味着材质采样的权重应为 1，而光源采样的权重应为 0。
+		// 如果原本是 MIS，保持材质采样
+		if (srec.is_specular) use_light = false;
+
+		if (use_light) light_strategies |= 1U << k;
+		if (use_mat) mat_strategies |= 1U << k;
 	}
 
-	int n_light_samples = 0;
-	int n_mat_samples = 0;
+	// 采样任务：每种样本至多一个
+	struct SamplingTask {
+		bool shadow_ray;		///< 光源采样（light_pdf）生成阴影光线；材质采样（srec.pdf）生成续接光线
+		std::uint32_t strategies = 0; ///< 使用该样本的策略掩码
+		glm::vec3 dir{};		///< 采样方向
+		double pdf_val = 0.0;	///< 采样方向的 pdf
+		float cos_theta = 0.0F; ///< 采样方向与法线夹角的余弦
+		bool sampled = false;	///< 是否得到有效样本（pdf 与余弦均为正）
+	};
+	SamplingTask light_task{true, light_strategies};
+	SamplingTask mat_task{false, mat_strategies};
+
+	const auto pdf_value = [&](const SamplingTask& task, const glm::vec3& dir) {
+		return task.shadow_ray ? light_pdf->value(dir) : srec.pdf.value(dir);
+	};
 
-	switch (m_strategy) {
-		case SamplingStrategy::MIS:
-			n_light_samples = 1;
-			n_mat_samples = 1;
-			break;
-		case SamplingStrategy::LIGHT:
-			n_light_samples = 1;
-			n_mat_samples = 0;
-			break;
-		case SamplingStrategy::MATERIAL:
-		default:
-			n_light_samples = 0;
-			n_mat_samples = 1;
-			break;
+	// 1. 生成所有样本
+	for (SamplingTask* task : {&light_task, &mat_task}) {
+		if (task->strategies == 0) continue;
+		sampler.set_dimension(dimension + (task->shadow_ray ? LIGHT_DIMENSION : BSDF_DIMENSION));
+		task->dir = task->shadow_ray ? light_pdf->generate(sampler) : srec.pdf.generate(sampler);
+		task->pdf_val = pdf_value(*task, task->dir);
+		if (task->pdf_val <= 0) continue;
+
+		task->cos_theta = glm::dot(hit_rec.normal, glm::normalize(task->dir));
+		task->sampled = task->cos_theta > 0;
 	}
 
-	// 如果没有光源，强制只使用材质采样
-	if (!light_pdf_ptr) {
-		n_light_samples = 0;
-		n_mat_samples = 1;
+	// 策略 k 的 MIS 权重（平衡启发式），只计入该策略使用且得到有效样本的样本
+	const auto cal_mis_weight = [&](const SamplingTask& cur, const std::uint32_t strategy_bit) {
+		const bool both = (light_task.strategies & mat_task.strategies & strategy_bit) != 0;
+		if (!both) return 1.0;
+
+		double sum = 0.0;
+		for (const SamplingTask* task : {&light_task, &mat_task})
+			if (task->sampled) sum += pdf_value(*task, cur.dir);
+		return (sum > 0) ? cur.pdf_val / sum : 0.0;
+	};
+
+	// 2. 计算每个样本对各策略的加权贡献系数 brdf * cos / pdf，光源样本在光源列表中找到采样点
+	for (const SamplingTask* task : {&light_task, &mat_task}) {
+		if (task->strategies == 0 || !task->sampled) continue;
+
+		Ray r_next(hit_rec.p, task->dir);
+		const auto brdf = m_brdf(r_in, hit_rec, r_next);
+		const auto factor = [&](const int k) {
+			return brdf * task->cos_theta * rr_factor *
+				   static_cast<float>(cal_mis_weight(*task, 1U << k) / task->pdf_val);
+		};
+
+		if (task->shadow_ray) {
+			HitRecord light_rec;
+			if (!lights->hit(r_next, RAY_T_MIN, DOUBLE_INF, light_rec)) continue;
+			vertex.shadow = true;
+			vertex.shadow_ray = r_next;
+			vertex.shadow_t_max = light_rec.t * (1.0 - SHADOW_RAY_EPSILON);
+			vertex.shadow_strategies = task->strategies;
+			const glm::vec3 light_emitted = m_emitted(r_next, light_rec);
+			for (std::uint32_t m = task->strategies; m != 0; m &= m - 1) {
+				const int k = std::countr_zero(m);
+				vertex.shadow_radiance[k] = factor(k) * light_emitted;
+			}
+		} else {
+			vertex.extend = true;
+			vertex.next = r_next;
+			vertex.extend_strategies = task->strategies;
+			for (std::uint32_t m = task->strategies; m != 0; m &= m - 1) {
+				const int k = std::countr_zero(m);
+				vertex.weight[k] = factor(k);
+			}
+		}
 	}
+}
 
-	// 针对镜面反射（Delta分布）的处理：
-	// 镜面反射的 PDF 值为无穷大 (Dirac Delta)。
-	// 在数值上，这意味着材质采样的权重应为 1，而光源采样的权重应为 0。
-	if (srec.is_specular) {
-		n_light_samples = 0;
-		// 如果原本是 MIS，保持材质采样
-		if (m_strategy == SamplingStrategy::MIS) {
-			n_mat_samples = 1;
+void SoftTracer::set_sampling_strategies(const std::span<const SamplingStrategy> strategies) {
+	if (strategies.empty() || strategies.size() > MAX_STRATEGIES)
+		throw std::invalid_argument("between 1 and " + std::to_string(MAX_STRATEGIES) + " sampling strategies expected");
+	m_strategies.assign(strategies.begin(), strategies.end());
+}
+
+void SoftTracer::render(const Hittable& scene, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+						const std::string& filename) {
+	const size_t dot = filename.find_last_of('.');
+	const size_t slash = filename.find_last_of("/\\");
+	const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+	const std::string stem = has_extension ? filename.substr(0, dot) : filename;
+	const std::string extension = has_extension ? filename.substr(dot) : std::string(".png");
+
+	const std::vector<std::vector<glm::vec3>> framebuffers =
+		render_framebuffers(scene, lights, cam, [&](const int samples, const auto& snapshot) {
+			m_write_images(snapshot, stem + "_" + std::to_string(samples), extension);
+		});
+	m_write_images(framebuffers, stem, extension);
+
+	if (m_adaptive_error > 0) write_sample_heatmap(stem + "_spp" + extension);
+}
+
+void SoftTracer::m_write_images(const std::vector<std::vector<glm::vec3>>& framebuffers, const std::string& stem,
+								const std::string& extension) const {
+	for (size_t k = 0; k < framebuffers.size(); ++k) {
+		std::string strategy_stem = stem;
+		if (framebuffers.size() > 1) {
+			switch (m_strategies[k]) {
+				case SamplingStrategy::MIS:
+					strategy_stem += "_mis";
+					break;
+				case SamplingStrategy::LIGHT:
+					strategy_stem += "_light";
+					break;
+				case SamplingStrategy::MATERIAL:
+				default:
+					strategy_stem += "_material";
+					break;
+			}
+		}
+
+		const std::string image_filename = strategy_stem + extension;
+		const std::vector<unsigned char> image_data = tone_map(framebuffers[k], m_tone_mapping);
+		stbi_write_png(image_filename.c_str(), _image_width, _image_height, 3, image_data.data(), _image_width * 3);
+
+		if (m_hdr_format != HDRFormat::NONE) {
+			const HDRImage hdr{_image_width, _image_height, framebuffers[k]};
+			const std::string hdr_filename = strategy_stem + (m_hdr_format == HDRFormat::PFM ? ".pfm" : ".exr");
+			if (!hdr.write(hdr_filename, m_hdr_format)) fmt::print("Failed to write {}\n", hdr_filename);
 		}
 	}
+}
 
-	// 采样任务结构体
-	struct SamplingTask {
-		std::shared_ptr<PDF> pdf; ///< 采样 pdf
-		int num_samples;		  ///< 采样数量
-		int next_depth;			  ///< 递归深度，对于光源采样为 1, 对于材质采样为 depth - 1
-	};
-	std::vector<SamplingTask> tasks;
+void SoftTracer::write_sample_heatmap(const std::string& filename) const {
+	// 近似 inferno 色图的控制点，相邻控制点之间线性插值
+	static const std::array<glm::vec3, 5> RAMP = {
+		glm::vec3(0.00F, 0.00F, 0.02F), glm::vec3(0.34F, 0.06F, 0.43F), glm::vec3(0.74F, 0.22F, 0.33F),
+		glm::vec3(0.98F, 0.56F, 0.04F), glm::vec3(0.99F, 1.00F, 0.64F)};
+
+	const int max_count = m_sample_counts.empty() ? 0 : *std::max_element(m_sample_counts.begin(), m_sample_counts.end());
+	std::vector<unsigned char> image_data(m_sample_counts.size() * 3);
+	for (size_t k = 0; k < m_sample_counts.size(); ++k) {
+		const float t = max_count > 0 ? static_cast<float>(m_sample_counts[k]) / static_cast<float>(max_count) : 0.0F;
+		const float x = t * static_cast<float>(RAMP.size() - 1);
+		const auto segment = std::min(static_cast<size_t>(x), RAMP.size() - 2);
+		const glm::vec3 color =
+			RAMP[segment] + (RAMP[segment + 1] - RAMP[segment]) * (x - static_cast<float>(segment));
+		for (int c = 0; c < 3; ++c)
+			image_data[k * 3 + c] = static_cast<unsigned char>(255.0F * std::clamp(color[c], 0.0F, 1.0F) + 0.5F);
+	}
+	stbi_write_png(filename.c_str(), _image_width, _image_height, 3, image_data.data(), _image_width * 3);
+}
+
+std::vector<glm::vec3> SoftTracer::render_framebuffer(const Hittable& scene, const std::shared_ptr<Hittable>& lights,
+													  const Camera& cam) {
+	return std::move(render_framebuffers(scene, lights, cam).front());
+}
 
-	if (n_light_samples > 0 && light_pdf_ptr) {
-		tasks.push_back({light_pdf_ptr, n_light_samples, 1});
+std::vector<std::vector<glm::vec3>> SoftTracer::render_framebuffers(const Hittable& scene,
+																	const std::shared_ptr<Hittable>& lights,
+																	const Camera& cam, const SnapshotCallback& on_snapshot) {
+	const size_t pixel_count = static_cast<size_t>(_image_width) * _image_height;
+	m_radiance.assign(pixel_count * m_strategies.size(), glm::vec3(0, 0, 0));
+	m_luminance_sq.assign(pixel_count, 0.0);
+	m_sample_counts.assign(pixel_count, 0);
+	if (!m_checkpoint_path.empty()) m_restore_checkpoint();
+
+	if (m_adaptive_error > 0 || m_time_budget > 0 || !m_checkpoint_path.empty() || !m_snapshots.empty()) {
+		m_render_progressive(scene, lights, cam, on_snapshot);
+	} else {
+		std::vector<std::uint32_t> pixels(pixel_count);
+		std::iota(pixels.begin(), pixels.end(), 0U);
+		m_render_pass(scene, lights, cam, {pixels, 0, m_samples_per_pixel, nullptr, true}, m_radiance);
+		m_sample_counts.assign(pixel_count, m_samples_per_pixel);
 	}
-	if (n_mat_samples > 0) {
-		tasks.push_back({scatter_pdf_ptr, n_mat_samples, depth - 1});
+	fmt::print("\nDone.\n");
+	return m_resolve();
+}
+
+std::vector<std::vector<glm::vec3>> SoftTracer::m_resolve() const {
+	const size_t pixel_count = m_sample_counts.size();
+	std::vector<std::vector<glm::vec3>> framebuffers(m_strategies.size(), std::vector<glm::vec3>(pixel_count));
+	for (size_t layer = 0; layer < framebuffers.size(); ++layer)
+		for (size_t k = 0; k < pixel_count; ++k)
+			framebuffers[layer][k] =
+				m_radiance[layer * pixel_count + k] / static_cast<float>(std::max(m_sample_counts[k], 1));
+	return framebuffers;
+}
+
+Ray SoftTracer::m_primary_ray(const Camera& cam, const std::uint32_t pixel, Sampler& sampler) const {
+	// 帧缓冲左上角为原点，而相机的 v 从下往上，所以需要翻转 y 轴
+	const auto i = static_cast<int>(pixel % _image_width);
+	const int j = _image_height - 1 - static_cast<int>(pixel / _image_width);
+	const glm::vec2 jitter = sampler.get_2d();
+	auto u = (i + jitter.x) / (_image_width - 1);
+	auto v = (j + jitter.y) / (_image_height - 1);
+	return cam.get_ray(u, v);
+}
+
+void SoftTracer::m_render_pass(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+							   const PixelPass& pass, std::vector<glm::vec3>& framebuffer) {
+	if (m_integrator == IntegratorMode::WAVEFRONT && m_strategies.size() == 1)
+		m_render_wavefront(world, lights, cam, pass, framebuffer);
+	else if (m_schedule == RenderSchedule::TILES)
+		m_render_tiles(world, lights, cam, pass, framebuffer);
+	else
+		m_render_scanlines(world, lights, cam, pass, framebuffer);
+}
+
+void SoftTracer::m_render_group(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+								const PixelPass& pass, const std::span<const std::uint32_t> group,
+								const std::array<Sampler*, RayPacket::SIZE>& samplers,
+								std::vector<glm::vec3>& framebuffer) {
+	const auto lanes = static_cast<int>(group.size());
+	const size_t strategy_count = m_strategies.size();
+	std::array<StrategyColors, RayPacket::SIZE> pixel_colors{};
+	std::array<StrategyColors, RayPacket::SIZE> sample_colors{};
+	std::array<double, RayPacket::SIZE> luminance_sq{};
+	RayPacket packet;
+	for (int s = pass.first_sample; s < pass.first_sample + pass.sample_count; ++s) {
+		for (int lane = 0; lane < lanes; ++lane) {
+			samplers[lane]->start_pixel_sample(group[lane], s, 0);
+			packet.set(lane, m_primary_ray(cam, group[lane], *samplers[lane]));
+		}
+		sample_colors.fill({});
+		m_trace_packet(packet, world, lights, samplers, sample_colors);
+		for (int lane = 0; lane < lanes; ++lane) {
+			for (size_t k = 0; k < strategy_count; ++k)
+				pixel_colors[lane][k] += sample_colors[lane][k];
+			// 自适应采样按第一种策略的方差决定采样数
+			const double y = luminance(sample_colors[lane][0]);
+			luminance_sq[lane] += y * y;
+		}
 	}
 
-	// 采样结果结构体
-	struct SampleResult {
-		glm::vec3 dir;
-		double pdf;
-		glm::vec3 radiance;
-	};
-	std::vector<std::vector<SampleResult>> sample_results(tasks.size());
+	// 每种策略一层帧缓冲
+	const size_t layer_size = static_cast<size_t>(_image_width) * _image_height;
+	for (int lane = 0; lane < lanes; ++lane) {
+		for (size_t k = 0; k < strategy_count; ++k)
+			framebuffer[k * layer_size + group[lane]] += pixel_colors[lane][k];
+		if (pass.luminance_sq) (*pass.luminance_sq)[group[lane]] += luminance_sq[lane];
+	}
+}
 
-	// 1. 生成所有样本并计算 Radiance
-	for (size_t t_idx = 0; t_idx < tasks.size(); ++t_idx) {
-		const auto& task = tasks[t_idx];
-		for (int i = 0; i < task.num_samples; ++i) {
-			auto dir = task.pdf->generate();
-			auto pdf_val = task.pdf->value(dir);
+void SoftTracer::m_render_scanlines(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+									const PixelPass& pass, std::vector<glm::vec3>& framebuffer) {
+	// 同一行上相邻的至多 RayPacket::SIZE 个像素为一组，每个采样的主光线组成一个光线包；
+	// groups 记录每组在 pass.pixels 中的起始位置，末尾附加像素总数
+	std::vector<std::uint32_t> groups;
+	for (size_t k = 0; k < pass.pixels.size(); ++k) {
+		const std::uint32_t first = groups.empty() ? 0 : pass.pixels[groups.back()];
+		if (groups.empty() || k - groups.back() == RayPacket::SIZE ||
+			pass.pixels[k] / _image_width != first / _image_width)
+			groups.push_back(static_cast<std::uint32_t>(k));
+	}
+	groups.push_back(static_cast<std::uint32_t>(pass.pixels.size()));
+	const auto group_count = static_cast<int>(groups.size()) - 1;
 
-			if (pdf_val <= 0) continue;
+	// 每个线程每个通道一个采样器，随机数序列只取决于像素与采样序号，与线程无关
+	std::vector<std::array<std::unique_ptr<Sampler>, RayPacket::SIZE>> thread_samplers(omp_get_max_threads());
+	for (auto& lane_samplers : thread_samplers)
+		for (auto& sampler : lane_samplers)
+			sampler = make_sampler(m_sampler_type, m_seed);
 
-			Ray r_next(hit_rec.p, dir);
-			auto cos_theta = glm::dot(hit_rec.normal, glm::normalize(dir));
-			if (cos_theta <= 0) continue;
+	std::atomic<int> groups_finished = 0;
 
-			auto Li = m_ray_color(r_next, world, lights, task.next_depth);
-			auto brdf = mat_ptr->brdf(r_in, hit_rec, r_next);
+#pragma omp parallel for schedule(dynamic, 1)
+	for (int g = 0; g < group_count; ++g) {
+		const int finished = ++groups_finished;
+		if (pass.report_progress && finished % 256 == 0) {
+			fmt::print("\rPixels remaining: {}   ", pass.pixels.size() - groups[finished]);
+			std::fflush(stdout);
+		}
+		std::array<Sampler*, RayPacket::SIZE> samplers{};
+		for (int lane = 0; lane < RayPacket::SIZE; ++lane)
+			samplers[lane] = thread_samplers[omp_get_thread_num()][lane].get();
+		m_render_group(world, lights, cam, pass, pass.pixels.subspan(groups[g], groups[g + 1] - groups[g]), samplers,
+					   framebuffer);
+	}
+}
+
+void SoftTracer::m_render_tiles(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+								const PixelPass& pass, std::vector<glm::vec3>& framebuffer) {
+	const int thread_count = omp_get_max_threads();
+	TileScheduler scheduler(_image_width, _image_height, m_tile_size);
+	scheduler.assign(pass.pixels, thread_count);
+	const auto start = std::chrono::steady_clock::now();
+
+#pragma omp parallel num_threads(thread_count)
+	{
+		const int thread = omp_get_thread_num();
+		std::array<std::unique_ptr<Sampler>, RayPacket::SIZE> lane_samplers;
+		std::array<Sampler*, RayPacket::SIZE> samplers{};
+		for (int lane = 0; lane < RayPacket::SIZE; ++lane) {
+			lane_samplers[lane] = make_sampler(m_sampler_type, m_seed);
+			samplers[lane] = lane_samplers[lane].get();
+		}
 
-			if (cos_theta > 0) {
-				// 暂存未加权的贡献: brdf * Li * cos / pdf
-				auto unweighted_contrib = brdf * Li * (float)cos_theta * rr_factor / (float)pdf_val;
-				sample_results[t_idx].push_back({dir, pdf_val, unweighted_contrib});
+		double next_report = PROGRESS_INTERVAL;
+		std::span<const std::uint32_t> tile;
+		while (scheduler.next(thread, tile)) {
+			for (size_t k = 0; k < tile.size(); k += RayPacket::SIZE)
+				m_render_group(world, lights, cam, pass,
+							   tile.subspan(k, std::min<size_t>(RayPacket::SIZE, tile.size() - k)), samplers,
+							   framebuffer);
+			scheduler.finish(thread, tile.size());
+
+			if (pass.report_progress && thread == 0) {
+				const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				if (elapsed >= next_report) {
+					fmt::print("\rPixels remaining: {}   ", scheduler.pixel_count() - scheduler.finished());
+					std::fflush(stdout);
+					next_report = elapsed + PROGRESS_INTERVAL;
+				}
 			}
 		}
 	}
+}
 
-	// MIS 启发式函数 (例如 Power Heuristic)
-	auto mis_heuristic = [](const double val) { return val; };
-
-	// 计算 MIS 权重的辅助函数
-	auto cal_mis_weight = [&](const double cur_pdf, const int cur_n_samples, const glm::vec3& dir) {
-		if (tasks.size() <= 1) return 1.0;
+void SoftTracer::m_render_progressive(const Hittable& world, const std::shared_ptr<Hittable>& lights,
+									  const Camera& cam, const SnapshotCallback& on_snapshot) {
+	const size_t pixel_count = m_sample_counts.size();
+	const bool adaptive = m_adaptive_error > 0;
+	const int max_samples = m_max_samples_per_pixel();
+	// 采样数达到该值之前不判断收敛；快照可能把第一轮截断，之后的轮次先补足到该值
+	const int min_samples = adaptive ? std::min(m_adaptive_min_samples, m_samples_per_pixel) : 0;
+	const auto start = std::chrono::steady_clock::now();
+	auto last_checkpoint = start;
+	const auto seconds_since = [](const std::chrono::steady_clock::time_point t) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+	};
 
-		double sum = 0.0;
-		for (size_t t_idx = 0; t_idx < tasks.size(); ++t_idx) {
-			if (sample_results[t_idx].size() <= 0) continue;
-			double p = tasks[t_idx].pdf->value(dir);
-			sum += mis_heuristic(sample_results[t_idx].size() * p);
+	std::int64_t budget = static_cast<std::int64_t>(m_samples_per_pixel) * static_cast<std::int64_t>(pixel_count);
+	for (const int count : m_sample_counts)
+		budget -= count;
+
+	// 亮度均值的置信区间半宽相对均值的大小；不足两个采样时无法估计方差，误差视为无穷大
+	std::vector<float> error(pixel_count, std::numeric_limits<float>::infinity());
+	const auto update_error = [&](const std::uint32_t pixel) {
+		const auto n = static_cast<double>(m_sample_counts[pixel]);
+		if (n < 2.0) {
+			error[pixel] = std::numeric_limits<float>::infinity();
+			return;
 		}
-		return (sum > 0) ? mis_heuristic(cur_n_samples * cur_pdf) / sum : 0.0;
+		const double mean = luminance(m_radiance[pixel]) / n;
+		const double variance = std::max(m_luminance_sq[pixel] - n * mean * mean, 0.0) / (n - 1.0);
+		const double half_width = ADAPTIVE_CONFIDENCE_Z * std::sqrt(variance / n);
+		error[pixel] = static_cast<float>(half_width / std::max(mean, double{ADAPTIVE_MIN_LUMINANCE}));
+	};
+	// 只凭少量采样估计的方差可能偏低（例如全部错过了一个小光源），因此邻域内的像素都收敛才停止
+	const auto converged = [&](const std::uint32_t pixel) {
+		const auto i = static_cast<int>(pixel % _image_width);
+		const auto j = static_cast<int>(pixel / _image_width);
+		const int r = ADAPTIVE_WINDOW_RADIUS;
+		for (int y = std::max(j - r, 0); y <= std::min(j + r, _image_height - 1); ++y)
+			for (int x = std::max(i - r, 0); x <= std::min(i + r, _image_width - 1); ++x)
+				if (error[static_cast<size_t>(y) * _image_width + x] > m_adaptive_error) return false;
+		return true;
 	};
 
-	// 2. 计算 MIS 权重并合并结果
-	glm::vec3 L_scatter(0.0F);
+	// 活跃像素的采样数总是相同，每轮都从同一个采样序号继续，低差异序列的前缀保持完整；
+	// 从检查点恢复时，采样数最多的像素就是中断前仍在采样的像素
+	int samples = *std::max_element(m_sample_counts.begin(), m_sample_counts.end());
+	std::vector<std::uint32_t> active;
+	std::vector<std::uint32_t> next_active;
+	active.reserve(pixel_count);
+	next_active.reserve(pixel_count);
+	const bool warmed_up = adaptive && samples > 0 && samples >= min_samples;
+	if (warmed_up) {
+		for (std::uint32_t pixel = 0; pixel < pixel_count; ++pixel)
+			if (m_sample_counts[pixel] > 0) update_error(pixel);
+	}
+	for (std::uint32_t pixel = 0; pixel < pixel_count; ++pixel)
+		if (m_sample_counts[pixel] == samples && !(warmed_up && converged(pixel))) active.push_back(pixel);
+
+	// 恢复前已经达到的快照不再输出
+	auto snapshot = std::ranges::upper_bound(m_snapshots, samples);
+
+	// 上一次渲染收到的终止信号已经处理过，重新安装处理函数时清除
+	const bool handle_sigterm = !m_checkpoint_path.empty();
+	if (handle_sigterm) termination_requested = 0;
+	const auto previous_handler = handle_sigterm ? std::signal(SIGTERM, request_termination) : SIG_DFL;
+
+	int batch = adaptive && samples < min_samples ? min_samples - samples : PROGRESSIVE_BATCH;
+	while (!active.empty()) {
+		batch = std::min(batch, max_samples - samples);
+		// 轮次在下一个快照处截断，快照时活跃像素恰好采样到该数
+		if (snapshot != m_snapshots.end()) batch = std::min(batch, *snapshot - samples);
+		if (batch <= 0 || (adaptive && budget < batch)) break;
+		// 剩余预算不够所有活跃像素再追踪一轮时，只给误差最大的像素
+		const auto affordable = static_cast<size_t>(budget / batch);
+		if (adaptive && affordable < active.size()) {
+			std::nth_element(active.begin(), active.begin() + static_cast<std::ptrdiff_t>(affordable), active.end(),
+							 [&](const std::uint32_t a, const std::uint32_t b) { return error[a] > error[b]; });
+			active.resize(affordable);
+			std::sort(active.begin(), active.end());
+		}
 
-	for (size_t t_idx = 0; t_idx < tasks.size(); ++t_idx) {
-		if (sample_results[t_idx].size() <= 0) continue;
+		fmt::print("\rProgressive: {} pixels at {} spp   ", active.size(), samples);
+		std::fflush(stdout);
+		m_render_pass(world, lights, cam, {active, samples, batch, &m_luminance_sq, false}, m_radiance);
+		budget -= static_cast<std::int64_t>(batch) * static_cast<std::int64_t>(active.size());
+		samples += batch;
+		if (adaptive)
+			batch = samples < min_samples ? min_samples - samples : ADAPTIVE_BATCH;
+		else
+			batch = PROGRESSIVE_BATCH;
+		for (const std::uint32_t pixel : active)
+			m_sample_counts[pixel] = samples;
+
+		if (adaptive && samples >= min_samples) {
+			for (const std::uint32_t pixel : active)
+				update_error(pixel);
+			next_active.clear();
+			for (const std::uint32_t pixel : active)
+				if (!converged(pixel)) next_active.push_back(pixel);
+			std::swap(active, next_active);
+		}
 
-		glm::vec3 L_task(0.0F);
-		for (const auto& res : sample_results[t_idx]) {
-			double w = cal_mis_weight(res.pdf, sample_results[t_idx].size(), res.dir);
-			L_task += (float)w * res.radiance;
+		if (snapshot != m_snapshots.end() && samples == *snapshot) {
+			fmt::print("\nSnapshot at {} spp\n", samples);
+			if (on_snapshot) on_snapshot(samples, m_resolve());
+			++snapshot;
+		}
+
+		// 每轮结束时检查终止信号与时间预算；检查点只在两轮之间写入，此时累积的数据完整
+		if (termination_requested != 0 || (m_time_budget > 0 && seconds_since(start) >= m_time_budget)) {
+			fmt::print("\nStopped at {} spp after {:.1f} s", samples, seconds_since(start));
+			break;
+		}
+		if (!m_checkpoint_path.empty() && seconds_since(last_checkpoint) >= m_checkpoint_interval) {
+			m_save_checkpoint();
+			last_checkpoint = std::chrono::steady_clock::now();
 		}
-		L_scatter += L_task / (float)sample_results[t_idx].size();
 	}
 
-	return mat_ptr->emitted(r_in, hit_rec) + L_scatter;
+	if (!m_checkpoint_path.empty()) m_save_checkpoint();
+	if (handle_sigterm) std::signal(SIGTERM, previous_handler);
 }
 
-void SoftTracer::_write_color(std::vector<unsigned char>& image_data, const int index, const glm::vec3 pixel_color) {
-	auto r = pixel_color.x;
-	auto g = pixel_color.y;
-	auto b = pixel_color.z;
-
-	// gamma 校正，gamma=2.0
-	r = sqrt(r);
-	g = sqrt(g);
-	b = sqrt(b);
-
-	image_data[index] = static_cast<unsigned char>(256 * std::clamp(r, 0.0F, 0.999F));
-	image_data[index + 1] = static_cast<unsigned char>(256 * std::clamp(g, 0.0F, 0.999F));
-	image_data[index + 2] = static_cast<unsigned char>(256 * std::clamp(b, 0.0F, 0.999F));
+void SoftTracer::m_restore_checkpoint() {
+	std::optional<RenderCheckpoint> checkpoint = RenderCheckpoint::load(m_checkpoint_path);
+	if (!checkpoint) return;
+	if (checkpoint->width != _image_width || checkpoint->height != _image_height ||
+		checkpoint->layers != static_cast<int>(m_strategies.size()) || checkpoint->sampler != m_sampler_type ||
+		checkpoint->seed != m_seed)
+		throw std::runtime_error("checkpoint " + m_checkpoint_path.string() + " was rendered with different settings");
+
+	m_radiance = std::move(checkpoint->radiance);
+	m_luminance_sq = std::move(checkpoint->luminance_sq);
+	m_sample_counts = std::move(checkpoint->sample_counts);
+	fmt::println("Resuming from {} at {} spp", m_checkpoint_path.string(),
+				 *std::max_element(m_sample_counts.begin(), m_sample_counts.end()));
 }
 
-void SoftTracer::render(const Scene& scene, const std::shared_ptr<Hittable>& lights, const Camera& cam,
-						const std::string& filename) {
-	std::vector<unsigned char> image_data(static_cast<size_t>(_image_width * _image_height * 3));
+void SoftTracer::m_save_checkpoint() const {
+	const RenderCheckpoint checkpoint{_image_width,	 _image_height, static_cast<int>(m_strategies.size()),
+									  m_sampler_type, m_seed,		  m_radiance,
+									  m_luminance_sq, m_sample_counts};
+	if (!checkpoint.save(m_checkpoint_path))
+		fmt::print("\nFailed to write checkpoint {}\n", m_checkpoint_path.string());
+}
 
-	std::atomic<int> scanlines_finished = 0;
+void SoftTracer::m_render_wavefront(const Hittable& world, const std::shared_ptr<Hittable>& lights, const Camera& cam,
+									const PixelPass& pass, std::vector<glm::vec3>& framebuffer) {
+	// 一条正在推进的路径
+	struct PathState {
+		Ray ray{glm::vec3(0.0F), glm::vec3(0.0F)}; ///< 待求交的光线
+		glm::vec3 throughput{0.0F};				   ///< 路径吞吐量
+		glm::vec3 radiance{0.0F};				   ///< 已累积的辐射度
+		std::uint32_t pixel = 0;				   ///< 帧缓冲索引
+		int depth = 0;							   ///< 剩余深度，终止的路径为 0
+	};
 
-#pragma omp parallel for schedule(dynamic, 1)
-	for (int j = _image_height - 1; j >= 0; --j) {
-		int finished = ++scanlines_finished;
-		if (finished % 10 == 0) {
-			fmt::print("\rScanlines remaining: {}   ", _image_height - finished);
+	const auto pixel_count = static_cast<std::int64_t>(pass.pixels.size());
+	const std::int64_t capacity = std::min<std::int64_t>(pixel_count, WAVEFRONT_BATCH_SIZE);
+	std::vector<PathState> paths;
+	std::vector<PathState> next_paths;
+	paths.reserve(capacity);
+	next_paths.reserve(capacity);
+	std::vector<HitRecord> hits(capacity);
+	std::vector<unsigned char> hit_found(capacity);
+	std::vector<PathVertex> vertices(capacity);
+	std::vector<std::uint64_t> sort_keys(capacity);
+	std::vector<std::uint32_t> order(capacity); ///< 按排序键排列的路径索引
+	std::vector<std::uint32_t> shadow_queue(capacity);
+	// 排序与压缩的临时缓冲区，预留整批的容量，之后各轮都不再分配
+	RadixSortBuffers sort_buffers;
+	sort_buffers.keys.reserve(capacity);
+	sort_buffers.values.reserve(capacity);
+	std::vector<std::int64_t> compact_offsets;
+	// 每个线程一个采样器，着色前定位到当前路径的像素与采样
+	std::vector<std::unique_ptr<Sampler>> samplers(omp_get_max_threads());
+	for (auto& sampler : samplers)
+		sampler = make_sampler(m_sampler_type, m_seed);
+
+	const int end_sample = pass.first_sample + pass.sample_count;
+	for (int s = pass.first_sample; s < end_sample; ++s) {
+		if (pass.report_progress) {
+			fmt::print("\rSamples remaining: {}   ", end_sample - s);
 			std::fflush(stdout);
 		}
-		for (int i = 0; i < _image_width; ++i) {
-			glm::vec3 pixel_color(0, 0, 0);
-			for (int s = 0; s < m_samples_per_pixel; ++s) {
-				auto u = (i + random_double()) / (_image_width - 1);
-				auto v = (j + random_double()) / (_image_height - 1);
-				Ray r = cam.get_ray(u, v);
-				pixel_color += m_ray_color(r, scene, lights, m_max_depth);
-			}
 
-			pixel_color = pixel_color / static_cast<float>(m_samples_per_pixel);
+		for (std::int64_t first = 0; first < pixel_count; first += capacity) {
+			const std::int64_t count = std::min(capacity, pixel_count - first);
+
+			// 生成：批内每个像素一条主光线。像素互不相同，之后各阶段按路径写入互不冲突
+			paths.resize(count);
+#pragma omp parallel for schedule(static)
+			for (std::int64_t k = 0; k < count; ++k) {
+				const std::uint32_t pixel = pass.pixels[first + k];
+				Sampler& sampler = *samplers[omp_get_thread_num()];
+				sampler.start_pixel_sample(pixel, s, 0);
+				paths[k] = {m_primary_ray(cam, pixel, sampler), glm::vec3(1, 1, 1), glm::vec3(0, 0, 0), pixel,
+							m_max_depth};
+			}
 
-			// 计算 stb_image 的索引（左上角为原点，但我们是从下往上循环，所以需要翻转 y 轴）
-			int row = _image_height - 1 - j;
-			int index = (row * _image_width + i) * 3;
-			_write_color(image_data, index, pixel_color);
+			while (!paths.empty()) {
+				const auto n = static_cast<std::int64_t>(paths.size());
+
+				// 求交：最近击中
+#pragma omp parallel for schedule(dynamic, 64)
+				for (std::int64_t k = 0; k < n; ++k)
+					hit_found[k] = world.hit(paths[k].ray, RAY_T_MIN, DOUBLE_INF, hits[k]) ? 1 : 0;
+
+				// 按材质、再按光线方向所在卦限排序，着色阶段连续处理同一材质的路径；未击中的路径排在最前。
+				// 排序是并行的基数排序，只处理键中实际用到的位，所有键数位相同的趟直接跳过
+				sort_keys.resize(n);
+				order.resize(n);
+				std::uint64_t key_mask = 0;
+#pragma omp parallel for schedule(static) reduction(| : key_mask)
+				for (std::int64_t k = 0; k < n; ++k) {
+					const glm::vec3 dir = paths[k].ray.direction();
+					const auto octant = static_cast<std::uint64_t>((dir.x < 0 ? 1 : 0) | (dir.y < 0 ? 2 : 0) |
+																   (dir.z < 0 ? 4 : 0));
+					// 绑定了材质表时编号的高位是种类，同种材质连续着色；否则按材质地址分组
+					std::uint64_t material = 0;
+					if (hit_found[k] != 0) {
+						material = m_materials && hits[k].material_id != HitRecord::NO_MATERIAL_ID
+									   ? std::uint64_t{hits[k].material_id} + 1
+									   : reinterpret_cast<std::uintptr_t>(hits[k].mat_ptr);
+					}
+					sort_keys[k] = (material << 3) | octant;
+					order[k] = static_cast<std::uint32_t>(k);
+					key_mask |= sort_keys[k];
+				}
+				radix_sort(sort_keys, order, std::bit_width(key_mask), sort_buffers);
+
+				// 着色：未击中的路径累加背景并终止，击中的路径采样光源与材质
+#pragma omp parallel for schedule(static)
+				for (std::int64_t k = 0; k < n; ++k) {
+					const std::uint32_t idx = order[k];
+					PathState& path = paths[idx];
+					PathVertex& vertex = vertices[idx];
+					if (hit_found[idx] == 0) {
+						path.radiance += path.throughput * m_miss_color(path.ray);
+						vertex = PathVertex();
+						path.depth = 0;
+						continue;
+					}
+
+					// 弹射的维度由剩余深度决定，定位到该路径的采样即可继续
+					Sampler& sampler = *samplers[omp_get_thread_num()];
+					sampler.start_pixel_sample(path.pixel, s, 0);
+					m_sample_vertex(path.ray, hits[idx], lights, path.depth, sampler, vertex);
+					path.radiance += path.throughput * vertex.emitted;
+					vertex.shadow_radiance[0] *= path.throughput;
+					if (vertex.extend) {
+						path.throughput *= vertex.weight[0];
+						path.ray = vertex.next;
+						--path.depth;
+					} else {
+						path.depth = 0;
+					}
+					// 吞吐量为零的路径不会再有贡献，提前终止
+					if (path.throughput.x <= 0 && path.throughput.y <= 0 && path.throughput.z <= 0) path.depth = 0;
+				}
+
+				// 阴影：用并行前缀和收集需要遮挡测试的路径，成批做任意击中查询
+				const std::int64_t n_shadow = parallel_compact(
+					n, compact_offsets, [&](const std::int64_t k) { return vertices[order[k]].shadow; },
+					[&](const std::int64_t dst, const std::int64_t k) { shadow_queue[dst] = order[k]; });
+#pragma omp parallel for schedule(dynamic, 64)
+				for (std::int64_t k = 0; k < n_shadow; ++k) {
+					const PathVertex& vertex = vertices[shadow_queue[k]];
+					if (!world.occluded(vertex.shadow_ray, RAY_T_MIN, vertex.shadow_t_max))
+						paths[shadow_queue[k]].radiance += vertex.shadow_radiance[0];
+				}
+
+				// 累加：终止的路径写入帧缓冲，批内像素互不相同，可以并行写入
+#pragma omp parallel for schedule(static)
+				for (std::int64_t k = 0; k < n; ++k) {
+					const PathState& path = paths[k];
+					if (path.depth > 0) continue;
+					framebuffer[path.pixel] += path.radiance;
+					if (pass.luminance_sq) {
+						const double y = luminance(path.radiance);
+						(*pass.luminance_sq)[path.pixel] += y * y;
+					}
+				}
+
+				// 压缩：存活的路径用并行前缀和按着色顺序组成下一轮的队列
+				next_paths.resize(n);
+				const std::int64_t n_alive = parallel_compact(
+					n, compact_offsets, [&](const std::int64_t k) { return paths[order[k]].depth > 0; },
+					[&](const std::int64_t dst, const std::int64_t k) { next_paths[dst] = paths[order[k]]; });
+				next_paths.resize(n_alive);
+				std::swap(paths, next_paths);
+			}
 		}
 	}
-	fmt::print("\nDone.\n");
-
-	stbi_write_png(filename.c_str(), _image_width, _image_height, 3, image_data.data(), _image_width * 3);
 }
 
 } // namespace rt
@@ -0,0 +1,266 @@
+#include "rt/accel/BVHTree.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <numeric>
+
+namespace rt {
+
+namespace {
+
+/**
+ * @brief 递归 SAH 构建过程的共享状态。
+ */
+struct SahBuilder {
+	std::span<const AABB> bounds;		 ///< 图元包围盒。
+	std::span<const glm::vec3> centroids; ///< 图元质心。
+	std::vector<std::uint32_t>& indices; ///< 正在重排的图元下标。
+	std::vector<BVHNode>& nodes;		 ///< 输出节点。
+	std::vector<float> right_areas;	 ///< 扫描时使用的后缀包围盒面积缓存。
+
+	std::uint32_t make_leaf(const AABB& node_bounds, const std::uint32_t begin, const std::uint32_t count) {
+		const auto node_idx = static_cast<std::uint32_t>(nodes.size());
+		nodes.push_back({node_bounds, begin, static_cast<std::uint16_t>(count), 0});
+		return node_idx;
+	}
+
+	std::uint32_t build(const std::uint32_t begin, const std::uint32_t end, const int depth) {
+		AABB node_bounds;
+		AABB centroid_bounds;
+		for (std::uint32_t i = begin; i < end; ++i) {
+			node_bounds.expand(bounds[indices[i]]);
+			centroid_bounds.expand(centroids[indices[i]]);
+		}
+
+		const std::uint32_t count = end - begin;
+		if (count == 1) return make_leaf(node_bounds, begin, count);
+
+		// 在三个轴上扫描所有划分位置，寻找 SAH 代价最小的划分
+		float best_cost = std::numeric_limits<float>::infinity();
+		int best_axis = -1;
+		std::uint32_t best_split = 0;
+		int sorted_axis = -1;
+		const float inv_area = 1.0F / std::max(node_bounds.surface_area(), std::numeric_limits<float>::min());
+
+		for (int axis = 0; axis < 3; ++axis) {
+			if (centroid_bounds.extent()[axis] <= 0.0F) continue;
+			sort_by_axis(begin, end, axis);
+			sorted_axis = axis;
+
+			AABB right;
+			for (std::uint32_t i = end - 1; i > begin; --i) {
+				right.expand(bounds[indices[i]]);
+				right_areas[i] = right.surface_area();
+			}
+			AABB left;
+			for (std::uint32_t i = begin; i < end - 1; ++i) {
+				left.expand(bounds[indices[i]]);
+				const auto n_left = static_cast<float>(i - begin + 1);
+				const auto n_right = static_cast<float>(end - i - 1);
+				const float cost = BVHTree::TRAVERSAL_COST + BVHTree::INTERSECT_COST * inv_area *
+																 (left.surface_area() * n_left + right_areas[i + 1] * n_right);
+				if (cost < best_cost) {
+					best_cost = cost;
+					best_axis = axis;
+					best_split = i + 1;
+				}
+			}
+		}
+
+		const float leaf_cost = BVHTree::INTERSECT_COST * static_cast<float>(count);
+		if (best_axis < 0) {
+			// 所有质心重合：无法按质心划分，尽量作为叶节点，否则按中位数强制划分
+			if (count <= BVHTree::MAX_LEAF_SIZE) return make_leaf(node_bounds, begin, count);
+			best_axis = 0;
+			best_split = begin + count / 2;
+		} else if (count <= BVHTree::MAX_LEAF_SIZE && leaf_cost <= best_cost) {
+			return make_leaf(node_bounds, begin, count);
+		} else if (depth >= BVHTree::MAX_DEPTH - 16) {
+			// 深度过大时退化为中位数划分，保证遍历栈不会溢出
+			best_split = begin + count / 2;
+		}
+
+		if (best_axis != sorted_axis) sort_by_axis(begin, end, best_axis);
+
+		const auto node_idx = static_cast<std::uint32_t>(nodes.size());
+		nodes.push_back({node_bounds, 0, 0, static_cast<std::uint16_t>(best_axis)});
+		build(begin, best_split, depth + 1);
+		const std::uint32_t right_idx = build(best_split, end, depth + 1);
+		nodes[node_idx].offset = right_idx;
+		return node_idx;
+	}
+
+	void sort_by_axis(const std::uint32_t begin, const std::uint32_t end, const int axis) {
+		std::sort(indices.begin() + begin, indices.begin() + end, [&](const std::uint32_t a, const std::uint32_t b) {
+			return centroids[a][axis] < centroids[b][axis];
+		});
+	}
+};
+
+} // namespace
+
+void BVHTree::build(const std::span<const AABB> prim_bounds, const BVHBuildMode mode) {
+	const auto start = std::chrono::steady_clock::now();
+
+	_nodes.clear();
+	_indices.resize(prim_bounds.size());
+	std::iota(_indices.begin(), _indices.end(), 0U);
+
+	if (!prim_bounds.empty()) {
+		const auto n = static_cast<std::int64_t>(prim_bounds.size());
+		std::vector<glm::vec3> centroids(prim_bounds.size());
+#pragma omp parallel for schedule(static)
+		for (std::int64_t i = 0; i < n; ++i)
+			centroids[i] = prim_bounds[i].centroid();
+
+		switch (mode) {
+			case BVHBuildMode::SAH:
+				_build_full_sah(prim_bounds, centroids);
+				break;
+			case BVHBuildMode::LBVH:
+				_build_lbvh(prim_bounds, centroids, false);
+				break;
+			case BVHBuildMode::LBVH_TREELET:
+				_build_lbvh(prim_bounds, centroids, true);
+				break;
+			case BVHBuildMode::BINNED_SAH:
+			default:
+				_build_binned_sah(prim_bounds, centroids);
+				break;
+		}
+	}
+
+	_update_stats(prim_bounds.size(),
+				  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	// 遍历栈按 MAX_DEPTH 分配，更深的树会让栈溢出
+	assert(_stats.max_depth <= MAX_DEPTH);
+}
+
+void BVHTree::assign(const std::span<const BVHNode> nodes, const size_t prim_count) {
+	_nodes.assign(nodes.begin(), nodes.end());
+	_indices.resize(prim_count);
+	std::iota(_indices.begin(), _indices.end(), 0U);
+	_update_stats(prim_count, 0.0);
+}
+
+float BVHTree::refit(const std::span<const AABB> prim_bounds) {
+	if (_nodes.empty()) return 0.0F;
+	if (_level_offsets.empty()) _compute_levels();
+
+	// 子节点的深度总是比父节点大 1，从最深的一层向上处理时子节点已经更新完毕
+	for (size_t level = _level_offsets.size() - 1; level-- > 0;) {
+		const auto begin = static_cast<std::int64_t>(_level_offsets[level]);
+		const auto end = static_cast<std::int64_t>(_level_offsets[level + 1]);
+#pragma omp parallel for schedule(static) if (end - begin > 256)
+		for (std::int64_t i = begin; i < end; ++i) {
+			BVHNode& node = _nodes[_level_nodes[i]];
+			AABB box;
+			if (node.is_leaf()) {
+				for (std::uint32_t j = node.offset; j < node.offset + node.count; ++j)
+					box.expand(prim_bounds[j]);
+			} else {
+				box = _nodes[_level_nodes[i] + 1].bounds;
+				box.expand(_nodes[node.offset].bounds);
+			}
+			node.bounds = box;
+		}
+	}
+	return sah_cost();
+}
+
+void BVHTree::_compute_levels() {
+	std::vector<std::uint32_t> depth(_nodes.size(), 0);
+	std::uint32_t max_depth = 0;
+	for (size_t i = 0; i < _nodes.size(); ++i) {
+		max_depth = std::max(max_depth, depth[i]);
+		if (!_nodes[i].is_leaf()) {
+			depth[i + 1] = depth[i] + 1;
+			depth[_nodes[i].offset] = depth[i] + 1;
+		}
+	}
+
+	// 计数排序：_level_offsets[d] 为第 d 层的起始位置，最后一项为节点总数
+	_level_offsets.assign(max_depth + 2, 0);
+	for (const std::uint32_t d : depth)
+		++_level_offsets[d + 1];
+	for (size_t d = 1; d < _level_offsets.size(); ++d)
+		_level_offsets[d] += _level_offsets[d - 1];
+	_level_nodes.resize(_nodes.size());
+	std::vector<std::uint32_t> cursor(_level_offsets.begin(), _level_offsets.end() - 1);
+	for (size_t i = 0; i < _nodes.size(); ++i)
+		_level_nodes[cursor[depth[i]]++] = static_cast<std::uint32_t>(i);
+}
+
+void BVHTree::_update_stats(const size_t prim_count, const double build_ms) {
+	_level_nodes.clear();
+	_level_offsets.clear();
+	_stats = {};
+	_stats.build_ms = build_ms;
+	_stats.sah_cost = sah_cost();
+	_stats.node_count = _nodes.size();
+	_stats.leaf_count = static_cast<size_t>(
+		std::count_if(_nodes.begin(), _nodes.end(), [](const BVHNode& node) { return node.is_leaf(); }));
+	_stats.prim_count = prim_count;
+
+	// 左子节点紧跟父节点，右子节点下标大于父节点，按下标顺序扫描时父节点的深度总是先确定
+	std::vector<int> depth(_nodes.size(), 0);
+	for (size_t i = 0; i < _nodes.size(); ++i) {
+		_stats.max_depth = std::max(_stats.max_depth, depth[i]);
+		if (!_nodes[i].is_leaf()) {
+			depth[i + 1] = depth[i] + 1;
+			depth[_nodes[i].offset] = depth[i] + 1;
+		}
+	}
+}
+
+void BVHTree::_build_full_sah(const std::span<const AABB> prim_bounds, const std::span<const glm::vec3> centroids) {
+	_nodes.reserve(2 * prim_bounds.size());
+	SahBuilder builder{prim_bounds, centroids, _indices, _nodes, std::vector<float>(prim_bounds.size() + 1)};
+	builder.build(0, static_cast<std::uint32_t>(prim_bounds.size()), 0);
+}
+
+void BVHTree::_flatten(const std::vector<BVHBuildNode>& build_nodes, const std::uint32_t root) {
+	_nodes.clear();
+	_nodes.reserve(build_nodes.size());
+
+	// 显式栈的深度优先遍历：左子树紧跟父节点，右子树的位置在其被写入时回填
+	struct Pending {
+		std::uint32_t build_idx; ///< 临时节点下标。
+		std::uint32_t parent;	 ///< 需要回填右子节点下标的父节点，根节点为 UINT32_MAX。
+	};
+	std::vector<Pending> stack{{root, UINT32_MAX}};
+	while (!stack.empty()) {
+		const Pending item = stack.back();
+		stack.pop_back();
+
+		const auto node_idx = static_cast<std::uint32_t>(_nodes.size());
+		if (item.parent != UINT32_MAX) _nodes[item.parent].offset = node_idx;
+
+		const BVHBuildNode& node = build_nodes[item.build_idx];
+		if (node.count > 0) {
+			_nodes.push_back({node.bounds, node.first, static_cast<std::uint16_t>(node.count), 0});
+		} else {
+			_nodes.push_back({node.bounds, 0, 0, node.axis});
+			stack.push_back({node.children[1], node_idx});
+			stack.push_back({node.children[0], UINT32_MAX});
+		}
+	}
+}
+
+float BVHTree::sah_cost() const {
+	if (_nodes.empty()) return 0.0F;
+
+	const float root_area = std::max(_nodes[0].bounds.surface_area(), std::numeric_limits<float>::min());
+	float cost = 0.0F;
+	const auto n = static_cast<std::int64_t>(_nodes.size());
+#pragma omp parallel for schedule(static) reduction(+ : cost) if (n > 4096)
+	for (std::int64_t i = 0; i < n; ++i) {
+		const BVHNode& node = _nodes[i];
+		const float rel_area = node.bounds.surface_area() / root_area;
+		cost += node.is_leaf() ? rel_area * INTERSECT_COST * static_cast<float>(node.count)
+							   : rel_area * TRAVERSAL_COST;
+	}
+	return cost;
+}
+
+} // namespace rt
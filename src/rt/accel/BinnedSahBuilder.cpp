@@ -0,0 +1,222 @@
+#include "rt/accel/BVHTree.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace rt {
+
+namespace {
+
+constexpr std::uint32_t TASK_THRESHOLD = 4096;			///< 图元数超过该值的子树作为独立任务构建。
+constexpr std::uint32_t PARALLEL_BIN_THRESHOLD = 65536; ///< 图元数超过该值时并行分桶。
+constexpr std::uint32_t BIN_CHUNK_SIZE = 16384;			///< 并行分桶时每个任务处理的图元数。
+constexpr std::uint32_t MIN_BIN_COUNT = 8;				///< 小节点使用的最少桶数。
+
+/**
+ * @brief 单个桶的统计量。
+ */
+struct Bin {
+	AABB bounds;			  ///< 落入该桶的图元包围盒并集。
+	std::uint32_t count = 0; ///< 落入该桶的图元数。
+};
+
+using AxisBins = std::array<std::array<Bin, BVHTree::BIN_COUNT>, 3>;
+
+/**
+ * @brief 质心到桶编号的映射。
+ */
+struct BinMapping {
+	glm::vec3 origin; ///< 质心包围盒的最小角点。
+	glm::vec3 scale;  ///< 每个轴上单位长度对应的桶数，零跨度的轴为 0。
+	int n_bins;		  ///< 实际使用的桶数，小节点使用较少的桶。
+
+	BinMapping(const AABB& centroid_bounds, const std::uint32_t count) :
+		origin(centroid_bounds.min()), scale(0.0F),
+		n_bins(static_cast<int>(std::clamp<std::uint32_t>(count, MIN_BIN_COUNT, BVHTree::BIN_COUNT))) {
+		const glm::vec3 extent = centroid_bounds.extent();
+		for (int a = 0; a < 3; ++a)
+			if (extent[a] > 0.0F) scale[a] = static_cast<float>(n_bins) * (1.0F - 1e-5F) / extent[a];
+	}
+
+	[[nodiscard]] int bin(const glm::vec3& centroid, const int axis) const {
+		const auto b = static_cast<int>((centroid[axis] - origin[axis]) * scale[axis]);
+		return std::clamp(b, 0, n_bins - 1);
+	}
+};
+
+/**
+ * @brief 分桶 SAH 构建过程的共享状态，可被多个 OpenMP 任务同时访问。
+ *
+ * 每个任务只重排自己负责的 indices 区间，节点槽位通过原子计数器分配，
+ * 因此子树之间没有数据竞争。
+ */
+struct BinnedBuilder {
+	std::span<const AABB> bounds;				///< 图元包围盒。
+	std::span<const glm::vec3> centroids;		///< 图元质心。
+	std::vector<std::uint32_t>& indices;		///< 正在重排的图元下标。
+	std::vector<BVHBuildNode>& nodes;			///< 预分配的临时节点（最多 2n - 1 个）。
+	std::atomic<std::uint32_t> node_counter{0}; ///< 下一个可用的节点槽位。
+
+	std::uint32_t alloc_node() { return node_counter.fetch_add(1, std::memory_order_relaxed); }
+
+	void bin_range(const std::uint32_t begin, const std::uint32_t end, const BinMapping& mapping, AxisBins& bins,
+				   AABB& node_bounds) const {
+		for (std::uint32_t i = begin; i < end; ++i) {
+			const std::uint32_t prim = indices[i];
+			node_bounds.expand(bounds[prim]);
+			for (int axis = 0; axis < 3; ++axis) {
+				Bin& bin = bins[axis][mapping.bin(centroids[prim], axis)];
+				bin.bounds.expand(bounds[prim]);
+				++bin.count;
+			}
+		}
+	}
+
+	/**
+	 * @brief 统计区间内图元落入各桶的情况；大区间拆分为多个任务并行统计后归并。
+	 */
+	void compute_bins(const std::uint32_t begin, const std::uint32_t end, const BinMapping& mapping, AxisBins& bins,
+					  AABB& node_bounds) const {
+		const std::uint32_t count = end - begin;
+		if (count < PARALLEL_BIN_THRESHOLD) {
+			bin_range(begin, end, mapping, bins, node_bounds);
+			return;
+		}
+
+		const std::uint32_t n_chunks = (count + BIN_CHUNK_SIZE - 1) / BIN_CHUNK_SIZE;
+		std::vector<AxisBins> chunk_bins(n_chunks);
+		std::vector<AABB> chunk_bounds(n_chunks);
+		for (std::uint32_t c = 0; c < n_chunks; ++c) {
+#pragma omp task default(shared) firstprivate(c)
+			bin_range(begin + c * BIN_CHUNK_SIZE, std::min(end, begin + (c + 1) * BIN_CHUNK_SIZE), mapping,
+					  chunk_bins[c], chunk_bounds[c]);
+		}
+#pragma omp taskwait
+
+		for (std::uint32_t c = 0; c < n_chunks; ++c) {
+			node_bounds.expand(chunk_bounds[c]);
+			for (int axis = 0; axis < 3; ++axis) {
+				for (int b = 0; b < mapping.n_bins; ++b) {
+					bins[axis][b].bounds.expand(chunk_bins[c][axis][b].bounds);
+					bins[axis][b].count += chunk_bins[c][axis][b].count;
+				}
+			}
+		}
+	}
+
+	void make_leaf(BVHBuildNode& node, const AABB& node_bounds, const std::uint32_t begin,
+				   const std::uint32_t count) const {
+		node.bounds = node_bounds;
+		node.first = begin;
+		node.count = count;
+	}
+
+	void build(const std::uint32_t node_idx, const std::uint32_t begin, const std::uint32_t end, const int depth) {
+		BVHBuildNode& node = nodes[node_idx];
+		const std::uint32_t count = end - begin;
+
+		AABB centroid_bounds;
+		for (std::uint32_t i = begin; i < end; ++i)
+			centroid_bounds.expand(centroids[indices[i]]);
+
+		const BinMapping mapping(centroid_bounds, count);
+		AxisBins bins{};
+		AABB node_bounds;
+		compute_bins(begin, end, mapping, bins, node_bounds);
+
+		if (count == 1) {
+			make_leaf(node, node_bounds, begin, count);
+			return;
+		}
+
+		// 对每个轴做前缀/后缀扫描，在 n_bins - 1 个桶边界中选择 SAH 代价最小的划分
+		float best_cost = std::numeric_limits<float>::infinity();
+		int best_axis = -1;
+		int best_bin = 0;
+		const float inv_area = 1.0F / std::max(node_bounds.surface_area(), std::numeric_limits<float>::min());
+		for (int axis = 0; axis < 3; ++axis) {
+			if (mapping.scale[axis] <= 0.0F) continue;
+
+			std::array<float, BVHTree::BIN_COUNT> right_cost{};
+			AABB right;
+			std::uint32_t n_right = 0;
+			for (int b = mapping.n_bins - 1; b > 0; --b) {
+				right.expand(bins[axis][b].bounds);
+				n_right += bins[axis][b].count;
+				right_cost[b] = right.surface_area() * static_cast<float>(n_right);
+			}
+			AABB left;
+			std::uint32_t n_left = 0;
+			for (int b = 0; b < mapping.n_bins - 1; ++b) {
+				left.expand(bins[axis][b].bounds);
+				n_left += bins[axis][b].count;
+				if (n_left == 0 || n_left == count) continue;
+				const float cost =
+					BVHTree::TRAVERSAL_COST +
+					BVHTree::INTERSECT_COST * inv_area * (left.surface_area() * static_cast<float>(n_left) + right_cost[b + 1]);
+				if (cost < best_cost) {
+					best_cost = cost;
+					best_axis = axis;
+					best_bin = b + 1;
+				}
+			}
+		}
+
+		std::uint32_t mid = 0;
+		const float leaf_cost = BVHTree::INTERSECT_COST * static_cast<float>(count);
+		if (best_axis >= 0 && count <= BVHTree::MAX_LEAF_SIZE && leaf_cost <= best_cost) {
+			make_leaf(node, node_bounds, begin, count);
+			return;
+		}
+		if (best_axis >= 0 && depth < BVHTree::MAX_DEPTH - 16) {
+			const auto split = std::partition(indices.begin() + begin, indices.begin() + end, [&](const std::uint32_t p) {
+				return mapping.bin(centroids[p], best_axis) < best_bin;
+			});
+			mid = static_cast<std::uint32_t>(split - indices.begin());
+		} else {
+			// 质心全部重合或树过深：小区间直接作为叶节点，否则沿最长轴按中位数划分
+			if (count <= BVHTree::MAX_LEAF_SIZE) {
+				make_leaf(node, node_bounds, begin, count);
+				return;
+			}
+			best_axis = centroid_bounds.longest_axis();
+			mid = begin + count / 2;
+			std::nth_element(indices.begin() + begin, indices.begin() + mid, indices.begin() + end,
+							 [&](const std::uint32_t a, const std::uint32_t b) {
+								 return centroids[a][best_axis] < centroids[b][best_axis];
+							 });
+		}
+
+		const std::uint32_t left_idx = alloc_node();
+		const std::uint32_t right_idx = alloc_node();
+		node.bounds = node_bounds;
+		node.count = 0;
+		node.axis = static_cast<std::uint16_t>(best_axis);
+		node.children = {left_idx, right_idx};
+
+		// 大子树作为任务并行构建，小子树在当前线程递归以避免任务调度开销
+		if (mid - begin > TASK_THRESHOLD) {
+#pragma omp task default(shared) firstprivate(left_idx, begin, mid, depth)
+			build(left_idx, begin, mid, depth + 1);
+		} else {
+			build(left_idx, begin, mid, depth + 1);
+		}
+		build(right_idx, mid, end, depth + 1);
+#pragma omp taskwait
+	}
+};
+
+} // namespace
+
+void BVHTree::_build_binned_sah(const std::span<const AABB> prim_bounds, const std::span<const glm::vec3> centroids) {
+	std::vector<BVHBuildNode> build_nodes(2 * prim_bounds.size());
+	BinnedBuilder builder{prim_bounds, centroids, _indices, build_nodes};
+	const std::uint32_t root = builder.alloc_node();
+
+#pragma omp parallel default(shared)
+#pragma omp single
+	builder.build(root, 0, static_cast<std::uint32_t>(prim_bounds.size()), 0);
+
+	_flatten(build_nodes, root);
+}
+
+} // namespace rt
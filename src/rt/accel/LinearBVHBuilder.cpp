@@ -0,0 +1,390 @@
+#include "rt/accel/BVHTree.hpp"
+#include "rt/core/RadixSort.hpp"
+#include <omp.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+
+namespace rt {
+
+namespace {
+
+constexpr std::uint32_t TASK_THRESHOLD = 4096;		 ///< 子树图元数超过该值时作为独立任务处理。
+constexpr std::uint32_t TREELET_MIN_PRIMS = 16;		 ///< 只在图元数不少于该值的子树上做 treelet 优化。
+constexpr int TREELET_SUBSETS = 1 << BVHTree::TREELET_SIZE; ///< treelet 叶子集合的子集数。
+
+/**
+ * @brief 在 10 位整数的相邻位之间插入两个 0，用于 30 位 Morton 码。
+ */
+std::uint64_t expand_bits_10(std::uint64_t v) {
+	v &= 0x3FFULL;
+	v = (v | (v << 16)) & 0x030000FFULL;
+	v = (v | (v << 8)) & 0x0300F00FULL;
+	v = (v | (v << 4)) & 0x030C30C3ULL;
+	v = (v | (v << 2)) & 0x09249249ULL;
+	return v;
+}
+
+/**
+ * @brief 在 21 位整数的相邻位之间插入两个 0，用于 63 位 Morton 码。
+ */
+std::uint64_t expand_bits_21(std::uint64_t v) {
+	v &= 0x1FFFFFULL;
+	v = (v | (v << 32)) & 0x1F00000000FFFFULL;
+	v = (v | (v << 16)) & 0x1F0000FF0000FFULL;
+	v = (v | (v << 8)) & 0x100F00F00F00F00FULL;
+	v = (v | (v << 4)) & 0x10C30C30C30C30C3ULL;
+	v = (v | (v << 2)) & 0x1249249249249249ULL;
+	return v;
+}
+
+/**
+ * @brief LBVH 的临时二叉树。
+ *
+ * 节点编号：内部节点为 [0, n - 1)，叶节点 k（排序后第 k 个图元）为 n - 1 + k，根节点为 0。
+ */
+struct LinearTree {
+	std::span<const AABB> prim_bounds;						///< 图元包围盒。
+	std::vector<std::uint64_t> codes{};						///< 排序后的 Morton 码。
+	std::vector<std::uint32_t> sorted_prims{};				///< 排序后的图元下标。
+	std::vector<std::array<std::uint32_t, 2>> children{};	///< 内部节点的子节点。
+	std::vector<AABB> bounds{};								///< 所有节点的包围盒。
+	std::vector<float> cost{};								///< 所有节点子树的 SAH 代价（未归一化）。
+	std::vector<std::uint32_t> prim_count{};				///< 所有节点子树中的图元数。
+	std::vector<std::uint32_t> height{};					///< 所有节点线性化后的子树高度（叶节点为 0）。
+
+	[[nodiscard]] std::uint32_t leaf_count() const { return static_cast<std::uint32_t>(codes.size()); }
+	[[nodiscard]] bool is_leaf(const std::uint32_t node) const { return node + 1 >= leaf_count(); }
+	[[nodiscard]] std::uint32_t leaf_id(const std::uint32_t k) const { return leaf_count() - 1 + k; }
+
+	/**
+	 * @brief 排序后第 i 与第 j 个 Morton 码的公共前缀长度；码相同时以下标区分，越界返回 -1。
+	 */
+	[[nodiscard]] int delta(const std::int64_t i, const std::int64_t j) const {
+		if (j < 0 || j >= static_cast<std::int64_t>(codes.size())) return -1;
+		const std::uint64_t a = codes[i];
+		const std::uint64_t b = codes[j];
+		if (a == b) return 64 + std::countl_zero(static_cast<std::uint32_t>(i ^ j));
+		return std::countl_zero(a ^ b);
+	}
+
+	/**
+	 * @brief 按 Karras (2012) 的方法确定内部节点 i 覆盖的区间与划分位置，各内部节点互相独立。
+	 */
+	void build_internal(const std::int64_t i) {
+		const int d = delta(i, i + 1) - delta(i, i - 1) >= 0 ? 1 : -1;
+
+		// 以指数步长加二分搜索找到区间的另一端 j
+		const int delta_min = delta(i, i - d);
+		std::int64_t l_max = 2;
+		while (delta(i, i + l_max * d) > delta_min)
+			l_max *= 2;
+		std::int64_t l = 0;
+		for (std::int64_t t = l_max / 2; t >= 1; t /= 2)
+			if (delta(i, i + (l + t) * d) > delta_min) l += t;
+		const std::int64_t j = i + l * d;
+
+		// 二分搜索区间内公共前缀开始变化的位置 gamma
+		const int delta_node = delta(i, j);
+		std::int64_t s = 0;
+		std::int64_t divisor = 2;
+		for (std::int64_t t = (l + divisor - 1) / divisor; t >= 1; t = (l + divisor - 1) / divisor) {
+			if (delta(i, i + (s + t) * d) > delta_node) s += t;
+			if (t == 1) break;
+			divisor *= 2;
+		}
+		const std::int64_t gamma = i + s * d + std::min(d, 0);
+
+		const auto g = static_cast<std::uint32_t>(gamma);
+		const std::uint32_t left = std::min(i, j) == gamma ? leaf_id(g) : g;
+		const std::uint32_t right = std::max(i, j) == gamma + 1 ? leaf_id(g + 1) : g + 1;
+		children[i] = {left, right};
+		prim_count[i] = static_cast<std::uint32_t>(std::abs(j - i) + 1);
+	}
+
+	/**
+	 * @brief 后序遍历计算包围盒与 SAH 代价，大子树作为任务并行处理。
+	 */
+	void compute_bounds(const std::uint32_t node) {
+		if (is_leaf(node)) {
+			bounds[node] = prim_bounds[sorted_prims[node + 1 - leaf_count()]];
+			cost[node] = BVHTree::INTERSECT_COST * bounds[node].surface_area();
+			prim_count[node] = 1;
+			height[node] = 0;
+			return;
+		}
+		// OpenMP 子句中不能使用结构化绑定，这里显式取出子节点
+		const std::uint32_t left = children[node][0];
+		const std::uint32_t right = children[node][1];
+#pragma omp task default(shared) firstprivate(left) if (prim_count[node] > TASK_THRESHOLD)
+		compute_bounds(left);
+		compute_bounds(right);
+#pragma omp taskwait
+		update_node(node);
+	}
+
+	void update_node(const std::uint32_t node) {
+		const auto [left, right] = children[node];
+		bounds[node] = surrounding_box(bounds[left], bounds[right]);
+		cost[node] = BVHTree::TRAVERSAL_COST * bounds[node].surface_area() + cost[left] + cost[right];
+		prim_count[node] = prim_count[left] + prim_count[right];
+		// 图元数不超过 MAX_LEAF_SIZE 的子树在线性化时合并为一个叶节点
+		height[node] = prim_count[node] <= BVHTree::MAX_LEAF_SIZE ? 0 : 1 + std::max(height[left], height[right]);
+	}
+
+	/**
+	 * @brief 自底向上的 treelet 重构优化 (Karras & Aila 2013)。
+	 *
+	 * 以每个足够大的内部节点为根，反复展开面积最大的叶子形成最多 TREELET_SIZE 个叶子的 treelet，
+	 * 用子集动态规划求出 SAH 代价最小的拓扑，并复用 treelet 的内部节点重新连接。
+	 */
+	void optimize_treelets(const std::uint32_t node) {
+		if (is_leaf(node) || prim_count[node] < TREELET_MIN_PRIMS) return;
+
+		// OpenMP 子句中不能使用结构化绑定，这里显式取出子节点
+		const std::uint32_t left = children[node][0];
+		const std::uint32_t right = children[node][1];
+#pragma omp task default(shared) firstprivate(left) if (prim_count[node] > TASK_THRESHOLD)
+		optimize_treelets(left);
+		optimize_treelets(right);
+#pragma omp taskwait
+		update_node(node);
+		restructure(node);
+	}
+
+	void restructure(const std::uint32_t root) {
+		std::array<std::uint32_t, BVHTree::TREELET_SIZE> leaves{children[root][0], children[root][1]};
+		std::array<std::uint32_t, BVHTree::TREELET_SIZE - 1> internals{root};
+		int n_leaves = 2;
+		int n_internals = 1;
+		while (n_leaves < BVHTree::TREELET_SIZE) {
+			int best = -1;
+			float best_area = -1.0F;
+			for (int k = 0; k < n_leaves; ++k) {
+				if (!is_leaf(leaves[k]) && bounds[leaves[k]].surface_area() > best_area) {
+					best = k;
+					best_area = bounds[leaves[k]].surface_area();
+				}
+			}
+			if (best < 0) break;
+			const std::uint32_t expanded = leaves[best];
+			internals[n_internals++] = expanded;
+			leaves[best] = children[expanded][0];
+			leaves[n_leaves++] = children[expanded][1];
+		}
+		if (n_leaves < 3) return;
+
+		// 子集动态规划：copt[S] 为叶子集合 S 组成的最优子树代价
+		const int full = (1 << n_leaves) - 1;
+		std::array<float, TREELET_SUBSETS> area{};
+		std::array<float, TREELET_SUBSETS> copt{};
+		std::array<std::uint8_t, TREELET_SUBSETS> split{};
+		for (int mask = 1; mask <= full; ++mask) {
+			AABB box;
+			for (int k = 0; k < n_leaves; ++k)
+				if (mask & (1 << k)) box.expand(bounds[leaves[k]]);
+			area[mask] = box.surface_area();
+		}
+		for (int k = 0; k < n_leaves; ++k)
+			copt[1 << k] = cost[leaves[k]];
+		for (int mask = 1; mask <= full; ++mask) {
+			if (std::popcount(static_cast<unsigned>(mask)) < 2) continue;
+			const int lowest = mask & -mask;
+			float best = std::numeric_limits<float>::infinity();
+			for (int p = (mask - 1) & mask; p > 0; p = (p - 1) & mask) {
+				if (!(p & lowest)) continue;
+				const float c = copt[p] + copt[mask ^ p];
+				if (c < best) {
+					best = c;
+					split[mask] = static_cast<std::uint8_t>(p);
+				}
+			}
+			copt[mask] = BVHTree::TRAVERSAL_COST * area[mask] + best;
+		}
+		if (copt[full] >= cost[root] * (1.0F - 1e-5F)) return;
+
+		int next_internal = 1;
+		emit(full, root, leaves, internals, split, next_internal);
+	}
+
+	void emit(const int mask, const std::uint32_t slot, const std::array<std::uint32_t, BVHTree::TREELET_SIZE>& leaves,
+			  const std::array<std::uint32_t, BVHTree::TREELET_SIZE - 1>& internals,
+			  const std::array<std::uint8_t, TREELET_SUBSETS>& split, int& next_internal) {
+		const int p = split[mask];
+		std::array<std::uint32_t, 2> child{};
+		const std::array<int, 2> sub{p, mask ^ p};
+		for (int c = 0; c < 2; ++c) {
+			if (std::popcount(static_cast<unsigned>(sub[c])) == 1) {
+				child[c] = leaves[std::countr_zero(static_cast<unsigned>(sub[c]))];
+			} else {
+				child[c] = internals[next_internal++];
+				emit(sub[c], child[c], leaves, internals, split, next_internal);
+			}
+		}
+		children[slot] = child;
+		update_node(slot);
+	}
+};
+
+/**
+ * @brief 按中位数划分 count 个图元得到的子树高度。
+ */
+int median_height(std::uint32_t count) {
+	int height = 0;
+	for (; count > BVHTree::MAX_LEAF_SIZE; count = (count + 1) / 2)
+		++height;
+	return height;
+}
+
+/**
+ * @brief 沿质心最长轴按中位数划分 prims[begin, end)，以深度优先顺序追加到 nodes，子树高度为 median_height。
+ */
+void build_median(std::vector<BVHNode>& nodes, std::vector<std::uint32_t>& prims, const std::uint32_t begin,
+				  const std::uint32_t end, const std::span<const AABB> prim_bounds,
+				  const std::span<const glm::vec3> centroids) {
+	AABB node_bounds;
+	AABB centroid_bounds;
+	for (std::uint32_t i = begin; i < end; ++i) {
+		node_bounds.expand(prim_bounds[prims[i]]);
+		centroid_bounds.expand(centroids[prims[i]]);
+	}
+
+	const std::uint32_t count = end - begin;
+	if (count <= BVHTree::MAX_LEAF_SIZE) {
+		nodes.push_back({node_bounds, begin, static_cast<std::uint16_t>(count), 0});
+		return;
+	}
+
+	const int axis = centroid_bounds.longest_axis();
+	const std::uint32_t mid = begin + count / 2;
+	std::nth_element(prims.begin() + begin, prims.begin() + mid, prims.begin() + end,
+					 [&](const std::uint32_t a, const std::uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+	const auto node_idx = static_cast<std::uint32_t>(nodes.size());
+	nodes.push_back({node_bounds, 0, 0, static_cast<std::uint16_t>(axis)});
+	build_median(nodes, prims, begin, mid, prim_bounds, centroids);
+	nodes[node_idx].offset = static_cast<std::uint32_t>(nodes.size());
+	build_median(nodes, prims, mid, end, prim_bounds, centroids);
+}
+
+} // namespace
+
+void BVHTree::_build_lbvh(const std::span<const AABB> prim_bounds, const std::span<const glm::vec3> centroids,
+						  const bool optimize_treelets) {
+	const size_t n = prim_bounds.size();
+	const auto n_signed = static_cast<std::int64_t>(n);
+
+	// 1. 在质心包围盒内量化质心并计算 Morton 码
+	AABB centroid_bounds;
+	for (const auto& c : centroids)
+		centroid_bounds.expand(c);
+	const bool use_64 = n > MORTON64_THRESHOLD;
+	const int axis_bits = use_64 ? 21 : 10;
+	const float grid = static_cast<float>(1U << axis_bits);
+	glm::vec3 scale(0.0F);
+	for (int a = 0; a < 3; ++a)
+		if (centroid_bounds.extent()[a] > 0.0F) scale[a] = grid / centroid_bounds.extent()[a];
+
+	LinearTree tree{prim_bounds};
+	tree.codes.resize(n);
+	tree.sorted_prims.resize(n);
+#pragma omp parallel for schedule(static)
+	for (std::int64_t i = 0; i < n_signed; ++i) {
+		std::array<std::uint64_t, 3> q{};
+		for (int a = 0; a < 3; ++a) {
+			const float v = (centroids[i][a] - centroid_bounds.min()[a]) * scale[a];
+			q[a] = static_cast<std::uint64_t>(std::clamp(v, 0.0F, grid - 1.0F));
+		}
+		tree.codes[i] = use_64 ? (expand_bits_21(q[0]) << 2) | (expand_bits_21(q[1]) << 1) | expand_bits_21(q[2])
+							   : (expand_bits_10(q[0]) << 2) | (expand_bits_10(q[1]) << 1) | expand_bits_10(q[2]);
+		tree.sorted_prims[i] = static_cast<std::uint32_t>(i);
+	}
+
+	// 2. 并行基数排序
+	radix_sort(tree.codes, tree.sorted_prims, use_64 ? 63 : 30);
+
+	// 3. 并行生成所有内部节点
+	tree.children.resize(n > 1 ? n - 1 : 0);
+	tree.bounds.resize(2 * n - 1);
+	tree.cost.resize(2 * n - 1);
+	tree.prim_count.resize(2 * n - 1);
+	tree.height.resize(2 * n - 1);
+#pragma omp parallel for schedule(static)
+	for (std::int64_t i = 0; i < n_signed - 1; ++i)
+		tree.build_internal(i);
+
+	// 4. 自底向上计算包围盒，可选 treelet 优化
+#pragma omp parallel default(shared)
+#pragma omp single
+	{
+		tree.compute_bounds(0);
+		if (optimize_treelets) tree.optimize_treelets(0);
+	}
+
+	// 5. 线性化：图元数不超过 MAX_LEAF_SIZE 的子树合并为一个叶节点。
+	// Morton 码分布极不均匀时（例如大量重合的图元加上按 2 的幂分布的离群点）LBVH 会退化成很深的链，
+	// 会超出 MAX_DEPTH 的子树沿途保留原有划分，直到再往下就放不下按中位数重建的子树时，改为按中位数重建
+	_nodes.clear();
+	_nodes.reserve(2 * n);
+	std::vector<std::uint32_t> ordered;
+	ordered.reserve(n);
+
+	struct Pending {
+		std::uint32_t node;	 ///< 临时树节点编号。
+		std::uint32_t parent; ///< 需要回填右子节点下标的父节点，无则为 UINT32_MAX。
+		int depth;			 ///< 节点深度，根节点为 0。
+	};
+	std::vector<Pending> stack{{0, UINT32_MAX, 0}};
+	std::vector<std::uint32_t> gather;
+	const auto gather_prims = [&](const std::uint32_t node) {
+		gather.assign(1, node);
+		while (!gather.empty()) {
+			const std::uint32_t g = gather.back();
+			gather.pop_back();
+			if (tree.is_leaf(g)) {
+				ordered.push_back(tree.sorted_prims[g + 1 - tree.leaf_count()]);
+			} else {
+				gather.push_back(tree.children[g][1]);
+				gather.push_back(tree.children[g][0]);
+			}
+		}
+	};
+	while (!stack.empty()) {
+		const Pending item = stack.back();
+		stack.pop_back();
+
+		const auto slot = static_cast<std::uint32_t>(_nodes.size());
+		if (item.parent != UINT32_MAX) _nodes[item.parent].offset = slot;
+
+		const std::uint32_t count = tree.prim_count[item.node];
+		if (tree.is_leaf(item.node) || count <= MAX_LEAF_SIZE) {
+			const auto first = static_cast<std::uint32_t>(ordered.size());
+			gather_prims(item.node);
+			_nodes.push_back({tree.bounds[item.node], first, static_cast<std::uint16_t>(count), 0});
+			continue;
+		}
+		if (item.depth + static_cast<int>(tree.height[item.node]) > MAX_DEPTH &&
+			item.depth + 1 + median_height(count) > MAX_DEPTH) {
+			const auto first = static_cast<std::uint32_t>(ordered.size());
+			gather_prims(item.node);
+			build_median(_nodes, ordered, first, first + count, prim_bounds, centroids);
+			continue;
+		}
+
+		// 选择子节点质心分离最大的轴作为遍历排序轴，并保证左子节点位于该轴的较小一侧
+		auto [left, right] = tree.children[item.node];
+		const glm::vec3 separation = tree.bounds[right].centroid() - tree.bounds[left].centroid();
+		int axis = 0;
+		for (int a = 1; a < 3; ++a)
+			if (std::fabs(separation[a]) > std::fabs(separation[axis])) axis = a;
+		if (separation[axis] < 0.0F) std::swap(left, right);
+
+		_nodes.push_back({tree.bounds[item.node], 0, 0, static_cast<std::uint16_t>(axis)});
+		stack.push_back({right, slot, item.depth + 1});
+		stack.push_back({left, UINT32_MAX, item.depth + 1});
+	}
+	_indices = std::move(ordered);
+}
+
+} // namespace rt
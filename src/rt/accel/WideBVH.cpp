@@ -0,0 +1,162 @@
+#include "rt/accel/WideBVH.hpp"
+#include "rt/core/CpuFeatures.hpp"
+#include <limits>
+
+#if RT_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+void WideBVH::build(const BVHTree& tree) {
+	_nodes.clear();
+	_use_avx2 = !_force_scalar && RT_ARCH_X86 && cpu_features().avx2;
+	if (tree.empty()) return;
+
+	_nodes.reserve(tree.nodes().size() / 4 + 1);
+	_collapse(tree.nodes(), 0);
+}
+
+void WideBVH::set_force_scalar(const bool force_scalar) {
+	_force_scalar = force_scalar;
+	_use_avx2 = !force_scalar && RT_ARCH_X86 && cpu_features().avx2;
+}
+
+std::uint32_t WideBVH::_collapse(const std::vector<BVHNode>& binary, const std::uint32_t binary_idx) {
+	// 收集子节点：从二叉节点的两个孩子开始，反复展开面积最大的内部节点
+	std::array<std::uint32_t, WideBVHNode::WIDTH> children{};
+	int n_children = 0;
+	const BVHNode& root = binary[binary_idx];
+	if (root.is_leaf()) {
+		children[n_children++] = binary_idx;
+	} else {
+		children[n_children++] = binary_idx + 1;
+		children[n_children++] = root.offset;
+	}
+	while (n_children < WideBVHNode::WIDTH) {
+		int best = -1;
+		float best_area = -1.0F;
+		for (int k = 0; k < n_children; ++k) {
+			const BVHNode& c = binary[children[k]];
+			if (!c.is_leaf() && c.bounds.surface_area() > best_area) {
+				best = k;
+				best_area = c.bounds.surface_area();
+			}
+		}
+		if (best < 0) break;
+		const std::uint32_t expanded = children[best];
+		children[best] = expanded + 1;
+		children[n_children++] = binary[expanded].offset;
+	}
+
+	const auto node_idx = static_cast<std::uint32_t>(_nodes.size());
+	{
+		WideBVHNode& node = _nodes.emplace_back();
+		constexpr float INF = std::numeric_limits<float>::infinity();
+		node.min_x.fill(INF);
+		node.min_y.fill(INF);
+		node.min_z.fill(INF);
+		node.max_x.fill(-INF);
+		node.max_y.fill(-INF);
+		node.max_z.fill(-INF);
+		node.child.fill(0);
+		node.count.fill(0);
+	}
+
+	for (int k = 0; k < n_children; ++k) {
+		const BVHNode& c = binary[children[k]];
+		std::uint32_t child = c.offset;
+		if (!c.is_leaf()) child = _collapse(binary, children[k]);
+
+		// 递归可能导致 _nodes 重新分配，因此每次都通过下标重新取节点
+		WideBVHNode& node = _nodes[node_idx];
+		node.min_x[k] = c.bounds.min().x;
+		node.min_y[k] = c.bounds.min().y;
+		node.min_z[k] = c.bounds.min().z;
+		node.max_x[k] = c.bounds.max().x;
+		node.max_y[k] = c.bounds.max().y;
+		node.max_z[k] = c.bounds.max().z;
+		node.child[k] = child;
+		node.count[k] = c.count;
+	}
+	return node_idx;
+}
+
+unsigned WideBVH::intersect_node_scalar(const WideBVHNode& node, const glm::vec3& origin, const glm::vec3& inv_dir,
+										const float t_min, const float t_max,
+										std::array<float, WideBVHNode::WIDTH>& t_near) {
+	// 与 AVX2 版本相同，按方向符号选择近/远平面，使空槽位自然不命中
+	const std::array<const std::array<float, WideBVHNode::WIDTH>*, 3> lo = {
+		inv_dir.x < 0 ? &node.max_x : &node.min_x, inv_dir.y < 0 ? &node.max_y : &node.min_y,
+		inv_dir.z < 0 ? &node.max_z : &node.min_z};
+	const std::array<const std::array<float, WideBVHNode::WIDTH>*, 3> hi = {
+		inv_dir.x < 0 ? &node.min_x : &node.max_x, inv_dir.y < 0 ? &node.min_y : &node.max_y,
+		inv_dir.z < 0 ? &node.min_z : &node.max_z};
+
+	unsigned mask = 0;
+	for (int k = 0; k < WideBVHNode::WIDTH; ++k) {
+		float t_enter = t_min;
+		float t_exit = t_max;
+		for (int a = 0; a < 3; ++a) {
+			const float t0 = ((*lo[a])[k] - origin[a]) * inv_dir[a];
+			const float t1 = ((*hi[a])[k] - origin[a]) * inv_dir[a] * AABB::SLAB_ROBUST_SCALE;
+			t_enter = t0 > t_enter ? t0 : t_enter;
+			t_exit = t1 < t_exit ? t1 : t_exit;
+		}
+		t_near[k] = t_enter;
+		if (t_enter <= t_exit) mask |= 1U << k;
+	}
+	return mask;
+}
+
+#if RT_ARCH_X86
+
+RT_TARGET_AVX2 unsigned WideBVH::intersect_node_avx2(const WideBVHNode& node, const glm::vec3& origin,
+													 const glm::vec3& inv_dir, const float t_min, const float t_max,
+													 std::array<float, WideBVHNode::WIDTH>& t_near) {
+	const __m256 ox = _mm256_set1_ps(origin.x);
+	const __m256 oy = _mm256_set1_ps(origin.y);
+	const __m256 oz = _mm256_set1_ps(origin.z);
+	const __m256 ix = _mm256_set1_ps(inv_dir.x);
+	const __m256 iy = _mm256_set1_ps(inv_dir.y);
+	const __m256 iz = _mm256_set1_ps(inv_dir.z);
+
+	// 按方向符号选择近/远平面：空槽位 (min = +inf, max = -inf) 的进入距离为 +inf、离开距离为 -inf，必然不命中。
+	// 若用 min/max 排序两个平面，空包围盒会被当作整个空间。
+	const bool neg_x = inv_dir.x < 0;
+	const bool neg_y = inv_dir.y < 0;
+	const bool neg_z = inv_dir.z < 0;
+	const __m256 t_lo_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps((neg_x ? node.max_x : node.min_x).data()), ox), ix);
+	const __m256 t_hi_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps((neg_x ? node.min_x : node.max_x).data()), ox), ix);
+	const __m256 t_lo_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps((neg_y ? node.max_y : node.min_y).data()), oy), iy);
+	const __m256 t_hi_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps((neg_y ? node.min_y : node.max_y).data()), oy), iy);
+	const __m256 t_lo_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps((neg_z ? node.max_z : node.min_z).data()), oz), iz);
+	const __m256 t_hi_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps((neg_z ? node.min_z : node.max_z).data()), oz), iz);
+
+	// max_ps/min_ps 在任一操作数为 NaN 时返回第二个操作数，累积值放在第二个操作数，
+	// 使 0 * inf 产生的 NaN 被忽略，与 AABB::hit 的标量语义一致
+	const __m256 scale = _mm256_set1_ps(AABB::SLAB_ROBUST_SCALE);
+	__m256 t_enter = _mm256_set1_ps(t_min);
+	t_enter = _mm256_max_ps(t_lo_x, t_enter);
+	t_enter = _mm256_max_ps(t_lo_y, t_enter);
+	t_enter = _mm256_max_ps(t_lo_z, t_enter);
+	__m256 t_exit = _mm256_set1_ps(t_max);
+	t_exit = _mm256_min_ps(_mm256_mul_ps(t_hi_x, scale), t_exit);
+	t_exit = _mm256_min_ps(_mm256_mul_ps(t_hi_y, scale), t_exit);
+	t_exit = _mm256_min_ps(_mm256_mul_ps(t_hi_z, scale), t_exit);
+
+	_mm256_storeu_ps(t_near.data(), t_enter);
+	return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(t_enter, t_exit, _CMP_LE_OQ)));
+}
+
+#else
+
+unsigned WideBVH::intersect_node_avx2(const WideBVHNode& node, const glm::vec3& origin, const glm::vec3& inv_dir,
+									  const float t_min, const float t_max,
+									  std::array<float, WideBVHNode::WIDTH>& t_near) {
+	return intersect_node_scalar(node, origin, inv_dir, t_min, t_max, t_near);
+}
+
+#endif
+
+} // namespace rt
@@ -0,0 +1,107 @@
+#include "rt/apps/AnimatedSpheres.hpp"
+#include "rt/SoftTracer.hpp"
+#include "rt/core/Camera.hpp"
+#include "rt/core/Utils.hpp"
+#include "rt/hittables/BVH.hpp"
+#include "rt/hittables/Quad.hpp"
+#include "rt/hittables/Scene.hpp"
+#include "rt/hittables/Sphere.hpp"
+#include "rt/materials/Lambertian.hpp"
+#include "rt/materials/Metal.hpp"
+#include "rt/sampling/PCG32Sampler.hpp"
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <cmath>
+#include <vector>
+
+namespace rt {
+void AnimatedSpheresApp::run() {
+	fmt::println("Running Animated Spheres Scene...");
+
+	// Image
+	constexpr auto ASPECT_RATIO = 16.0 / 9.0;
+	constexpr int IMAGE_WIDTH = 320;
+	constexpr int IMAGE_HEIGHT = static_cast<int>(IMAGE_WIDTH / ASPECT_RATIO);
+	constexpr int SAMPLES_PER_PIXEL = 16;
+	constexpr int MAX_DEPTH = 10;
+	constexpr int FRAME_COUNT = 8;
+
+	// World：转台上的小球与小方块绕 y 轴旋转，拓扑不变，每帧只重新拟合 BVH
+	Scene world;
+	auto material_ground = std::make_shared<Lambertian>(glm::vec3(0.8, 0.8, 0.0));
+	world.add(std::make_shared<Quad>(glm::vec3(-20, -0.5, -20), glm::vec3(40, 0, 0), glm::vec3(0, 0, 40),
+									 material_ground));
+
+	struct Orbit {
+		float radius;	 ///< 轨道半径。
+		float phase;	 ///< 初始角度。
+		float height;	 ///< 高度。
+		float speed;	 ///< 每帧转过的角度系数。
+	};
+	std::vector<std::shared_ptr<Sphere>> spheres;
+	std::vector<std::shared_ptr<Quad>> cards;
+	std::vector<Orbit> sphere_orbits;
+	std::vector<Orbit> card_orbits;
+	constexpr int OBJECT_COUNT = 2000;
+	constexpr float QUAD_SIZE = 0.08F;
+	// 场景生成使用固定种子，每次运行得到相同的场景
+	PCG32Sampler rng;
+	for (int i = 0; i < OBJECT_COUNT; ++i) {
+		const Orbit orbit{static_cast<float>(random_double(rng, 0.3, 3.0)),
+						  static_cast<float>(random_double(rng, 0.0, 2.0 * PI)),
+						  static_cast<float>(random_double(rng, -0.45, 1.0)),
+						  static_cast<float>(random_double(rng, 0.5, 1.5))};
+		const glm::vec3 albedo = random_vec3(rng) * random_vec3(rng);
+		if (i % 4 == 0) {
+			cards.push_back(std::make_shared<Quad>(glm::vec3(0), glm::vec3(QUAD_SIZE, 0, 0), glm::vec3(0, QUAD_SIZE, 0),
+												   std::make_shared<Metal>(albedo, 0.2)));
+			card_orbits.push_back(orbit);
+			world.add(cards.back());
+		} else {
+			spheres.push_back(std::make_shared<Sphere>(glm::vec3(0), 0.04, std::make_shared<Lambertian>(albedo)));
+			sphere_orbits.push_back(orbit);
+			world.add(spheres.back());
+		}
+	}
+
+	const auto place = [](const Orbit& orbit, const float angle) {
+		const float a = orbit.phase + orbit.speed * angle;
+		return glm::vec3(orbit.radius * std::cos(a), orbit.height, orbit.radius * std::sin(a) - 1.0F);
+	};
+	const auto animate = [&](const float angle) {
+		for (size_t i = 0; i < spheres.size(); ++i)
+			spheres[i]->set_center(place(sphere_orbits[i], angle));
+		for (size_t i = 0; i < cards.size(); ++i) {
+			// 方块始终朝向转台中心
+			const float a = card_orbits[i].phase + card_orbits[i].speed * angle;
+			const glm::vec3 tangent(-std::sin(a) * QUAD_SIZE, 0.0F, std::cos(a) * QUAD_SIZE);
+			cards[i]->set_geometry(place(card_orbits[i], angle), tangent, glm::vec3(0, QUAD_SIZE, 0));
+		}
+	};
+
+	animate(0.0F);
+	BVH bvh(world);
+	const auto& stats = bvh.build_stats();
+	fmt::println("BVH: {} primitives, built in {:.2f} ms, SAH cost {:.2f}", stats.prim_count, stats.build_ms,
+				 stats.sah_cost);
+
+	// Camera
+	Camera cam(glm::vec3(0, 2.0, 3.5), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), 50, ASPECT_RATIO);
+
+	// Render
+	auto lights = std::make_shared<Scene>();
+	SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
+	tracer.set_background(glm::vec3(0.70, 0.80, 1.00), true);
+	for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+		if (frame > 0) {
+			animate(static_cast<float>(frame) * 0.15F);
+			const BVHRefitStats refit = bvh.refit();
+			fmt::println("Frame {}: {} in {:.2f} ms, SAH cost {:.2f} ({:.1f}% of full build)", frame,
+						 refit.rebuilt ? "rebuilt" : "refit", refit.refit_ms, refit.sah_cost,
+						 100.0F * refit.degradation);
+		}
+		tracer.render(bvh, lights, cam, fmt::format("animated_spheres_{:03}.png", frame));
+	}
+}
+} // namespace rt
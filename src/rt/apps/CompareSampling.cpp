@@ -53,42 +53,15 @@ void rt::CompareSamplingApp::run() {
 		
 	Camera cam(lookfrom, lookat, vup, 40, ASPECT_RATIO);
 
-	// 16
-	{
-		fmt::println("16 Samples per Pixel - Material Sampling Only...");
-		constexpr int SAMPLES_PER_PIXEL = 16; 
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MATERIAL);
-		tracer.render(world, lights, cam, "compare_sampling_16.png");
-	}
-	// 50
-	{
-		fmt::println("50 Samples per Pixel - Material Sampling Only...");
-		constexpr int SAMPLES_PER_PIXEL = 50; 
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MATERIAL);
-		tracer.render(world, lights, cam, "compare_sampling_50.png");
-	
-	}
-	// 100
-	{
-		fmt::println("100 Samples per Pixel - Material Sampling Only...");
-		constexpr int SAMPLES_PER_PIXEL = 100; 
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MATERIAL);
-		tracer.render(world, lights, cam, "compare_sampling_100.png");
-	}
-	// 1000
-	{
-		fmt::println("1000 Samples per Pixel - Material Sampling Only...");
-		constexpr int SAMPLES_PER_PIXEL = 1000; 
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MATERIAL);
-		tracer.render(world, lights, cam, "compare_sampling_1000.png");
-	}
-
-}
\ No newline at end of file
+	// 一趟 1000 spp 的渐进渲染，在 16、50、100 与 1000 spp 时各写出一份快照：
+	// compare_sampling_16.png（及 .exr）……compare_sampling_1000.png，最终图像同时写入 compare_sampling.png
+	fmt::println("16, 50, 100 and 1000 Samples per Pixel - Material Sampling Only...");
+	constexpr int SAMPLES_PER_PIXEL = 1000;
+	SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
+	tracer.set_background(glm::vec3(0,0,0), false);
+	tracer.set_sampling_strategy(SamplingStrategy::MATERIAL);
+	tracer.set_sampler(SamplerType::SOBOL);
+	tracer.set_snapshots({16, 50, 100, SAMPLES_PER_PIXEL});
+	tracer.set_hdr_output(HDRFormat::EXR);
+	tracer.render(world, lights, cam, "compare_sampling.png");
+}
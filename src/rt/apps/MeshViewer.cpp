@@ -0,0 +1,56 @@
+#include "rt/apps/MeshViewer.hpp"
+#include "rt/SoftTracer.hpp"
+#include "rt/core/Camera.hpp"
+#include "rt/hittables/Scene.hpp"
+#include "rt/io/MeshLoader.hpp"
+#include "rt/materials/Lambertian.hpp"
+
+#include <fmt/base.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace rt {
+void MeshViewerApp::run() {
+	fmt::println("Running Mesh Viewer...");
+	fmt::print("Mesh file (.obj / .ply): ");
+	std::string path;
+	std::cin >> path;
+
+	// Image
+	constexpr auto ASPECT_RATIO = 16.0 / 9.0;
+	constexpr int IMAGE_WIDTH = 400;
+	constexpr int IMAGE_HEIGHT = static_cast<int>(IMAGE_WIDTH / ASPECT_RATIO);
+	constexpr int SAMPLES_PER_PIXEL = 32;
+	constexpr int MAX_DEPTH = 8;
+
+	// World：首次加载解析源文件并写入缓存，再次运行时直接映射缓存
+	auto material = std::make_shared<Lambertian>(glm::vec3(0.7, 0.7, 0.7));
+	std::shared_ptr<TriangleMesh> mesh;
+	MeshLoadStats stats;
+	try {
+		mesh = MeshLoader::load(path, material, {}, &stats);
+	} catch (const std::runtime_error& e) {
+		fmt::println("Failed to load mesh: {}", e.what());
+		return;
+	}
+	fmt::println("Mesh: {} vertices, {} triangles, {} in {:.2f} ms (parse {:.2f} ms), peak memory {:.1f} MB",
+				 stats.vertex_count, stats.triangle_count, stats.from_cache ? "mapped from cache" : "parsed",
+				 stats.load_ms, stats.parse_ms, static_cast<double>(stats.peak_memory) / (1024.0 * 1024.0));
+
+	Scene world;
+	world.add(mesh);
+
+	// Camera：沿 +z 方向看向包围盒中心，距离按包围盒大小确定
+	const AABB bounds = mesh->bounding_box();
+	const glm::vec3 center = bounds.centroid();
+	const float radius = 0.5F * glm::length(bounds.extent());
+	Camera cam(center + glm::vec3(0.0F, 0.3F * radius, 2.5F * radius), center, glm::vec3(0, 1, 0), 45, ASPECT_RATIO);
+
+	// Render
+	auto lights = std::make_shared<Scene>();
+	SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
+	tracer.set_background(glm::vec3(0.70, 0.80, 1.00), true);
+	tracer.render(world, lights, cam, "mesh_viewer.png");
+}
+} // namespace rt
@@ -15,7 +15,7 @@ void MirrorBoxApp::run() {
 	constexpr double ASPECT_RATIO = 1.0;
 	constexpr int IMAGE_WIDTH = 1024;
 	constexpr int IMAGE_HEIGHT = static_cast<int>(IMAGE_WIDTH / ASPECT_RATIO);
-	constexpr int SAMPLES_PER_PIXEL = 6000;
+	constexpr int SAMPLES_PER_PIXEL = 2560; // Sobol 采样下误差与独立采样约 6000 spp 相当
 	constexpr int MAX_DEPTH = 400;
 
 	Scene world;
@@ -57,6 +57,10 @@ void MirrorBoxApp::run() {
 
 	SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
 	tracer.set_sampling_strategy(SamplingStrategy::MIS);
+	tracer.set_integrator(IntegratorMode::ITERATIVE); // 镜面盒中的路径可能弹射数百次
+	tracer.set_sampler(SamplerType::SOBOL);
+	tracer.set_checkpoint("mirror_box.ckpt"); // 每 5 分钟与收到 SIGTERM 时写入检查点，被中断后再次运行即从检查点继续
+	tracer.set_hdr_output(HDRFormat::EXR); // 线性辐射度另存为 mirror_box.exr，可用色调映射应用重新生成 PNG
 	tracer.set_background(glm::vec3(0,0,0), false);
 	tracer.render(world, lights, cam, "mirror_box.png");
 }
@@ -6,6 +6,7 @@
 #include "rt/materials/DiffuseLight.hpp"
 #include "rt/materials/Lambertian.hpp"
 #include "rt/materials/Metal.hpp"
+#include <array>
 #include <iostream>
 #include <fmt/core.h>
 
@@ -84,32 +85,15 @@ void MisComparisonApp::run() {
 	// Camera
 	Camera cam(cam_pos, glm::vec3(0, 180, 0), glm::vec3(0,1,0), 50, ASPECT_RATIO);
 
-	// Render 1: MIS (Default)
-	{
-		fmt::print("\nRendering with MIS (Mixture Sampling)...\n");
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MIS);
-		tracer.render(world, lights, cam, "mis_comparison_1_mis.png");
-	}
-
-	// Render 2: Light Sampling Only
-	{
-		fmt::print("\nRendering with Light Sampling Only (NEE)...\n");
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::LIGHT);
-		tracer.render(world, lights, cam, "mis_comparison_2_light.png");
-	}
-
-	// Render 3: Material Sampling Only
-	{
-		fmt::print("\nRendering with Material Sampling Only (Standard Path Tracing)...\n");
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MATERIAL);
-		tracer.render(world, lights, cam, "mis_comparison_3_material.png");
-	}
+	// 三种策略在同一趟渲染中估计，共用相机光线、求交与光源/材质样本，
+	// 分别写出 mis_comparison_mis.png、mis_comparison_light.png 与 mis_comparison_material.png
+	fmt::print("\nRendering with MIS, Light Sampling Only (NEE) and Material Sampling Only in one pass...\n");
+	constexpr std::array<SamplingStrategy, 3> STRATEGIES = {SamplingStrategy::MIS, SamplingStrategy::LIGHT,
+														   SamplingStrategy::MATERIAL};
+	SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
+	tracer.set_background(glm::vec3(0,0,0), false);
+	tracer.set_sampling_strategies(STRATEGIES);
+	tracer.render(world, lights, cam, "mis_comparison.png");
 }
 
 std::shared_ptr<Quad> MisComparisonApp::m_build_mirror(const glm::vec3& light, const glm::vec3& eye, const glm::vec3& pos, std::shared_ptr<Material> material) {
@@ -7,6 +7,7 @@
 #include "rt/materials/Lambertian.hpp"
 #include "rt/materials/Metal.hpp"
 #include <fmt/base.h>
+#include <array>
 #include <iostream>
 #include <fmt/core.h>
 
@@ -56,31 +57,14 @@ void PlaygroundApp::run() {
 		
 	Camera cam(lookfrom, lookat, vup, 40, ASPECT_RATIO);
 
-	// Render 1: MIS (Default)
-	{
-		fmt::print("\nRendering with MIS (Mixture Sampling)...\n");
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MIS);
-		tracer.render(world, lights, cam, "playground_mis.png");
-	}
-
-	// Render 2: Light Sampling Only
-	{
-		fmt::print("\nRendering with Light Sampling Only (NEE)...\n");
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::LIGHT);
-		tracer.render(world, lights, cam, "playground_light.png");
-	}
-
-	// Render 3: Material Sampling Only
-	{
-		fmt::print("\nRendering with Material Sampling Only (Standard Path Tracing)...\n");
-		SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
-		tracer.set_background(glm::vec3(0,0,0), false);
-		tracer.set_sampling_strategy(SamplingStrategy::MATERIAL);
-		tracer.render(world, lights, cam, "playground_material.png");
-	}
+	// 三种策略在同一趟渲染中估计，共用相机光线、求交与光源/材质样本，
+	// 分别写出 playground_mis.png、playground_light.png 与 playground_material.png
+	fmt::print("\nRendering with MIS, Light Sampling Only (NEE) and Material Sampling Only in one pass...\n");
+	constexpr std::array<SamplingStrategy, 3> STRATEGIES = {SamplingStrategy::MIS, SamplingStrategy::LIGHT,
+														   SamplingStrategy::MATERIAL};
+	SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
+	tracer.set_background(glm::vec3(0,0,0), false);
+	tracer.set_sampling_strategies(STRATEGIES);
+	tracer.render(world, lights, cam, "playground.png");
 }
 } // namespace rt
\ No newline at end of file
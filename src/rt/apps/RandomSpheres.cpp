@@ -1,12 +1,19 @@
 #include "rt/apps/RandomSpheres.hpp"
 #include "rt/SoftTracer.hpp"
 #include "rt/core/Camera.hpp"
+#include "rt/core/Utils.hpp"
+#include "rt/hittables/BVH.hpp"
 #include "rt/hittables/Scene.hpp"
 #include "rt/hittables/Sphere.hpp"
+#include "rt/hittables/SphereSet.hpp"
 #include "rt/materials/Lambertian.hpp"
 #include "rt/materials/Metal.hpp"
+#include "rt/sampling/PCG32Sampler.hpp"
 
 #include <fmt/base.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
 
 namespace rt {
 void RandomSpheresApp::run() {
@@ -32,6 +39,44 @@ void RandomSpheresApp::run() {
 	world.add(std::make_shared<Sphere>(glm::vec3(-1.0,    0.0, -1.0),   0.5, material_left));
 	world.add(std::make_shared<Sphere>(glm::vec3( 1.0,    0.0, -1.0),   0.5, material_right));
 
+	// 地面上随机散布的小球，用于体现加速结构的作用；按空间位置分组为 SphereSet，以 SIMD 批量求交
+	std::vector<std::shared_ptr<Sphere>> small_spheres;
+	constexpr int SPHERE_GRID = 40;
+	constexpr double SMALL_RADIUS = 0.03;
+	const std::array<glm::vec3, 3> big_centers = {glm::vec3(0, 0, -1), glm::vec3(-1, 0, -1), glm::vec3(1, 0, -1)};
+	// 场景生成使用固定种子，每次运行得到相同的场景
+	PCG32Sampler rng;
+	for (int a = -SPHERE_GRID; a < SPHERE_GRID; ++a) {
+		for (int b = 0; b < SPHERE_GRID; ++b) {
+			const double x = 0.1 * (a + 0.8 * random_double(rng));
+			const double z = -0.3 - 0.1 * (b + 0.8 * random_double(rng));
+			// 让小球贴在地面大球的表面上
+			const double y = -100.5 + std::sqrt(100.0 * 100.0 - x * x - (z + 1.0) * (z + 1.0)) + SMALL_RADIUS;
+			const glm::vec3 center(x, y, z);
+
+			const bool overlaps = std::ranges::any_of(big_centers, [&](const glm::vec3& c) {
+				return glm::length(glm::vec3(center.x, 0, center.z) - c) < 0.6F;
+			});
+			if (overlaps) continue;
+
+			const glm::vec3 albedo = random_vec3(rng) * random_vec3(rng);
+			if (random_double(rng) < 0.8) {
+				small_spheres.push_back(
+					std::make_shared<Sphere>(center, SMALL_RADIUS, std::make_shared<Lambertian>(albedo)));
+			} else {
+				small_spheres.push_back(
+					std::make_shared<Sphere>(center, SMALL_RADIUS, std::make_shared<Metal>(albedo, 0.5 * random_double(rng))));
+			}
+		}
+	}
+	for (const auto& cluster : SphereSet::make_clusters(small_spheres))
+		world.add(cluster);
+
+	BVH bvh(world);
+	const auto& stats = bvh.build_stats();
+	fmt::println("BVH: {} primitives, {} nodes, built in {:.2f} ms, SAH cost {:.2f}", stats.prim_count, stats.node_count,
+				 stats.build_ms, stats.sah_cost);
+
 	// Camera
 	Camera cam(glm::vec3(0,0,0), glm::vec3(0,0,-1), glm::vec3(0,1,0), 90, ASPECT_RATIO);
 
@@ -39,6 +84,7 @@ void RandomSpheresApp::run() {
 	auto lights = std::make_shared<Scene>();
 	SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
 	tracer.set_background(glm::vec3(0.70, 0.80, 1.00), true); // Use sky gradient
-	tracer.render(world, lights, cam, "random_spheres.png");
+	tracer.set_adaptive_sampling(0.05F); // 天空很快收敛，采样集中到金属球与地面上；热力图写入 random_spheres_spp.png
+	tracer.render(bvh, lights, cam, "random_spheres.png");
 }
 } // namespace rt
\ No newline at end of file
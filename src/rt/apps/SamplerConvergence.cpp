@@ -0,0 +1,142 @@
+#include "rt/apps/SamplerConvergence.hpp"
+#include "rt/SoftTracer.hpp"
+#include "rt/core/Camera.hpp"
+#include "rt/hittables/Quad.hpp"
+#include "rt/hittables/Scene.hpp"
+#include "rt/hittables/Sphere.hpp"
+#include "rt/materials/DiffuseLight.hpp"
+#include "rt/materials/Lambertian.hpp"
+#include "rt/materials/Metal.hpp"
+#include "rt/materials/WrongLambertian.hpp"
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace rt {
+
+namespace {
+
+constexpr int IMAGE_SIZE = 96;
+constexpr int REFERENCE_SPP = 4096;
+constexpr std::array<int, 5> SAMPLE_COUNTS = {4, 16, 64, 256, 1024};
+constexpr std::array<SamplerType, 3> SAMPLERS = {SamplerType::INDEPENDENT, SamplerType::SOBOL, SamplerType::PMJ02};
+
+/**
+ * @brief 待测场景与渲染设置。
+ */
+struct ConvergenceCase {
+	std::string name;
+	Scene world;
+	std::shared_ptr<Scene> lights = std::make_shared<Scene>();
+	Camera cam;
+	SamplingStrategy strategy;
+	IntegratorMode integrator;
+	int max_depth;
+};
+
+double rmse(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference) {
+	double sum = 0.0;
+	for (size_t k = 0; k < image.size(); ++k) {
+		const glm::vec3 d = image[k] - reference[k];
+		sum += glm::dot(d, d) / 3.0;
+	}
+	return std::sqrt(sum / static_cast<double>(image.size()));
+}
+
+std::vector<glm::vec3> render(const ConvergenceCase& c, const SamplerType sampler, const int spp, const int seed) {
+	SoftTracer tracer(IMAGE_SIZE, IMAGE_SIZE, spp, c.max_depth);
+	tracer.set_background(glm::vec3(0, 0, 0), false);
+	tracer.set_sampling_strategy(c.strategy);
+	tracer.set_integrator(c.integrator);
+	tracer.set_sampler(sampler);
+	tracer.set_seed(seed);
+	return tracer.render_framebuffer(c.world, c.lights, c.cam);
+}
+
+/**
+ * @brief CompareSamplingApp 的场景：Cornell Box 中一个 Lambertian 球与一个 WrongLambertian 球，只做材质采样。
+ */
+ConvergenceCase compare_sampling_case() {
+	ConvergenceCase c{"CompareSampling (material sampling)", Scene(), std::make_shared<Scene>(),
+					  Camera(glm::vec3(278, 278, -780), glm::vec3(278, 278, 0), glm::vec3(0, 1, 0), 40, 1.0),
+					  SamplingStrategy::MATERIAL, IntegratorMode::RECURSIVE, 70};
+
+	auto red   = std::make_shared<Lambertian>(glm::vec3(.65, .05, .05));
+	auto white = std::make_shared<Lambertian>(glm::vec3(.73, .73, .73));
+	auto green = std::make_shared<Lambertian>(glm::vec3(.12, .45, .15));
+	auto light = std::make_shared<DiffuseLight>(glm::vec3(15, 15, 15));
+
+	c.world.add(std::make_shared<Quad>(glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), green));
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), red));
+	auto light_shape =
+		std::make_shared<Quad>(glm::vec3(343, 554, 332), glm::vec3(-130, 0, 0), glm::vec3(0, 0, -105), light);
+	c.world.add(light_shape);
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 0, 0), glm::vec3(555, 0, 0), glm::vec3(0, 0, 555), white));
+	c.world.add(std::make_shared<Quad>(glm::vec3(555, 555, 555), glm::vec3(-555, 0, 0), glm::vec3(0, 0, -555), white));
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 0, 555), glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), white));
+	c.world.add(std::make_shared<Sphere>(glm::vec3(180, 100, 278), 100, white));
+	c.world.add(std::make_shared<Sphere>(glm::vec3(375, 100, 278), 100,
+										 std::make_shared<WrongLambertian>(glm::vec3(.73, .73, .73))));
+	c.lights->add(light_shape);
+	return c;
+}
+
+/**
+ * @brief MirrorBoxApp 的场景：镜面盒中的球形光源，MIS 与迭代积分器；深度降低以控制测量耗时。
+ */
+ConvergenceCase mirror_box_case() {
+	ConvergenceCase c{"MirrorBox (MIS)", Scene(), std::make_shared<Scene>(),
+					  Camera(glm::vec3(10, 250, 40), glm::vec3(278, 278, 100), glm::vec3(0, 1, 0), 40, 1.0),
+					  SamplingStrategy::MIS, IntegratorMode::ITERATIVE, 50};
+
+	auto mirror_mat = std::make_shared<Metal>(glm::vec3(0.9, 0.9, 0.9), 0.002);
+	auto perfect_mirror_mat = std::make_shared<Metal>(glm::vec3(0.9, 0.9, 0.9), 0);
+	auto red = std::make_shared<Lambertian>(glm::vec3(.65, .05, .05));
+	auto gray = std::make_shared<Lambertian>(glm::vec3(.2, .2, .2));
+	auto light = std::make_shared<DiffuseLight>(glm::vec3(12, 12, 12));
+
+	c.world.add(std::make_shared<Quad>(glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), mirror_mat));
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), mirror_mat));
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 0, 0), glm::vec3(700, 0, 0), glm::vec3(0, 0, 700), gray));
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 555, 0), glm::vec3(700, 0, 0), glm::vec3(0, 0, 700), mirror_mat));
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 0, 555), glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), mirror_mat));
+	c.world.add(std::make_shared<Quad>(glm::vec3(0, 0, 0), glm::vec3(700, 0, 0), glm::vec3(0, 700, 0), mirror_mat));
+
+	auto light_sphere = std::make_shared<Sphere>(glm::vec3(378, 70, 100), 70, light);
+	c.world.add(std::make_shared<Sphere>(glm::vec3(278, 100, 278), 100, red));
+	c.world.add(light_sphere);
+	c.world.add(std::make_shared<Sphere>(glm::vec3(350, 350, 350), 80, perfect_mirror_mat));
+	c.lights->add(light_sphere);
+	return c;
+}
+
+} // namespace
+
+void SamplerConvergenceApp::run() {
+	fmt::println("Running Sampler Convergence...");
+
+	for (const ConvergenceCase& c : {compare_sampling_case(), mirror_box_case()}) {
+		// 参考图像用与被测图像不同的种子，避免与被测序列相关
+		fmt::println("{}: rendering {} spp reference...", c.name, REFERENCE_SPP);
+		const std::vector<glm::vec3> reference = render(c, SamplerType::SOBOL, REFERENCE_SPP, 1);
+
+		std::vector<std::string> rows;
+		for (const int spp : SAMPLE_COUNTS) {
+			std::string row = fmt::format("{:>6}", spp);
+			for (const SamplerType sampler : SAMPLERS)
+				row += fmt::format(" {:>12.5f}", rmse(render(c, sampler, spp, 0), reference));
+			rows.push_back(row);
+		}
+
+		fmt::println("\n{} ({}x{}, RMSE vs {} spp reference)", c.name, IMAGE_SIZE, IMAGE_SIZE, REFERENCE_SPP);
+		fmt::println("{:>6} {:>12} {:>12} {:>12}", "spp", "independent", "sobol", "pmj02");
+		for (const auto& row : rows)
+			fmt::println("{}", row);
+	}
+}
+
+} // namespace rt
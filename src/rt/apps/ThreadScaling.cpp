@@ -0,0 +1,112 @@
+#include "rt/apps/ThreadScaling.hpp"
+#include "rt/SoftTracer.hpp"
+#include "rt/core/Camera.hpp"
+#include "rt/hittables/Quad.hpp"
+#include "rt/hittables/Scene.hpp"
+#include "rt/hittables/Sphere.hpp"
+#include "rt/materials/DiffuseLight.hpp"
+#include "rt/materials/Lambertian.hpp"
+#include "rt/materials/MaterialTable.hpp"
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <omp.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace rt {
+void ThreadScalingApp::run() {
+	fmt::println("Running Thread Scaling Benchmark...");
+
+	// Image
+	constexpr double ASPECT_RATIO	= 1.0;
+	constexpr int IMAGE_WIDTH		= 256;
+	constexpr int IMAGE_HEIGHT		= static_cast<int>(IMAGE_WIDTH / ASPECT_RATIO);
+	constexpr int SAMPLES_PER_PIXEL = 32;
+	constexpr int MAX_DEPTH			= 20;
+
+	// World：大部分表面共用同一个白色材质，所有线程都会频繁访问它
+	Scene world;
+
+	auto red   = std::make_shared<Lambertian>(glm::vec3(.65, .05, .05));
+	auto white = std::make_shared<Lambertian>(glm::vec3(.73, .73, .73));
+	auto green = std::make_shared<Lambertian>(glm::vec3(.12, .45, .15));
+	auto light = std::make_shared<DiffuseLight>(glm::vec3(15, 15, 15));
+
+	world.add(std::make_shared<Quad>(glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), green));
+	world.add(std::make_shared<Quad>(glm::vec3(0, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), red));
+	auto light_shape =
+		std::make_shared<Quad>(glm::vec3(343, 554, 332), glm::vec3(-130, 0, 0), glm::vec3(0, 0, -105), light);
+	world.add(light_shape);
+	world.add(std::make_shared<Quad>(glm::vec3(0, 0, 0), glm::vec3(555, 0, 0), glm::vec3(0, 0, 555), white));
+	world.add(std::make_shared<Quad>(glm::vec3(0, 555, 0), glm::vec3(555, 0, 0), glm::vec3(0, 0, 555), white));
+	world.add(std::make_shared<Quad>(glm::vec3(0, 0, 555), glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), white));
+	world.add(std::make_shared<Sphere>(glm::vec3(278, 100, 278), 100, white));
+
+	auto lights = std::make_shared<Scene>();
+	lights->add(light_shape);
+
+	// 内置材质编译进材质表，着色时按种类静态分发
+	auto materials = std::make_shared<MaterialTable>();
+	world.bind_materials(*materials);
+
+	// Camera
+	Camera cam(glm::vec3(278, 278, -800), glm::vec3(278, 278, 0), glm::vec3(0, 1, 0), 40, ASPECT_RATIO);
+
+	// 线程数按 1, 2, 4, ... 递增到 MAX_THREADS，并包含全部可用线程；超过核心数时用于观察超额订阅下的调度开销
+	constexpr int MAX_THREADS = 128;
+	const int max_threads = omp_get_max_threads();
+	std::vector<int> thread_counts;
+	for (int n = 1; n <= MAX_THREADS; n *= 2)
+		thread_counts.push_back(n);
+	if (std::ranges::find(thread_counts, max_threads) == thread_counts.end()) thread_counts.push_back(max_threads);
+	std::ranges::sort(thread_counts);
+
+	// 扫描线调度与两种边长的图块调度，渲染结果逐位相同，只比较耗时
+	struct Schedule {
+		const char* name;
+		RenderSchedule schedule;
+		int tile_size;
+	};
+	const std::array<Schedule, 3> schedules = {{
+		{"scanlines", RenderSchedule::SCANLINES, 0},
+		{"tiles 16", RenderSchedule::TILES, 16},
+		{"tiles 32", RenderSchedule::TILES, 32},
+	}};
+
+	constexpr double SAMPLE_COUNT = static_cast<double>(IMAGE_WIDTH) * IMAGE_HEIGHT * SAMPLES_PER_PIXEL;
+	std::array<double, 3> single_thread_ms{};
+	std::vector<std::string> rows;
+	for (const int threads : thread_counts) {
+		omp_set_num_threads(threads);
+		double scanline_ms = 0.0;
+		for (size_t k = 0; k < schedules.size(); ++k) {
+			SoftTracer tracer(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, MAX_DEPTH);
+			tracer.set_background(glm::vec3(0, 0, 0), false);
+			tracer.set_material_table(materials);
+			tracer.set_schedule(schedules[k].schedule, schedules[k].tile_size);
+
+			const auto start = std::chrono::steady_clock::now();
+			tracer.render_framebuffer(world, lights, cam);
+			const double ms =
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (threads == 1) single_thread_ms[k] = ms;
+			if (k == 0) scanline_ms = ms;
+
+			const double speedup = single_thread_ms[k] / ms;
+			rows.push_back(fmt::format("{:>7} {:>10} {:>10.1f} {:>12.2f} {:>8.2f} {:>10.0f}% {:>12.2f}", threads,
+									   schedules[k].name, ms, SAMPLE_COUNT / ms / 1000.0, speedup,
+									   100.0 * speedup / threads, scanline_ms / ms));
+		}
+	}
+	omp_set_num_threads(max_threads);
+
+	fmt::println("\n{:>7} {:>10} {:>10} {:>12} {:>8} {:>11} {:>12}", "threads", "schedule", "time (ms)", "Msamples/s",
+				 "speedup", "efficiency", "vs scanline");
+	for (const auto& row : rows)
+		fmt::println("{}", row);
+}
+} // namespace rt
@@ -0,0 +1,67 @@
+#include "rt/apps/ToneMapping.hpp"
+#include "rt/io/HDRImage.hpp"
+#include "rt/io/ToneMap.hpp"
+
+#include <fmt/base.h>
+#include <stb_image_write.h>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace rt {
+
+namespace {
+
+/**
+ * @brief 输出的色调映射变体。
+ */
+struct ToneMapVariant {
+	const char* suffix;
+	ToneMapSettings settings;
+};
+
+} // namespace
+
+void ToneMappingApp::run() {
+	fmt::print("HDR file to tone map (.pfm or .exr): ");
+	std::string input;
+	std::cin >> input;
+
+	const auto load_start = std::chrono::steady_clock::now();
+	HDRImage image;
+	try {
+		image = HDRImage::read(input);
+	} catch (const std::runtime_error& e) {
+		fmt::println("Failed to read {}: {}", input, e.what());
+		return;
+	}
+	const auto load_end = std::chrono::steady_clock::now();
+	fmt::println("Loaded {}x{} in {:.1f} ms", image.width, image.height,
+				 std::chrono::duration<double, std::milli>(load_end - load_start).count());
+
+	const std::array<ToneMapVariant, 5> variants = {{
+		{"_gamma", {}},
+		{"_srgb", {0.0F, ToneMapOperator::CLAMP, TransferFunction::SRGB}},
+		{"_reinhard", {0.0F, ToneMapOperator::REINHARD, TransferFunction::SRGB}},
+		{"_aces", {0.0F, ToneMapOperator::ACES, TransferFunction::SRGB}},
+		{"_aces_plus1ev", {1.0F, ToneMapOperator::ACES, TransferFunction::SRGB}},
+	}};
+
+	const std::filesystem::path path(input);
+	const std::string stem = (path.parent_path() / path.stem()).string();
+	for (const ToneMapVariant& variant : variants) {
+		const auto start = std::chrono::steady_clock::now();
+		const std::vector<unsigned char> image_data = tone_map(image.pixels, variant.settings);
+		const auto end = std::chrono::steady_clock::now();
+
+		const std::string output = stem + variant.suffix + ".png";
+		stbi_write_png(output.c_str(), image.width, image.height, 3, image_data.data(), image.width * 3);
+		fmt::println("{:<32} tone mapped in {:.2f} ms", output,
+					 std::chrono::duration<double, std::milli>(end - start).count());
+	}
+}
+
+} // namespace rt
@@ -0,0 +1,41 @@
+#include "rt/core/CpuFeatures.hpp"
+
+#if RT_ARCH_X86 && defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+CpuFeatures detect_cpu_features() {
+	CpuFeatures features;
+#if RT_ARCH_X86 && (defined(__GNUC__) || defined(__clang__))
+	__builtin_cpu_init();
+	features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	features.avx512f = __builtin_cpu_supports("avx512f");
+#elif RT_ARCH_X86 && defined(_MSC_VER)
+	int regs[4] = {};
+	__cpuid(regs, 1);
+	const bool osxsave = (regs[2] & (1 << 27)) != 0;
+	const bool fma = (regs[2] & (1 << 12)) != 0;
+	if (!osxsave) return features;
+	const unsigned long long xcr0 = _xgetbv(0);
+	const bool ymm_saved = (xcr0 & 0x6) == 0x6;
+	const bool zmm_saved = (xcr0 & 0xE6) == 0xE6;
+	__cpuidex(regs, 7, 0);
+	features.avx2 = ymm_saved && fma && (regs[1] & (1 << 5)) != 0;
+	features.avx512f = zmm_saved && (regs[1] & (1 << 16)) != 0;
+#endif
+	return features;
+}
+
+} // namespace
+
+const CpuFeatures& cpu_features() {
+	static const CpuFeatures FEATURES = detect_cpu_features();
+	return FEATURES;
+}
+
+} // namespace rt
@@ -0,0 +1,66 @@
+#include "rt/core/RadixSort.hpp"
+#include <omp.h>
+
+namespace rt {
+
+void radix_sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, const int key_bits) {
+	RadixSortBuffers buffers;
+	radix_sort(keys, values, key_bits, buffers);
+}
+
+void radix_sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, const int key_bits,
+				RadixSortBuffers& buffers) {
+	constexpr int RADIX_BITS = RadixSortBuffers::RADIX_BITS;
+	constexpr int RADIX_SIZE = RadixSortBuffers::RADIX_SIZE;
+	const size_t n = keys.size();
+	std::vector<std::uint64_t>& keys_tmp = buffers.keys;
+	std::vector<std::uint32_t>& values_tmp = buffers.values;
+	std::vector<std::array<size_t, RADIX_SIZE>>& offsets = buffers.offsets;
+	keys_tmp.resize(n);
+	values_tmp.resize(n);
+	offsets.resize(static_cast<size_t>(omp_get_max_threads()));
+
+	for (int shift = 0; shift < key_bits; shift += RADIX_BITS) {
+		bool uniform = false;
+#pragma omp parallel default(shared)
+		{
+			const auto n_threads = static_cast<size_t>(omp_get_num_threads());
+			const auto tid = static_cast<size_t>(omp_get_thread_num());
+			const size_t begin = n * tid / n_threads;
+			const size_t end = n * (tid + 1) / n_threads;
+
+			auto& hist = offsets[tid];
+			hist.fill(0);
+			for (size_t i = begin; i < end; ++i)
+				++hist[(keys[i] >> shift) & (RADIX_SIZE - 1)];
+
+#pragma omp barrier
+#pragma omp single
+			{
+				size_t sum = 0;
+				for (int digit = 0; digit < RADIX_SIZE; ++digit) {
+					const size_t digit_begin = sum;
+					for (size_t t = 0; t < n_threads; ++t) {
+						const size_t c = offsets[t][digit];
+						offsets[t][digit] = sum;
+						sum += c;
+					}
+					if (sum - digit_begin == n) uniform = true;
+				}
+			}
+
+			if (!uniform) {
+				for (size_t i = begin; i < end; ++i) {
+					const size_t dst = hist[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+					keys_tmp[dst] = keys[i];
+					values_tmp[dst] = values[i];
+				}
+			}
+		}
+		if (uniform) continue;
+		keys.swap(keys_tmp);
+		values.swap(values_tmp);
+	}
+}
+
+} // namespace rt
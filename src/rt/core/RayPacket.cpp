@@ -0,0 +1,160 @@
+#include "rt/core/RayPacket.hpp"
+#include "rt/core/CpuFeatures.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#if RT_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+/**
+ * @brief 将 double 类型的区间上界转换为 float，超出范围时取 inf（与 BVHTree::to_float_t 一致）。
+ */
+float to_float_t(const double t) {
+	constexpr auto FLOAT_MAX = static_cast<double>(std::numeric_limits<float>::max());
+	return t < FLOAT_MAX ? static_cast<float>(t) : std::numeric_limits<float>::infinity();
+}
+
+std::uint32_t intersect_box_scalar(const RayPacket& packet, const AABB& box, const std::uint32_t mask,
+								   const float t_min, const std::array<double, RayPacket::SIZE>& t_max) {
+	std::uint32_t result = 0;
+	for (std::uint32_t m = mask; m != 0; m &= m - 1) {
+		const int lane = std::countr_zero(m);
+		const glm::vec3 origin(packet.origin_x[lane], packet.origin_y[lane], packet.origin_z[lane]);
+		const glm::vec3 inv_dir(packet.inv_dir_x[lane], packet.inv_dir_y[lane], packet.inv_dir_z[lane]);
+		float t_entry = 0;
+		if (box.hit(origin, inv_dir, t_min, to_float_t(t_max[lane]), t_entry)) result |= 1U << lane;
+	}
+	return result;
+}
+
+#if RT_ARCH_X86
+
+RT_TARGET_AVX2 std::uint32_t intersect_box_avx2(const RayPacket& packet, const AABB& box, const std::uint32_t mask,
+												 const float t_min, const std::array<double, RayPacket::SIZE>& t_max) {
+	const __m256 ox = _mm256_load_ps(packet.origin_x.data());
+	const __m256 oy = _mm256_load_ps(packet.origin_y.data());
+	const __m256 oz = _mm256_load_ps(packet.origin_z.data());
+	const __m256 ix = _mm256_load_ps(packet.inv_dir_x.data());
+	const __m256 iy = _mm256_load_ps(packet.inv_dir_y.data());
+	const __m256 iz = _mm256_load_ps(packet.inv_dir_z.data());
+
+	// 各通道方向符号不同，按方向倒数的符号位逐通道选择近/远平面
+	const __m256 lo_x = _mm256_blendv_ps(_mm256_set1_ps(box.min().x), _mm256_set1_ps(box.max().x), ix);
+	const __m256 hi_x = _mm256_blendv_ps(_mm256_set1_ps(box.max().x), _mm256_set1_ps(box.min().x), ix);
+	const __m256 lo_y = _mm256_blendv_ps(_mm256_set1_ps(box.min().y), _mm256_set1_ps(box.max().y), iy);
+	const __m256 hi_y = _mm256_blendv_ps(_mm256_set1_ps(box.max().y), _mm256_set1_ps(box.min().y), iy);
+	const __m256 lo_z = _mm256_blendv_ps(_mm256_set1_ps(box.min().z), _mm256_set1_ps(box.max().z), iz);
+	const __m256 hi_z = _mm256_blendv_ps(_mm256_set1_ps(box.max().z), _mm256_set1_ps(box.min().z), iz);
+
+	// 与 WideBVH 相同，累积值放在 max_ps/min_ps 的第二个操作数，忽略 0 * inf 产生的 NaN
+	const __m256 scale = _mm256_set1_ps(AABB::SLAB_ROBUST_SCALE);
+	__m256 t_enter = _mm256_set1_ps(t_min);
+	t_enter = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(lo_x, ox), ix), t_enter);
+	t_enter = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(lo_y, oy), iy), t_enter);
+	t_enter = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(lo_z, oz), iz), t_enter);
+
+	// double 转 float 时超出范围的值变为 inf，与 to_float_t 一致
+	__m256 t_exit = _mm256_set_m128(_mm256_cvtpd_ps(_mm256_loadu_pd(t_max.data() + 4)),
+									_mm256_cvtpd_ps(_mm256_loadu_pd(t_max.data())));
+	t_exit = _mm256_min_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(hi_x, ox), ix), scale), t_exit);
+	t_exit = _mm256_min_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(hi_y, oy), iy), scale), t_exit);
+	t_exit = _mm256_min_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(hi_z, oz), iz), scale), t_exit);
+
+	return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(t_enter, t_exit, _CMP_LE_OQ))) & mask;
+}
+
+#endif
+
+/**
+ * @brief 区间乘法 [a_lo, a_hi] * [b_lo, b_hi]，返回乘积区间的下界与上界。
+ */
+std::pair<float, float> interval_mul(const float a_lo, const float a_hi, const float b_lo, const float b_hi) {
+	const float p0 = a_lo * b_lo;
+	const float p1 = a_lo * b_hi;
+	const float p2 = a_hi * b_lo;
+	const float p3 = a_hi * b_hi;
+	return {std::min({p0, p1, p2, p3}), std::max({p0, p1, p2, p3})};
+}
+
+} // namespace
+
+void RayPacket::set(const int lane, const Ray& r) {
+	const glm::vec3 origin = r.origin();
+	const glm::vec3 dir = r.direction();
+	const glm::vec3 inv_dir = 1.0F / dir;
+	origin_x[lane] = origin.x;
+	origin_y[lane] = origin.y;
+	origin_z[lane] = origin.z;
+	dir_x[lane] = dir.x;
+	dir_y[lane] = dir.y;
+	dir_z[lane] = dir.z;
+	inv_dir_x[lane] = inv_dir.x;
+	inv_dir_y[lane] = inv_dir.y;
+	inv_dir_z[lane] = inv_dir.z;
+	valid |= 1U << lane;
+}
+
+std::uint32_t RayPacket::intersect_box(const AABB& box, const std::uint32_t mask, const float t_min,
+									   const std::array<double, SIZE>& t_max) const {
+#if RT_ARCH_X86
+	if (cpu_features().avx2) return intersect_box_avx2(*this, box, mask, t_min, t_max);
+#endif
+	return intersect_box_scalar(*this, box, mask, t_min, t_max);
+}
+
+PacketFrustum::PacketFrustum(const RayPacket& packet, const std::uint32_t mask) {
+	if (mask == 0) return;
+
+	constexpr float INF = std::numeric_limits<float>::infinity();
+	_origin_min = glm::vec3(INF);
+	_origin_max = glm::vec3(-INF);
+	_inv_dir_min = glm::vec3(INF);
+	_inv_dir_max = glm::vec3(-INF);
+	for (std::uint32_t m = mask; m != 0; m &= m - 1) {
+		const int lane = std::countr_zero(m);
+		const glm::vec3 origin(packet.origin_x[lane], packet.origin_y[lane], packet.origin_z[lane]);
+		const glm::vec3 inv_dir(packet.inv_dir_x[lane], packet.inv_dir_y[lane], packet.inv_dir_z[lane]);
+		_origin_min = glm::min(_origin_min, origin);
+		_origin_max = glm::max(_origin_max, origin);
+		_inv_dir_min = glm::min(_inv_dir_min, inv_dir);
+		_inv_dir_max = glm::max(_inv_dir_max, inv_dir);
+	}
+
+	_valid = true;
+	for (int a = 0; a < 3; ++a) {
+		const bool same_sign = _inv_dir_min[a] > 0 || _inv_dir_max[a] < 0;
+		if (!same_sign || !std::isfinite(_inv_dir_min[a]) || !std::isfinite(_inv_dir_max[a])) _valid = false;
+	}
+}
+
+bool PacketFrustum::may_hit(const AABB& box, const float t_min, const float t_max) const {
+	if (!_valid) return true;
+
+	float t_enter = t_min;
+	float t_exit = t_max;
+	for (int a = 0; a < 3; ++a) {
+		const bool neg = _inv_dir_max[a] < 0;
+		const float near_plane = neg ? box.max()[a] : box.min()[a];
+		const float far_plane = neg ? box.min()[a] : box.max()[a];
+		// 任一通道的进入距离不小于 near_lo，离开距离不大于 far_hi
+		const float near_lo = interval_mul(near_plane - _origin_max[a], near_plane - _origin_min[a], _inv_dir_min[a],
+										   _inv_dir_max[a]).first;
+		const float far_hi = interval_mul(far_plane - _origin_max[a], far_plane - _origin_min[a], _inv_dir_min[a],
+										  _inv_dir_max[a]).second;
+		// 向外放宽一个舍入误差界，保证剔除是保守的
+		constexpr float SCALE = AABB::SLAB_ROBUST_SCALE;
+		t_enter = std::max(t_enter, near_lo >= 0 ? near_lo / SCALE : near_lo * SCALE);
+		t_exit = std::min(t_exit, far_hi >= 0 ? far_hi * SCALE : far_hi / SCALE);
+	}
+	return t_enter <= t_exit;
+}
+
+} // namespace rt
@@ -0,0 +1,141 @@
+#include "rt/core/TileScheduler.hpp"
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <utility>
+
+namespace rt {
+
+namespace {
+
+/**
+ * @brief 点 (x, y) 在边长为 n（2 的幂）的 Hilbert 曲线上的序号。
+ */
+std::uint64_t hilbert_index(const std::uint32_t n, std::uint32_t x, std::uint32_t y) {
+	std::uint64_t d = 0;
+	for (std::uint32_t s = n / 2; s > 0; s /= 2) {
+		const std::uint32_t rx = (x & s) != 0 ? 1 : 0;
+		const std::uint32_t ry = (y & s) != 0 ? 1 : 0;
+		d += std::uint64_t{s} * s * ((3 * rx) ^ ry);
+		// 旋转象限，使子曲线首尾相接
+		if (ry == 0) {
+			if (rx == 1) {
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+/**
+ * @brief 取出 Morton 码中偶数位上的比特并压紧。
+ */
+std::uint32_t compact_bits(std::uint32_t v) {
+	v &= 0x55555555U;
+	v = (v | (v >> 1U)) & 0x33333333U;
+	v = (v | (v >> 2U)) & 0x0f0f0f0fU;
+	v = (v | (v >> 4U)) & 0x00ff00ffU;
+	v = (v | (v >> 8U)) & 0x0000ffffU;
+	return v;
+}
+
+constexpr std::uint64_t pack_range(const std::uint32_t begin, const std::uint32_t end) {
+	return (std::uint64_t{begin} << 32U) | end;
+}
+
+} // namespace
+
+TileScheduler::TileScheduler(const int width, const int height, const int tile_size) {
+	const std::uint32_t size = std::bit_ceil(static_cast<std::uint32_t>(std::max(tile_size, 1)));
+	const auto tiles_x = static_cast<std::uint32_t>((width + size - 1) / size);
+	const auto tiles_y = static_cast<std::uint32_t>((height + size - 1) / size);
+	const std::uint32_t side = std::bit_ceil(std::max({tiles_x, tiles_y, 1U}));
+
+	std::vector<std::uint64_t> keys(static_cast<size_t>(tiles_x) * tiles_y);
+	for (std::uint32_t ty = 0; ty < tiles_y; ++ty)
+		for (std::uint32_t tx = 0; tx < tiles_x; ++tx)
+			keys[ty * tiles_x + tx] = hilbert_index(side, tx, ty);
+	std::vector<std::uint32_t> tiles(keys.size());
+	std::iota(tiles.begin(), tiles.end(), 0U);
+	std::ranges::sort(tiles, {}, [&](const std::uint32_t t) { return keys[t]; });
+
+	_order.reserve(static_cast<size_t>(width) * height);
+	_order_tiles.reserve(tiles.size() + 1);
+	for (const std::uint32_t t : tiles) {
+		_order_tiles.push_back(static_cast<std::uint32_t>(_order.size()));
+		const std::uint32_t x0 = t % tiles_x * size;
+		const std::uint32_t y0 = t / tiles_x * size;
+		for (std::uint32_t m = 0; m < size * size; ++m) {
+			const std::uint32_t x = x0 + compact_bits(m);
+			const std::uint32_t y = y0 + compact_bits(m >> 1U);
+			if (x < static_cast<std::uint32_t>(width) && y < static_cast<std::uint32_t>(height))
+				_order.push_back(y * static_cast<std::uint32_t>(width) + x);
+		}
+	}
+	_order_tiles.push_back(static_cast<std::uint32_t>(_order.size()));
+}
+
+void TileScheduler::assign(const std::span<const std::uint32_t> pixels, const int thread_count) {
+	if (pixels.size() == _order.size()) {
+		_pixels = _order;
+		_tiles = _order_tiles;
+	} else {
+		std::vector<unsigned char> active(_order.size(), 0);
+		for (const std::uint32_t pixel : pixels)
+			active[pixel] = 1;
+		_pixels.clear();
+		_tiles.clear();
+		for (size_t t = 0; t + 1 < _order_tiles.size(); ++t) {
+			const auto first = static_cast<std::uint32_t>(_pixels.size());
+			for (std::uint32_t k = _order_tiles[t]; k < _order_tiles[t + 1]; ++k)
+				if (active[_order[k]] != 0) _pixels.push_back(_order[k]);
+			if (_pixels.size() > first) _tiles.push_back(first);
+		}
+		_tiles.push_back(static_cast<std::uint32_t>(_pixels.size()));
+	}
+
+	// 按曲线顺序切成连续的段，每个线程从屏幕上相邻的一片区域开始
+	_queue_count = std::max(thread_count, 1);
+	_queues = std::make_unique<Queue[]>(_queue_count);
+	const size_t tile_count = _tiles.size() - 1;
+	for (int q = 0; q < _queue_count; ++q) {
+		const auto begin = static_cast<std::uint32_t>(tile_count * q / _queue_count);
+		const auto end = static_cast<std::uint32_t>(tile_count * (q + 1) / _queue_count);
+		_queues[q].range.store(pack_range(begin, end), std::memory_order_relaxed);
+	}
+}
+
+bool TileScheduler::next(const int thread, std::span<const std::uint32_t>& tile) {
+	const auto take = [&](Queue& queue, const bool front) {
+		std::uint64_t range = queue.range.load(std::memory_order_relaxed);
+		while (true) {
+			const auto begin = static_cast<std::uint32_t>(range >> 32U);
+			const auto end = static_cast<std::uint32_t>(range);
+			if (begin >= end) return false;
+			const std::uint32_t index = front ? begin : end - 1;
+			const std::uint64_t rest = front ? pack_range(begin + 1, end) : pack_range(begin, end - 1);
+			if (queue.range.compare_exchange_weak(range, rest, std::memory_order_relaxed)) {
+				tile = std::span<const std::uint32_t>(_pixels).subspan(_tiles[index],
+																	   _tiles[index + 1] - _tiles[index]);
+				return true;
+			}
+		}
+	};
+
+	if (take(_queues[thread], true)) return true;
+	// 队列只会缩短，依次检查一遍其他队列都为空时全部图块已经取完
+	for (int k = 1; k < _queue_count; ++k)
+		if (take(_queues[(thread + k) % _queue_count], false)) return true;
+	return false;
+}
+
+size_t TileScheduler::finished() const {
+	size_t total = 0;
+	for (int q = 0; q < _queue_count; ++q)
+		total += _queues[q].finished.load(std::memory_order_relaxed);
+	return total;
+}
+
+} // namespace rt
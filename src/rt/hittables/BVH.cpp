@@ -0,0 +1,190 @@
+#include "rt/hittables/BVH.hpp"
+#include "rt/materials/MaterialTable.hpp"
+#include "rt/core/Utils.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+namespace rt {
+
+namespace {
+
+std::vector<AABB> object_bounds(const std::vector<shared_ptr<Hittable>>& objects) {
+	std::vector<AABB> bounds(objects.size());
+	const auto n = static_cast<std::int64_t>(objects.size());
+#pragma omp parallel for schedule(static)
+	for (std::int64_t i = 0; i < n; ++i)
+		bounds[i] = objects[i]->bounding_box();
+	return bounds;
+}
+
+} // namespace
+
+BVH::BVH(std::vector<shared_ptr<Hittable>> objects, const BVHBuildMode mode, const BVHLayout layout) :
+	_objects(std::move(objects)), _mode(mode), _layout(layout) {
+	_build();
+}
+
+void BVH::_build() {
+	_tree.build(object_bounds(_objects), _mode);
+	if (_layout == BVHLayout::WIDE8) _wide.build(_tree);
+
+	// 按叶子顺序重排对象，使叶节点中的对象在内存中连续
+	std::vector<shared_ptr<Hittable>> sorted;
+	sorted.reserve(_objects.size());
+	for (const auto idx : _tree.indices())
+		sorted.push_back(std::move(_objects[idx]));
+	_objects = std::move(sorted);
+}
+
+BVHRefitStats BVH::refit() {
+	const auto start = std::chrono::steady_clock::now();
+	BVHRefitStats stats;
+
+	// 对象已按叶子顺序排列，包围盒数组可直接作为叶子顺序的图元包围盒
+	stats.sah_cost = _tree.refit(object_bounds(_objects));
+	const float built_cost = _tree.stats().sah_cost;
+	stats.degradation = built_cost > 0.0F ? stats.sah_cost / built_cost : 1.0F;
+	if (stats.degradation > _rebuild_threshold) {
+		_build();
+		stats.sah_cost = _tree.stats().sah_cost;
+		stats.rebuilt = true;
+	} else if (_layout == BVHLayout::WIDE8) {
+		// 8 叉节点由二叉节点折叠而来，折叠只需线性时间，直接重新折叠
+		_wide.build(_tree);
+	}
+
+	stats.refit_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return stats;
+}
+
+bool BVH::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+	HitRecord temp_rec;
+	auto closest_so_far = t_max;
+
+	const auto leaf = [&](const std::uint32_t first, const std::uint32_t count, double& t_closest) {
+		bool hit_leaf = false;
+		for (std::uint32_t i = first; i < first + count; ++i) {
+			if (_objects[i]->hit(r, t_min, t_closest, temp_rec)) {
+				hit_leaf = true;
+				t_closest = temp_rec.t;
+				rec = temp_rec;
+			}
+		}
+		return hit_leaf;
+	};
+
+	if (!_wide.empty()) return _wide.intersect(r, t_min, closest_so_far, leaf);
+	return _tree.intersect(r, t_min, closest_so_far, leaf);
+}
+
+bool BVH::occluded(const Ray& r, const double t_min, const double t_max) const {
+	const auto leaf = [&](const std::uint32_t first, const std::uint32_t count) {
+		for (std::uint32_t i = first; i < first + count; ++i)
+			if (_objects[i]->occluded(r, t_min, t_max)) return true;
+		return false;
+	};
+
+	if (!_wide.empty()) return _wide.occluded(r, t_min, t_max, leaf);
+	return _tree.occluded(r, t_min, t_max, leaf);
+}
+
+std::uint32_t BVH::hit_packet(const RayPacket& packet, const std::uint32_t active, const double t_min,
+							  PacketHitRecord& hits) const {
+	const auto& nodes = _tree.nodes();
+	if (nodes.empty() || active == 0) return 0;
+
+	const PacketFrustum frustum(packet, active);
+	const auto t_min_f = static_cast<float>(t_min);
+	std::uint32_t hit_mask = 0;
+
+	// 发散后的单条光线从子树根开始遍历，叶回调与 hit 相同
+	const auto trace_single = [&](const std::uint32_t root, const int lane) {
+		const Ray r = packet.ray(lane);
+		HitRecord temp_rec;
+		const auto leaf = [&](const std::uint32_t first, const std::uint32_t count, double& t_closest) {
+			bool hit_leaf = false;
+			for (std::uint32_t i = first; i < first + count; ++i) {
+				if (_objects[i]->hit(r, t_min, t_closest, temp_rec)) {
+					hit_leaf = true;
+					t_closest = temp_rec.t;
+					hits.rec[lane] = temp_rec;
+				}
+			}
+			return hit_leaf;
+		};
+		if (_tree.intersect(r, t_min, hits.t_max[lane], leaf, root)) hit_mask |= 1U << lane;
+	};
+
+	struct StackEntry {
+		std::uint32_t node; ///< 待访问的节点。
+		std::uint32_t mask; ///< 父节点处仍与包围盒相交的通道。
+	};
+	std::array<StackEntry, BVHTree::MAX_DEPTH> stack{};
+	int stack_size = 0;
+	StackEntry entry{0, active};
+
+	while (true) {
+		const BVHNode& node = nodes[entry.node];
+		// 视锥剔除只需一次标量测试；未剔除时再逐通道测试，节点在出栈时测试，使用已收缩的 t_max
+		double t_far = t_min;
+		for (std::uint32_t m = entry.mask; m != 0; m &= m - 1)
+			t_far = std::max(t_far, hits.t_max[std::countr_zero(m)]);
+		std::uint32_t mask = 0;
+		if (frustum.may_hit(node.bounds, t_min_f, BVHTree::to_float_t(t_far)))
+			mask = packet.intersect_box(node.bounds, entry.mask, t_min_f, hits.t_max);
+
+		if (mask != 0) {
+			if (std::popcount(mask) <= PACKET_FALLBACK_LANES) {
+				for (std::uint32_t m = mask; m != 0; m &= m - 1)
+					trace_single(entry.node, std::countr_zero(m));
+			} else if (node.is_leaf()) {
+				for (std::uint32_t i = node.offset; i < node.offset + static_cast<std::uint32_t>(node.count); ++i)
+					hit_mask |= _objects[i]->hit_packet(packet, mask, t_min, hits);
+			} else {
+				// 相干光线方向一致，按首个活跃通道的方向符号先访问近侧子节点
+				const int lane = std::countr_zero(mask);
+				const float dir = node.axis == 0   ? packet.dir_x[lane]
+								  : node.axis == 1 ? packet.dir_y[lane]
+												   : packet.dir_z[lane];
+				if (dir < 0) {
+					stack[stack_size++] = {entry.node + 1, mask};
+					entry = {node.offset, mask};
+				} else {
+					stack[stack_size++] = {node.offset, mask};
+					entry = {entry.node + 1, mask};
+				}
+				continue;
+			}
+		}
+		if (stack_size == 0) break;
+		entry = stack[--stack_size];
+	}
+
+	hits.hit_mask |= hit_mask;
+	return hit_mask;
+}
+
+double BVH::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
+	if (_objects.empty()) return 0.0;
+
+	auto sum = 0.0;
+	for (const auto& obj : _objects)
+		sum += obj->pdf_value(origin, v);
+
+	return sum / static_cast<double>(_objects.size());
+}
+
+glm::vec3 BVH::random(const glm::vec3& origin, Sampler& sampler) const {
+	if (_objects.empty()) return {1, 0, 0};
+
+	const auto int_size = static_cast<int>(_objects.size());
+	return _objects[random_int(sampler, 0, int_size - 1)]->random(origin, sampler);
+}
+
+void BVH::bind_materials(MaterialTable& table) {
+	for (const auto& object : _objects)
+		object->bind_materials(table);
+}
+
+} // namespace rt
@@ -0,0 +1,22 @@
+#include "rt/hittables/Hittable.hpp"
+#include <bit>
+
+namespace rt {
+
+std::uint32_t Hittable::hit_packet(const RayPacket& packet, const std::uint32_t active, const double t_min,
+								   PacketHitRecord& hits) const {
+	std::uint32_t hit_mask = 0;
+	HitRecord temp_rec;
+	for (std::uint32_t m = active; m != 0; m &= m - 1) {
+		const int lane = std::countr_zero(m);
+		if (hit(packet.ray(lane), t_min, hits.t_max[lane], temp_rec)) {
+			hits.t_max[lane] = temp_rec.t;
+			hits.rec[lane] = temp_rec;
+			hit_mask |= 1U << lane;
+		}
+	}
+	hits.hit_mask |= hit_mask;
+	return hit_mask;
+}
+
+} // namespace rt
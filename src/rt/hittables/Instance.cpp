@@ -0,0 +1,97 @@
+#include "rt/hittables/Instance.hpp"
+#include "rt/materials/MaterialTable.hpp"
+
+namespace rt {
+
+InstanceRecord InstanceRecord::make(const glm::mat4& object_to_world, const std::uint32_t blas_id,
+									const std::uint32_t material_id, const std::uint32_t instance_id) {
+	const glm::mat4 inv = glm::inverse(object_to_world);
+	InstanceRecord record;
+	for (int row = 0; row < 3; ++row)
+		for (int col = 0; col < 4; ++col)
+			record.world_to_object[4 * row + col] = inv[col][row];
+	record.blas_id = blas_id;
+	record.material_id = material_id;
+	record.instance_id = instance_id;
+	return record;
+}
+
+glm::vec3 InstanceRecord::point_to_object(const glm::vec3& p) const {
+	const auto& m = world_to_object;
+	return {m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3], m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7],
+			m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11]};
+}
+
+glm::vec3 InstanceRecord::vector_to_object(const glm::vec3& v) const {
+	const auto& m = world_to_object;
+	return {m[0] * v.x + m[1] * v.y + m[2] * v.z, m[4] * v.x + m[5] * v.y + m[6] * v.z,
+			m[8] * v.x + m[9] * v.y + m[10] * v.z};
+}
+
+glm::vec3 InstanceRecord::normal_to_world(const glm::vec3& n) const {
+	const auto& m = world_to_object;
+	return glm::normalize(glm::vec3(m[0] * n.x + m[4] * n.y + m[8] * n.z, m[1] * n.x + m[5] * n.y + m[9] * n.z,
+									m[2] * n.x + m[6] * n.y + m[10] * n.z));
+}
+
+glm::mat4 InstanceRecord::object_to_world() const {
+	glm::mat4 inv(1.0F);
+	for (int row = 0; row < 3; ++row)
+		for (int col = 0; col < 4; ++col)
+			inv[col][row] = world_to_object[4 * row + col];
+	return glm::inverse(inv);
+}
+
+AABB InstanceRecord::world_bounds(const AABB& object_bounds) const {
+	if (object_bounds.empty()) return {};
+	const glm::mat4 m = object_to_world();
+	AABB box;
+	for (int corner = 0; corner < 8; ++corner) {
+		const glm::vec3 p((corner & 1) != 0 ? object_bounds.max().x : object_bounds.min().x,
+						  (corner & 2) != 0 ? object_bounds.max().y : object_bounds.min().y,
+						  (corner & 4) != 0 ? object_bounds.max().z : object_bounds.min().z);
+		box.expand(glm::vec3(m * glm::vec4(p, 1.0F)));
+	}
+	return box;
+}
+
+bool InstanceRecord::hit(const Hittable& blas, const Ray& r, const double t_min, const double t_max,
+						 HitRecord& rec) const {
+	const Ray local(point_to_object(r.origin()), vector_to_object(r.direction()));
+	if (!blas.hit(local, t_min, t_max, rec)) return false;
+
+	// 方向未归一化，t 在两个空间中一致；法线已按物体空间光线定向，变换后与世界空间光线的相对朝向不变
+	rec.p = r.at(rec.t);
+	rec.normal = normal_to_world(rec.normal);
+	return true;
+}
+
+double InstanceRecord::pdf_value(const Hittable& blas, const glm::vec3& origin, const glm::vec3& v) const {
+	return blas.pdf_value(point_to_object(origin), vector_to_object(v));
+}
+
+glm::vec3 InstanceRecord::random(const Hittable& blas, const glm::vec3& origin, Sampler& sampler) const {
+	const glm::vec3 local = blas.random(point_to_object(origin), sampler);
+	return glm::vec3(object_to_world() * glm::vec4(local, 0.0F));
+}
+
+Instance::Instance(std::shared_ptr<Hittable> blas, const glm::mat4& object_to_world,
+				   std::shared_ptr<Material> material) :
+	_blas(std::move(blas)), _material(std::move(material)), _record(InstanceRecord::make(object_to_world, 0)),
+	_bounds(_record.world_bounds(_blas->bounding_box())) {}
+
+bool Instance::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+	if (!_record.hit(*_blas, r, t_min, t_max, rec)) return false;
+	if (_material) {
+		rec.mat_ptr = _material.get();
+		rec.material_id = _material_id;
+	}
+	return true;
+}
+
+void Instance::bind_materials(MaterialTable& table) {
+	_blas->bind_materials(table);
+	if (_material) _material_id = table.add(_material);
+}
+
+} // namespace rt
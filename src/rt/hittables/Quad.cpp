@@ -1,36 +1,214 @@
 #include "rt/hittables/Quad.hpp"
+#include "rt/materials/MaterialTable.hpp"
 #include "rt/core/Utils.hpp"
+#include "rt/core/CpuFeatures.hpp"
+#include <bit>
 #include <cmath>
 
+#if RT_ARCH_X86
+#include <immintrin.h>
+#endif
+
 namespace rt {
 
-bool Quad::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+namespace {
+
+/**
+ * @brief 四边形的平面参数，在光线包各通道间共享。
+ */
+struct QuadLanes {
+	glm::vec3 normal;	  ///< 单位法线。
+	float d_param;		  ///< 平面方程常数。
+	glm::vec3 corner;	  ///< 角点。
+	glm::vec3 alpha_axis; ///< v × w：与交点相对角点的向量点乘得到 alpha = w · (p × v)。
+	glm::vec3 beta_axis;  ///< w × u：点乘得到 beta = w · (u × p)。
+};
+
+#if RT_ARCH_X86
+
+/**
+ * @brief 单精度候选测试的相对误差余量，远大于单精度与双精度求交之间的舍入差异。
+ */
+constexpr float PACKET_EPSILON = 0x1p-16F;
+
+/**
+ * @brief 返回 |x|。
+ */
+RT_TARGET_AVX2 __m256 abs_ps(const __m256 x) {
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0F), x);
+}
+
+/**
+ * @brief 返回 |x| + |y| + |z|，用于估计三项和的舍入误差。
+ */
+RT_TARGET_AVX2 __m256 sum_abs(const __m256 x, const __m256 y, const __m256 z) {
+	return _mm256_add_ps(_mm256_add_ps(abs_ps(x), abs_ps(y)), abs_ps(z));
+}
+
+/**
+ * @brief 交点相对角点的向量 p 在 axis 上的投影（即 alpha 或 beta），err 为由 p 各分量的误差界 e 得到的误差界。
+ */
+RT_TARGET_AVX2 __m256 planar_coordinate(const __m256 px, const __m256 py, const __m256 pz, const __m256 ex,
+										const __m256 ey, const __m256 ez, const glm::vec3& axis, __m256& err) {
+	const __m256 ax = _mm256_set1_ps(axis.x);
+	const __m256 ay = _mm256_set1_ps(axis.y);
+	const __m256 az = _mm256_set1_ps(axis.z);
+	const __m256 value = _mm256_fmadd_ps(pz, az, _mm256_fmadd_ps(py, ay, _mm256_mul_ps(px, ax)));
+	err = _mm256_fmadd_ps(ez, abs_ps(az), _mm256_fmadd_ps(ey, abs_ps(ay), _mm256_mul_ps(ex, abs_ps(ax))));
+	err = _mm256_fmadd_ps(_mm256_set1_ps(PACKET_EPSILON), abs_ps(value), err);
+	return value;
+}
+
+/**
+ * @brief 光线包的 8 个通道与同一个四边形做保守的候选测试，返回候选掩码。
+ *
+ * 分母、t 与平面坐标各自按误差界放宽，分母接近舍入误差的通道直接作为候选，因此双精度 Quad::hit
+ * 能击中的通道一定是候选（边缘与掠射处也不会丢失），多出的候选由双精度求交排除。
+ */
+RT_TARGET_AVX2 std::uint32_t intersect_packet_avx2(const RayPacket& packet, const QuadLanes& q, const float t_min,
+												   const std::array<double, RayPacket::SIZE>& t_max) {
+	const __m256 dx = _mm256_load_ps(packet.dir_x.data());
+	const __m256 dy = _mm256_load_ps(packet.dir_y.data());
+	const __m256 dz = _mm256_load_ps(packet.dir_z.data());
+	const __m256 ox = _mm256_load_ps(packet.origin_x.data());
+	const __m256 oy = _mm256_load_ps(packet.origin_y.data());
+	const __m256 oz = _mm256_load_ps(packet.origin_z.data());
+	const __m256 nx = _mm256_set1_ps(q.normal.x);
+	const __m256 ny = _mm256_set1_ps(q.normal.y);
+	const __m256 nz = _mm256_set1_ps(q.normal.z);
+	const __m256 eps = _mm256_set1_ps(PACKET_EPSILON);
+
+	// 光线平行于平面时不相交；法线为单位向量，分母的误差不超过 eps * |d|_1
+	const __m256 denom = _mm256_fmadd_ps(nz, dz, _mm256_fmadd_ps(ny, dy, _mm256_mul_ps(nx, dx)));
+	const __m256 abs_denom = abs_ps(denom);
+	const __m256 denom_err = _mm256_mul_ps(eps, sum_abs(dx, dy, dz));
+	const __m256 not_parallel =
+		_mm256_cmp_ps(_mm256_add_ps(abs_denom, denom_err), _mm256_set1_ps(1e-8F), _CMP_GE_OQ);
+	const __m256 uncertain = _mm256_cmp_ps(abs_denom, _mm256_add_ps(denom_err, denom_err), _CMP_LE_OQ);
+
+	const __m256 d_param = _mm256_set1_ps(q.d_param);
+	const __m256 n_dot_o = _mm256_fmadd_ps(nz, oz, _mm256_fmadd_ps(ny, oy, _mm256_mul_ps(nx, ox)));
+	const __m256 t_hit = _mm256_div_ps(_mm256_sub_ps(d_param, n_dot_o), denom);
+	const __m256 num_err = _mm256_mul_ps(eps, _mm256_add_ps(abs_ps(d_param), sum_abs(ox, oy, oz)));
+	const __m256 t_err = _mm256_div_ps(_mm256_fmadd_ps(abs_ps(t_hit), denom_err, num_err),
+									   _mm256_sub_ps(abs_denom, denom_err));
+	const __m256 hi = _mm256_set_m128(_mm256_cvtpd_ps(_mm256_loadu_pd(t_max.data() + 4)),
+									  _mm256_cvtpd_ps(_mm256_loadu_pd(t_max.data())));
+	__m256 hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(t_hit, t_err), _mm256_set1_ps(t_min), _CMP_GE_OQ),
+							   _mm256_cmp_ps(_mm256_sub_ps(t_hit, t_err), hi, _CMP_LE_OQ));
+	if (_mm256_movemask_ps(_mm256_and_ps(not_parallel, _mm256_or_ps(uncertain, hit))) == 0) return 0;
+
+	// 交点相对角点的向量，以及每个分量的误差界：t 的误差沿方向传播，再加上各项的舍入
+	const __m256 tdx = _mm256_mul_ps(t_hit, dx);
+	const __m256 tdy = _mm256_mul_ps(t_hit, dy);
+	const __m256 tdz = _mm256_mul_ps(t_hit, dz);
+	const __m256 cx = _mm256_set1_ps(q.corner.x);
+	const __m256 cy = _mm256_set1_ps(q.corner.y);
+	const __m256 cz = _mm256_set1_ps(q.corner.z);
+	const __m256 px = _mm256_sub_ps(_mm256_add_ps(tdx, ox), cx);
+	const __m256 py = _mm256_sub_ps(_mm256_add_ps(tdy, oy), cy);
+	const __m256 pz = _mm256_sub_ps(_mm256_add_ps(tdz, oz), cz);
+	const __m256 ex = _mm256_fmadd_ps(t_err, abs_ps(dx), _mm256_mul_ps(eps, sum_abs(tdx, ox, cx)));
+	const __m256 ey = _mm256_fmadd_ps(t_err, abs_ps(dy), _mm256_mul_ps(eps, sum_abs(tdy, oy, cy)));
+	const __m256 ez = _mm256_fmadd_ps(t_err, abs_ps(dz), _mm256_mul_ps(eps, sum_abs(tdz, oz, cz)));
+
+	__m256 a_err;
+	__m256 b_err;
+	const __m256 a = planar_coordinate(px, py, pz, ex, ey, ez, q.alpha_axis, a_err);
+	const __m256 b = planar_coordinate(px, py, pz, ex, ey, ez, q.beta_axis, b_err);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0F);
+	hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(a, a_err), zero, _CMP_GE_OQ),
+										   _mm256_cmp_ps(_mm256_sub_ps(a, a_err), one, _CMP_LE_OQ)));
+	hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(b, b_err), zero, _CMP_GE_OQ),
+										   _mm256_cmp_ps(_mm256_sub_ps(b, b_err), one, _CMP_LE_OQ)));
+	return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_and_ps(not_parallel, _mm256_or_ps(uncertain, hit))));
+}
+
+#endif
+
+} // namespace
+
+bool Quad::_intersect(const Ray& r, const double t_min, const double t_max, double& t, double& alpha,
+					  double& beta) const {
 	const auto denom = glm::dot(_normal, r.direction());
 
 	// 如果光线平行于平面，则不相交
 	if (std::abs(denom) < 1e-8) return false;
 
 	// 计算交点参数 t
-	const auto t = (_d_param - glm::dot(_normal, r.origin())) / denom;
+	t = (_d_param - glm::dot(_normal, r.origin())) / denom;
 	if (t < t_min || t > t_max) return false;
 
 	// 确定交点是否在四边形内
-	const auto intersection = r.at(t);
-	const glm::vec3 planar_hitpt_vector = intersection - _corner;
-	const auto alpha = glm::dot(_w, glm::cross(planar_hitpt_vector, _v));
-	const auto beta = glm::dot(_w, glm::cross(_u, planar_hitpt_vector));
+	const glm::vec3 planar_hitpt_vector = r.at(t) - _corner;
+	alpha = glm::dot(_w, glm::cross(planar_hitpt_vector, _v));
+	beta = glm::dot(_w, glm::cross(_u, planar_hitpt_vector));
 
-	if (alpha < 0 || alpha > 1 || beta < 0 || beta > 1) return false;
+	return alpha >= 0 && alpha <= 1 && beta >= 0 && beta <= 1;
+}
+
+bool Quad::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+	double t = 0;
+	double alpha = 0;
+	double beta = 0;
+	if (!_intersect(r, t_min, t_max, t, alpha, beta)) return false;
 
-	// 记录击中信息
+	_set_hit_record(r, t, alpha, beta, rec);
+	return true;
+}
+
+void Quad::_set_hit_record(const Ray& r, const double t, const double alpha, const double beta,
+						   HitRecord& rec) const {
 	rec.t = t;
-	rec.p = intersection;
-	rec.mat_ptr = _mat_ptr;
+	rec.p = r.at(t);
+	rec.mat_ptr = _mat_ptr.get();
+	rec.material_id = _material_id;
 	rec.set_face_normal(r, _normal);
 	rec.u = alpha;
 	rec.v = beta;
+}
 
-	return true;
+std::uint32_t Quad::hit_packet(const RayPacket& packet, const std::uint32_t active, const double t_min,
+							   PacketHitRecord& hits) const {
+#if RT_ARCH_X86
+	if (cpu_features().avx2) {
+		const QuadLanes lanes{_normal, static_cast<float>(_d_param), _corner, glm::cross(_v, _w), glm::cross(_w, _u)};
+		const std::uint32_t candidates =
+			intersect_packet_avx2(packet, lanes, static_cast<float>(t_min), hits.t_max) & active;
+		std::uint32_t hit_mask = 0;
+		for (std::uint32_t m = candidates; m != 0; m &= m - 1) {
+			const int lane = std::countr_zero(m);
+			// 候选测试是保守的，按单光线的精度重新求交决定是否击中，使结果与 hit 完全一致
+			const Ray r = packet.ray(lane);
+			double t = 0;
+			double alpha = 0;
+			double beta = 0;
+			if (!_intersect(r, t_min, hits.t_max[lane], t, alpha, beta)) continue;
+			_set_hit_record(r, t, alpha, beta, hits.rec[lane]);
+			hits.t_max[lane] = t;
+			hit_mask |= 1U << lane;
+		}
+		hits.hit_mask |= hit_mask;
+		return hit_mask;
+	}
+#endif
+	return Hittable::hit_packet(packet, active, t_min, hits);
+}
+
+bool Quad::occluded(const Ray& r, const double t_min, const double t_max) const {
+	double t = 0;
+	double alpha = 0;
+	double beta = 0;
+	return _intersect(r, t_min, t_max, t, alpha, beta);
+}
+
+AABB Quad::bounding_box() const {
+	AABB box(_corner, _corner + _u + _v);
+	box.expand(_corner + _u);
+	box.expand(_corner + _v);
+	// 四边形在某一轴上可能没有厚度，略微加厚以保证 slab 测试稳定
+	return box.padded(QUAD_BOX_PADDING);
 }
 
 double Quad::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
@@ -45,12 +223,17 @@ double Quad::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
 	return distance_squared / (cosine * _area);
 }
 
-glm::vec3 Quad::random(const glm::vec3& origin) const {
+glm::vec3 Quad::random(const glm::vec3& origin, Sampler& sampler) const {
 	// 范围从 [0, 1] 变为 [0.00005, 0.99995]，避免边缘浮点误差
-	const auto r1 = 0.00005 + 0.9999 * random_double();
-	const auto r2 = 0.00005 + 0.9999 * random_double();
+	const glm::vec2 u = sampler.get_2d();
+	const auto r1 = 0.00005 + 0.9999 * u.x;
+	const auto r2 = 0.00005 + 0.9999 * u.y;
 	const auto p = _corner + static_cast<float>(r1) * _u + static_cast<float>(r2) * _v;
 	return p - origin;
 }
 
+void Quad::bind_materials(MaterialTable& table) {
+	_material_id = table.add(_mat_ptr);
+}
+
 } // namespace rt
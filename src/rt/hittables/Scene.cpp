@@ -1,4 +1,5 @@
 #include "rt/hittables/Scene.hpp"
+#include "rt/materials/MaterialTable.hpp"
 #include "rt/core/Utils.hpp"
 
 namespace rt {
@@ -19,6 +20,27 @@ bool Scene::hit(const Ray& r, const double t_min, const double t_max, HitRecord&
 	return hit_anything;
 }
 
+bool Scene::occluded(const Ray& r, const double t_min, const double t_max) const {
+	for (const auto& object : objects)
+		if (object->occluded(r, t_min, t_max)) return true;
+	return false;
+}
+
+std::uint32_t Scene::hit_packet(const RayPacket& packet, const std::uint32_t active, const double t_min,
+								PacketHitRecord& hits) const {
+	std::uint32_t hit_mask = 0;
+	for (const auto& object : objects)
+		hit_mask |= object->hit_packet(packet, active, t_min, hits);
+	return hit_mask;
+}
+
+AABB Scene::bounding_box() const {
+	AABB box;
+	for (const auto& object : objects)
+		box.expand(object->bounding_box());
+	return box;
+}
+
 double Scene::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
 	if (objects.empty()) return 0.0;
 
@@ -29,11 +51,16 @@ double Scene::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
 	return sum / static_cast<double>(objects.size());
 }
 
-glm::vec3 Scene::random(const glm::vec3& origin) const {
+glm::vec3 Scene::random(const glm::vec3& origin, Sampler& sampler) const {
 	if (objects.empty()) return {1,0,0};
 
 	const auto int_size = static_cast<int>(objects.size());
-	return objects[random_int(0, int_size-1)]->random(origin);
+	return objects[random_int(sampler, 0, int_size-1)]->random(origin, sampler);
+}
+
+void Scene::bind_materials(MaterialTable& table) {
+	for (const auto& object : objects)
+		object->bind_materials(table);
 }
 
 } // namespace rt
@@ -1,11 +1,85 @@
 #include "rt/hittables/Sphere.hpp"
+#include "rt/materials/MaterialTable.hpp"
 #include "rt/core/Utils.hpp"
 #include "rt/core/ONB.hpp"
+#include "rt/core/CpuFeatures.hpp"
+#include <bit>
 #include <cmath>
 
+#if RT_ARCH_X86
+#include <immintrin.h>
+#endif
+
 namespace rt {
 
-static void get_sphere_uv(const glm::vec3& p, double& u, double& v) {
+namespace {
+
+#if RT_ARCH_X86
+
+/**
+ * @brief 单精度候选测试的相对误差余量，远大于单精度与双精度求根之间的舍入差异。
+ */
+constexpr float PACKET_EPSILON = 0x1p-16F;
+
+/**
+ * @brief 光线包的 8 个通道与同一个球体做保守的候选测试，返回候选掩码。
+ *
+ * 判别式与 SphereSet 一样按 a * (r^2 - |co - (co·d / a) d|^2) 计算，避免单精度下的相消误差。
+ * 判别式按与 a (|co|^2 + r^2) 成比例的余量放宽，根的区间再按 sqrt 的余量放宽，因此双精度 Sphere::hit
+ * 能击中的通道一定是候选（掠射的轮廓处也不会丢失），多出的候选由双精度求根排除。
+ */
+RT_TARGET_AVX2 std::uint32_t intersect_packet_avx2(const RayPacket& packet, const glm::vec3& center, const float radius,
+												   const float t_min, const std::array<double, RayPacket::SIZE>& t_max) {
+	const __m256 dx = _mm256_load_ps(packet.dir_x.data());
+	const __m256 dy = _mm256_load_ps(packet.dir_y.data());
+	const __m256 dz = _mm256_load_ps(packet.dir_z.data());
+	const __m256 cox = _mm256_sub_ps(_mm256_load_ps(packet.origin_x.data()), _mm256_set1_ps(center.x));
+	const __m256 coy = _mm256_sub_ps(_mm256_load_ps(packet.origin_y.data()), _mm256_set1_ps(center.y));
+	const __m256 coz = _mm256_sub_ps(_mm256_load_ps(packet.origin_z.data()), _mm256_set1_ps(center.z));
+	const __m256 zero = _mm256_setzero_ps();
+
+	const __m256 a = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+	const __m256 inv_a = _mm256_div_ps(_mm256_set1_ps(1.0F), a);
+	const __m256 half_b = _mm256_fmadd_ps(coz, dz, _mm256_fmadd_ps(coy, dy, _mm256_mul_ps(cox, dx)));
+	const __m256 proj = _mm256_mul_ps(half_b, inv_a);
+	const __m256 fx = _mm256_fnmadd_ps(proj, dx, cox);
+	const __m256 fy = _mm256_fnmadd_ps(proj, dy, coy);
+	const __m256 fz = _mm256_fnmadd_ps(proj, dz, coz);
+	const __m256 f2 = _mm256_fmadd_ps(fz, fz, _mm256_fmadd_ps(fy, fy, _mm256_mul_ps(fx, fx)));
+	const __m256 co2 = _mm256_fmadd_ps(coz, coz, _mm256_fmadd_ps(coy, coy, _mm256_mul_ps(cox, cox)));
+	const __m256 r = _mm256_set1_ps(radius);
+	const __m256 discriminant = _mm256_mul_ps(a, _mm256_fmsub_ps(r, r, f2));
+	const __m256 margin =
+		_mm256_mul_ps(_mm256_set1_ps(PACKET_EPSILON), _mm256_mul_ps(a, _mm256_fmadd_ps(r, r, co2)));
+	const __m256 valid = _mm256_cmp_ps(_mm256_add_ps(discriminant, margin), zero, _CMP_GE_OQ);
+	if (_mm256_movemask_ps(valid) == 0) return 0;
+
+	// 两个根各自的取值范围：近根在 [near_lo, near_hi] 内，远根在 [far_lo, far_hi] 内；
+	// sqrt_hi >= sqrt(margin)，其 2^-8 倍足以覆盖 half_b 与乘以 inv_a 的舍入
+	const __m256 sqrt_hi = _mm256_sqrt_ps(_mm256_max_ps(_mm256_add_ps(discriminant, margin), zero));
+	const __m256 sqrt_lo = _mm256_sqrt_ps(_mm256_max_ps(_mm256_sub_ps(discriminant, margin), zero));
+	const __m256 slack = _mm256_mul_ps(sqrt_hi, _mm256_set1_ps(0x1p-8F));
+	const __m256 neg_b = _mm256_sub_ps(zero, half_b);
+	const __m256 near_lo = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(neg_b, sqrt_hi), slack), inv_a);
+	const __m256 near_hi = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(neg_b, sqrt_lo), slack), inv_a);
+	const __m256 far_lo = _mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(neg_b, sqrt_lo), slack), inv_a);
+	const __m256 far_hi = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(neg_b, sqrt_hi), slack), inv_a);
+
+	const __m256 lo = _mm256_set1_ps(t_min);
+	const __m256 hi = _mm256_set_m128(_mm256_cvtpd_ps(_mm256_loadu_pd(t_max.data() + 4)),
+									  _mm256_cvtpd_ps(_mm256_loadu_pd(t_max.data())));
+	const __m256 near_in =
+		_mm256_and_ps(_mm256_cmp_ps(near_hi, lo, _CMP_GE_OQ), _mm256_cmp_ps(near_lo, hi, _CMP_LE_OQ));
+	const __m256 far_in =
+		_mm256_and_ps(_mm256_cmp_ps(far_hi, lo, _CMP_GE_OQ), _mm256_cmp_ps(far_lo, hi, _CMP_LE_OQ));
+	return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_and_ps(valid, _mm256_or_ps(near_in, far_in))));
+}
+
+#endif
+
+} // namespace
+
+void Sphere::get_uv(const glm::vec3& p, double& u, double& v) {
 	const auto theta = acos(-p.y);
 	const auto phi = atan2(-p.z, p.x) + PI;
 
@@ -13,32 +87,78 @@ static void get_sphere_uv(const glm::vec3& p, double& u, double& v) {
 	v = theta / PI;
 }
 
-bool Sphere::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
-	const glm::vec3 co = r.origin() - _center;
+bool Sphere::intersect(const glm::vec3& center, const double radius, const Ray& r, const double t_min,
+					   const double t_max, double& root) {
+	const glm::vec3 co = r.origin() - center;
 	const auto a = glm::dot(r.direction(), r.direction());
 	const auto half_b = glm::dot(co, r.direction());
-	const auto c = glm::dot(co, co) - _radius * _radius;
+	const auto c = glm::dot(co, co) - radius * radius;
 
 	const auto discriminant = half_b * half_b - a * c;
 	if (discriminant < 0) return false;
 	const auto sqrtd = std::sqrt(discriminant);
 
 	// 找到最近的根，在 t_min 和 t_max 范围内
-	auto root = (-half_b - sqrtd) / a;
+	root = (-half_b - sqrtd) / a;
 	if (root < t_min || t_max < root) {
 		root = (-half_b + sqrtd) / a;
 		if (root < t_min || t_max < root)
 			return false;
 	}
+	return true;
+}
 
-	rec.t = root;
+bool Sphere::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+	double root = 0;
+	if (!_intersect(r, t_min, t_max, root)) return false;
+
+	_set_hit_record(r, root, rec);
+	return true;
+}
+
+void Sphere::_set_hit_record(const Ray& r, const double t, HitRecord& rec) const {
+	rec.t = t;
 	rec.p = r.at(rec.t);
 	const glm::vec3 outward_normal = (rec.p - _center) / static_cast<float>(_radius);
 	rec.set_face_normal(r, outward_normal);
-	get_sphere_uv(outward_normal, rec.u, rec.v);
-	rec.mat_ptr = _mat_ptr;
+	get_uv(outward_normal, rec.u, rec.v);
+	rec.mat_ptr = _mat_ptr.get();
+	rec.material_id = _material_id;
+}
 
-	return true;
+std::uint32_t Sphere::hit_packet(const RayPacket& packet, const std::uint32_t active, const double t_min,
+								 PacketHitRecord& hits) const {
+#if RT_ARCH_X86
+	if (cpu_features().avx2) {
+		const std::uint32_t candidates =
+			intersect_packet_avx2(packet, _center, static_cast<float>(_radius), static_cast<float>(t_min), hits.t_max) &
+			active;
+		std::uint32_t hit_mask = 0;
+		for (std::uint32_t m = candidates; m != 0; m &= m - 1) {
+			const int lane = std::countr_zero(m);
+			// 候选测试是保守的，按单光线的精度重新求根决定是否击中，使结果与 hit 完全一致
+			const Ray r = packet.ray(lane);
+			double root = 0;
+			if (!_intersect(r, t_min, hits.t_max[lane], root)) continue;
+			_set_hit_record(r, root, hits.rec[lane]);
+			hits.t_max[lane] = root;
+			hit_mask |= 1U << lane;
+		}
+		hits.hit_mask |= hit_mask;
+		return hit_mask;
+	}
+#endif
+	return Hittable::hit_packet(packet, active, t_min, hits);
+}
+
+bool Sphere::occluded(const Ray& r, const double t_min, const double t_max) const {
+	double root = 0;
+	return _intersect(r, t_min, t_max, root);
+}
+
+AABB Sphere::bounding_box() const {
+	const glm::vec3 r_vec(static_cast<float>(std::fabs(_radius)));
+	return {_center - r_vec, _center + r_vec};
 }
 
 double Sphere::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
@@ -51,14 +171,18 @@ double Sphere::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
 	return  1 / solid_angle;
 }
 
-glm::vec3 Sphere::random(const glm::vec3& origin) const {
+glm::vec3 Sphere::random(const glm::vec3& origin, Sampler& sampler) const {
 	const glm::vec3 direction = _center - origin;
 	const auto distance_squared = glm::length2(direction);
 	ONB uvw;
 	uvw.build_from_w(direction);
 	// 使用略小于实际半径的值进行采样，避免生成刚好擦过球体边缘的光线。
 	// 边缘光线容易因浮点误差导致在 pdf_value 的 hit 检测中失败，从而产生黑点。
-	return uvw.transform_to_world(random_to_sphere(0.9999 * _radius, distance_squared));
+	return uvw.transform_to_world(random_to_sphere(sampler, 0.9999 * _radius, distance_squared));
+}
+
+void Sphere::bind_materials(MaterialTable& table) {
+	_material_id = table.add(_mat_ptr);
 }
 
 } // namespace rt
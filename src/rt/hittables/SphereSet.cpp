@@ -0,0 +1,353 @@
+#include "rt/hittables/SphereSet.hpp"
+#include "rt/materials/MaterialTable.hpp"
+#include "rt/accel/BVHTree.hpp"
+#include "rt/core/CpuFeatures.hpp"
+#include "rt/core/Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if RT_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+/**
+ * @brief 一条光线在各 SIMD 通道间共享的参数。
+ */
+struct RayLanes {
+	glm::vec3 origin; ///< 光线起点。
+	glm::vec3 dir;	  ///< 光线方向（未归一化）。
+	float a;		  ///< dot(dir, dir)。
+	float inv_a;	  ///< 1 / a。
+	float t_min;	  ///< 有效区间下界。
+	float t_max;	  ///< 有效区间上界。
+};
+
+/**
+ * @brief 球体数组中一段连续通道的起始指针。
+ */
+struct SphereLanes {
+	const float* cx; ///< 球心 x。
+	const float* cy; ///< 球心 y。
+	const float* cz; ///< 球心 z。
+	const float* r;	 ///< 半径。
+};
+
+/**
+ * @brief 测试 n 个通道 (n ≤ SphereSet::SIMD_LANES)，返回命中掩码并把区间内的根写入 t。
+ *
+ * 与 Sphere::hit 相同，优先取近根，近根不在区间内时取远根。填充通道的球心为 NaN，所有比较均为假。
+ * 判别式按 r^2 - |co - (co·d / a) d|^2 计算，避免单精度下 half_b^2 - a * c 在远距离小球上的相消误差。
+ */
+unsigned intersect_scalar(const SphereLanes& s, const std::uint32_t n, const RayLanes& ray, float* t) {
+	unsigned mask = 0;
+	for (std::uint32_t k = 0; k < n; ++k) {
+		const glm::vec3 co = ray.origin - glm::vec3(s.cx[k], s.cy[k], s.cz[k]);
+		const float half_b = glm::dot(co, ray.dir);
+		const glm::vec3 f = co - (half_b * ray.inv_a) * ray.dir;
+		const float discriminant = ray.a * (s.r[k] * s.r[k] - glm::dot(f, f));
+		if (!(discriminant >= 0)) continue;
+		const float sqrtd = std::sqrt(discriminant);
+
+		float root = (-half_b - sqrtd) * ray.inv_a;
+		if (root < ray.t_min || ray.t_max < root) {
+			root = (-half_b + sqrtd) * ray.inv_a;
+			if (root < ray.t_min || ray.t_max < root) continue;
+		}
+		t[k] = root;
+		mask |= 1U << k;
+	}
+	return mask;
+}
+
+#if RT_ARCH_X86
+
+RT_TARGET_AVX2 unsigned intersect_avx2(const SphereLanes& s, const std::uint32_t n, const RayLanes& ray, float* t) {
+	const __m256 ox = _mm256_set1_ps(ray.origin.x);
+	const __m256 oy = _mm256_set1_ps(ray.origin.y);
+	const __m256 oz = _mm256_set1_ps(ray.origin.z);
+	const __m256 dx = _mm256_set1_ps(ray.dir.x);
+	const __m256 dy = _mm256_set1_ps(ray.dir.y);
+	const __m256 dz = _mm256_set1_ps(ray.dir.z);
+	const __m256 a = _mm256_set1_ps(ray.a);
+	const __m256 inv_a = _mm256_set1_ps(ray.inv_a);
+	const __m256 t_min = _mm256_set1_ps(ray.t_min);
+	const __m256 t_max = _mm256_set1_ps(ray.t_max);
+	const __m256 zero = _mm256_setzero_ps();
+
+	unsigned mask = 0;
+	for (std::uint32_t base = 0; base < n; base += 8) {
+		const __m256 cox = _mm256_sub_ps(ox, _mm256_load_ps(s.cx + base));
+		const __m256 coy = _mm256_sub_ps(oy, _mm256_load_ps(s.cy + base));
+		const __m256 coz = _mm256_sub_ps(oz, _mm256_load_ps(s.cz + base));
+		const __m256 r = _mm256_load_ps(s.r + base);
+
+		const __m256 half_b = _mm256_fmadd_ps(coz, dz, _mm256_fmadd_ps(coy, dy, _mm256_mul_ps(cox, dx)));
+		const __m256 proj = _mm256_mul_ps(half_b, inv_a);
+		const __m256 fx = _mm256_fnmadd_ps(proj, dx, cox);
+		const __m256 fy = _mm256_fnmadd_ps(proj, dy, coy);
+		const __m256 fz = _mm256_fnmadd_ps(proj, dz, coz);
+		const __m256 f2 = _mm256_fmadd_ps(fz, fz, _mm256_fmadd_ps(fy, fy, _mm256_mul_ps(fx, fx)));
+		const __m256 discriminant = _mm256_mul_ps(a, _mm256_fmsub_ps(r, r, f2));
+		const __m256 valid = _mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ);
+		// 大多数球体不与光线相交，全部通道未命中时跳过开方与求根
+		if (_mm256_movemask_ps(valid) == 0) continue;
+		const __m256 sqrtd = _mm256_sqrt_ps(_mm256_max_ps(discriminant, zero));
+
+		const __m256 near_root = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(zero, half_b), sqrtd), inv_a);
+		const __m256 far_root = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(zero, half_b), sqrtd), inv_a);
+		const __m256 near_in =
+			_mm256_and_ps(_mm256_cmp_ps(near_root, t_min, _CMP_GE_OQ), _mm256_cmp_ps(near_root, t_max, _CMP_LE_OQ));
+		const __m256 far_in =
+			_mm256_and_ps(_mm256_cmp_ps(far_root, t_min, _CMP_GE_OQ), _mm256_cmp_ps(far_root, t_max, _CMP_LE_OQ));
+
+		_mm256_storeu_ps(t + base, _mm256_blendv_ps(far_root, near_root, near_in));
+		const __m256 hit = _mm256_and_ps(valid, _mm256_or_ps(near_in, far_in));
+		mask |= static_cast<unsigned>(_mm256_movemask_ps(hit)) << base;
+	}
+	return mask;
+}
+
+RT_TARGET_AVX512 unsigned intersect_avx512(const SphereLanes& s, const std::uint32_t n, const RayLanes& ray,
+										   float* t) {
+	const __m512 cox = _mm512_sub_ps(_mm512_set1_ps(ray.origin.x), _mm512_load_ps(s.cx));
+	const __m512 coy = _mm512_sub_ps(_mm512_set1_ps(ray.origin.y), _mm512_load_ps(s.cy));
+	const __m512 coz = _mm512_sub_ps(_mm512_set1_ps(ray.origin.z), _mm512_load_ps(s.cz));
+	const __m512 r = _mm512_load_ps(s.r);
+	const __m512 a = _mm512_set1_ps(ray.a);
+	const __m512 zero = _mm512_setzero_ps();
+
+	const __m512 dx = _mm512_set1_ps(ray.dir.x);
+	const __m512 dy = _mm512_set1_ps(ray.dir.y);
+	const __m512 dz = _mm512_set1_ps(ray.dir.z);
+
+	const __m512 half_b = _mm512_fmadd_ps(coz, dz, _mm512_fmadd_ps(coy, dy, _mm512_mul_ps(cox, dx)));
+	const __m512 inv_a = _mm512_set1_ps(ray.inv_a);
+	const __m512 proj = _mm512_mul_ps(half_b, inv_a);
+	const __m512 fx = _mm512_fnmadd_ps(proj, dx, cox);
+	const __m512 fy = _mm512_fnmadd_ps(proj, dy, coy);
+	const __m512 fz = _mm512_fnmadd_ps(proj, dz, coz);
+	const __m512 f2 = _mm512_fmadd_ps(fz, fz, _mm512_fmadd_ps(fy, fy, _mm512_mul_ps(fx, fx)));
+	const __m512 discriminant = _mm512_mul_ps(a, _mm512_fmsub_ps(r, r, f2));
+	const __mmask16 valid = _mm512_cmp_ps_mask(discriminant, zero, _CMP_GE_OQ);
+	if (valid == 0) return 0;
+	// 只对判别式非负的通道开方，其余通道置 0；不带掩码的 sqrt / max 以未定义值作为直通源，GCC 会报告未初始化
+	const __m512 sqrtd = _mm512_maskz_sqrt_ps(valid, discriminant);
+
+	const __m512 near_root = _mm512_mul_ps(_mm512_sub_ps(_mm512_sub_ps(zero, half_b), sqrtd), inv_a);
+	const __m512 far_root = _mm512_mul_ps(_mm512_add_ps(_mm512_sub_ps(zero, half_b), sqrtd), inv_a);
+	const __m512 t_min = _mm512_set1_ps(ray.t_min);
+	const __m512 t_max = _mm512_set1_ps(ray.t_max);
+	const __mmask16 near_in =
+		_mm512_cmp_ps_mask(near_root, t_min, _CMP_GE_OQ) & _mm512_cmp_ps_mask(near_root, t_max, _CMP_LE_OQ);
+	const __mmask16 far_in =
+		_mm512_cmp_ps_mask(far_root, t_min, _CMP_GE_OQ) & _mm512_cmp_ps_mask(far_root, t_max, _CMP_LE_OQ);
+
+	_mm512_storeu_ps(t, _mm512_mask_blend_ps(near_in, far_root, near_root));
+	const auto lanes = static_cast<unsigned>((1U << n) - 1U);
+	return static_cast<unsigned>(valid & (near_in | far_in)) & lanes;
+}
+
+#endif
+
+} // namespace
+
+SphereSet::SphereSet() : _kernel(_detect_kernel()) {}
+
+SphereSet::Kernel SphereSet::_detect_kernel() {
+#if RT_ARCH_X86
+	if (cpu_features().avx512f) return Kernel::AVX512;
+	if (cpu_features().avx2) return Kernel::AVX2;
+#endif
+	return Kernel::SCALAR;
+}
+
+void SphereSet::set_force_scalar(const bool force_scalar) {
+	_kernel = force_scalar ? Kernel::SCALAR : _detect_kernel();
+}
+
+void SphereSet::add(const glm::vec3& center, const float radius, const std::shared_ptr<Material>& mat) {
+	const std::uint32_t lane = _count % SIMD_LANES;
+	if (lane == 0) {
+		constexpr float NaN = std::numeric_limits<float>::quiet_NaN();
+		Block& block = _blocks.emplace_back();
+		block.center_x.fill(NaN);
+		block.center_y.fill(NaN);
+		block.center_z.fill(NaN);
+		block.radius.fill(NaN);
+	}
+	Block& block = _blocks.back();
+	block.center_x[lane] = center.x;
+	block.center_y[lane] = center.y;
+	block.center_z[lane] = center.z;
+	block.radius[lane] = radius;
+	++_count;
+
+	const auto it = std::ranges::find(_materials, mat);
+	_material_ids.push_back(static_cast<std::uint32_t>(it - _materials.begin()));
+	if (it == _materials.end()) _materials.push_back(mat);
+
+	const glm::vec3 r_vec(std::fabs(radius));
+	_bounds.expand(AABB(center - r_vec, center + r_vec));
+}
+
+std::vector<std::shared_ptr<Hittable>> SphereSet::make_clusters(const std::vector<std::shared_ptr<Sphere>>& spheres,
+																 const std::uint32_t cluster_size) {
+	std::vector<AABB> bounds(spheres.size());
+	for (size_t i = 0; i < spheres.size(); ++i)
+		bounds[i] = spheres[i]->bounding_box();
+
+	BVHTree tree;
+	tree.build(bounds, BVHBuildMode::BINNED_SAH);
+	if (tree.empty()) return {};
+
+	// 深度优先顺序中子节点总在父节点之后，倒序遍历即可自底向上得到每棵子树的图元区间
+	const auto& nodes = tree.nodes();
+	std::vector<std::uint32_t> first(nodes.size());
+	std::vector<std::uint32_t> count(nodes.size());
+	for (size_t i = nodes.size(); i-- > 0;) {
+		if (nodes[i].is_leaf()) {
+			first[i] = nodes[i].offset;
+			count[i] = nodes[i].count;
+		} else {
+			first[i] = first[i + 1];
+			count[i] = count[i + 1] + count[nodes[i].offset];
+		}
+	}
+
+	// 图元数不超过 cluster_size 的最大子树作为一组，组内球体在 SAH 意义下是紧凑的
+	std::vector<std::shared_ptr<Hittable>> clusters;
+	std::vector<std::uint32_t> stack = {0};
+	while (!stack.empty()) {
+		const std::uint32_t node_idx = stack.back();
+		stack.pop_back();
+		if (count[node_idx] > cluster_size && !nodes[node_idx].is_leaf()) {
+			stack.push_back(nodes[node_idx].offset);
+			stack.push_back(node_idx + 1);
+			continue;
+		}
+
+		auto cluster = std::make_shared<SphereSet>();
+		for (std::uint32_t i = first[node_idx]; i < first[node_idx] + count[node_idx]; ++i) {
+			const Sphere& sphere = *spheres[tree.indices()[i]];
+			cluster->add(sphere.center(), static_cast<float>(sphere.radius()), sphere.material());
+		}
+		clusters.push_back(std::move(cluster));
+	}
+	return clusters;
+}
+
+std::int64_t SphereSet::_closest(const Ray& r, const double t_min, double t_max, const bool any_hit,
+								 double& t) const {
+	// 单精度的筛选区间向外多取一个 ulp，双精度区间内的根不会因转换时的舍入被剔除
+	constexpr float FLOAT_INF = std::numeric_limits<float>::infinity();
+	const float t_min_f = std::nextafter(static_cast<float>(t_min), -FLOAT_INF);
+	const float t_max_f = std::nextafter(BVHTree::to_float_t(t_max), FLOAT_INF);
+
+	// 先用整组的包围盒剔除，未穿过包围盒的光线不必逐个测试球体
+	float t_entry = 0;
+	if (!_bounds.hit(r.origin(), 1.0F / r.direction(), t_min_f, t_max_f, t_entry)) return -1;
+
+	const float a = glm::dot(r.direction(), r.direction());
+	RayLanes ray{r.origin(), r.direction(), a, 1.0F / a, t_min_f, t_max_f};
+	std::array<float, SIMD_LANES> t_lanes{};
+	std::int64_t closest = -1;
+
+	for (std::uint32_t base = 0; base < _count; base += SIMD_LANES) {
+		const Block& block = _blocks[base / SIMD_LANES];
+		const SphereLanes lanes{block.center_x.data(), block.center_y.data(), block.center_z.data(),
+								block.radius.data()};
+		const std::uint32_t n = std::min(SIMD_LANES, _count - base);
+		unsigned mask = 0;
+		switch (_kernel) {
+#if RT_ARCH_X86
+			case Kernel::AVX512: mask = intersect_avx512(lanes, n, ray, t_lanes.data()); break;
+			// AVX2 每次处理 8 个通道，末尾不足 8 个的部分由 NaN 填充通道补齐
+			case Kernel::AVX2: mask = intersect_avx2(lanes, (n + 7) / 8 * 8, ray, t_lanes.data()); break;
+#endif
+			default: mask = intersect_scalar(lanes, n, ray, t_lanes.data()); break;
+		}
+
+		// 单精度的根在远处误差较大，候选按 Sphere 的双精度求根确认并给出交点，使两种图元的结果一致；
+		// 双精度否决的候选只是被跳过，不影响同组的其他球体
+		for (; mask != 0; mask &= mask - 1) {
+			const int k = std::countr_zero(mask);
+			const glm::vec3 center(block.center_x[k], block.center_y[k], block.center_z[k]);
+			double root = 0;
+			if (!Sphere::intersect(center, block.radius[k], r, t_min, t_max, root)) continue;
+			t = t_max = root;
+			closest = base + k;
+			if (any_hit) return closest;
+			ray.t_max = std::nextafter(BVHTree::to_float_t(t_max), FLOAT_INF);
+		}
+	}
+	return closest;
+}
+
+glm::vec3 SphereSet::_center(const std::uint32_t idx) const {
+	const Block& block = _blocks[idx / SIMD_LANES];
+	const std::uint32_t lane = idx % SIMD_LANES;
+	return {block.center_x[lane], block.center_y[lane], block.center_z[lane]};
+}
+
+float SphereSet::_radius(const std::uint32_t idx) const {
+	return _blocks[idx / SIMD_LANES].radius[idx % SIMD_LANES];
+}
+
+Sphere SphereSet::_sphere(const std::uint32_t idx) const {
+	return {_center(idx), _radius(idx), _materials[_material_ids[idx]]};
+}
+
+bool SphereSet::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+	double t = 0;
+	const std::int64_t idx = _closest(r, t_min, t_max, false, t);
+	if (idx < 0) return false;
+
+	// 只对最近的球体计算击中点、法线与纹理坐标
+	const glm::vec3 center = _center(static_cast<std::uint32_t>(idx));
+	const float radius = _radius(static_cast<std::uint32_t>(idx));
+	rec.t = t;
+	rec.p = r.at(rec.t);
+	const glm::vec3 outward_normal = (rec.p - center) / radius;
+	rec.set_face_normal(r, outward_normal);
+	Sphere::get_uv(outward_normal, rec.u, rec.v);
+	const std::uint32_t material = _material_ids[idx];
+	rec.mat_ptr = _materials[material].get();
+	rec.material_id = material < _table_ids.size() ? _table_ids[material] : HitRecord::NO_MATERIAL_ID;
+	return true;
+}
+
+bool SphereSet::occluded(const Ray& r, const double t_min, const double t_max) const {
+	double t = 0;
+	return _closest(r, t_min, t_max, true, t) >= 0;
+}
+
+double SphereSet::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
+	if (_count == 0) return 0.0;
+
+	auto sum = 0.0;
+	for (std::uint32_t i = 0; i < _count; ++i)
+		sum += _sphere(i).pdf_value(origin, v);
+
+	return sum / static_cast<double>(_count);
+}
+
+glm::vec3 SphereSet::random(const glm::vec3& origin, Sampler& sampler) const {
+	if (_count == 0) return {1, 0, 0};
+
+	return _sphere(random_int(sampler, 0, static_cast<int>(_count) - 1)).random(origin, sampler);
+}
+
+void SphereSet::bind_materials(MaterialTable& table) {
+	_table_ids.clear();
+	for (const auto& material : _materials)
+		_table_ids.push_back(table.add(material));
+}
+
+} // namespace rt
@@ -0,0 +1,119 @@
+#include "rt/hittables/TLAS.hpp"
+#include "rt/materials/MaterialTable.hpp"
+#include "rt/core/Utils.hpp"
+
+namespace rt {
+
+std::uint32_t TLAS::add_blas(std::shared_ptr<Hittable> blas) {
+	_blas.push_back(std::move(blas));
+	return static_cast<std::uint32_t>(_blas.size() - 1);
+}
+
+std::uint32_t TLAS::add_material(std::shared_ptr<Material> material) {
+	_materials.push_back(std::move(material));
+	return static_cast<std::uint32_t>(_materials.size() - 1);
+}
+
+std::uint32_t TLAS::add_instance(const std::uint32_t blas_id, const glm::mat4& object_to_world,
+								 const std::uint32_t material_id) {
+	const auto instance_id = static_cast<std::uint32_t>(_instances.size());
+	_instances.push_back(InstanceRecord::make(object_to_world, blas_id, material_id, instance_id));
+	return instance_id;
+}
+
+void TLAS::build(const BVHBuildMode mode) {
+	std::vector<AABB> blas_bounds(_blas.size());
+	for (size_t i = 0; i < _blas.size(); ++i)
+		blas_bounds[i] = _blas[i]->bounding_box();
+
+	std::vector<AABB> bounds(_instances.size());
+	const auto n = static_cast<std::int64_t>(_instances.size());
+#pragma omp parallel for schedule(static)
+	for (std::int64_t i = 0; i < n; ++i)
+		bounds[i] = _instances[i].world_bounds(blas_bounds[_instances[i].blas_id]);
+
+	_tree.build(bounds, mode);
+	if (_layout == BVHLayout::WIDE8) _wide.build(_tree);
+
+	// 按叶子顺序重排实例记录，使叶节点中的实例在内存中连续
+	std::vector<InstanceRecord> sorted(_instances.size());
+#pragma omp parallel for schedule(static)
+	for (std::int64_t i = 0; i < n; ++i)
+		sorted[i] = _instances[_tree.indices()[i]];
+	_instances = std::move(sorted);
+
+	_bounds = _tree.bounds();
+	_stats = _tree.stats();
+	if (!_wide.empty()) _tree = BVHTree();
+}
+
+bool TLAS::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+	HitRecord temp_rec;
+	auto closest_so_far = t_max;
+
+	const auto leaf = [&](const std::uint32_t first, const std::uint32_t count, double& t_closest) {
+		bool hit_leaf = false;
+		for (std::uint32_t i = first; i < first + count; ++i) {
+			const InstanceRecord& instance = _instances[i];
+			if (instance.hit(*_blas[instance.blas_id], r, t_min, t_closest, temp_rec)) {
+				hit_leaf = true;
+				t_closest = temp_rec.t;
+				if (instance.material_id != InstanceRecord::NO_MATERIAL) {
+					temp_rec.mat_ptr = _materials[instance.material_id].get();
+					// 绑定后新增的覆盖材质没有编号，回退到虚函数
+					temp_rec.material_id = instance.material_id < _table_ids.size() ? _table_ids[instance.material_id]
+																					 : HitRecord::NO_MATERIAL_ID;
+				}
+				rec = temp_rec;
+			}
+		}
+		return hit_leaf;
+	};
+
+	if (!_wide.empty()) return _wide.intersect(r, t_min, closest_so_far, leaf);
+	return _tree.intersect(r, t_min, closest_so_far, leaf);
+}
+
+bool TLAS::occluded(const Ray& r, const double t_min, const double t_max) const {
+	const auto leaf = [&](const std::uint32_t first, const std::uint32_t count) {
+		for (std::uint32_t i = first; i < first + count; ++i)
+			if (_instances[i].occluded(*_blas[_instances[i].blas_id], r, t_min, t_max)) return true;
+		return false;
+	};
+
+	if (!_wide.empty()) return _wide.occluded(r, t_min, t_max, leaf);
+	return _tree.occluded(r, t_min, t_max, leaf);
+}
+
+double TLAS::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
+	if (_instances.empty()) return 0.0;
+
+	auto sum = 0.0;
+	for (const auto& instance : _instances)
+		sum += instance.pdf_value(*_blas[instance.blas_id], origin, v);
+
+	return sum / static_cast<double>(_instances.size());
+}
+
+glm::vec3 TLAS::random(const glm::vec3& origin, Sampler& sampler) const {
+	if (_instances.empty()) return {1, 0, 0};
+
+	const auto int_size = static_cast<int>(_instances.size());
+	const InstanceRecord& instance = _instances[random_int(sampler, 0, int_size - 1)];
+	return instance.random(*_blas[instance.blas_id], origin, sampler);
+}
+
+size_t TLAS::memory_bytes() const {
+	return _instances.capacity() * sizeof(InstanceRecord) + _tree.nodes().capacity() * sizeof(BVHNode) +
+		   _tree.indices().capacity() * sizeof(std::uint32_t) + _wide.nodes().size() * sizeof(WideBVHNode);
+}
+
+void TLAS::bind_materials(MaterialTable& table) {
+	for (const auto& blas : _blas)
+		blas->bind_materials(table);
+	_table_ids.clear();
+	for (const auto& material : _materials)
+		_table_ids.push_back(table.add(material));
+}
+
+} // namespace rt
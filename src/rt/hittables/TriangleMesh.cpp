@@ -0,0 +1,324 @@
+#include "rt/hittables/TriangleMesh.hpp"
+#include "rt/materials/MaterialTable.hpp"
+#include "rt/core/CpuFeatures.hpp"
+#include "rt/core/Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+#if RT_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+TriangleMesh::ShearedRay::ShearedRay(const Ray& r) : origin(r.origin()) {
+	const glm::vec3 dir = r.direction();
+	const glm::vec3 abs_dir = glm::abs(dir);
+	kz = abs_dir.x > abs_dir.y ? (abs_dir.x > abs_dir.z ? 0 : 2) : (abs_dir.y > abs_dir.z ? 1 : 2);
+	kx = (kz + 1) % 3;
+	ky = (kx + 1) % 3;
+	// 保持剪切空间的手性，使三角形的绕序判断不随光线方向改变
+	if (dir[kz] < 0) std::swap(kx, ky);
+	sx = dir[kx] / dir[kz];
+	sy = dir[ky] / dir[kz];
+	sz = 1.0F / dir[kz];
+}
+
+namespace {
+
+/**
+ * @brief 由 vector 构造网格时持有的缓冲。
+ */
+struct OwnedMeshBuffers {
+	std::vector<glm::vec3> positions;	///< 顶点位置。
+	std::vector<glm::vec3> normals;		///< 顶点法线。
+	std::vector<glm::vec2> uvs;			///< 顶点纹理坐标。
+	std::vector<std::uint32_t> indices; ///< 按叶子顺序排列的三角形顶点下标。
+};
+
+} // namespace
+
+TriangleMesh::TriangleMesh(std::vector<glm::vec3> positions, std::vector<std::uint32_t> indices,
+						   std::shared_ptr<Material> mat, std::vector<glm::vec3> normals, std::vector<glm::vec2> uvs,
+						   const BVHBuildMode mode) :
+	_mat_ptr(std::move(mat)) {
+	auto owned = std::make_shared<OwnedMeshBuffers>();
+	owned->positions = std::move(positions);
+	owned->normals = std::move(normals);
+	owned->uvs = std::move(uvs);
+
+	const size_t n_triangles = indices.size() / 3;
+	std::vector<AABB> bounds(n_triangles);
+	const auto n = static_cast<std::int64_t>(n_triangles);
+#pragma omp parallel for schedule(static)
+	for (std::int64_t i = 0; i < n; ++i) {
+		AABB box;
+		for (int j = 0; j < 3; ++j)
+			box.expand(owned->positions[indices[3 * i + j]]);
+		bounds[i] = box;
+	}
+	_tree.build(bounds, mode);
+
+	// 按叶子顺序重排三角形，使叶节点中的三角形下标连续
+	owned->indices.resize(3 * n_triangles);
+#pragma omp parallel for schedule(static)
+	for (std::int64_t slot = 0; slot < n; ++slot) {
+		const std::uint32_t tri = _tree.indices()[slot];
+		for (int j = 0; j < 3; ++j)
+			owned->indices[3 * slot + j] = indices[3 * tri + j];
+	}
+
+	_positions = owned->positions;
+	_normals = owned->normals;
+	_uvs = owned->uvs;
+	_indices = owned->indices;
+	_storage = std::move(owned);
+	_finalize();
+}
+
+TriangleMesh::TriangleMesh(MeshBuffers buffers, const std::span<const BVHNode> nodes, std::shared_ptr<Material> mat) :
+	_positions(buffers.positions), _normals(buffers.normals), _uvs(buffers.uvs), _indices(buffers.indices),
+	_storage(std::move(buffers.owner)), _mat_ptr(std::move(mat)) {
+	_tree.assign(nodes, _indices.size() / 3);
+	_finalize();
+}
+
+void TriangleMesh::_finalize() {
+	_wide.build(_tree);
+
+	const size_t n_triangles = _indices.size() / 3;
+	_area_cdf.resize(n_triangles);
+	float area_sum = 0.0F;
+	for (size_t tri = 0; tri < n_triangles; ++tri) {
+		const glm::vec3& v0 = _positions[_indices[3 * tri]];
+		const glm::vec3 n_vec =
+			glm::cross(_positions[_indices[3 * tri + 1]] - v0, _positions[_indices[3 * tri + 2]] - v0);
+		area_sum += 0.5F * glm::length(n_vec);
+		_area_cdf[tri] = area_sum;
+	}
+}
+
+bool TriangleMesh::_intersect_triangle(const ShearedRay& ray, const std::uint32_t tri, const float t_min,
+									   const float t_max, TriangleHit& hit) const {
+	const glm::vec3 a = _positions[_indices[3 * tri]] - ray.origin;
+	const glm::vec3 b = _positions[_indices[3 * tri + 1]] - ray.origin;
+	const glm::vec3 c = _positions[_indices[3 * tri + 2]] - ray.origin;
+
+	// 剪切变换后光线沿 +z 轴，三角形投影到 xy 平面上做二维边函数测试
+	const float ax = a[ray.kx] - ray.sx * a[ray.kz];
+	const float ay = a[ray.ky] - ray.sy * a[ray.kz];
+	const float bx = b[ray.kx] - ray.sx * b[ray.kz];
+	const float by = b[ray.ky] - ray.sy * b[ray.kz];
+	const float cx = c[ray.kx] - ray.sx * c[ray.kz];
+	const float cy = c[ray.ky] - ray.sy * c[ray.kz];
+
+	float u = cx * by - cy * bx;
+	float v = ax * cy - ay * cx;
+	float w = bx * ay - by * ax;
+
+	// 边函数恰好为 0 时单精度无法判断光线落在边的哪一侧，改用双精度重新计算，保证共享边不漏
+	if (u == 0.0F || v == 0.0F || w == 0.0F) {
+		u = static_cast<float>(static_cast<double>(cx) * by - static_cast<double>(cy) * bx);
+		v = static_cast<float>(static_cast<double>(ax) * cy - static_cast<double>(ay) * cx);
+		w = static_cast<float>(static_cast<double>(bx) * ay - static_cast<double>(by) * ax);
+	}
+
+	if ((u < 0 || v < 0 || w < 0) && (u > 0 || v > 0 || w > 0)) return false;
+	const float det = u + v + w;
+	if (det == 0.0F) return false;
+
+	const float t_scaled = u * ray.sz * a[ray.kz] + v * ray.sz * b[ray.kz] + w * ray.sz * c[ray.kz];
+	const float inv_det = 1.0F / det;
+	const float t = t_scaled * inv_det;
+	if (!(t >= t_min && t <= t_max)) return false;
+
+	hit.t = t;
+	hit.b1 = v * inv_det;
+	hit.b2 = w * inv_det;
+	hit.tri = tri;
+	return true;
+}
+
+bool TriangleMesh::_intersect_leaf(const ShearedRay& ray, const std::uint32_t first, const std::uint32_t count,
+								   const float t_min, float& t_max, const bool any_hit, TriangleHit& hit) const {
+	bool hit_leaf = false;
+#if RT_ARCH_X86
+	// 将叶子中最多 4 个三角形的顶点按原坐标轴收集为 SoA，再按剪切空间的坐标轴取出整行，
+	// 用 SSE 一次完成 4 个三角形的边函数测试。叶子最多 MAX_LEAF_SIZE == LANES 个三角形，其余通道保持为 0
+	constexpr int LANES = 4;
+	static_assert(BVHTree::MAX_LEAF_SIZE <= LANES);
+	std::array<std::array<float, LANES>, 3> pa{}, pb{}, pc{};
+	const std::uint32_t lanes = std::min(count, static_cast<std::uint32_t>(LANES));
+	for (std::uint32_t k = 0; k < lanes; ++k) {
+		const glm::vec3 a = _positions[_indices[3 * (first + k)]] - ray.origin;
+		const glm::vec3 b = _positions[_indices[3 * (first + k) + 1]] - ray.origin;
+		const glm::vec3 c = _positions[_indices[3 * (first + k) + 2]] - ray.origin;
+		pa[0][k] = a.x, pa[1][k] = a.y, pa[2][k] = a.z;
+		pb[0][k] = b.x, pb[1][k] = b.y, pb[2][k] = b.z;
+		pc[0][k] = c.x, pc[1][k] = c.y, pc[2][k] = c.z;
+	}
+
+	const __m128 sx = _mm_set1_ps(ray.sx);
+	const __m128 sy = _mm_set1_ps(ray.sy);
+	const __m128 sz = _mm_set1_ps(ray.sz);
+	const __m128 a_z = _mm_loadu_ps(pa[ray.kz].data());
+	const __m128 b_z = _mm_loadu_ps(pb[ray.kz].data());
+	const __m128 c_z = _mm_loadu_ps(pc[ray.kz].data());
+	const __m128 a_x = _mm_sub_ps(_mm_loadu_ps(pa[ray.kx].data()), _mm_mul_ps(sx, a_z));
+	const __m128 a_y = _mm_sub_ps(_mm_loadu_ps(pa[ray.ky].data()), _mm_mul_ps(sy, a_z));
+	const __m128 b_x = _mm_sub_ps(_mm_loadu_ps(pb[ray.kx].data()), _mm_mul_ps(sx, b_z));
+	const __m128 b_y = _mm_sub_ps(_mm_loadu_ps(pb[ray.ky].data()), _mm_mul_ps(sy, b_z));
+	const __m128 c_x = _mm_sub_ps(_mm_loadu_ps(pc[ray.kx].data()), _mm_mul_ps(sx, c_z));
+	const __m128 c_y = _mm_sub_ps(_mm_loadu_ps(pc[ray.ky].data()), _mm_mul_ps(sy, c_z));
+
+	const __m128 u = _mm_sub_ps(_mm_mul_ps(c_x, b_y), _mm_mul_ps(c_y, b_x));
+	const __m128 v = _mm_sub_ps(_mm_mul_ps(a_x, c_y), _mm_mul_ps(a_y, c_x));
+	const __m128 w = _mm_sub_ps(_mm_mul_ps(b_x, a_y), _mm_mul_ps(b_y, a_x));
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 any_neg =
+		_mm_or_ps(_mm_or_ps(_mm_cmplt_ps(u, zero), _mm_cmplt_ps(v, zero)), _mm_cmplt_ps(w, zero));
+	const __m128 any_pos =
+		_mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(u, zero), _mm_cmpgt_ps(v, zero)), _mm_cmpgt_ps(w, zero));
+	const __m128 any_zero =
+		_mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(u, zero), _mm_cmpeq_ps(v, zero)), _mm_cmpeq_ps(w, zero));
+
+	const __m128 det = _mm_add_ps(_mm_add_ps(u, v), w);
+	const __m128 t_scaled =
+		_mm_mul_ps(sz, _mm_add_ps(_mm_add_ps(_mm_mul_ps(u, a_z), _mm_mul_ps(v, b_z)), _mm_mul_ps(w, c_z)));
+	const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0F), det);
+	const __m128 t = _mm_mul_ps(t_scaled, inv_det);
+	const __m128 in_range = _mm_and_ps(_mm_cmpge_ps(t, _mm_set1_ps(t_min)), _mm_cmple_ps(t, _mm_set1_ps(t_max)));
+
+	const unsigned lane_mask = (1U << count) - 1U;
+	// 边函数含 0 的通道交给标量路径做双精度判断
+	const unsigned zero_mask = static_cast<unsigned>(_mm_movemask_ps(any_zero)) & lane_mask;
+	const __m128 inside = _mm_andnot_ps(_mm_and_ps(any_neg, any_pos), _mm_cmpneq_ps(det, zero));
+	unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(inside, in_range))) & lane_mask & ~zero_mask;
+
+	std::array<float, LANES> t_lanes{}, b1_lanes{}, b2_lanes{};
+	_mm_storeu_ps(t_lanes.data(), t);
+	_mm_storeu_ps(b1_lanes.data(), _mm_mul_ps(v, inv_det));
+	_mm_storeu_ps(b2_lanes.data(), _mm_mul_ps(w, inv_det));
+	for (; mask != 0; mask &= mask - 1) {
+		const int k = std::countr_zero(mask);
+		if (t_lanes[k] > t_max) continue;
+		hit = {t_lanes[k], b1_lanes[k], b2_lanes[k], first + k};
+		t_max = t_lanes[k];
+		hit_leaf = true;
+		if (any_hit) return true;
+	}
+	for (unsigned zero_lanes = zero_mask; zero_lanes != 0; zero_lanes &= zero_lanes - 1) {
+		const auto k = static_cast<std::uint32_t>(std::countr_zero(zero_lanes));
+		if (_intersect_triangle(ray, first + k, t_min, t_max, hit)) {
+			t_max = hit.t;
+			hit_leaf = true;
+			if (any_hit) return true;
+		}
+	}
+#else
+	for (std::uint32_t tri = first; tri < first + count; ++tri) {
+		if (_intersect_triangle(ray, tri, t_min, t_max, hit)) {
+			t_max = hit.t;
+			hit_leaf = true;
+			if (any_hit) return true;
+		}
+	}
+#endif
+	return hit_leaf;
+}
+
+bool TriangleMesh::_closest_hit(const Ray& r, const double t_min, const double t_max, TriangleHit& hit) const {
+	const ShearedRay ray(r);
+	const auto t_min_f = static_cast<float>(t_min);
+	auto closest_so_far = t_max;
+
+	return _wide.intersect(r, t_min, closest_so_far,
+						   [&](const std::uint32_t first, const std::uint32_t count, double& t_closest) {
+							   float t_leaf = BVHTree::to_float_t(t_closest);
+							   if (!_intersect_leaf(ray, first, count, t_min_f, t_leaf, false, hit)) return false;
+							   t_closest = t_leaf;
+							   return true;
+						   });
+}
+
+glm::vec3 TriangleMesh::_geometric_normal(const std::uint32_t tri) const {
+	const glm::vec3& v0 = _positions[_indices[3 * tri]];
+	return glm::normalize(glm::cross(_positions[_indices[3 * tri + 1]] - v0, _positions[_indices[3 * tri + 2]] - v0));
+}
+
+bool TriangleMesh::hit(const Ray& r, const double t_min, const double t_max, HitRecord& rec) const {
+	TriangleHit tri_hit;
+	if (!_closest_hit(r, t_min, t_max, tri_hit)) return false;
+
+	const std::uint32_t i0 = _indices[3 * tri_hit.tri];
+	const std::uint32_t i1 = _indices[3 * tri_hit.tri + 1];
+	const std::uint32_t i2 = _indices[3 * tri_hit.tri + 2];
+	const float b0 = 1.0F - tri_hit.b1 - tri_hit.b2;
+
+	rec.t = tri_hit.t;
+	// 用重心坐标插值击中点，比 r.at(t) 更贴近三角形平面
+	rec.p = b0 * _positions[i0] + tri_hit.b1 * _positions[i1] + tri_hit.b2 * _positions[i2];
+	rec.set_face_normal(r, _geometric_normal(tri_hit.tri));
+	if (!_normals.empty()) {
+		// 着色法线翻转到与几何法线相同的一侧
+		const glm::vec3 shading =
+			glm::normalize(b0 * _normals[i0] + tri_hit.b1 * _normals[i1] + tri_hit.b2 * _normals[i2]);
+		rec.normal = glm::dot(shading, rec.normal) < 0 ? -shading : shading;
+	}
+	if (!_uvs.empty()) {
+		const glm::vec2 uv = b0 * _uvs[i0] + tri_hit.b1 * _uvs[i1] + tri_hit.b2 * _uvs[i2];
+		rec.u = uv.x;
+		rec.v = uv.y;
+	} else {
+		rec.u = tri_hit.b1;
+		rec.v = tri_hit.b2;
+	}
+	rec.mat_ptr = _mat_ptr.get();
+	rec.material_id = _material_id;
+	return true;
+}
+
+bool TriangleMesh::occluded(const Ray& r, const double t_min, const double t_max) const {
+	const ShearedRay ray(r);
+	const auto t_min_f = static_cast<float>(t_min);
+	return _wide.occluded(r, t_min, t_max, [&](const std::uint32_t first, const std::uint32_t count) {
+		float t_leaf = BVHTree::to_float_t(t_max);
+		TriangleHit tri_hit;
+		return _intersect_leaf(ray, first, count, t_min_f, t_leaf, true, tri_hit);
+	});
+}
+
+double TriangleMesh::pdf_value(const glm::vec3& origin, const glm::vec3& v) const {
+	TriangleHit tri_hit;
+	if (_area_cdf.empty() || !_closest_hit(Ray(origin, v), 0.001, DOUBLE_INF, tri_hit)) return 0;
+
+	const double distance_squared = static_cast<double>(tri_hit.t) * tri_hit.t * glm::length2(v);
+	const double cosine = std::fabs(glm::dot(v, _geometric_normal(tri_hit.tri)) / glm::length(v));
+	return distance_squared / (cosine * _area_cdf.back());
+}
+
+glm::vec3 TriangleMesh::random(const glm::vec3& origin, Sampler& sampler) const {
+	if (_area_cdf.empty()) return {1, 0, 0};
+
+	// 按面积选择三角形，再在三角形内均匀采样
+	const auto target = sampler.get_1d() * _area_cdf.back();
+	const auto it = std::ranges::upper_bound(_area_cdf, target);
+	const auto tri = static_cast<std::uint32_t>(std::min<size_t>(it - _area_cdf.begin(), _area_cdf.size() - 1));
+
+	const glm::vec2 u = sampler.get_2d();
+	const auto su = std::sqrt(u.x);
+	const auto r2 = u.y;
+	const glm::vec3 p = (1.0F - su) * _positions[_indices[3 * tri]] + (r2 * su) * _positions[_indices[3 * tri + 1]] +
+						(su * (1.0F - r2)) * _positions[_indices[3 * tri + 2]];
+	return p - origin;
+}
+
+void TriangleMesh::bind_materials(MaterialTable& table) {
+	_material_id = table.add(_mat_ptr);
+}
+
+} // namespace rt
@@ -0,0 +1,120 @@
+#include "rt/io/Checkpoint.hpp"
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace rt {
+
+namespace {
+
+constexpr std::array<char, 8> CHECKPOINT_MAGIC = {'R', 'T', 'C', 'K', 'P', 'T', '\0', '\0'};
+constexpr std::uint32_t CHECKPOINT_VERSION = 2;
+constexpr std::uint32_t CHECKPOINT_ENDIAN_TAG = 0x01020304;
+
+/**
+ * @brief 检查点文件头，之后依次是采样数（int32）、各层辐射度（glm::vec3）与亮度平方和（double）三个数组。
+ */
+struct CheckpointHeader {
+	std::array<char, 8> magic{};  ///< 文件标识。
+	std::uint32_t version = 0;	  ///< 格式版本。
+	std::uint32_t endian_tag = 0; ///< 字节序标记。
+	std::uint32_t vec3_size = 0;  ///< sizeof(glm::vec3)。
+	std::uint32_t sampler = 0;	  ///< 采样器类型。
+	std::int32_t width = 0;		  ///< 图像宽度。
+	std::int32_t height = 0;	  ///< 图像高度。
+	std::int32_t layers = 0;	  ///< 辐射度的层数。
+	std::int32_t reserved = 0;	  ///< 保留，使 seed 按 8 字节对齐。
+	std::uint64_t seed = 0;		  ///< 随机数种子。
+};
+static_assert(std::is_trivially_copyable_v<CheckpointHeader>);
+
+} // namespace
+
+bool RenderCheckpoint::save(const std::filesystem::path& path) const {
+	const size_t pixel_count = sample_counts.size();
+	if (layers <= 0 || radiance.size() != pixel_count * static_cast<size_t>(layers) ||
+		luminance_sq.size() != pixel_count)
+		return false;
+
+	CheckpointHeader header;
+	header.magic = CHECKPOINT_MAGIC;
+	header.version = CHECKPOINT_VERSION;
+	header.endian_tag = CHECKPOINT_ENDIAN_TAG;
+	header.vec3_size = sizeof(glm::vec3);
+	header.sampler = static_cast<std::uint32_t>(sampler);
+	header.width = width;
+	header.height = height;
+	header.layers = layers;
+	header.seed = seed;
+
+	std::filesystem::path temp = path;
+	temp += ".tmp";
+	{
+		std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(sample_counts.data()),
+				  static_cast<std::streamsize>(pixel_count * sizeof(int)));
+		out.write(reinterpret_cast<const char*>(radiance.data()),
+				  static_cast<std::streamsize>(radiance.size() * sizeof(glm::vec3)));
+		out.write(reinterpret_cast<const char*>(luminance_sq.data()),
+				  static_cast<std::streamsize>(pixel_count * sizeof(double)));
+		if (!out.flush()) {
+			out.close();
+			std::error_code ec;
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(temp, path, ec);
+	if (ec) std::filesystem::remove(temp, ec);
+	return !ec;
+}
+
+std::optional<RenderCheckpoint> RenderCheckpoint::load(const std::filesystem::path& path) {
+	std::error_code ec;
+	if (!std::filesystem::exists(path, ec)) return std::nullopt;
+
+	std::ifstream in(path, std::ios::binary);
+	if (!in) throw std::runtime_error("cannot open " + path.string());
+	CheckpointHeader header;
+	in.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!in || header.magic != CHECKPOINT_MAGIC) throw std::runtime_error(path.string() + " is not a checkpoint");
+	if (header.version != CHECKPOINT_VERSION || header.endian_tag != CHECKPOINT_ENDIAN_TAG ||
+		header.vec3_size != sizeof(glm::vec3))
+		throw std::runtime_error(path.string() + " was written by an incompatible build");
+	if (header.width <= 0 || header.height <= 0 || header.layers <= 0 ||
+		header.sampler > static_cast<std::uint32_t>(SamplerType::PMJ02))
+		throw std::runtime_error(path.string() + " has an invalid header");
+
+	const size_t pixel_count = static_cast<size_t>(header.width) * static_cast<size_t>(header.height);
+	const std::uintmax_t expected_size =
+		sizeof(header) + pixel_count * (sizeof(int) + static_cast<size_t>(header.layers) * sizeof(glm::vec3) + sizeof(double));
+	if (std::filesystem::file_size(path, ec) != expected_size || ec)
+		throw std::runtime_error(path.string() + " is truncated");
+
+	RenderCheckpoint checkpoint;
+	checkpoint.width = header.width;
+	checkpoint.height = header.height;
+	checkpoint.layers = header.layers;
+	checkpoint.sampler = static_cast<SamplerType>(header.sampler);
+	checkpoint.seed = header.seed;
+	checkpoint.sample_counts.resize(pixel_count);
+	checkpoint.radiance.resize(pixel_count * static_cast<size_t>(header.layers));
+	checkpoint.luminance_sq.resize(pixel_count);
+	in.read(reinterpret_cast<char*>(checkpoint.sample_counts.data()),
+			static_cast<std::streamsize>(pixel_count * sizeof(int)));
+	in.read(reinterpret_cast<char*>(checkpoint.radiance.data()),
+			static_cast<std::streamsize>(checkpoint.radiance.size() * sizeof(glm::vec3)));
+	in.read(reinterpret_cast<char*>(checkpoint.luminance_sq.data()),
+			static_cast<std::streamsize>(pixel_count * sizeof(double)));
+	if (!in) throw std::runtime_error("cannot read " + path.string());
+	for (const int count : checkpoint.sample_counts)
+		if (count < 0) throw std::runtime_error(path.string() + " has negative sample counts");
+	return checkpoint;
+}
+
+} // namespace rt
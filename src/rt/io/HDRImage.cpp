@@ -0,0 +1,486 @@
+#include "rt/io/HDRImage.hpp"
+#include "rt/io/MappedFile.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace rt {
+
+namespace {
+
+constexpr std::array<unsigned char, 4> EXR_MAGIC = {0x76, 0x2f, 0x31, 0x01};
+constexpr std::uint32_t EXR_VERSION = 2;
+constexpr std::uint32_t EXR_TILED_FLAG = 0x200;		///< 版本字段中的分块图像标记。
+constexpr std::uint32_t EXR_NON_IMAGE_FLAG = 0x800; ///< 深度数据标记。
+constexpr std::uint32_t EXR_MULTIPART_FLAG = 0x1000; ///< 多部分文件标记。
+constexpr std::int32_t EXR_HALF = 1;
+constexpr std::int32_t EXR_FLOAT = 2;
+constexpr unsigned char EXR_NO_COMPRESSION = 0;
+constexpr unsigned char EXR_ZIPS_COMPRESSION = 2;
+constexpr unsigned char EXR_ZIP_COMPRESSION = 3;
+constexpr int ZIP_LINES = 16;		   ///< ZIP 压缩每块的行数。
+constexpr int ZIP_LEVEL = 4;		   ///< zlib 压缩级别，在压缩率与写出耗时之间折中。
+
+/**
+ * @brief 小端序的字节缓冲写入器。
+ */
+struct ByteWriter {
+	std::vector<unsigned char> bytes;
+
+	void u8(const unsigned char v) { bytes.push_back(v); }
+
+	void u32(const std::uint32_t v) {
+		for (int k = 0; k < 4; ++k)
+			bytes.push_back(static_cast<unsigned char>(v >> (8 * k)));
+	}
+
+	void i32(const std::int32_t v) { u32(static_cast<std::uint32_t>(v)); }
+
+	void u64(const std::uint64_t v) {
+		for (int k = 0; k < 8; ++k)
+			bytes.push_back(static_cast<unsigned char>(v >> (8 * k)));
+	}
+
+	void f32(const float v) { u32(std::bit_cast<std::uint32_t>(v)); }
+
+	void str(const std::string_view s) {
+		bytes.insert(bytes.end(), s.begin(), s.end());
+		bytes.push_back(0);
+	}
+
+	/**
+	 * @brief 写入一个 EXR 头部属性：名称、类型、值的字节数，值由 write_value 写入。
+	 */
+	template <typename F>
+	void attribute(const std::string_view name, const std::string_view type, const std::uint32_t size,
+				   F&& write_value) {
+		str(name);
+		str(type);
+		u32(size);
+		write_value();
+	}
+};
+
+/**
+ * @brief 从映射的字节中按小端序读取，越界时抛出异常。
+ */
+struct ByteReader {
+	std::span<const std::byte> bytes;
+	size_t pos = 0;
+
+	void require(const size_t n) const {
+		if (n > bytes.size() - pos) throw std::runtime_error("EXR file is truncated");
+	}
+
+	std::uint32_t u32() {
+		require(4);
+		std::uint32_t v = 0;
+		for (int k = 0; k < 4; ++k)
+			v |= std::to_integer<std::uint32_t>(bytes[pos + k]) << (8 * k);
+		pos += 4;
+		return v;
+	}
+
+	std::int32_t i32() { return static_cast<std::int32_t>(u32()); }
+
+	std::uint64_t u64() {
+		const std::uint64_t lo = u32();
+		return lo | (std::uint64_t{u32()} << 32U);
+	}
+
+	std::string_view str() {
+		const auto* begin = reinterpret_cast<const char*>(bytes.data() + pos);
+		const size_t length = std::string_view(begin, bytes.size() - pos).find('\0');
+		if (length == std::string_view::npos) throw std::runtime_error("EXR file is truncated");
+		pos += length + 1;
+		return {begin, length};
+	}
+};
+
+float half_to_float(const std::uint16_t h) {
+	const std::uint32_t sign = (h & 0x8000U) << 16U;
+	std::uint32_t exponent = (h >> 10U) & 0x1fU;
+	std::uint32_t mantissa = h & 0x3ffU;
+	if (exponent == 0x1fU) return std::bit_cast<float>(sign | 0x7f800000U | (mantissa << 13U)); // Inf 与 NaN
+	if (exponent == 0) {
+		if (mantissa == 0) return std::bit_cast<float>(sign);
+		// 非规格化数：规格化后再换算指数
+		exponent = 1;
+		while ((mantissa & 0x400U) == 0) {
+			mantissa <<= 1U;
+			--exponent;
+		}
+		mantissa &= 0x3ffU;
+	}
+	return std::bit_cast<float>(sign | ((exponent + 112U) << 23U) | (mantissa << 13U));
+}
+
+/**
+ * @brief EXR ZIP 压缩的预处理：字节按奇偶位置分成前后两半，再做差分预测，使相邻像素相近的字节更易压缩。
+ */
+void exr_predict(const std::vector<unsigned char>& raw, std::vector<unsigned char>& out) {
+	out.resize(raw.size());
+	const size_t half = (raw.size() + 1) / 2;
+	for (size_t k = 0; k < raw.size(); ++k)
+		out[(k % 2 == 0 ? 0 : half) + k / 2] = raw[k];
+	for (size_t k = out.size(); k-- > 1;)
+		out[k] = static_cast<unsigned char>(out[k] - out[k - 1] + 128);
+}
+
+/**
+ * @brief exr_predict 的逆变换。
+ */
+void exr_unpredict(std::vector<unsigned char>& data, std::vector<unsigned char>& out) {
+	for (size_t k = 1; k < data.size(); ++k)
+		data[k] = static_cast<unsigned char>(data[k - 1] + data[k] - 128);
+	out.resize(data.size());
+	const size_t half = (data.size() + 1) / 2;
+	for (size_t k = 0; k < data.size(); ++k)
+		out[k] = data[(k % 2 == 0 ? 0 : half) + k / 2];
+}
+
+/**
+ * @brief 写出整个文件，先写入临时文件再重命名，避免留下不完整的图像。
+ */
+bool write_file(const std::filesystem::path& path, const std::vector<unsigned char>& bytes) {
+	std::filesystem::path temp = path;
+	temp += ".tmp";
+	{
+		std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+		out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		if (!out.flush()) {
+			out.close();
+			std::error_code ec;
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(temp, path, ec);
+	if (ec) std::filesystem::remove(temp, ec);
+	return !ec;
+}
+
+} // namespace
+
+bool HDRImage::write_pfm(const std::filesystem::path& path) const {
+	ByteWriter writer;
+	const std::string header = "PF\n" + std::to_string(width) + " " + std::to_string(height) + "\n-1.0\n";
+	writer.bytes.assign(header.begin(), header.end());
+	writer.bytes.reserve(header.size() + pixels.size() * 12);
+	for (int y = height - 1; y >= 0; --y) {
+		for (int x = 0; x < width; ++x) {
+			const glm::vec3& p = pixels[static_cast<size_t>(y) * width + x];
+			writer.f32(p.x);
+			writer.f32(p.y);
+			writer.f32(p.z);
+		}
+	}
+	return write_file(path, writer.bytes);
+}
+
+bool HDRImage::write_exr(const std::filesystem::path& path, const ExrCompression compression) const {
+	const int lines_per_chunk = compression == ExrCompression::ZIP ? ZIP_LINES : 1;
+	const int chunk_count = (height + lines_per_chunk - 1) / lines_per_chunk;
+
+	ByteWriter writer;
+	writer.bytes.assign(EXR_MAGIC.begin(), EXR_MAGIC.end());
+	writer.u32(EXR_VERSION);
+	// 通道按名称字母序排列
+	writer.attribute("channels", "chlist", 3 * 18 + 1, [&] {
+		for (const char* name : {"B", "G", "R"}) {
+			writer.str(name);
+			writer.i32(EXR_FLOAT);
+			writer.u32(0); // pLinear 与保留字节
+			writer.i32(1);
+			writer.i32(1);
+		}
+		writer.u8(0);
+	});
+	writer.attribute("compression", "compression", 1, [&] {
+		writer.u8(compression == ExrCompression::ZIP ? EXR_ZIP_COMPRESSION : EXR_NO_COMPRESSION);
+	});
+	for (const char* window : {"dataWindow", "displayWindow"}) {
+		writer.attribute(window, "box2i", 16, [&] {
+			writer.i32(0);
+			writer.i32(0);
+			writer.i32(width - 1);
+			writer.i32(height - 1);
+		});
+	}
+	writer.attribute("lineOrder", "lineOrder", 1, [&] { writer.u8(0); });
+	writer.attribute("pixelAspectRatio", "float", 4, [&] { writer.f32(1.0F); });
+	writer.attribute("screenWindowCenter", "v2f", 8, [&] {
+		writer.f32(0.0F);
+		writer.f32(0.0F);
+	});
+	writer.attribute("screenWindowWidth", "float", 4, [&] { writer.f32(1.0F); });
+	writer.u8(0);
+
+	// 各块独立打包与压缩；压缩后不比原数据小的块按 EXR 约定直接保存原数据
+	std::vector<std::vector<unsigned char>> chunks(chunk_count);
+	bool ok = true;
+#pragma omp parallel for schedule(dynamic, 1) reduction(&& : ok)
+	for (int c = 0; c < chunk_count; ++c) {
+		const int y0 = c * lines_per_chunk;
+		const int y1 = std::min(y0 + lines_per_chunk, height);
+		ByteWriter raw;
+		raw.bytes.reserve(static_cast<size_t>(y1 - y0) * width * 12);
+		for (int y = y0; y < y1; ++y) {
+			const glm::vec3* row = pixels.data() + static_cast<size_t>(y) * width;
+			for (int channel = 2; channel >= 0; --channel)
+				for (int x = 0; x < width; ++x)
+					raw.f32(row[x][channel]);
+		}
+
+		std::vector<unsigned char>& chunk = chunks[c];
+		if (compression == ExrCompression::ZIP) {
+			std::vector<unsigned char> predicted;
+			exr_predict(raw.bytes, predicted);
+			uLongf size = compressBound(static_cast<uLong>(predicted.size()));
+			chunk.resize(size);
+			if (compress2(chunk.data(), &size, predicted.data(), static_cast<uLong>(predicted.size()), ZIP_LEVEL) != Z_OK)
+				ok = false;
+			chunk.resize(size);
+			if (size >= raw.bytes.size()) chunk = std::move(raw.bytes);
+		} else {
+			chunk = std::move(raw.bytes);
+		}
+	}
+	if (!ok) return false;
+
+	// 偏移表之后依次是各块：起始行、数据字节数与数据
+	std::uint64_t offset = writer.bytes.size() + static_cast<std::uint64_t>(chunk_count) * 8;
+	for (int c = 0; c < chunk_count; ++c) {
+		writer.u64(offset);
+		offset += 8 + chunks[c].size();
+	}
+	for (int c = 0; c < chunk_count; ++c) {
+		writer.i32(c * lines_per_chunk);
+		writer.u32(static_cast<std::uint32_t>(chunks[c].size()));
+		writer.bytes.insert(writer.bytes.end(), chunks[c].begin(), chunks[c].end());
+	}
+	return write_file(path, writer.bytes);
+}
+
+bool HDRImage::write(const std::filesystem::path& path, const HDRFormat format) const {
+	switch (format) {
+		case HDRFormat::PFM:
+			return write_pfm(path);
+		case HDRFormat::EXR:
+			return write_exr(path);
+		case HDRFormat::NONE:
+		default:
+			return true;
+	}
+}
+
+HDRImage HDRImage::read_pfm(const std::filesystem::path& path) {
+	const MappedFile file(path);
+	const std::string_view content(reinterpret_cast<const char*>(file.data()), file.size());
+
+	// 头部依次是以空白分隔的标识、宽、高与比例（负数表示小端序），比例之后恰好一个空白字符
+	size_t pos = 0;
+	const auto token = [&] {
+		while (pos < content.size() && std::isspace(static_cast<unsigned char>(content[pos])) != 0)
+			++pos;
+		const size_t begin = pos;
+		while (pos < content.size() && std::isspace(static_cast<unsigned char>(content[pos])) == 0)
+			++pos;
+		return content.substr(begin, pos - begin);
+	};
+	const std::string_view magic = token();
+	if (magic != "PF" && magic != "Pf") throw std::runtime_error(path.string() + " is not a PFM file");
+	const int channels = magic == "PF" ? 3 : 1;
+
+	HDRImage image;
+	const std::string_view w = token();
+	const std::string_view h = token();
+	const std::string scale(token());
+	if (std::from_chars(w.data(), w.data() + w.size(), image.width).ec != std::errc() ||
+		std::from_chars(h.data(), h.data() + h.size(), image.height).ec != std::errc() || image.width <= 0 ||
+		image.height <= 0 || scale.empty())
+		throw std::runtime_error(path.string() + " has an invalid PFM header");
+	const bool little_endian = std::stod(scale) < 0.0;
+	++pos;
+
+	const size_t count = static_cast<size_t>(image.width) * image.height;
+	if (content.size() < pos || (content.size() - pos) / (4 * channels) < count)
+		throw std::runtime_error(path.string() + " is truncated");
+	const auto* data = reinterpret_cast<const unsigned char*>(content.data() + pos);
+	const auto value = [&](const size_t index) {
+		const unsigned char* b = data + 4 * index;
+		const std::uint32_t bits =
+			little_endian ? (std::uint32_t{b[0]} | std::uint32_t{b[1]} << 8U | std::uint32_t{b[2]} << 16U |
+							 std::uint32_t{b[3]} << 24U)
+						  : (std::uint32_t{b[3]} | std::uint32_t{b[2]} << 8U | std::uint32_t{b[1]} << 16U |
+							 std::uint32_t{b[0]} << 24U);
+		return std::bit_cast<float>(bits);
+	};
+
+	image.pixels.resize(count);
+	for (int y = 0; y < image.height; ++y) {
+		// PFM 从最下一行开始存放
+		const size_t row = static_cast<size_t>(image.height - 1 - y) * image.width;
+		for (int x = 0; x < image.width; ++x) {
+			const size_t k = (row + x) * channels;
+			image.pixels[static_cast<size_t>(y) * image.width + x] =
+				channels == 3 ? glm::vec3(value(k), value(k + 1), value(k + 2)) : glm::vec3(value(k));
+		}
+	}
+	return image;
+}
+
+HDRImage HDRImage::read_exr(const std::filesystem::path& path) {
+	const MappedFile file(path);
+	ByteReader reader{file.bytes()};
+	reader.require(8);
+	if (std::memcmp(file.data(), EXR_MAGIC.data(), EXR_MAGIC.size()) != 0)
+		throw std::runtime_error(path.string() + " is not an OpenEXR file");
+	reader.pos = 4;
+	const std::uint32_t version = reader.u32();
+	if ((version & 0xffU) != EXR_VERSION || (version & (EXR_TILED_FLAG | EXR_NON_IMAGE_FLAG | EXR_MULTIPART_FLAG)) != 0)
+		throw std::runtime_error(path.string() + ": only single-part scanline OpenEXR files are supported");
+
+	struct Channel {
+		std::string name;
+		std::int32_t type;
+	};
+	std::vector<Channel> channels;
+	int compression = -1;
+	std::array<std::int32_t, 4> window{};
+	bool has_window = false;
+	while (true) {
+		const std::string_view name = reader.str();
+		if (name.empty()) break;
+		const std::string_view type = reader.str();
+		const std::uint32_t size = reader.u32();
+		reader.require(size);
+		const size_t end = reader.pos + size;
+		if (name == "channels" && type == "chlist") {
+			while (true) {
+				const std::string_view channel = reader.str();
+				if (channel.empty()) break;
+				const std::int32_t pixel_type = reader.i32();
+				reader.u32(); // pLinear 与保留字节
+				if (reader.i32() != 1 || reader.i32() != 1)
+					throw std::runtime_error(path.string() + ": subsampled channels are not supported");
+				if (pixel_type != EXR_HALF && pixel_type != EXR_FLOAT)
+					throw std::runtime_error(path.string() + ": only half and float channels are supported");
+				channels.push_back({std::string(channel), pixel_type});
+			}
+		} else if (name == "compression" && size == 1) {
+			compression = std::to_integer<int>(file.bytes()[reader.pos]);
+		} else if (name == "dataWindow" && size == 16) {
+			for (auto& v : window)
+				v = reader.i32();
+			has_window = true;
+		}
+		if (reader.pos > end) throw std::runtime_error(path.string() + " has an invalid header");
+		reader.pos = end;
+	}
+
+	if (compression != EXR_NO_COMPRESSION && compression != EXR_ZIPS_COMPRESSION && compression != EXR_ZIP_COMPRESSION)
+		throw std::runtime_error(path.string() + ": only NONE, ZIPS and ZIP compression are supported");
+	if (!has_window || window[2] < window[0] || window[3] < window[1] ||
+		static_cast<std::int64_t>(window[2]) - window[0] >= std::numeric_limits<std::int32_t>::max() ||
+		static_cast<std::int64_t>(window[3]) - window[1] >= std::numeric_limits<std::int32_t>::max())
+		throw std::runtime_error(path.string() + " has an invalid data window");
+
+	HDRImage image;
+	image.width = window[2] - window[0] + 1;
+	image.height = window[3] - window[1] + 1;
+	image.pixels.assign(static_cast<size_t>(image.width) * image.height, glm::vec3(0.0F));
+
+	// 每行依次存放各通道的全部像素；记录 R、G、B 通道在行内的偏移
+	std::array<size_t, 3> rgb_offset{};
+	std::array<std::int32_t, 3> rgb_type{};
+	std::array<bool, 3> rgb_found{};
+	size_t line_bytes = 0;
+	for (const Channel& channel : channels) {
+		const size_t bytes = channel.type == EXR_HALF ? 2 : 4;
+		for (int c = 0; c < 3; ++c) {
+			if (channel.name == std::string_view("RGB" + c, 1)) {
+				rgb_offset[c] = line_bytes;
+				rgb_type[c] = channel.type;
+				rgb_found[c] = true;
+			}
+		}
+		line_bytes += bytes * image.width;
+	}
+	if (!rgb_found[0] && !rgb_found[1] && !rgb_found[2])
+		throw std::runtime_error(path.string() + " has no R, G or B channel");
+
+	const int lines_per_chunk = compression == EXR_ZIP_COMPRESSION ? ZIP_LINES : 1;
+	const int chunk_count = (image.height + lines_per_chunk - 1) / lines_per_chunk;
+	std::vector<std::uint64_t> offsets(chunk_count);
+	for (auto& offset : offsets)
+		offset = reader.u64();
+
+	std::vector<unsigned char> packed;
+	std::vector<unsigned char> predicted;
+	std::vector<unsigned char> raw;
+	for (int c = 0; c < chunk_count; ++c) {
+		if (offsets[c] > file.size()) throw std::runtime_error(path.string() + " is truncated");
+		reader.pos = offsets[c];
+		const std::int32_t y0 = reader.i32() - window[1];
+		const std::uint32_t size = reader.u32();
+		reader.require(size);
+		if (y0 < 0 || y0 >= image.height || y0 % lines_per_chunk != 0)
+			throw std::runtime_error(path.string() + " has an invalid chunk");
+		const int lines = std::min(lines_per_chunk, image.height - y0);
+		const size_t raw_size = line_bytes * lines;
+		const auto* data = reinterpret_cast<const unsigned char*>(file.data() + reader.pos);
+
+		if (compression == EXR_NO_COMPRESSION || size == raw_size) {
+			raw.assign(data, data + size);
+		} else {
+			predicted.resize(raw_size);
+			uLongf unpacked = raw_size;
+			if (uncompress(predicted.data(), &unpacked, data, size) != Z_OK || unpacked != raw_size)
+				throw std::runtime_error(path.string() + " has a corrupt ZIP chunk");
+			exr_unpredict(predicted, raw);
+		}
+		if (raw.size() != raw_size) throw std::runtime_error(path.string() + " has an invalid chunk size");
+
+		for (int line = 0; line < lines; ++line) {
+			const unsigned char* row = raw.data() + line * line_bytes;
+			glm::vec3* out = image.pixels.data() + static_cast<size_t>(y0 + line) * image.width;
+			for (int channel = 0; channel < 3; ++channel) {
+				if (!rgb_found[channel]) continue;
+				const unsigned char* p = row + rgb_offset[channel];
+				for (int x = 0; x < image.width; ++x) {
+					if (rgb_type[channel] == EXR_HALF) {
+						out[x][channel] = half_to_float(static_cast<std::uint16_t>(p[2 * x] | p[2 * x + 1] << 8U));
+					} else {
+						const unsigned char* b = p + 4 * x;
+						out[x][channel] = std::bit_cast<float>(std::uint32_t{b[0]} | std::uint32_t{b[1]} << 8U |
+															   std::uint32_t{b[2]} << 16U | std::uint32_t{b[3]} << 24U);
+					}
+				}
+			}
+		}
+	}
+	return image;
+}
+
+HDRImage HDRImage::read(const std::filesystem::path& path) {
+	std::string ext = path.extension().string();
+	std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	if (ext == ".pfm") return read_pfm(path);
+	if (ext == ".exr") return read_exr(path);
+	throw std::runtime_error("unsupported HDR image format: " + path.string());
+}
+
+} // namespace rt
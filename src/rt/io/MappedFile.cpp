@@ -0,0 +1,80 @@
+#include "rt/io/MappedFile.hpp"
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rt {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot open " + path.string());
+	LARGE_INTEGER size{};
+	if (GetFileSizeEx(file, &size) == 0) {
+		CloseHandle(file);
+		throw std::runtime_error("cannot stat " + path.string());
+	}
+	_file = file;
+	_size = static_cast<size_t>(size.QuadPart);
+	if (_size == 0) return;
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		if (mapping != nullptr) CloseHandle(mapping);
+		CloseHandle(file);
+		throw std::runtime_error("cannot map " + path.string());
+	}
+	_mapping = mapping;
+	_data = static_cast<const std::byte*>(view);
+}
+
+MappedFile::~MappedFile() {
+	if (_data != nullptr) UnmapViewOfFile(_data);
+	if (_mapping != nullptr) CloseHandle(_mapping);
+	if (_file != nullptr) CloseHandle(_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("cannot open " + path.string());
+	struct stat st {};
+	if (::fstat(fd, &st) != 0) {
+		::close(fd);
+		throw std::runtime_error("cannot stat " + path.string());
+	}
+	_size = static_cast<size_t>(st.st_size);
+	if (_size == 0) {
+		::close(fd);
+		return;
+	}
+
+	void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// 映射建立后文件描述符即可关闭，映射本身保持有效
+	::close(fd);
+	if (addr == MAP_FAILED) throw std::runtime_error("cannot map " + path.string());
+	_data = static_cast<const std::byte*>(addr);
+}
+
+MappedFile::~MappedFile() {
+	if (_data != nullptr) ::munmap(const_cast<std::byte*>(_data), _size);
+}
+
+#endif
+
+} // namespace rt
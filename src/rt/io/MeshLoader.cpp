@@ -0,0 +1,875 @@
+#include "rt/io/MeshLoader.hpp"
+#include "rt/io/MappedFile.hpp"
+#include <omp.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(const Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief 解析得到的网格数据，交给 TriangleMesh 构建 BVH。
+ */
+struct ParsedMesh {
+	std::vector<glm::vec3> positions;	///< 顶点位置。
+	std::vector<glm::vec3> normals;		///< 顶点法线（可为空）。
+	std::vector<glm::vec2> uvs;			///< 顶点纹理坐标（可为空）。
+	std::vector<std::uint32_t> indices; ///< 三角形顶点下标。
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// OBJ
+// ---------------------------------------------------------------------------------------------------------------------
+
+constexpr std::int32_t NO_INDEX = std::numeric_limits<std::int32_t>::min(); ///< 面顶点未给出该属性。
+constexpr size_t OBJ_MIN_CHUNK_BYTES = size_t{1} << 16;					///< 每块至少的字节数，避免切分过细。
+
+/**
+ * @brief OBJ 面的一个角：位置、纹理坐标与法线的下标。
+ *
+ * 负下标（相对下标）在块内解析时只知道本块之前的数量，先记录为块内下标并在 relative 中标记，合并时再加上前面各块的数量。
+ */
+struct ObjCorner {
+	std::int32_t v = NO_INDEX;	///< 位置下标。
+	std::int32_t vt = NO_INDEX; ///< 纹理坐标下标。
+	std::int32_t vn = NO_INDEX; ///< 法线下标。
+	std::uint8_t relative = 0;	///< 第 0/1/2 位分别表示 v/vt/vn 为块内相对下标。
+
+	bool operator==(const ObjCorner& other) const { return v == other.v && vt == other.vt && vn == other.vn; }
+};
+
+struct ObjCornerHash {
+	size_t operator()(const ObjCorner& c) const {
+		std::uint64_t h = static_cast<std::uint32_t>(c.v) * 0x9E3779B97F4A7C15ULL;
+		h ^= (static_cast<std::uint32_t>(c.vt) + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2));
+		h ^= (static_cast<std::uint32_t>(c.vn) + 0x85157AF5ULL + (h << 6) + (h >> 2));
+		return static_cast<size_t>(h);
+	}
+};
+
+/**
+ * @brief 一块 OBJ 文本的解析结果，面已按扇形三角化，每 3 个角为一个三角形。
+ */
+struct ObjChunk {
+	std::vector<glm::vec3> positions; ///< 本块的 v。
+	std::vector<glm::vec2> uvs;		  ///< 本块的 vt。
+	std::vector<glm::vec3> normals;	  ///< 本块的 vn。
+	std::vector<ObjCorner> corners;	  ///< 三角形的角。
+	std::string error;				  ///< 解析错误，为空表示成功。
+};
+
+const char* skip_space(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+	return p;
+}
+
+bool parse_float(const char*& p, const char* end, float& out) {
+	p = skip_space(p, end);
+	if (p < end && *p == '+') ++p;
+	const auto [ptr, ec] = std::from_chars(p, end, out);
+	if (ec != std::errc()) return false;
+	p = ptr;
+	return true;
+}
+
+/**
+ * @brief 解析一个 OBJ 下标，1 起始的正下标转为 0 起始，负下标相对于块内当前数量。
+ */
+bool parse_obj_index(const char*& p, const char* end, const size_t local_count, const std::uint8_t relative_bit,
+					 std::int32_t& out, std::uint8_t& relative) {
+	std::int64_t idx = 0;
+	const auto [ptr, ec] = std::from_chars(p, end, idx);
+	if (ec != std::errc() || idx == 0 || idx > std::numeric_limits<std::int32_t>::max() ||
+		idx < -std::numeric_limits<std::int32_t>::max())
+		return false;
+	p = ptr;
+	if (idx > 0) {
+		out = static_cast<std::int32_t>(idx - 1);
+	} else {
+		out = static_cast<std::int32_t>(static_cast<std::int64_t>(local_count) + idx);
+		relative |= relative_bit;
+	}
+	return true;
+}
+
+/**
+ * @brief 解析面的一个角：v、v/vt、v//vn 或 v/vt/vn。
+ */
+bool parse_obj_corner(const char*& p, const char* end, const ObjChunk& chunk, ObjCorner& corner) {
+	if (!parse_obj_index(p, end, chunk.positions.size(), 1, corner.v, corner.relative)) return false;
+	if (p == end || *p != '/') return true;
+	++p;
+	if (p < end && *p != '/') {
+		if (!parse_obj_index(p, end, chunk.uvs.size(), 2, corner.vt, corner.relative)) return false;
+	}
+	if (p == end || *p != '/') return true;
+	++p;
+	return parse_obj_index(p, end, chunk.normals.size(), 4, corner.vn, corner.relative);
+}
+
+void parse_obj_chunk(const char* begin, const char* end, ObjChunk& chunk) {
+	std::vector<ObjCorner> polygon;
+	for (const char* line = begin; line < end;) {
+		const auto* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+		const char* line_end = newline != nullptr ? newline : end;
+		const char* line_begin = line;
+		const char* p = skip_space(line, line_end);
+		line = line_end + 1;
+		if (line_end - p < 2) continue;
+
+		bool ok = true;
+		if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+			glm::vec3 v;
+			p += 2;
+			ok = parse_float(p, line_end, v.x) && parse_float(p, line_end, v.y) && parse_float(p, line_end, v.z);
+			chunk.positions.push_back(v);
+		} else if (p[0] == 'v' && p[1] == 't') {
+			glm::vec2 uv(0.0F);
+			p += 2;
+			ok = parse_float(p, line_end, uv.x);
+			// 一维纹理坐标允许省略 v
+			if (ok && !parse_float(p, line_end, uv.y)) uv.y = 0.0F;
+			chunk.uvs.push_back(uv);
+		} else if (p[0] == 'v' && p[1] == 'n') {
+			glm::vec3 n;
+			p += 2;
+			ok = parse_float(p, line_end, n.x) && parse_float(p, line_end, n.y) && parse_float(p, line_end, n.z);
+			chunk.normals.push_back(n);
+		} else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+			polygon.clear();
+			p = skip_space(p + 2, line_end);
+			while (ok && p < line_end) {
+				ObjCorner corner;
+				ok = parse_obj_corner(p, line_end, chunk, corner);
+				polygon.push_back(corner);
+				p = skip_space(p, line_end);
+			}
+			ok = ok && polygon.size() >= 3;
+			// 凸多边形按扇形三角化
+			for (size_t k = 1; ok && k + 1 < polygon.size(); ++k)
+				chunk.corners.insert(chunk.corners.end(), {polygon[0], polygon[k], polygon[k + 1]});
+		}
+
+		if (!ok) {
+			chunk.error = "malformed line: " + std::string(line_begin, line_end);
+			return;
+		}
+	}
+}
+
+ParsedMesh parse_obj(const MappedFile& file) {
+	const auto* text = reinterpret_cast<const char*>(file.data());
+	const size_t size = file.size();
+
+	// 按行边界把文件切成若干块，块数多于线程数以平衡负载
+	const auto n_threads = static_cast<size_t>(omp_get_max_threads());
+	const size_t n_chunks = std::clamp<size_t>(size / OBJ_MIN_CHUNK_BYTES, 1, 4 * n_threads);
+	std::vector<size_t> bounds(n_chunks + 1, size);
+	bounds[0] = 0;
+	for (size_t i = 1; i < n_chunks; ++i) {
+		size_t pos = std::max(size * i / n_chunks, bounds[i - 1]);
+		while (pos < size && text[pos - 1] != '\n') ++pos;
+		bounds[i] = pos;
+	}
+
+	std::vector<ObjChunk> chunks(n_chunks);
+	const auto n = static_cast<std::int64_t>(n_chunks);
+#pragma omp parallel for schedule(dynamic, 1)
+	for (std::int64_t i = 0; i < n; ++i)
+		parse_obj_chunk(text + bounds[i], text + bounds[i + 1], chunks[i]);
+	for (const ObjChunk& chunk : chunks)
+		if (!chunk.error.empty()) throw std::runtime_error("OBJ " + chunk.error);
+
+	// 各块数量的前缀和，用于合并数组与修正相对下标
+	struct Offsets {
+		size_t positions = 0, uvs = 0, normals = 0, corners = 0;
+	};
+	std::vector<Offsets> offsets(n_chunks + 1);
+	for (size_t i = 0; i < n_chunks; ++i) {
+		offsets[i + 1].positions = offsets[i].positions + chunks[i].positions.size();
+		offsets[i + 1].uvs = offsets[i].uvs + chunks[i].uvs.size();
+		offsets[i + 1].normals = offsets[i].normals + chunks[i].normals.size();
+		offsets[i + 1].corners = offsets[i].corners + chunks[i].corners.size();
+	}
+	const Offsets& total = offsets[n_chunks];
+	if (total.corners == 0) throw std::runtime_error("OBJ contains no faces");
+	if (total.positions > std::numeric_limits<std::uint32_t>::max())
+		throw std::runtime_error("OBJ has too many vertices");
+
+	std::vector<glm::vec3> positions(total.positions);
+	std::vector<glm::vec2> uvs(total.uvs);
+	std::vector<glm::vec3> normals(total.normals);
+	std::vector<ObjCorner> corners(total.corners);
+
+	// 合并各块，同时把相对下标转为全局下标并检查范围
+	bool valid = true;
+	bool all_vt = true;
+	bool all_vn = true;
+	bool shared_indices = true;
+#pragma omp parallel for schedule(dynamic, 1) reduction(&& : valid, all_vt, all_vn, shared_indices)
+	for (std::int64_t i = 0; i < n; ++i) {
+		ObjChunk& chunk = chunks[i];
+		const Offsets& base = offsets[i];
+		std::ranges::copy(chunk.positions, positions.begin() + static_cast<std::ptrdiff_t>(base.positions));
+		std::ranges::copy(chunk.uvs, uvs.begin() + static_cast<std::ptrdiff_t>(base.uvs));
+		std::ranges::copy(chunk.normals, normals.begin() + static_cast<std::ptrdiff_t>(base.normals));
+
+		const auto resolve = [](std::int32_t& idx, const bool relative, const size_t base_count, const size_t count) {
+			if (idx == NO_INDEX) return true;
+			const std::int64_t global = static_cast<std::int64_t>(idx) + (relative ? static_cast<std::int64_t>(base_count) : 0);
+			if (global < 0 || global >= static_cast<std::int64_t>(count)) return false;
+			idx = static_cast<std::int32_t>(global);
+			return true;
+		};
+		for (size_t k = 0; k < chunk.corners.size(); ++k) {
+			ObjCorner c = chunk.corners[k];
+			valid = valid && resolve(c.v, (c.relative & 1) != 0, base.positions, total.positions) &&
+					resolve(c.vt, (c.relative & 2) != 0, base.uvs, total.uvs) &&
+					resolve(c.vn, (c.relative & 4) != 0, base.normals, total.normals);
+			all_vt = all_vt && c.vt != NO_INDEX;
+			all_vn = all_vn && c.vn != NO_INDEX;
+			shared_indices = shared_indices && (c.vt == NO_INDEX || c.vt == c.v) && (c.vn == NO_INDEX || c.vn == c.v);
+			c.relative = 0;
+			corners[base.corners + k] = c;
+		}
+		// 及时释放块内缓冲，降低峰值内存
+		chunk = ObjChunk();
+	}
+	if (!valid) throw std::runtime_error("OBJ face index out of range");
+
+	// 只有部分面给出纹理坐标或法线时整体忽略该属性
+	const bool use_uvs = all_vt;
+	const bool use_normals = all_vn;
+
+	ParsedMesh mesh;
+	mesh.indices.resize(corners.size());
+	const bool direct = shared_indices && (!use_uvs || uvs.size() == positions.size()) &&
+						(!use_normals || normals.size() == positions.size());
+	if (direct) {
+		// v、vt、vn 下标一致（或只有位置）：顶点数组可直接使用
+		const auto n_corners = static_cast<std::int64_t>(corners.size());
+#pragma omp parallel for schedule(static)
+		for (std::int64_t k = 0; k < n_corners; ++k)
+			mesh.indices[k] = static_cast<std::uint32_t>(corners[k].v);
+		mesh.positions = std::move(positions);
+		if (use_uvs) mesh.uvs = std::move(uvs);
+		if (use_normals) mesh.normals = std::move(normals);
+	} else {
+		// 下标组合各不相同：按 (v, vt, vn) 组合去重生成顶点
+		std::unordered_map<ObjCorner, std::uint32_t, ObjCornerHash> vertex_ids;
+		vertex_ids.reserve(positions.size());
+		for (size_t k = 0; k < corners.size(); ++k) {
+			ObjCorner key = corners[k];
+			if (!use_uvs) key.vt = NO_INDEX;
+			if (!use_normals) key.vn = NO_INDEX;
+			const auto [it, inserted] = vertex_ids.try_emplace(key, static_cast<std::uint32_t>(mesh.positions.size()));
+			if (inserted) {
+				mesh.positions.push_back(positions[key.v]);
+				if (use_uvs) mesh.uvs.push_back(uvs[key.vt]);
+				if (use_normals) mesh.normals.push_back(normals[key.vn]);
+			}
+			mesh.indices[k] = it->second;
+		}
+	}
+	return mesh;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// PLY
+// ---------------------------------------------------------------------------------------------------------------------
+
+enum class PlyType : std::uint8_t { INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64 };
+
+size_t ply_type_size(const PlyType type) {
+	switch (type) {
+	case PlyType::INT8:
+	case PlyType::UINT8: return 1;
+	case PlyType::INT16:
+	case PlyType::UINT16: return 2;
+	case PlyType::INT32:
+	case PlyType::UINT32:
+	case PlyType::FLOAT32: return 4;
+	case PlyType::FLOAT64: return 8;
+	}
+	return 0;
+}
+
+PlyType parse_ply_type(const std::string_view name) {
+	if (name == "char" || name == "int8") return PlyType::INT8;
+	if (name == "uchar" || name == "uint8") return PlyType::UINT8;
+	if (name == "short" || name == "int16") return PlyType::INT16;
+	if (name == "ushort" || name == "uint16") return PlyType::UINT16;
+	if (name == "int" || name == "int32") return PlyType::INT32;
+	if (name == "uint" || name == "uint32") return PlyType::UINT32;
+	if (name == "float" || name == "float32") return PlyType::FLOAT32;
+	if (name == "double" || name == "float64") return PlyType::FLOAT64;
+	throw std::runtime_error("PLY unknown property type " + std::string(name));
+}
+
+template <typename T> T load_scalar(const std::byte* p, const bool swap) {
+	if constexpr (sizeof(T) == 1) {
+		T value;
+		std::memcpy(&value, p, 1);
+		return value;
+	} else {
+		using Bits = std::conditional_t<sizeof(T) == 2, std::uint16_t,
+										std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+		Bits bits;
+		std::memcpy(&bits, p, sizeof(T));
+		if (swap) bits = std::byteswap(bits);
+		return std::bit_cast<T>(bits);
+	}
+}
+
+double load_ply_value(const std::byte* p, const PlyType type, const bool swap) {
+	switch (type) {
+	case PlyType::INT8: return load_scalar<std::int8_t>(p, swap);
+	case PlyType::UINT8: return load_scalar<std::uint8_t>(p, swap);
+	case PlyType::INT16: return load_scalar<std::int16_t>(p, swap);
+	case PlyType::UINT16: return load_scalar<std::uint16_t>(p, swap);
+	case PlyType::INT32: return load_scalar<std::int32_t>(p, swap);
+	case PlyType::UINT32: return load_scalar<std::uint32_t>(p, swap);
+	case PlyType::FLOAT32: return load_scalar<float>(p, swap);
+	case PlyType::FLOAT64: return load_scalar<double>(p, swap);
+	}
+	return 0.0;
+}
+
+std::int64_t load_ply_index(const std::byte* p, const PlyType type, const bool swap) {
+	switch (type) {
+	case PlyType::INT8: return load_scalar<std::int8_t>(p, swap);
+	case PlyType::UINT8: return load_scalar<std::uint8_t>(p, swap);
+	case PlyType::INT16: return load_scalar<std::int16_t>(p, swap);
+	case PlyType::UINT16: return load_scalar<std::uint16_t>(p, swap);
+	case PlyType::INT32: return load_scalar<std::int32_t>(p, swap);
+	case PlyType::UINT32: return load_scalar<std::uint32_t>(p, swap);
+	default: return -1;
+	}
+}
+
+struct PlyProperty {
+	std::string name;					///< 属性名。
+	PlyType type = PlyType::FLOAT32;	///< 标量类型，列表属性为元素类型。
+	bool is_list = false;				///< 是否为列表属性。
+	PlyType count_type = PlyType::UINT8; ///< 列表长度的类型。
+};
+
+struct PlyElement {
+	std::string name;				  ///< 元素名。
+	size_t count = 0;				  ///< 元素个数。
+	std::vector<PlyProperty> properties; ///< 属性列表。
+
+	[[nodiscard]] bool fixed_size() const {
+		return std::ranges::none_of(properties, [](const PlyProperty& p) { return p.is_list; });
+	}
+
+	[[nodiscard]] size_t stride() const {
+		size_t size = 0;
+		for (const PlyProperty& p : properties)
+			size += ply_type_size(p.type);
+		return size;
+	}
+
+	/**
+	 * @brief 属性在定长记录中的字节偏移，不存在时返回 -1。
+	 */
+	[[nodiscard]] std::ptrdiff_t offset_of(const std::string_view name, PlyType& type) const {
+		std::ptrdiff_t offset = 0;
+		for (const PlyProperty& p : properties) {
+			if (p.name == name) {
+				type = p.type;
+				return offset;
+			}
+			offset += static_cast<std::ptrdiff_t>(ply_type_size(p.type));
+		}
+		return -1;
+	}
+};
+
+/**
+ * @brief 计算一条变长记录的字节数。
+ */
+size_t ply_record_size(const PlyElement& element, const std::byte* p, const std::byte* end, const bool swap) {
+	size_t size = 0;
+	for (const PlyProperty& prop : element.properties) {
+		if (!prop.is_list) {
+			size += ply_type_size(prop.type);
+			continue;
+		}
+		const size_t count_size = ply_type_size(prop.count_type);
+		if (p + size + count_size > end) throw std::runtime_error("PLY file is truncated");
+		const std::int64_t count = load_ply_index(p + size, prop.count_type, swap);
+		if (count < 0) throw std::runtime_error("PLY invalid list length");
+		size += count_size + static_cast<size_t>(count) * ply_type_size(prop.type);
+	}
+	return size;
+}
+
+ParsedMesh parse_ply(const MappedFile& file) {
+	const auto* text = reinterpret_cast<const char*>(file.data());
+	const std::string_view content(text, file.size());
+	constexpr std::string_view END_HEADER = "end_header";
+	if (!content.starts_with("ply")) throw std::runtime_error("not a PLY file");
+	const size_t header_end = content.find(END_HEADER);
+	if (header_end == std::string_view::npos) throw std::runtime_error("PLY header is incomplete");
+	const size_t body_begin = content.find('\n', header_end);
+	if (body_begin == std::string_view::npos) throw std::runtime_error("PLY header is incomplete");
+
+	// 解析文本头
+	bool little_endian = true;
+	std::vector<PlyElement> elements;
+	size_t pos = 0;
+	while (pos < header_end) {
+		const size_t eol = content.find('\n', pos);
+		std::string_view line = content.substr(pos, eol - pos);
+		pos = eol + 1;
+		if (line.ends_with('\r')) line.remove_suffix(1);
+
+		std::vector<std::string_view> tokens;
+		for (size_t start = 0; start < line.size();) {
+			const size_t stop = std::min(line.find_first_of(" \t", start), line.size());
+			if (stop > start) tokens.push_back(line.substr(start, stop - start));
+			start = stop + 1;
+		}
+		if (tokens.empty()) continue;
+		if (tokens[0] == "format") {
+			if (tokens.size() < 2) throw std::runtime_error("PLY invalid format line");
+			if (tokens[1] == "binary_little_endian") little_endian = true;
+			else if (tokens[1] == "binary_big_endian") little_endian = false;
+			else throw std::runtime_error("PLY format " + std::string(tokens[1]) + " is not supported");
+		} else if (tokens[0] == "element") {
+			if (tokens.size() < 3) throw std::runtime_error("PLY invalid element line");
+			PlyElement element;
+			element.name = tokens[1];
+			if (std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), element.count).ec != std::errc())
+				throw std::runtime_error("PLY invalid element count");
+			elements.push_back(std::move(element));
+		} else if (tokens[0] == "property") {
+			if (elements.empty()) throw std::runtime_error("PLY property before element");
+			PlyProperty prop;
+			if (tokens.size() >= 5 && tokens[1] == "list") {
+				prop.is_list = true;
+				prop.count_type = parse_ply_type(tokens[2]);
+				prop.type = parse_ply_type(tokens[3]);
+				prop.name = tokens[4];
+			} else if (tokens.size() >= 3) {
+				prop.type = parse_ply_type(tokens[1]);
+				prop.name = tokens[2];
+			} else {
+				throw std::runtime_error("PLY invalid property line");
+			}
+			elements.back().properties.push_back(std::move(prop));
+		}
+	}
+
+	const bool swap = little_endian != (std::endian::native == std::endian::little);
+	const std::byte* p = file.data() + body_begin + 1;
+	const std::byte* end = file.data() + file.size();
+	ParsedMesh mesh;
+
+	for (const PlyElement& element : elements) {
+		if (element.name == "vertex") {
+			if (!element.fixed_size()) throw std::runtime_error("PLY vertex element must not contain lists");
+			const size_t stride = element.stride();
+			if (static_cast<size_t>(end - p) < stride * element.count) throw std::runtime_error("PLY file is truncated");
+			if (element.count > std::numeric_limits<std::uint32_t>::max())
+				throw std::runtime_error("PLY has too many vertices");
+
+			const auto find = [&](std::initializer_list<std::string_view> names, PlyType& type) -> std::ptrdiff_t {
+				for (const std::string_view name : names) {
+					const std::ptrdiff_t offset = element.offset_of(name, type);
+					if (offset >= 0) return offset;
+				}
+				return -1;
+			};
+			std::array<PlyType, 3> pos_type{}, normal_type{};
+			std::array<PlyType, 2> uv_type{};
+			const std::array<std::ptrdiff_t, 3> pos_offset = {find({"x"}, pos_type[0]), find({"y"}, pos_type[1]),
+															  find({"z"}, pos_type[2])};
+			const std::array<std::ptrdiff_t, 3> normal_offset = {
+				find({"nx"}, normal_type[0]), find({"ny"}, normal_type[1]), find({"nz"}, normal_type[2])};
+			const std::array<std::ptrdiff_t, 2> uv_offset = {find({"u", "s", "texture_u"}, uv_type[0]),
+															 find({"v", "t", "texture_v"}, uv_type[1])};
+			if (std::ranges::any_of(pos_offset, [](std::ptrdiff_t o) { return o < 0; }))
+				throw std::runtime_error("PLY vertex element has no x/y/z");
+			const bool has_normals = std::ranges::none_of(normal_offset, [](std::ptrdiff_t o) { return o < 0; });
+			const bool has_uvs = std::ranges::none_of(uv_offset, [](std::ptrdiff_t o) { return o < 0; });
+
+			mesh.positions.resize(element.count);
+			if (has_normals) mesh.normals.resize(element.count);
+			if (has_uvs) mesh.uvs.resize(element.count);
+			const auto n = static_cast<std::int64_t>(element.count);
+#pragma omp parallel for schedule(static)
+			for (std::int64_t i = 0; i < n; ++i) {
+				const std::byte* record = p + static_cast<size_t>(i) * stride;
+				for (int axis = 0; axis < 3; ++axis) {
+					mesh.positions[i][axis] =
+						static_cast<float>(load_ply_value(record + pos_offset[axis], pos_type[axis], swap));
+					if (has_normals)
+						mesh.normals[i][axis] =
+							static_cast<float>(load_ply_value(record + normal_offset[axis], normal_type[axis], swap));
+				}
+				if (has_uvs) {
+					for (int axis = 0; axis < 2; ++axis)
+						mesh.uvs[i][axis] =
+							static_cast<float>(load_ply_value(record + uv_offset[axis], uv_type[axis], swap));
+				}
+			}
+			p += stride * element.count;
+		} else if (element.name == "face") {
+			const auto list = std::ranges::find_if(element.properties, [](const PlyProperty& prop) {
+				return prop.is_list && (prop.name == "vertex_indices" || prop.name == "vertex_index");
+			});
+			if (list == element.properties.end()) throw std::runtime_error("PLY face element has no vertex_indices");
+			const size_t count_size = ply_type_size(list->count_type);
+			const size_t index_size = ply_type_size(list->type);
+			const auto n = static_cast<std::int64_t>(element.count);
+
+			// 常见情况：面只有顶点列表且全是三角形，记录定长，可并行解码
+			const size_t tri_stride = count_size + 3 * index_size;
+			bool all_triangles = element.properties.size() == 1 &&
+								 static_cast<size_t>(end - p) >= tri_stride * element.count;
+			if (all_triangles) {
+#pragma omp parallel for schedule(static) reduction(&& : all_triangles)
+				for (std::int64_t i = 0; i < n; ++i)
+					all_triangles = all_triangles &&
+									load_ply_index(p + static_cast<size_t>(i) * tri_stride, list->count_type, swap) == 3;
+			}
+
+			bool valid = true;
+			const auto vertex_count = static_cast<std::int64_t>(mesh.positions.size());
+			if (all_triangles) {
+				mesh.indices.resize(3 * element.count);
+#pragma omp parallel for schedule(static) reduction(&& : valid)
+				for (std::int64_t i = 0; i < n; ++i) {
+					const std::byte* record = p + static_cast<size_t>(i) * tri_stride + count_size;
+					for (size_t j = 0; j < 3; ++j) {
+						const std::int64_t idx = load_ply_index(record + j * index_size, list->type, swap);
+						valid = valid && idx >= 0 && idx < vertex_count;
+						mesh.indices[3 * i + j] = static_cast<std::uint32_t>(idx);
+					}
+				}
+				p += tri_stride * element.count;
+			} else {
+				// 一般情况：逐条记录顺序解析，多边形按扇形三角化
+				for (size_t i = 0; i < element.count; ++i) {
+					const size_t record_size = ply_record_size(element, p, end, swap);
+					if (static_cast<size_t>(end - p) < record_size) throw std::runtime_error("PLY file is truncated");
+					const std::byte* prop_ptr = p;
+					for (const PlyProperty& prop : element.properties) {
+						if (!prop.is_list) {
+							prop_ptr += ply_type_size(prop.type);
+							continue;
+						}
+						const auto count = static_cast<size_t>(load_ply_index(prop_ptr, prop.count_type, swap));
+						const std::byte* items = prop_ptr + ply_type_size(prop.count_type);
+						if (&prop == &*list) {
+							const auto index_at = [&](const size_t k) {
+								const std::int64_t idx = load_ply_index(items + k * index_size, prop.type, swap);
+								valid = valid && idx >= 0 && idx < vertex_count;
+								return static_cast<std::uint32_t>(idx);
+							};
+							for (size_t k = 1; k + 1 < count; ++k)
+								mesh.indices.insert(mesh.indices.end(), {index_at(0), index_at(k), index_at(k + 1)});
+						}
+						prop_ptr = items + count * ply_type_size(prop.type);
+					}
+					p += record_size;
+				}
+			}
+			if (!valid) throw std::runtime_error("PLY face index out of range");
+		} else if (element.fixed_size()) {
+			const size_t size = element.stride() * element.count;
+			if (static_cast<size_t>(end - p) < size) throw std::runtime_error("PLY file is truncated");
+			p += size;
+		} else {
+			for (size_t i = 0; i < element.count; ++i)
+				p += ply_record_size(element, p, end, swap);
+			if (p > end) throw std::runtime_error("PLY file is truncated");
+		}
+	}
+
+	if (mesh.indices.empty()) throw std::runtime_error("PLY contains no faces");
+	return mesh;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// 缓存
+// ---------------------------------------------------------------------------------------------------------------------
+
+constexpr std::array<char, 8> CACHE_MAGIC = {'R', 'T', 'M', 'E', 'S', 'H', '\0', '\0'};
+constexpr std::uint32_t CACHE_VERSION = 1;
+constexpr std::uint32_t CACHE_ENDIAN_TAG = 0x01020304;
+constexpr std::uint64_t CACHE_ALIGNMENT = 64; ///< 各数据段的对齐，保证映射后可直接作为数组访问。
+
+/**
+ * @brief 缓存文件头，各数据段紧随其后并按 CACHE_ALIGNMENT 对齐。
+ *
+ * 数据以本机字节序与内存布局保存，类型大小或字节序不一致时缓存视为无效并重新解析源文件。
+ */
+struct CacheHeader {
+	std::array<char, 8> magic{};   ///< 文件标识。
+	std::uint32_t version = 0;	   ///< 格式版本。
+	std::uint32_t endian_tag = 0;  ///< 字节序标记。
+	std::uint32_t vec3_size = 0;   ///< sizeof(glm::vec3)。
+	std::uint32_t vec2_size = 0;   ///< sizeof(glm::vec2)。
+	std::uint32_t node_size = 0;   ///< sizeof(BVHNode)。
+	std::uint32_t build_mode = 0;  ///< BVH 构建算法。
+	std::uint64_t source_size = 0; ///< 源文件大小。
+	std::int64_t source_mtime = 0; ///< 源文件修改时间。
+	std::uint64_t vertex_count = 0;	///< 顶点数。
+	std::uint64_t normal_count = 0;	///< 法线数（0 或顶点数）。
+	std::uint64_t uv_count = 0;		///< 纹理坐标数（0 或顶点数）。
+	std::uint64_t index_count = 0;	///< 下标数。
+	std::uint64_t node_count = 0;	///< BVH 节点数。
+	std::uint64_t positions_offset = 0; ///< 顶点位置段偏移。
+	std::uint64_t normals_offset = 0;	///< 法线段偏移。
+	std::uint64_t uvs_offset = 0;		///< 纹理坐标段偏移。
+	std::uint64_t indices_offset = 0;	///< 下标段偏移。
+	std::uint64_t nodes_offset = 0;		///< BVH 节点段偏移。
+	std::uint64_t file_size = 0;		///< 缓存文件总大小。
+};
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+static_assert(std::is_trivially_copyable_v<BVHNode>);
+
+constexpr std::uint64_t align_up(const std::uint64_t offset) {
+	return (offset + CACHE_ALIGNMENT - 1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+}
+
+/**
+ * @brief 由源文件信息与网格规模填写文件头及各段偏移。
+ */
+bool make_cache_header(const std::filesystem::path& source, const BVHBuildMode mode, CacheHeader& header) {
+	std::error_code ec;
+	const auto source_size = std::filesystem::file_size(source, ec);
+	if (ec) return false;
+	const auto mtime = std::filesystem::last_write_time(source, ec);
+	if (ec) return false;
+
+	header.magic = CACHE_MAGIC;
+	header.version = CACHE_VERSION;
+	header.endian_tag = CACHE_ENDIAN_TAG;
+	header.vec3_size = sizeof(glm::vec3);
+	header.vec2_size = sizeof(glm::vec2);
+	header.node_size = sizeof(BVHNode);
+	header.build_mode = static_cast<std::uint32_t>(mode);
+	header.source_size = source_size;
+	header.source_mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+	return true;
+}
+
+void layout_cache(CacheHeader& header) {
+	header.positions_offset = align_up(sizeof(CacheHeader));
+	header.normals_offset = align_up(header.positions_offset + header.vertex_count * sizeof(glm::vec3));
+	header.uvs_offset = align_up(header.normals_offset + header.normal_count * sizeof(glm::vec3));
+	header.indices_offset = align_up(header.uvs_offset + header.uv_count * sizeof(glm::vec2));
+	header.nodes_offset = align_up(header.indices_offset + header.index_count * sizeof(std::uint32_t));
+	header.file_size = header.nodes_offset + header.node_count * sizeof(BVHNode);
+}
+
+/**
+ * @brief 映射缓存文件并构造网格，缓存不存在、过期或损坏时返回 nullptr。
+ */
+std::shared_ptr<TriangleMesh> map_cache(const std::filesystem::path& cache, const std::filesystem::path& source,
+										const BVHBuildMode mode, std::shared_ptr<Material> mat) {
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(cache, ec)) return nullptr;
+
+	CacheHeader expected;
+	if (!make_cache_header(source, mode, expected)) return nullptr;
+
+	std::shared_ptr<const MappedFile> file;
+	try {
+		file = std::make_shared<const MappedFile>(cache);
+	} catch (const std::runtime_error&) {
+		return nullptr;
+	}
+	if (file->size() < sizeof(CacheHeader)) return nullptr;
+	CacheHeader header;
+	std::memcpy(&header, file->data(), sizeof(CacheHeader));
+
+	if (header.magic != expected.magic || header.version != expected.version ||
+		header.endian_tag != expected.endian_tag || header.vec3_size != expected.vec3_size ||
+		header.vec2_size != expected.vec2_size || header.node_size != expected.node_size ||
+		header.build_mode != expected.build_mode || header.source_size != expected.source_size ||
+		header.source_mtime != expected.source_mtime)
+		return nullptr;
+
+	// 重新计算布局并与文件头比对，避免损坏的偏移越界
+	CacheHeader layout = header;
+	layout_cache(layout);
+	if (header.normal_count != 0 && header.normal_count != header.vertex_count) return nullptr;
+	if (header.uv_count != 0 && header.uv_count != header.vertex_count) return nullptr;
+	if (header.vertex_count > std::numeric_limits<std::uint32_t>::max() || header.index_count % 3 != 0 ||
+		header.index_count == 0 || header.node_count == 0)
+		return nullptr;
+	if (std::memcmp(&layout, &header, sizeof(CacheHeader)) != 0 || file->size() != header.file_size) return nullptr;
+
+	const std::byte* base = file->data();
+	const auto* indices = reinterpret_cast<const std::uint32_t*>(base + header.indices_offset);
+	const auto* nodes = reinterpret_cast<const BVHNode*>(base + header.nodes_offset);
+
+	// 检查下标与节点引用，保证损坏的缓存不会导致越界访问
+	const auto n_indices = static_cast<std::int64_t>(header.index_count);
+	const auto n_nodes = static_cast<std::int64_t>(header.node_count);
+	const std::uint64_t n_triangles = header.index_count / 3;
+	bool valid = true;
+#pragma omp parallel for schedule(static) reduction(&& : valid)
+	for (std::int64_t i = 0; i < n_indices; ++i)
+		valid = valid && indices[i] < header.vertex_count;
+#pragma omp parallel for schedule(static) reduction(&& : valid)
+	for (std::int64_t i = 0; i < n_nodes; ++i) {
+		const BVHNode& node = nodes[i];
+		valid = valid && (node.is_leaf() ? static_cast<std::uint64_t>(node.offset) + node.count <= n_triangles
+										 : node.offset > static_cast<std::uint64_t>(i) + 1 &&
+											   node.offset < header.node_count);
+	}
+	if (!valid) return nullptr;
+
+	MeshBuffers buffers;
+	buffers.positions = {reinterpret_cast<const glm::vec3*>(base + header.positions_offset), header.vertex_count};
+	buffers.normals = {reinterpret_cast<const glm::vec3*>(base + header.normals_offset), header.normal_count};
+	buffers.uvs = {reinterpret_cast<const glm::vec2*>(base + header.uvs_offset), header.uv_count};
+	buffers.indices = {indices, header.index_count};
+	buffers.owner = std::move(file);
+	return std::make_shared<TriangleMesh>(std::move(buffers), std::span<const BVHNode>(nodes, header.node_count),
+										  std::move(mat));
+}
+
+} // namespace
+
+std::filesystem::path MeshLoader::cache_path(const std::filesystem::path& path) {
+	std::filesystem::path cache = path;
+	cache += ".rtmesh";
+	return cache;
+}
+
+bool MeshLoader::write_cache(const TriangleMesh& mesh, const std::filesystem::path& source, const BVHBuildMode mode) {
+	CacheHeader header;
+	if (!make_cache_header(source, mode, header)) return false;
+	const MeshBuffers buffers = mesh.buffers();
+	const std::vector<BVHNode>& nodes = mesh.tree().nodes();
+	header.vertex_count = buffers.positions.size();
+	header.normal_count = buffers.normals.size();
+	header.uv_count = buffers.uvs.size();
+	header.index_count = buffers.indices.size();
+	header.node_count = nodes.size();
+	layout_cache(header);
+
+	const std::filesystem::path cache = cache_path(source);
+	std::filesystem::path temp = cache;
+	temp += ".tmp";
+	{
+		std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+		const auto write_at = [&](const std::uint64_t offset, const void* data, const size_t bytes) {
+			static constexpr std::array<char, CACHE_ALIGNMENT> PADDING{};
+			const auto pos = static_cast<std::uint64_t>(out.tellp());
+			out.write(PADDING.data(), static_cast<std::streamsize>(offset - pos));
+			out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+		};
+		write_at(0, &header, sizeof(header));
+		write_at(header.positions_offset, buffers.positions.data(), buffers.positions.size_bytes());
+		write_at(header.normals_offset, buffers.normals.data(), buffers.normals.size_bytes());
+		write_at(header.uvs_offset, buffers.uvs.data(), buffers.uvs.size_bytes());
+		write_at(header.indices_offset, buffers.indices.data(), buffers.indices.size_bytes());
+		write_at(header.nodes_offset, nodes.data(), nodes.size() * sizeof(BVHNode));
+		if (!out.flush()) {
+			out.close();
+			std::error_code ec;
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+	}
+
+	// 先写临时文件再重命名：已映射旧缓存的进程不受影响，中途失败也不会留下半个缓存
+	std::error_code ec;
+	std::filesystem::rename(temp, cache, ec);
+	if (ec) std::filesystem::remove(temp, ec);
+	return !ec;
+}
+
+std::shared_ptr<TriangleMesh> MeshLoader::load(const std::filesystem::path& path, std::shared_ptr<Material> mat,
+											   const MeshLoadOptions& options, MeshLoadStats* stats) {
+	const auto start = Clock::now();
+	MeshLoadStats result;
+	std::shared_ptr<TriangleMesh> mesh;
+
+	if (options.use_cache) {
+		mesh = map_cache(cache_path(path), path, options.build_mode, mat);
+		result.from_cache = mesh != nullptr;
+		result.parse_ms = elapsed_ms(start);
+	}
+
+	if (!mesh) {
+		std::string ext = path.extension().string();
+		std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		ParsedMesh parsed;
+		{
+			const MappedFile file(path);
+			if (ext == ".obj") parsed = parse_obj(file);
+			else if (ext == ".ply") parsed = parse_ply(file);
+			else throw std::runtime_error("unsupported mesh format: " + path.string());
+		}
+		result.parse_ms = elapsed_ms(start);
+		mesh = std::make_shared<TriangleMesh>(std::move(parsed.positions), std::move(parsed.indices), std::move(mat),
+											  std::move(parsed.normals), std::move(parsed.uvs), options.build_mode);
+		if (options.write_cache) result.cache_written = write_cache(*mesh, path, options.build_mode);
+	}
+
+	result.load_ms = elapsed_ms(start);
+	result.peak_memory = peak_memory();
+	result.vertex_count = mesh->vertex_count();
+	result.triangle_count = mesh->triangle_count();
+	if (stats != nullptr) *stats = result;
+	return mesh;
+}
+
+size_t MeshLoader::peak_memory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == 0) return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	// Linux 上 ru_maxrss 以 KB 为单位
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+} // namespace rt
@@ -0,0 +1,55 @@
+#include "rt/io/ToneMap.hpp"
+#include "rt/core/Utils.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace rt {
+
+namespace {
+
+constexpr float ACES_INPUT_SCALE = 0.6F; ///< 拟合曲线以此缩放输入，使曝光 0 时的中灰与 ACES 参考一致。
+
+float aces(float x) {
+	x *= ACES_INPUT_SCALE;
+	return (x * (2.51F * x + 0.03F)) / (x * (2.43F * x + 0.59F) + 0.14F);
+}
+
+float srgb(const float x) {
+	return x <= 0.0031308F ? 12.92F * x : 1.055F * std::pow(x, 1.0F / 2.4F) - 0.055F;
+}
+
+} // namespace
+
+std::vector<unsigned char> tone_map(const std::span<const glm::vec3> pixels, const ToneMapSettings& settings) {
+	std::vector<unsigned char> image_data(pixels.size() * 3);
+	const float scale = std::exp2(settings.exposure);
+	const auto count = static_cast<std::ptrdiff_t>(pixels.size());
+
+#pragma omp parallel for schedule(static)
+	for (std::ptrdiff_t k = 0; k < count; ++k) {
+		glm::vec3 color = pixels[k] * scale;
+		switch (settings.tone_operator) {
+			case ToneMapOperator::REINHARD: {
+				const float l = luminance(color);
+				if (l > 0.0F) color *= 1.0F / (1.0F + l);
+				break;
+			}
+			case ToneMapOperator::ACES:
+				for (int c = 0; c < 3; ++c)
+					color[c] = aces(std::max(color[c], 0.0F));
+				break;
+			case ToneMapOperator::CLAMP:
+			default:
+				break;
+		}
+
+		for (int c = 0; c < 3; ++c) {
+			const float v = settings.transfer == TransferFunction::SRGB ? srgb(std::max(color[c], 0.0F))
+																		: std::sqrt(color[c]);
+			image_data[k * 3 + c] = static_cast<unsigned char>(256 * std::clamp(v, 0.0F, 0.999F));
+		}
+	}
+	return image_data;
+}
+
+} // namespace rt
@@ -1,16 +1,23 @@
 #include "rt/materials/Lambertian.hpp"
-#include "rt/pdf/CosinePDF.hpp"
 
 namespace rt {
 
 bool Lambertian::scatter(const Ray& /*r_in*/, const HitRecord& rec, ScatterRecord& srec) const {
-	srec.attenuation = _albedo;
-	srec.pdf_ptr	 = std::make_shared<CosinePDF>(rec.normal);
+	sample_scatter(_albedo, rec, srec);
 	return true;
 }
 
 glm::vec3 Lambertian::brdf(const Ray& /*r_in*/, const HitRecord& /*rec*/, const Ray& /*scattered*/) const {
-	return _albedo / static_cast<float>(PI);
+	return eval_brdf(_albedo);
+}
+
+void Lambertian::sample_scatter(const glm::vec3& albedo, const HitRecord& rec, ScatterRecord& srec) {
+	srec.attenuation = albedo;
+	srec.pdf		 = CosinePDF(rec.normal);
+}
+
+glm::vec3 Lambertian::eval_brdf(const glm::vec3& albedo) {
+	return albedo / static_cast<float>(PI);
 }
 
 } // namespace rt
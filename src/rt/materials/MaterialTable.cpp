@@ -0,0 +1,99 @@
+#include "rt/materials/MaterialTable.hpp"
+#include "rt/materials/DiffuseLight.hpp"
+#include "rt/materials/Lambertian.hpp"
+#include "rt/materials/Metal.hpp"
+#include <typeinfo>
+
+namespace rt {
+
+namespace {
+
+std::uint32_t make_id(const MaterialTable::Kind kind, const size_t index) {
+	return (static_cast<std::uint32_t>(kind) << MaterialTable::KIND_SHIFT) | static_cast<std::uint32_t>(index);
+}
+
+} // namespace
+
+std::uint32_t MaterialTable::add(const std::shared_ptr<Material>& material) {
+	if (const auto it = _ids.find(material.get()); it != _ids.end()) return it->second;
+
+	// 按精确类型分类：内置材质的子类可能覆盖了 scatter / brdf / emitted，不能走静态内核
+	std::uint32_t id = 0;
+	const Material& base = *material;
+	const std::type_info& type = typeid(base);
+	if (type == typeid(Lambertian)) {
+		const auto& lambertian = static_cast<const Lambertian&>(base);
+		id = make_id(Kind::LAMBERTIAN, _lambertian.albedo.size());
+		_lambertian.albedo.push_back(lambertian.albedo());
+	} else if (type == typeid(Metal)) {
+		const auto& metal = static_cast<const Metal&>(base);
+		id = make_id(Kind::METAL, _metal.albedo.size());
+		_metal.albedo.push_back(metal.albedo());
+		_metal.fuzz.push_back(metal.fuzz());
+	} else if (type == typeid(DiffuseLight)) {
+		const auto& light = static_cast<const DiffuseLight&>(base);
+		id = make_id(Kind::DIFFUSE_LIGHT, _diffuse_light.emit.size());
+		_diffuse_light.emit.push_back(light.emit());
+	} else {
+		id = make_id(Kind::CUSTOM, _custom.size());
+		_custom.push_back(material);
+	}
+
+	_owned.push_back(material);
+	_ids.emplace(material.get(), id);
+	return id;
+}
+
+bool MaterialTable::scatter(const Ray& r_in, const HitRecord& rec, ScatterRecord& srec) const {
+	if (rec.material_id == HitRecord::NO_MATERIAL_ID) return rec.mat_ptr->scatter(r_in, rec, srec);
+
+	const std::uint32_t idx = index(rec.material_id);
+	switch (kind(rec.material_id)) {
+		case Kind::LAMBERTIAN:
+			Lambertian::sample_scatter(_lambertian.albedo[idx], rec, srec);
+			return true;
+		case Kind::METAL:
+			Metal::sample_scatter(_metal.albedo[idx], _metal.fuzz[idx], r_in, rec, srec);
+			return true;
+		case Kind::DIFFUSE_LIGHT:
+			return false;
+		case Kind::CUSTOM:
+		default:
+			return _custom[idx]->scatter(r_in, rec, srec);
+	}
+}
+
+glm::vec3 MaterialTable::brdf(const Ray& r_in, const HitRecord& rec, const Ray& scattered) const {
+	if (rec.material_id == HitRecord::NO_MATERIAL_ID) return rec.mat_ptr->brdf(r_in, rec, scattered);
+
+	const std::uint32_t idx = index(rec.material_id);
+	switch (kind(rec.material_id)) {
+		case Kind::LAMBERTIAN:
+			return Lambertian::eval_brdf(_lambertian.albedo[idx]);
+		case Kind::METAL:
+			return Metal::eval_brdf(_metal.albedo[idx], _metal.fuzz[idx], r_in, rec, scattered);
+		case Kind::DIFFUSE_LIGHT:
+			return {0, 0, 0};
+		case Kind::CUSTOM:
+		default:
+			return _custom[idx]->brdf(r_in, rec, scattered);
+	}
+}
+
+glm::vec3 MaterialTable::emitted(const Ray& r_in, const HitRecord& rec) const {
+	if (rec.material_id == HitRecord::NO_MATERIAL_ID) return rec.mat_ptr->emitted(r_in, rec);
+
+	const std::uint32_t idx = index(rec.material_id);
+	switch (kind(rec.material_id)) {
+		case Kind::DIFFUSE_LIGHT:
+			return _diffuse_light.emit[idx];
+		case Kind::CUSTOM:
+			return _custom[idx]->emitted(r_in, rec);
+		case Kind::LAMBERTIAN:
+		case Kind::METAL:
+		default:
+			return {0, 0, 0};
+	}
+}
+
+} // namespace rt
@@ -1,29 +1,36 @@
 #include "rt/materials/Metal.hpp"
-#include "rt/pdf/CosinePowerPDF.hpp"
-#include "rt/pdf/DeltaPDF.hpp"
 #include "rt/core/Utils.hpp"
 
 namespace rt {
 
 bool Metal::scatter(const Ray& r_in, const HitRecord& rec, ScatterRecord& srec) const {
+	sample_scatter(_albedo, _fuzz, r_in, rec, srec);
+	return true;
+}
+
+glm::vec3 Metal::brdf(const Ray& r_in, const HitRecord& rec, const Ray& scattered) const {
+	return eval_brdf(_albedo, _fuzz, r_in, rec, scattered);
+}
+
+void Metal::sample_scatter(const glm::vec3& albedo, const double fuzz, const Ray& r_in, const HitRecord& rec,
+						   ScatterRecord& srec) {
 	glm::vec3 reflected = glm::reflect(glm::normalize(r_in.direction()), rec.normal);
-	srec.attenuation = _albedo;
+	srec.attenuation = albedo;
 
 	// 针对较小的 fuzz 值（高光泽/近镜面）使用单独的逻辑分支
 	// 使用 DeltaPDF 避免高指数带来的数值问题
-	if (_fuzz < 0.01) {
-		srec.pdf_ptr = std::make_shared<DeltaPDF>(reflected);
+	if (fuzz < 0.01) {
+		srec.pdf = DeltaPDF(reflected);
 		srec.is_specular = true;
 	} else {
 		// 普通粗糙度
-		double exponent = 2.0 / (_fuzz * _fuzz) - 2.0;
-		srec.pdf_ptr = std::make_shared<CosinePowerPDF>(reflected, exponent);
+		double exponent = 2.0 / (fuzz * fuzz) - 2.0;
+		srec.pdf = CosinePowerPDF(reflected, exponent);
 	}
-
-	return true;
 }
 
-glm::vec3 Metal::brdf(const Ray& r_in, const HitRecord& rec, const Ray& scattered) const {
+glm::vec3 Metal::eval_brdf(const glm::vec3& albedo, const double fuzz, const Ray& r_in, const HitRecord& rec,
+						   const Ray& scattered) {
 	const glm::vec3 reflected = glm::reflect(glm::normalize(r_in.direction()), rec.normal);
 	const glm::vec3 out_dir = glm::normalize(scattered.direction());
 
@@ -33,12 +40,12 @@ glm::vec3 Metal::brdf(const Ray& r_in, const HitRecord& rec, const Ray& scattere
 	}
 
 	// 针对较小的 fuzz 值提取的逻辑
-	if (_fuzz < 0.01) {
+	if (fuzz < 0.01) {
 		// 检查散射方向是否与反射方向一致（允许微小误差）
 		if (glm::dot(out_dir, reflected) > 0.9999) {
 			// 对于 Delta 分布 (PDF=1)，BRDF 应该是 albedo / cos_theta
 			// 这样 estimator = (BRDF * Li * cos) / PDF = (albedo/cos * Li * cos) / 1 = albedo * Li
-			return _albedo / static_cast<float>(cos_theta);
+			return albedo / static_cast<float>(cos_theta);
 		}
 		return {0, 0, 0};
 	}
@@ -49,10 +56,10 @@ glm::vec3 Metal::brdf(const Ray& r_in, const HitRecord& rec, const Ray& scattere
 		return {0, 0, 0};
 	}
 
-	const double exponent = 2.0 / (_fuzz * _fuzz) - 2.0;
+	const double exponent = 2.0 / (fuzz * fuzz) - 2.0;
 	const double pdf_val = (exponent + 1) / (2 * PI) * pow(cos_alpha, exponent);
 
-	return _albedo * static_cast<float>(pdf_val / cos_theta);
+	return albedo * static_cast<float>(pdf_val / cos_theta);
 }
 
 } // namespace rt
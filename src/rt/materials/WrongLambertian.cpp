@@ -1,11 +1,10 @@
 #include "rt/materials/WrongLambertian.hpp"
-#include "rt/pdf/UniformPDF.hpp"
 
 namespace rt {
 
 bool WrongLambertian::scatter(const Ray& /*r_in*/, const HitRecord& rec, ScatterRecord& srec) const {
 	srec.attenuation = _albedo;
-	srec.pdf_ptr = std::make_shared<UniformPDF>(rec.normal);
+	srec.pdf = UniformPDF(rec.normal);
 	return true;
 }
 
@@ -0,0 +1,230 @@
+#include "rt/sampling/PMJ02Sampler.hpp"
+#include "rt/sampling/PCG32Sampler.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <vector>
+
+namespace rt {
+
+namespace {
+
+struct Point {
+	double x;
+	double y;
+};
+
+/**
+ * @brief 按 Christensen 等 (2018) 的算法逐级扩展 PMJ02 点集：点数从 4^k 翻倍时在每个点所在单元的对角子象限
+ * 补一个点，从 2·4^k 翻倍时补齐每个单元剩下的两个子象限；新点只放在不与已有点共享任何基本区间的位置。
+ */
+class PMJ02Builder {
+public:
+	std::vector<Point> build(const std::uint32_t count) {
+		_points.assign(count, {0.0, 0.0});
+		_points[0] = {uniform(), uniform()};
+		std::uint32_t n = 1;
+		while (n < count) {
+			extend_even(n);
+			n *= 2;
+			if (n < count) {
+				extend_odd(n);
+				n *= 2;
+			}
+		}
+		return _points;
+	}
+
+private:
+	static constexpr int MAX_ATTEMPTS = 64; ///< 随机选取空闲位置的次数，失败后改为枚举。
+
+	double uniform() { return _rng.next_uint() * 0x1p-32; }
+
+	/**
+	 * @brief 以 grid 个细分层为分辨率，标记前 n 个点占用的全部基本区间（从 grid×1 到 1×grid）。
+	 */
+	void mark_existing(const std::uint32_t n, const std::uint32_t grid) {
+		_grid = grid;
+		_log_grid = std::countr_zero(grid);
+		_occupied.assign(static_cast<size_t>(_log_grid + 1) * grid, 0);
+		for (std::uint32_t s = 0; s < n; ++s)
+			mark(fine_stratum(_points[s].x), fine_stratum(_points[s].y));
+	}
+
+	[[nodiscard]] std::uint32_t fine_stratum(const double v) const {
+		return std::min(static_cast<std::uint32_t>(v * _grid), _grid - 1);
+	}
+
+	/**
+	 * @brief 细分层 (xs, ys) 中的点在形状 k（x 方向 grid >> k 层，y 方向 2^k 层）中所在基本区间的下标。
+	 */
+	[[nodiscard]] size_t interval(const int k, const std::uint32_t xs, const std::uint32_t ys) const {
+		const std::uint32_t x = xs >> static_cast<std::uint32_t>(k);
+		const std::uint32_t y = ys >> static_cast<std::uint32_t>(_log_grid - k);
+		return static_cast<size_t>(k) * _grid + static_cast<size_t>(y) * (_grid >> static_cast<std::uint32_t>(k)) + x;
+	}
+
+	[[nodiscard]] bool occupied(const std::uint32_t xs, const std::uint32_t ys) const {
+		for (int k = 0; k <= _log_grid; ++k)
+			if (_occupied[interval(k, xs, ys)] != 0) return true;
+		return false;
+	}
+
+	void mark(const std::uint32_t xs, const std::uint32_t ys) {
+		for (int k = 0; k <= _log_grid; ++k)
+			_occupied[interval(k, xs, ys)] = 1;
+	}
+
+	/**
+	 * @brief 在 cells×cells 网格的单元 (i, j) 的子象限 (xhalf, yhalf) 中生成一个不与已有点共享基本区间的点。
+	 */
+	Point sample_subquadrant(const std::uint32_t i, const std::uint32_t j, const std::uint32_t xhalf,
+							 const std::uint32_t yhalf, const std::uint32_t cells) {
+		const std::uint32_t span = _grid / (2 * cells); // 子象限每个方向覆盖的细分层数
+		const std::uint32_t x0 = (2 * i + xhalf) * span;
+		const std::uint32_t y0 = (2 * j + yhalf) * span;
+
+		std::uint32_t xs = x0;
+		std::uint32_t ys = y0;
+		bool found = false;
+		for (int attempt = 0; attempt < MAX_ATTEMPTS && !found; ++attempt) {
+			xs = x0 + _rng.next_uint() % span;
+			ys = y0 + _rng.next_uint() % span;
+			found = !occupied(xs, ys);
+		}
+		// 随机尝试失败时枚举子象限内的全部细分层，在空闲的位置中均匀地选一个
+		std::uint32_t candidates = 0;
+		for (std::uint32_t dy = 0; dy < span && !found; ++dy) {
+			for (std::uint32_t dx = 0; dx < span; ++dx) {
+				if (occupied(x0 + dx, y0 + dy)) continue;
+				if (_rng.next_uint() % ++candidates == 0) {
+					xs = x0 + dx;
+					ys = y0 + dy;
+				}
+			}
+		}
+
+		mark(xs, ys);
+		return {(xs + uniform()) / _grid, (ys + uniform()) / _grid};
+	}
+
+	/**
+	 * @brief 点数由 n = 4^k 扩展到 2n：在每个点所在单元的对角子象限中补一个点。
+	 */
+	void extend_even(const std::uint32_t n) {
+		const std::uint32_t cells = 1U << (std::countr_zero(n) / 2);
+		mark_existing(n, 2 * n);
+		for (std::uint32_t s = 0; s < n; ++s) {
+			const auto qx = static_cast<std::uint32_t>(_points[s].x * 2 * cells);
+			const auto qy = static_cast<std::uint32_t>(_points[s].y * 2 * cells);
+			_points[n + s] = sample_subquadrant(qx / 2, qy / 2, 1 - (qx & 1U), 1 - (qy & 1U), cells);
+		}
+	}
+
+	/**
+	 * @brief 点数由 n = 2·4^k 扩展到 2n：每个单元已有两个对角的点，随机决定两个空子象限的填充顺序。
+	 */
+	void extend_odd(const std::uint32_t n) {
+		const std::uint32_t cells = 1U << (std::countr_zero(n / 2) / 2);
+		mark_existing(n, 2 * n);
+		for (std::uint32_t s = 0; s < n / 2; ++s) {
+			const auto qx = static_cast<std::uint32_t>(_points[s].x * 2 * cells);
+			const auto qy = static_cast<std::uint32_t>(_points[s].y * 2 * cells);
+			std::uint32_t xhalf = qx & 1U;
+			std::uint32_t yhalf = qy & 1U;
+			if ((_rng.next_uint() & 1U) != 0)
+				xhalf = 1 - xhalf;
+			else
+				yhalf = 1 - yhalf;
+			_points[n + s] = sample_subquadrant(qx / 2, qy / 2, xhalf, yhalf, cells);
+			_points[n + n / 2 + s] = sample_subquadrant(qx / 2, qy / 2, 1 - xhalf, 1 - yhalf, cells);
+		}
+	}
+
+	PCG32 _rng{0x706d6a3032ULL, 0};		///< 固定种子，点表每次生成都相同。
+	std::vector<Point> _points;			///< 已生成的点。
+	std::vector<unsigned char> _occupied; ///< 各形状的基本区间是否已被占用。
+	std::uint32_t _grid = 1;			///< 当前的细分层数，等于扩展后的点数。
+	int _log_grid = 0;					///< log2(_grid)。
+};
+
+/**
+ * @brief 共享的 PMJ02 点表，首次使用时生成，每个点两个 32 位定点坐标。
+ */
+const std::vector<std::uint32_t>& pmj02_table() {
+	static const std::vector<std::uint32_t> table = [] {
+		const std::vector<Point> points = PMJ02Builder().build(PMJ02Sampler::TABLE_SIZE);
+		std::vector<std::uint32_t> fixed(2 * points.size());
+		for (size_t i = 0; i < points.size(); ++i) {
+			fixed[2 * i] = static_cast<std::uint32_t>(points[i].x * 0x1p32);
+			fixed[2 * i + 1] = static_cast<std::uint32_t>(points[i].y * 0x1p32);
+		}
+		return fixed;
+	}();
+	return table;
+}
+
+/**
+ * @brief [0, l) 上由 p 决定的一个置换的第 i 个元素（Kensler 2013 的散列置换）。
+ */
+std::uint32_t permutation_element(std::uint32_t i, const std::uint32_t l, const std::uint32_t p) {
+	std::uint32_t w = l - 1;
+	w |= w >> 1U;
+	w |= w >> 2U;
+	w |= w >> 4U;
+	w |= w >> 8U;
+	w |= w >> 16U;
+	do {
+		i ^= p;
+		i *= 0xe170893dU;
+		i ^= p >> 16U;
+		i ^= (i & w) >> 4U;
+		i ^= p >> 8U;
+		i *= 0x0929eb3fU;
+		i ^= p >> 23U;
+		i ^= (i & w) >> 1U;
+		i *= 1U | p >> 27U;
+		i *= 0x6935fa69U;
+		i ^= (i & w) >> 11U;
+		i *= 0x74dcb303U;
+		i ^= (i & w) >> 2U;
+		i *= 0x9e501cc3U;
+		i ^= (i & w) >> 2U;
+		i *= 0xc860a3dfU;
+		i &= w;
+		i ^= i >> 5U;
+	} while (i >= l);
+	return (i + p) % l;
+}
+
+} // namespace
+
+PMJ02Sampler::PMJ02Sampler(const std::uint64_t seed) : _seed(seed), _table(pmj02_table().data()) {
+	start_pixel_sample(0, 0, 0);
+}
+
+glm::vec2 PMJ02Sampler::get_2d() {
+	std::uint64_t hash = hash_combine(_pixel_hash, _dimension);
+	_dimension += 2;
+
+	// 点表只保证 2 的幂前缀分层，因此只在 [2^j, 2^(j+1)) 内打乱采样顺序，每个 2 的幂前缀仍是同一组点；
+	// 超出点表的采样换一组散列值重复使用点表
+	std::uint32_t index = _sample_index % TABLE_SIZE;
+	const std::uint32_t octave = std::bit_floor(index);
+	if (octave > 1) index = octave + permutation_element(index - octave, octave, static_cast<std::uint32_t>(hash));
+	hash = hash_combine(hash, _sample_index / TABLE_SIZE);
+
+	// 随机数字异或把每个基本区间映射到同形状的另一个基本区间，分层保持不变
+	const std::uint64_t digits = mix_bits(hash);
+	return {fixed_to_float(_table[2 * index] ^ static_cast<std::uint32_t>(digits)),
+			fixed_to_float(_table[2 * index + 1] ^ static_cast<std::uint32_t>(digits >> 32U))};
+}
+
+float PMJ02Sampler::get_1d() {
+	// PMJ02 的一维投影同样分层，取二维点的 x 坐标，只消耗一个维度
+	const float x = get_2d().x;
+	--_dimension;
+	return x;
+}
+
+} // namespace rt
@@ -0,0 +1,20 @@
+#include "rt/sampling/Sampler.hpp"
+#include "rt/sampling/PCG32Sampler.hpp"
+#include "rt/sampling/PMJ02Sampler.hpp"
+#include "rt/sampling/SobolSampler.hpp"
+
+namespace rt {
+
+std::unique_ptr<Sampler> make_sampler(const SamplerType type, const std::uint64_t seed) {
+	switch (type) {
+		case SamplerType::SOBOL:
+			return std::make_unique<SobolSampler>(seed);
+		case SamplerType::PMJ02:
+			return std::make_unique<PMJ02Sampler>(seed);
+		case SamplerType::INDEPENDENT:
+		default:
+			return std::make_unique<PCG32Sampler>(seed);
+	}
+}
+
+} // namespace rt
@@ -0,0 +1,84 @@
+#include "rt/sampling/SobolSampler.hpp"
+#include <array>
+
+namespace rt {
+
+namespace {
+
+constexpr int SOBOL_BITS = 32;
+
+/**
+ * @brief Sobol 序列第 1 维（本原多项式 x + 1）的生成矩阵按字节展开的查找表：
+ * 表 b 的第 k 项是采样序号第 b 个字节为 k 时对应各列的异或，四次查表即得一个点。
+ * 第 0 维是 van der Corput 序列，其值就是采样序号按位反转，不需要查表。
+ */
+constexpr std::array<std::array<std::uint32_t, 256>, 4> SOBOL1_BYTE_TABLES = [] {
+	std::array<std::uint32_t, SOBOL_BITS> matrix{};
+	matrix[0] = 1U << (SOBOL_BITS - 1);
+	for (int i = 1; i < SOBOL_BITS; ++i)
+		matrix[i] = matrix[i - 1] ^ (matrix[i - 1] >> 1U);
+
+	std::array<std::array<std::uint32_t, 256>, 4> tables{};
+	for (int b = 0; b < 4; ++b) {
+		for (std::uint32_t k = 0; k < 256; ++k) {
+			std::uint32_t v = 0;
+			for (int bit = 0; bit < 8; ++bit)
+				if (((k >> static_cast<std::uint32_t>(bit)) & 1U) != 0) v ^= matrix[8 * b + bit];
+			tables[b][k] = v;
+		}
+	}
+	return tables;
+}();
+
+std::uint32_t sobol1(const std::uint32_t index) {
+	return SOBOL1_BYTE_TABLES[0][index & 0xffU] ^ SOBOL1_BYTE_TABLES[1][(index >> 8U) & 0xffU] ^
+		   SOBOL1_BYTE_TABLES[2][(index >> 16U) & 0xffU] ^ SOBOL1_BYTE_TABLES[3][index >> 24U];
+}
+
+std::uint32_t reverse_bits(std::uint32_t v) {
+	v = ((v >> 1U) & 0x55555555U) | ((v & 0x55555555U) << 1U);
+	v = ((v >> 2U) & 0x33333333U) | ((v & 0x33333333U) << 2U);
+	v = ((v >> 4U) & 0x0f0f0f0fU) | ((v & 0x0f0f0f0fU) << 4U);
+	v = ((v >> 8U) & 0x00ff00ffU) | ((v & 0x00ff00ffU) << 8U);
+	return (v >> 16U) | (v << 16U);
+}
+
+/**
+ * @brief Laine-Karras 置换：每一位只受更低位的影响，按位反转后即为 Owen 置乱（Burley 2020 的散列版本）。
+ */
+std::uint32_t laine_karras_permutation(std::uint32_t x, const std::uint32_t seed) {
+	x += seed;
+	x ^= x * 0x6c50b47cU;
+	x ^= x * 0xb82f1e52U;
+	x ^= x * 0xc7afe638U;
+	x ^= x * 0x8d22f6e6U;
+	return x;
+}
+
+/**
+ * @brief 嵌套均匀置乱：作用于坐标即 Owen 置乱，作用于采样序号即保持 2 的幂对齐块的打乱。
+ */
+std::uint32_t nested_uniform_scramble(const std::uint32_t x, const std::uint32_t seed) {
+	return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+
+} // namespace
+
+float SobolSampler::get_1d() {
+	const std::uint64_t hash = hash_combine(_pixel_hash, _dimension);
+	const std::uint32_t index = nested_uniform_scramble(_sample_index, static_cast<std::uint32_t>(hash));
+	++_dimension;
+	// 第 0 维的值是 index 按位反转，与 Owen 置乱开头的反转相抵
+	return fixed_to_float(reverse_bits(laine_karras_permutation(index, static_cast<std::uint32_t>(hash >> 32U))));
+}
+
+glm::vec2 SobolSampler::get_2d() {
+	const std::uint64_t hash = hash_combine(_pixel_hash, _dimension);
+	const std::uint32_t index = nested_uniform_scramble(_sample_index, static_cast<std::uint32_t>(hash));
+	const std::uint64_t axis_hash = mix_bits(hash);
+	_dimension += 2;
+	return {fixed_to_float(reverse_bits(laine_karras_permutation(index, static_cast<std::uint32_t>(hash >> 32U)))),
+			fixed_to_float(nested_uniform_scramble(sobol1(index), static_cast<std::uint32_t>(axis_hash)))};
+}
+
+} // namespace rt
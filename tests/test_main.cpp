@@ -1,7 +1,41 @@
 #include <catch2/catch_test_macros.hpp>
+#include "rt/SoftTracer.hpp"
+#include "rt/core/Camera.hpp"
 #include "rt/core/Ray.hpp"
+#include "rt/core/RayPacket.hpp"
+#include "rt/core/TileScheduler.hpp"
+#include "rt/core/Utils.hpp"
+#include "rt/hittables/BVH.hpp"
+#include "rt/hittables/Instance.hpp"
+#include "rt/hittables/Quad.hpp"
 #include "rt/hittables/Sphere.hpp"
+#include "rt/hittables/SphereSet.hpp"
+#include "rt/hittables/TLAS.hpp"
+#include "rt/hittables/TriangleMesh.hpp"
+#include "rt/io/HDRImage.hpp"
+#include "rt/io/MeshLoader.hpp"
+#include "rt/io/ToneMap.hpp"
+#include "rt/materials/DiffuseLight.hpp"
 #include "rt/materials/Lambertian.hpp"
+#include "rt/materials/MaterialTable.hpp"
+#include "rt/materials/Metal.hpp"
+#include "rt/materials/WrongLambertian.hpp"
+#include "rt/sampling/PCG32Sampler.hpp"
+#include "rt/sampling/PMJ02Sampler.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <glm/gtc/matrix_transform.hpp>
+#include <fstream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <stdexcept>
 
 TEST_CASE("Ray At", "[ray]") {
     rt::Ray r(glm::vec3(0,0,0), glm::vec3(1,0,0));
@@ -21,3 +55,1169 @@ TEST_CASE("Sphere Hit", "[sphere]") {
     REQUIRE(hit == true);
     REQUIRE(rec.t == 1.0);
 }
+
+TEST_CASE("BVH matches Scene closest hit", "[bvh]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-50.0F, 50.0F);
+    std::uniform_real_distribution<float> size(0.5F, 4.0F);
+
+    rt::Scene scene;
+    auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+    for (int i = 0; i < 300; ++i) {
+        scene.add(std::make_shared<rt::Sphere>(glm::vec3(pos(rng), pos(rng), pos(rng)), size(rng), mat));
+        scene.add(std::make_shared<rt::Quad>(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(size(rng), 0, 0),
+                                             glm::vec3(0, size(rng), size(rng)), mat));
+    }
+    const auto mode = GENERATE(rt::BVHBuildMode::SAH, rt::BVHBuildMode::BINNED_SAH, rt::BVHBuildMode::LBVH,
+                               rt::BVHBuildMode::LBVH_TREELET);
+    const auto layout = GENERATE(rt::BVHLayout::BINARY, rt::BVHLayout::WIDE8);
+    const bool force_scalar = GENERATE(false, true);
+    rt::BVH bvh(scene, mode, layout);
+    bvh.set_force_scalar(force_scalar);
+    REQUIRE(bvh.build_stats().sah_cost > 0.0F);
+
+    int hits = 0;
+    for (int i = 0; i < 5000; ++i) {
+        glm::vec3 dir(pos(rng), pos(rng), pos(rng));
+        // 部分光线平行于坐标平面，覆盖 slab 测试中 0 * inf 的情况
+        if (i % 10 == 0) dir[i % 3] = 0.0F;
+        rt::Ray r(glm::vec3(pos(rng), pos(rng), pos(rng)), dir);
+        rt::HitRecord expected;
+        rt::HitRecord actual;
+        const bool hit_scene = scene.hit(r, 0.001, rt::DOUBLE_INF, expected);
+        const bool hit_bvh = bvh.hit(r, 0.001, rt::DOUBLE_INF, actual);
+        REQUIRE(hit_scene == hit_bvh);
+        REQUIRE(bvh.occluded(r, 0.001, rt::DOUBLE_INF) == hit_scene);
+        REQUIRE(scene.occluded(r, 0.001, rt::DOUBLE_INF) == hit_scene);
+        if (hit_scene) REQUIRE_FALSE(bvh.occluded(r, 0.001, expected.t * 0.999));
+        if (hit_scene) {
+            ++hits;
+            REQUIRE(actual.t == expected.t);
+            REQUIRE(actual.p == expected.p);
+            REQUIRE(actual.normal == expected.normal);
+        }
+    }
+    REQUIRE(hits > 0);
+}
+
+TEST_CASE("BVH depth stays within the traversal stack", "[bvh]") {
+    // 大量重合的包围盒加上沿三个轴按 2 的幂分布的离群点：每个离群点的 Morton 码恰好多出一位，
+    // 不限制深度时 LBVH 会在重合的图元之上形成 63 层的链
+    constexpr int COINCIDENT = 200000;
+    std::vector<rt::AABB> boxes(COINCIDENT, rt::AABB(glm::vec3(-0.5F), glm::vec3(0.5F)));
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int k = 0; k < 21; ++k) {
+            glm::vec3 c(0.0F);
+            c[axis] = std::ldexp(1.0F, k);
+            boxes.emplace_back(c - 0.5F, c + 0.5F);
+        }
+    }
+
+    const auto mode = GENERATE(rt::BVHBuildMode::SAH, rt::BVHBuildMode::BINNED_SAH, rt::BVHBuildMode::LBVH,
+                               rt::BVHBuildMode::LBVH_TREELET);
+    rt::BVHTree tree;
+    tree.build(boxes, mode);
+    REQUIRE(tree.stats().max_depth <= rt::BVHTree::MAX_DEPTH);
+
+    // 沿 x 轴的光线穿过重合的包围盒与 x 轴上的离群点，二叉树与 8 叉树都应恰好访问每个一次
+    rt::WideBVH wide;
+    wide.build(tree);
+    const rt::Ray r(glm::vec3(-1, 0, 0), glm::vec3(1, 0, 0));
+    for (const bool use_wide : {false, true}) {
+        std::vector<int> visits(boxes.size(), 0);
+        const auto leaf = [&](const std::uint32_t first, const std::uint32_t count, double&) {
+            for (std::uint32_t k = first; k < first + count; ++k)
+                ++visits[tree.indices()[k]];
+            return false;
+        };
+        double t_max = rt::DOUBLE_INF;
+        if (use_wide)
+            wide.intersect(r, 0.0, t_max, leaf);
+        else
+            tree.intersect(r, 0.0, t_max, leaf);
+        REQUIRE(std::ranges::all_of(visits.begin(), visits.begin() + COINCIDENT + 21, [](const int v) { return v == 1; }));
+    }
+}
+
+TEST_CASE("Ray packets match single-ray hits", "[packet]") {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> pos(-50.0F, 50.0F);
+    std::uniform_real_distribution<float> size(0.5F, 4.0F);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    rt::Scene scene;
+    auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+    for (int i = 0; i < 300; ++i) {
+        scene.add(std::make_shared<rt::Sphere>(glm::vec3(pos(rng), pos(rng), pos(rng)), size(rng), mat));
+        scene.add(std::make_shared<rt::Quad>(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(size(rng), 0, 0),
+                                             glm::vec3(0, size(rng), size(rng)), mat));
+    }
+    const auto layout = GENERATE(rt::BVHLayout::BINARY, rt::BVHLayout::WIDE8);
+    rt::BVH bvh(scene, rt::BVHBuildMode::BINNED_SAH, layout);
+    const std::array<const rt::Hittable*, 2> worlds = {&scene, &bvh};
+
+    // 相干的相机主光线包与方向随机的发散光线包（后者在根附近就会回退到逐条遍历），部分包只有少数有效通道
+    const rt::Camera cam(glm::vec3(0, 0, 80), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0), 60.0, 1.0);
+    int total = 0;
+    int hits = 0;
+    for (int p = 0; p < 600; ++p) {
+        const bool coherent = p % 3 != 0;
+        const int lanes = p % 5 == 0 ? 1 + p % rt::RayPacket::SIZE : rt::RayPacket::SIZE;
+        const double u0 = unit(rng);
+        const double v0 = unit(rng);
+        rt::RayPacket packet;
+        for (int lane = 0; lane < lanes; ++lane) {
+            if (coherent)
+                packet.set(lane, cam.get_ray(u0 + lane * 0.002, v0));
+            else
+                packet.set(lane, rt::Ray(glm::vec3(pos(rng), pos(rng), pos(rng)),
+                                         glm::vec3(pos(rng), pos(rng), pos(rng))));
+        }
+
+        for (const rt::Hittable* world : worlds) {
+            rt::PacketHitRecord packet_hits;
+            packet_hits.reset(rt::DOUBLE_INF);
+            const std::uint32_t mask = world->hit_packet(packet, packet.valid, 0.001, packet_hits);
+            REQUIRE(mask == packet_hits.hit_mask);
+            REQUIRE((mask & ~packet.valid) == 0);
+            for (int lane = 0; lane < lanes; ++lane) {
+                rt::HitRecord expected;
+                const bool hit = scene.hit(packet.ray(lane), 0.001, rt::DOUBLE_INF, expected);
+                const bool packet_hit = (mask & (1U << lane)) != 0;
+                ++total;
+                // 光线包的单精度测试只是保守的候选筛选，击中与交点都由单光线的双精度求交确定，包括掠射的轮廓
+                INFO("packet " << p << " lane " << lane);
+                REQUIRE(hit == packet_hit);
+                if (!hit) continue;
+                ++hits;
+                REQUIRE(packet_hits.t_max[lane] == packet_hits.rec[lane].t);
+                REQUIRE(std::abs(packet_hits.rec[lane].t - expected.t) <= 1e-9 * (1.0 + expected.t));
+            }
+        }
+    }
+    REQUIRE(hits > total / 10);
+}
+
+TEST_CASE("Ray packets keep grazing hits at silhouettes", "[packet]") {
+    auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+    const glm::vec3 center(0.3F, 0.2F, -5.0F);
+    constexpr float RADIUS = 1.37F;
+    const glm::vec3 corner(-1.1F, -0.7F, -3.0F);
+    const glm::vec3 u(2.3F, 0.1F, 0.4F);
+    const glm::vec3 v(-0.2F, 1.9F, 0.3F);
+    const std::vector<std::shared_ptr<rt::Hittable>> objects = {std::make_shared<rt::Sphere>(center, RADIUS, mat),
+                                                                std::make_shared<rt::Quad>(corner, u, v, mat)};
+
+    // 光线瞄准球体轮廓与四边形边缘上的点，再按单精度的几个 ulp 向内外偏移，命中与否只差舍入
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+    int hits = 0;
+    int misses = 0;
+    for (int p = 0; p < 2000; ++p) {
+        const glm::vec3 origin(unit(rng) - 0.5F, unit(rng) - 0.5F, 20.0F + unit(rng));
+        rt::RayPacket sphere_packet;
+        rt::RayPacket quad_packet;
+        for (int lane = 0; lane < rt::RayPacket::SIZE; ++lane) {
+            const float offset = static_cast<float>(lane - rt::RayPacket::SIZE / 2) * 1e-7F;
+            // 与视线垂直的平面上，球心周围半径 sqrt(|co|^2 - R^2) * R / |co| 的圆是轮廓
+            const glm::vec3 to_center = center - origin;
+            const glm::vec3 side = glm::normalize(glm::cross(to_center, glm::vec3(std::cos(p), std::sin(p), 0)));
+            const float dist2 = glm::dot(to_center, to_center);
+            const float ring = RADIUS * std::sqrt(dist2 - RADIUS * RADIUS) / std::sqrt(dist2);
+            const glm::vec3 rim = center - to_center * (RADIUS * RADIUS / dist2) + side * (ring * (1.0F + offset));
+            sphere_packet.set(lane, rt::Ray(origin, rim - origin));
+
+            const float along = unit(rng);
+            const glm::vec3 edge = p % 2 == 0 ? corner + along * u + offset * v : corner + offset * u + along * v;
+            quad_packet.set(lane, rt::Ray(origin, edge - origin));
+        }
+
+        for (size_t i = 0; i < objects.size(); ++i) {
+            const rt::RayPacket& packet = i == 0 ? sphere_packet : quad_packet;
+            rt::PacketHitRecord packet_hits;
+            packet_hits.reset(rt::DOUBLE_INF);
+            const std::uint32_t mask = objects[i]->hit_packet(packet, packet.valid, 0.001, packet_hits);
+            for (int lane = 0; lane < rt::RayPacket::SIZE; ++lane) {
+                rt::HitRecord expected;
+                const bool hit = objects[i]->hit(packet.ray(lane), 0.001, rt::DOUBLE_INF, expected);
+                INFO("packet " << p << " object " << i << " lane " << lane);
+                REQUIRE(((mask >> lane) & 1U) == static_cast<std::uint32_t>(hit));
+                if (hit)
+                    REQUIRE(packet_hits.rec[lane].t == expected.t);
+                ++(hit ? hits : misses);
+            }
+        }
+    }
+    REQUIRE(hits > 0);
+    REQUIRE(misses > 0);
+}
+
+TEST_CASE("BVH refit follows moving objects", "[bvh]") {
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> pos(-40.0F, 40.0F);
+    std::uniform_real_distribution<float> step(-1.0F, 1.0F);
+
+    rt::Scene scene;
+    std::vector<std::shared_ptr<rt::Sphere>> spheres;
+    std::vector<std::shared_ptr<rt::Quad>> quads;
+    auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+    for (int i = 0; i < 300; ++i) {
+        spheres.push_back(std::make_shared<rt::Sphere>(glm::vec3(pos(rng), pos(rng), pos(rng)), 1.5, mat));
+        quads.push_back(std::make_shared<rt::Quad>(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(2, 0, 0),
+                                                   glm::vec3(0, 2, 1), mat));
+        scene.add(spheres.back());
+        scene.add(quads.back());
+    }
+    const auto layout = GENERATE(rt::BVHLayout::BINARY, rt::BVHLayout::WIDE8);
+    rt::BVH bvh(scene, rt::BVHBuildMode::BINNED_SAH, layout);
+
+    const auto check = [&] {
+        for (int i = 0; i < 1000; ++i) {
+            const rt::Ray r(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(pos(rng), pos(rng), pos(rng)));
+            rt::HitRecord expected;
+            rt::HitRecord actual;
+            const bool hit = scene.hit(r, 0.001, rt::DOUBLE_INF, expected);
+            REQUIRE(bvh.hit(r, 0.001, rt::DOUBLE_INF, actual) == hit);
+            REQUIRE(bvh.occluded(r, 0.001, rt::DOUBLE_INF) == hit);
+            if (hit) REQUIRE(actual.t == expected.t);
+        }
+    };
+
+    // 小幅移动：只重新拟合，不重建
+    bvh.set_rebuild_threshold(std::numeric_limits<float>::infinity());
+    for (int frame = 0; frame < 3; ++frame) {
+        for (const auto& sphere : spheres)
+            sphere->set_center(sphere->center() + glm::vec3(step(rng), step(rng), step(rng)));
+        for (const auto& quad : quads)
+            quad->set_geometry(quad->corner() + glm::vec3(step(rng), step(rng), step(rng)), quad->u(), quad->v());
+        const rt::BVHRefitStats stats = bvh.refit();
+        REQUIRE_FALSE(stats.rebuilt);
+        REQUIRE(stats.degradation > 0.0F);
+        check();
+    }
+
+    // 打乱全部位置：树的质量严重下降，触发自动重建
+    bvh.set_rebuild_threshold(rt::BVH::DEFAULT_REBUILD_THRESHOLD);
+    for (const auto& sphere : spheres)
+        sphere->set_center(glm::vec3(pos(rng), pos(rng), pos(rng)));
+    const rt::BVHRefitStats stats = bvh.refit();
+    REQUIRE(stats.rebuilt);
+    REQUIRE(stats.sah_cost == bvh.build_stats().sah_cost);
+    check();
+}
+
+TEST_CASE("SphereSet matches individual spheres", "[sphere]") {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-20.0F, 20.0F);
+    std::uniform_real_distribution<float> size(0.2F, 1.5F);
+
+    rt::Scene scene;
+    std::vector<std::shared_ptr<rt::Sphere>> spheres;
+    for (int i = 0; i < 500; ++i) {
+        auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+        spheres.push_back(std::make_shared<rt::Sphere>(glm::vec3(pos(rng), pos(rng), pos(rng)), size(rng), mat));
+        scene.add(spheres.back());
+    }
+    const auto cluster_size = GENERATE(3U, 8U, 16U, 21U);
+    const bool force_scalar = GENERATE(false, true);
+    auto clusters = rt::SphereSet::make_clusters(spheres, cluster_size);
+    for (const auto& cluster : clusters)
+        std::static_pointer_cast<rt::SphereSet>(cluster)->set_force_scalar(force_scalar);
+    rt::BVH bvh(clusters);
+
+    int hits = 0;
+    for (int i = 0; i < 3000; ++i) {
+        rt::Ray r(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(pos(rng), pos(rng), pos(rng)));
+        rt::HitRecord expected;
+        rt::HitRecord actual;
+        const bool hit_scene = scene.hit(r, 0.001, rt::DOUBLE_INF, expected);
+        REQUIRE(bvh.hit(r, 0.001, rt::DOUBLE_INF, actual) == hit_scene);
+        REQUIRE(bvh.occluded(r, 0.001, rt::DOUBLE_INF) == hit_scene);
+        if (hit_scene) {
+            ++hits;
+            // 单精度只用来选出最近的球体，交点按与 Sphere 相同的双精度求根确定；-ffast-math 下两处内联的求根
+            // 与单精度的击中点可能按不同方式收缩运算，法线除以小半径后差异放大，只要求在舍入误差以内一致
+            REQUIRE(std::abs(actual.t - expected.t) <= 1e-9 * (1.0 + expected.t));
+            REQUIRE(actual.mat_ptr == expected.mat_ptr);
+            REQUIRE(glm::length(actual.normal - expected.normal) < 1e-4F);
+        }
+    }
+    REQUIRE(hits > 0);
+}
+
+TEST_CASE("SphereSet skips candidates rejected in double precision", "[sphere]") {
+    auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+    // 两种精度算出的球 a 近根相同，t_min 比它大得不足一个单精度 ulp：单精度测试把近根当作候选，
+    // 双精度求根却换成远根，真正最近的交点在两者之间的球 b 上
+    const rt::Sphere a(glm::vec3(0, 0, 0), 1.0, mat);
+    const rt::Sphere b(glm::vec3(0, 0, 0.25F), 0.125, mat);
+    rt::Scene scene;
+    scene.add(std::make_shared<rt::Sphere>(a));
+    scene.add(std::make_shared<rt::Sphere>(b));
+    rt::SphereSet set;
+    set.add(a.center(), static_cast<float>(a.radius()), mat);
+    set.add(b.center(), static_cast<float>(b.radius()), mat);
+    set.set_force_scalar(GENERATE(false, true));
+
+    const rt::Ray r(glm::vec3(0, 0, 1.001F), glm::vec3(0, 0, -1));
+    const double t_min = static_cast<double>(1.001F) - 1.0 + 1e-12;
+    rt::HitRecord expected;
+    rt::HitRecord actual;
+    REQUIRE(scene.hit(r, t_min, rt::DOUBLE_INF, expected));
+    REQUIRE(set.hit(r, t_min, rt::DOUBLE_INF, actual));
+    REQUIRE(actual.t == expected.t);
+    REQUIRE(set.occluded(r, t_min, rt::DOUBLE_INF));
+    REQUIRE(std::abs(actual.t - 0.626) < 1e-6);
+    REQUIRE_FALSE(set.hit(r, t_min, 0.5, actual));
+    REQUIRE_FALSE(set.occluded(r, t_min, 0.5));
+}
+
+TEST_CASE("TriangleMesh is watertight and matches Quad", "[mesh]") {
+    auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+
+    // N x N 的网格平面，共享边与顶点都位于整数坐标上
+    constexpr int N = 16;
+    std::vector<glm::vec3> positions;
+    std::vector<std::uint32_t> indices;
+    for (int y = 0; y <= N; ++y)
+        for (int x = 0; x <= N; ++x)
+            positions.emplace_back(x, y, 0);
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            const auto i = static_cast<std::uint32_t>(y * (N + 1) + x);
+            indices.insert(indices.end(), {i, i + 1, i + N + 2, i, i + N + 2, i + N + 1});
+        }
+    }
+    const rt::TriangleMesh grid(positions, indices, mat);
+    REQUIRE(grid.triangle_count() == 2 * N * N);
+
+    // 穿过顶点、边与对角线的光线都必须击中
+    for (int y = 1; y < 2 * N; ++y) {
+        for (int x = 1; x < 2 * N; ++x) {
+            const glm::vec3 target(0.5F * static_cast<float>(x), 0.5F * static_cast<float>(y), 0.0F);
+            for (const glm::vec3 dir : {glm::vec3(0, 0, -1), glm::vec3(0.3F, -0.2F, -1), glm::vec3(-1, 1, -0.7F)}) {
+                const rt::Ray r(target - 5.0F * dir, dir);
+                rt::HitRecord rec;
+                REQUIRE(grid.hit(r, 0.001, rt::DOUBLE_INF, rec));
+                REQUIRE(std::abs(rec.t - 5.0) < 1e-4);
+                REQUIRE(grid.occluded(r, 0.001, rt::DOUBLE_INF));
+                REQUIRE_FALSE(grid.occluded(r, 0.001, 4.9));
+            }
+        }
+    }
+
+    // 两个三角形组成的四边形与 Quad 的结果一致
+    const glm::vec3 q(-1, 2, 3);
+    const glm::vec3 u(4, 0, 1);
+    const glm::vec3 v(0, 3, -1);
+    const rt::Quad quad(q, u, v, mat);
+    const rt::TriangleMesh quad_mesh({q, q + u, q + u + v, q + v}, {0, 1, 2, 0, 2, 3}, mat, {},
+                                     {glm::vec2(0, 0), glm::vec2(1, 0), glm::vec2(1, 1), glm::vec2(0, 1)});
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> pos(-10.0F, 10.0F);
+    for (int i = 0; i < 2000; ++i) {
+        const rt::Ray r(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(pos(rng), pos(rng), pos(rng)));
+        rt::HitRecord expected;
+        rt::HitRecord actual;
+        const bool hit_quad = quad.hit(r, 0.001, rt::DOUBLE_INF, expected);
+        const bool hit_mesh = quad_mesh.hit(r, 0.001, rt::DOUBLE_INF, actual);
+        if (!hit_quad) {
+            REQUIRE_FALSE(hit_mesh);
+            continue;
+        }
+        // 只比较远离边界的击中，边界上两种算法的舍入方向可能不同
+        if (std::min({expected.u, 1 - expected.u, expected.v, 1 - expected.v}) > 1e-3) {
+            REQUIRE(hit_mesh);
+            REQUIRE(std::abs(actual.t - expected.t) < 1e-4 * expected.t);
+            REQUIRE(glm::dot(actual.normal, expected.normal) > 0.9999F);
+            REQUIRE(std::abs(actual.u - expected.u) < 1e-3);
+            REQUIRE(std::abs(actual.v - expected.v) < 1e-3);
+        }
+    }
+}
+
+TEST_CASE("MeshLoader parses OBJ and PLY and maps the cache", "[mesh]") {
+    auto mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+    const auto dir = std::filesystem::temp_directory_path() / "rt_mesh_loader_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 起伏的网格面，每个格子单独写 4 个顶点，OBJ 面使用负数相对下标
+    constexpr int N = 96;
+    std::vector<glm::vec3> positions;
+    std::vector<std::uint32_t> indices;
+    std::ofstream obj(dir / "grid.obj");
+    obj << "# grid\n";
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            const auto base = static_cast<std::uint32_t>(positions.size());
+            for (const auto& [dx, dy] : {std::pair(0, 0), std::pair(1, 0), std::pair(1, 1), std::pair(0, 1)}) {
+                const float px = static_cast<float>(x + dx);
+                const float py = static_cast<float>(y + dy);
+                positions.emplace_back(px, py, std::sin(0.3F * px) * std::cos(0.2F * py));
+                obj << "v " << positions.back().x << ' ' << positions.back().y << ' ' << positions.back().z << '\n';
+                obj << "vt " << dx << ' ' << dy << "\nvn 0 0 1\n";
+            }
+            obj << "f -4/-4/-4 -3/-3/-3 -2/-2/-2 -1/-1/-1\n";
+            indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+        }
+    }
+    obj.close();
+
+    // 同一网格的二进制 PLY
+    {
+        std::ofstream ply(dir / "grid.ply", std::ios::binary);
+        ply << "ply\nformat binary_little_endian 1.0\nelement vertex " << positions.size()
+            << "\nproperty float x\nproperty float y\nproperty float z\nelement face " << indices.size() / 3
+            << "\nproperty list uchar int vertex_indices\nend_header\n";
+        ply.write(reinterpret_cast<const char*>(positions.data()),
+                  static_cast<std::streamsize>(positions.size() * sizeof(glm::vec3)));
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            const std::uint8_t count = 3;
+            ply.write(reinterpret_cast<const char*>(&count), 1);
+            ply.write(reinterpret_cast<const char*>(&indices[i]), 3 * sizeof(std::uint32_t));
+        }
+    }
+
+    const rt::TriangleMesh reference(positions, indices, mat);
+    const auto file = GENERATE(std::string("grid.obj"), std::string("grid.ply"));
+    rt::MeshLoadStats parsed_stats;
+    rt::MeshLoadStats cached_stats;
+    const auto parsed = rt::MeshLoader::load(dir / file, mat, {}, &parsed_stats);
+    const auto cached = rt::MeshLoader::load(dir / file, mat, {}, &cached_stats);
+    REQUIRE_FALSE(parsed_stats.from_cache);
+    REQUIRE(parsed_stats.cache_written);
+    REQUIRE(cached_stats.from_cache);
+    REQUIRE(cached_stats.peak_memory > 0);
+    REQUIRE(parsed->triangle_count() == reference.triangle_count());
+    REQUIRE(cached->triangle_count() == reference.triangle_count());
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> pos(0.0F, static_cast<float>(N));
+    for (int i = 0; i < 2000; ++i) {
+        const rt::Ray r(glm::vec3(pos(rng), pos(rng), 5.0F), glm::vec3(pos(rng) - 48.0F, pos(rng) - 48.0F, -10.0F));
+        rt::HitRecord expected;
+        rt::HitRecord from_file;
+        rt::HitRecord from_cache;
+        const bool hit = reference.hit(r, 0.001, rt::DOUBLE_INF, expected);
+        REQUIRE(parsed->hit(r, 0.001, rt::DOUBLE_INF, from_file) == hit);
+        REQUIRE(cached->hit(r, 0.001, rt::DOUBLE_INF, from_cache) == hit);
+        if (hit) {
+            REQUIRE(std::abs(from_file.t - expected.t) < 1e-5 * expected.t);
+            REQUIRE(from_cache.t == from_file.t);
+            REQUIRE(from_cache.normal == from_file.normal);
+            REQUIRE(from_cache.u == from_file.u);
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("TLAS instances match transformed geometry", "[instance]") {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> pos(-30.0F, 30.0F);
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+
+    // BLAS 为以原点为中心的单位球；经旋转、均匀缩放与平移后等价于另一个球
+    auto base_mat = std::make_shared<rt::Lambertian>(glm::vec3(0.5, 0.5, 0.5));
+    auto override_mat = std::make_shared<rt::Lambertian>(glm::vec3(0.9, 0.1, 0.1));
+    auto unit_sphere = std::make_shared<rt::Sphere>(glm::vec3(0, 0, 0), 1.0, base_mat);
+    const auto layout = GENERATE(rt::BVHLayout::BINARY, rt::BVHLayout::WIDE8);
+    rt::TLAS tlas(layout);
+    const std::uint32_t sphere_id = tlas.add_blas(unit_sphere);
+    const std::uint32_t override_id = tlas.add_material(override_mat);
+
+    rt::Scene expected_scene;
+    rt::Scene instance_scene;
+    for (int i = 0; i < 400; ++i) {
+        const glm::vec3 center(pos(rng), pos(rng), pos(rng));
+        const float radius = 0.3F + 2.0F * unit(rng);
+        const glm::vec3 axis(unit(rng) - 0.5F, unit(rng) - 0.5F, unit(rng) + 0.1F);
+        glm::mat4 transform = glm::translate(glm::mat4(1.0F), center);
+        transform = glm::rotate(transform, 6.0F * unit(rng), axis);
+        transform = glm::scale(transform, glm::vec3(radius));
+        const auto& mat = i % 3 == 0 ? override_mat : base_mat;
+
+        tlas.add_instance(sphere_id, transform, i % 3 == 0 ? override_id : rt::InstanceRecord::NO_MATERIAL);
+        instance_scene.add(std::make_shared<rt::Instance>(unit_sphere, transform, i % 3 == 0 ? override_mat : nullptr));
+        expected_scene.add(std::make_shared<rt::Sphere>(center, radius, mat));
+    }
+    tlas.build();
+    const rt::BVH instance_bvh(instance_scene);
+    REQUIRE(tlas.instance_count() == 400);
+
+    int hits = 0;
+    for (int i = 0; i < 3000; ++i) {
+        const rt::Ray r(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(pos(rng), pos(rng), pos(rng)));
+        rt::HitRecord expected;
+        const bool hit = expected_scene.hit(r, 0.001, rt::DOUBLE_INF, expected);
+        REQUIRE(tlas.occluded(r, 0.001, rt::DOUBLE_INF) == hit);
+        const std::array<const rt::Hittable*, 2> worlds = {&tlas, &instance_bvh};
+        for (const rt::Hittable* world : worlds) {
+            rt::HitRecord actual;
+            REQUIRE(world->hit(r, 0.001, rt::DOUBLE_INF, actual) == hit);
+            if (!hit) continue;
+            REQUIRE(std::abs(actual.t - expected.t) < 1e-4 * (1.0 + expected.t));
+            REQUIRE(glm::length(actual.p - expected.p) < 1e-4F * (1.0F + glm::length(expected.p)));
+            REQUIRE(glm::dot(actual.normal, expected.normal) > 0.999F);
+            REQUIRE(actual.front_face == expected.front_face);
+            REQUIRE(actual.mat_ptr == expected.mat_ptr);
+        }
+        hits += hit ? 1 : 0;
+    }
+    REQUIRE(hits > 0);
+}
+
+namespace {
+
+/**
+ * @brief 小尺寸 Cornell Box：漫反射墙面、一个金属球与一个面光源，用于比较积分器。
+ */
+struct CornellScene {
+    rt::Scene world;
+    std::shared_ptr<rt::Scene> lights = std::make_shared<rt::Scene>();
+    rt::Camera cam{glm::vec3(278, 278, -800), glm::vec3(278, 278, 0), glm::vec3(0, 1, 0), 40, 1.0};
+
+    CornellScene() {
+        auto red = std::make_shared<rt::Lambertian>(glm::vec3(.65, .05, .05));
+        auto white = std::make_shared<rt::Lambertian>(glm::vec3(.73, .73, .73));
+        auto green = std::make_shared<rt::Lambertian>(glm::vec3(.12, .45, .15));
+        auto metal = std::make_shared<rt::Metal>(glm::vec3(.8, .85, .88), 0.0);
+        auto light = std::make_shared<rt::DiffuseLight>(glm::vec3(4, 4, 4));
+        // 没有天花板、光源面积较大，估计的方差有界，少量样本即可稳定比较
+        auto light_shape = std::make_shared<rt::Quad>(glm::vec3(455, 554, 455), glm::vec3(-355, 0, 0),
+                                                      glm::vec3(0, 0, -355), light);
+        world.add(std::make_shared<rt::Quad>(glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), green));
+        world.add(std::make_shared<rt::Quad>(glm::vec3(0, 0, 0), glm::vec3(0, 555, 0), glm::vec3(0, 0, 555), red));
+        world.add(std::make_shared<rt::Quad>(glm::vec3(0, 0, 0), glm::vec3(555, 0, 0), glm::vec3(0, 0, 555), white));
+        world.add(std::make_shared<rt::Quad>(glm::vec3(0, 0, 555), glm::vec3(555, 0, 0), glm::vec3(0, 555, 0), white));
+        world.add(std::make_shared<rt::Sphere>(glm::vec3(278, 100, 278), 100, metal));
+        world.add(light_shape);
+        lights->add(light_shape);
+    }
+
+    /**
+     * @brief 渲染并返回左右两半图像的平均颜色。
+     */
+    std::array<glm::vec3, 2> render(rt::SoftTracer& tracer, const int size) const {
+        tracer.set_background(glm::vec3(0, 0, 0), false);
+        const std::vector<glm::vec3> framebuffer = tracer.render_framebuffer(world, lights, cam);
+        std::array<glm::vec3, 2> halves = {glm::vec3(0.0F), glm::vec3(0.0F)};
+        for (size_t k = 0; k < framebuffer.size(); ++k)
+            halves[static_cast<int>(k % size) < size / 2 ? 0 : 1] += framebuffer[k];
+        for (auto& half : halves)
+            half /= static_cast<float>(framebuffer.size() / 2);
+        return halves;
+    }
+};
+
+} // namespace
+
+TEST_CASE("Wavefront integrator matches recursive", "[integrator]") {
+    const auto strategy = GENERATE(rt::SamplingStrategy::MIS, rt::SamplingStrategy::LIGHT,
+                                   rt::SamplingStrategy::MATERIAL);
+    constexpr int SIZE = 16;
+    constexpr int SPP = 512;
+    const CornellScene scene;
+
+    rt::SoftTracer recursive(SIZE, SIZE, SPP, 8);
+    recursive.set_sampling_strategy(strategy);
+    rt::SoftTracer wavefront(SIZE, SIZE, SPP, 8);
+    wavefront.set_sampling_strategy(strategy);
+    wavefront.set_integrator(rt::IntegratorMode::WAVEFRONT);
+
+    const auto expected = scene.render(recursive, SIZE);
+    const auto actual = scene.render(wavefront, SIZE);
+    for (int half = 0; half < 2; ++half) {
+        for (int c = 0; c < 3; ++c) {
+            INFO("half " << half << " channel " << c);
+            REQUIRE(expected[half][c] > 0.0F);
+            REQUIRE(std::abs(actual[half][c] - expected[half][c]) <= 0.05F * expected[half][c]);
+        }
+    }
+}
+
+TEST_CASE("Iterative integrator matches recursive", "[integrator]") {
+    const auto strategy = GENERATE(rt::SamplingStrategy::MIS, rt::SamplingStrategy::LIGHT,
+                                   rt::SamplingStrategy::MATERIAL);
+    constexpr int SIZE = 16;
+    constexpr int SPP = 512;
+    const CornellScene scene;
+
+    rt::SoftTracer recursive(SIZE, SIZE, SPP, 8);
+    recursive.set_sampling_strategy(strategy);
+    rt::SoftTracer iterative(SIZE, SIZE, SPP, 8);
+    iterative.set_sampling_strategy(strategy);
+    iterative.set_integrator(rt::IntegratorMode::ITERATIVE);
+
+    const auto expected = scene.render(recursive, SIZE);
+    const auto actual = scene.render(iterative, SIZE);
+    for (int half = 0; half < 2; ++half) {
+        for (int c = 0; c < 3; ++c) {
+            INFO("half " << half << " channel " << c);
+            REQUIRE(expected[half][c] > 0.0F);
+            REQUIRE(std::abs(actual[half][c] - expected[half][c]) <= 0.05F * expected[half][c]);
+        }
+    }
+}
+
+TEST_CASE("Sampler streams depend only on pixel and sample index", "[sampler]") {
+    rt::PCG32Sampler a(7);
+    rt::PCG32Sampler b(7);
+    std::array<float, 8> first{};
+    a.start_pixel_sample(12, 3, 0);
+    for (auto& x : first) {
+        x = a.get_1d();
+        REQUIRE(x >= 0.0F);
+        REQUIRE(x < 1.0F);
+    }
+    REQUIRE(a.dimension() == first.size());
+
+    // 从中间的维度开始与顺序取到该维度得到相同的数
+    b.start_pixel_sample(12, 3, 5);
+    REQUIRE(b.get_1d() == first[5]);
+    REQUIRE(b.get_2d() == glm::vec2(first[6], first[7]));
+
+    // 相邻像素、相邻采样与不同种子的序列互不相同
+    b.start_pixel_sample(13, 3, 0);
+    REQUIRE(b.get_1d() != first[0]);
+    b.start_pixel_sample(12, 4, 0);
+    REQUIRE(b.get_1d() != first[0]);
+    rt::PCG32Sampler c(8);
+    c.start_pixel_sample(12, 3, 0);
+    REQUIRE(c.get_1d() != first[0]);
+
+    // 整幅图像可以逐位复现，扫描线与波前积分器对同一像素使用同一序列
+    const CornellScene scene;
+    std::array<std::vector<glm::vec3>, 3> images;
+    for (size_t k = 0; k < images.size(); ++k) {
+        rt::SoftTracer tracer(8, 8, 4, 8);
+        tracer.set_background(glm::vec3(0, 0, 0), false);
+        tracer.set_seed(7);
+        if (k == 2) tracer.set_integrator(rt::IntegratorMode::WAVEFRONT);
+        images[k] = tracer.render_framebuffer(scene.world, scene.lights, scene.cam);
+    }
+    REQUIRE(images[0] == images[1]);
+    for (size_t p = 0; p < images[0].size(); ++p) {
+        INFO("pixel " << p);
+        for (int ch = 0; ch < 3; ++ch)
+            REQUIRE(std::abs(images[2][p][ch] - images[0][p][ch]) <= 1e-4F * std::max(1.0F, images[0][p][ch]));
+    }
+}
+
+TEST_CASE("Low-discrepancy samplers stratify every dimension", "[sampler]") {
+    const auto type = GENERATE(rt::SamplerType::SOBOL, rt::SamplerType::PMJ02);
+    constexpr int SPP = 16;
+    const auto sampler = rt::make_sampler(type, 3);
+
+    // 每个像素、每组维度的 16 个二维点都是 (0,4,2) 网：16x1、8x2、4x4、2x8、1x16 的每个基本区间恰有一个点
+    for (std::uint32_t pixel = 0; pixel < 4; ++pixel) {
+        for (std::uint32_t dimension = 0; dimension < 40; dimension += 5) {
+            INFO("pixel " << pixel << " dimension " << dimension);
+            std::array<glm::vec2, SPP> points{};
+            std::array<float, SPP> values{};
+            for (int s = 0; s < SPP; ++s) {
+                sampler->start_pixel_sample(pixel, s, dimension);
+                points[s] = sampler->get_2d();
+                REQUIRE(sampler->dimension() == dimension + 2);
+                sampler->set_dimension(dimension + 3);
+                values[s] = sampler->get_1d();
+            }
+            for (int k = 0; k <= 4; ++k) {
+                const int x_divs = SPP >> k;
+                const int y_divs = 1 << k;
+                std::array<int, SPP> count{};
+                for (const glm::vec2& p : points)
+                    ++count[static_cast<int>(p.y * y_divs) * x_divs + static_cast<int>(p.x * x_divs)];
+                for (const int c : count)
+                    REQUIRE(c == 1);
+            }
+            std::array<int, SPP> count{};
+            for (const float v : values)
+                ++count[static_cast<int>(v * SPP)];
+            for (const int c : count)
+                REQUIRE(c == 1);
+        }
+    }
+
+    // 两组不同的维度之间不相关：同一采样序号取到的点不相同
+    sampler->start_pixel_sample(0, 5, 0);
+    const glm::vec2 a = sampler->get_2d();
+    const glm::vec2 b = sampler->get_2d();
+    REQUIRE(a != b);
+
+    // 与独立采样收敛到同一幅图像
+    constexpr int SIZE = 16;
+    const CornellScene scene;
+    rt::SoftTracer independent(SIZE, SIZE, 256, 8);
+    rt::SoftTracer low_discrepancy(SIZE, SIZE, 256, 8);
+    low_discrepancy.set_sampler(type);
+    const auto expected = scene.render(independent, SIZE);
+    const auto actual = scene.render(low_discrepancy, SIZE);
+    for (int half = 0; half < 2; ++half) {
+        for (int c = 0; c < 3; ++c) {
+            INFO("half " << half << " channel " << c);
+            REQUIRE(std::abs(actual[half][c] - expected[half][c]) <= 0.05F * expected[half][c]);
+        }
+    }
+}
+
+TEST_CASE("Low-discrepancy sample prefixes stay stratified", "[sampler]") {
+    const auto type = GENERATE(rt::SamplerType::SOBOL, rt::SamplerType::PMJ02);
+    const auto sampler = rt::make_sampler(type, 7);
+
+    // 自适应采样不知道像素最终的采样数：从 0 开始与越过点表大小之后的每个 2 的幂前缀都必须是 (0,m,2) 网
+    constexpr int MAX_LOG = 8;
+    const std::uint32_t first = GENERATE(0U, rt::PMJ02Sampler::TABLE_SIZE);
+    for (std::uint32_t pixel = 0; pixel < 4; ++pixel) {
+        for (std::uint32_t dimension = 0; dimension < 20; dimension += 2) {
+            std::vector<glm::vec2> points;
+            for (int log_n = 0; log_n <= MAX_LOG; ++log_n) {
+                const int n = 1 << log_n;
+                while (static_cast<int>(points.size()) < n) {
+                    sampler->start_pixel_sample(pixel, first + static_cast<std::uint32_t>(points.size()), dimension);
+                    points.push_back(sampler->get_2d());
+                }
+                INFO("pixel " << pixel << " dimension " << dimension << " prefix " << n);
+                for (int k = 0; k <= log_n; ++k) {
+                    const int x_divs = n >> k;
+                    const int y_divs = 1 << k;
+                    std::vector<int> count(n, 0);
+                    for (const glm::vec2& p : points)
+                        ++count[static_cast<int>(p.y * y_divs) * x_divs + static_cast<int>(p.x * x_divs)];
+                    REQUIRE(std::all_of(count.begin(), count.end(), [](const int c) { return c == 1; }));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Adaptive sampling moves samples from converged pixels", "[adaptive]") {
+    const auto mode = GENERATE(rt::IntegratorMode::RECURSIVE, rt::IntegratorMode::WAVEFRONT);
+    constexpr int SIZE = 16;
+    constexpr int SPP = 64;
+    // 天空渐变下的一个漫反射球：天空像素的亮度几乎不随采样变化，球面则需要更多采样
+    rt::Scene world;
+    world.add(std::make_shared<rt::Sphere>(glm::vec3(0, 0, -1), 0.3, std::make_shared<rt::Lambertian>(
+                                               glm::vec3(0.5, 0.5, 0.5))));
+    world.add(std::make_shared<rt::Sphere>(glm::vec3(0, -100.3, -1), 100, std::make_shared<rt::Lambertian>(
+                                               glm::vec3(0.8, 0.8, 0.0))));
+    const auto lights = std::make_shared<rt::Scene>();
+    const rt::Camera cam(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), 90, 1.0);
+
+    rt::SoftTracer uniform(SIZE, SIZE, SPP, 8);
+    uniform.set_integrator(mode);
+    rt::SoftTracer adaptive(SIZE, SIZE, SPP, 8);
+    adaptive.set_integrator(mode);
+    adaptive.set_adaptive_sampling(0.05F);
+    const std::vector<glm::vec3> expected = uniform.render_framebuffer(world, lights, cam);
+    const std::vector<glm::vec3> actual = adaptive.render_framebuffer(world, lights, cam);
+
+    // 总采样数不超过预算；左上角的天空像素在最少采样数时就已停止，省下的采样用在了其他像素上
+    const std::vector<int>& counts = adaptive.sample_counts();
+    REQUIRE(counts.size() == expected.size());
+    long long total = 0;
+    for (const int count : counts)
+        total += count;
+    REQUIRE(total <= static_cast<long long>(SPP) * SIZE * SIZE);
+    REQUIRE(counts[0] == rt::SoftTracer::ADAPTIVE_MIN_SAMPLES);
+    REQUIRE(*std::max_element(counts.begin(), counts.end()) > SPP);
+    REQUIRE(uniform.sample_counts() == std::vector<int>(expected.size(), SPP));
+
+    glm::vec3 expected_mean(0.0F);
+    glm::vec3 actual_mean(0.0F);
+    for (size_t k = 0; k < expected.size(); ++k) {
+        expected_mean += expected[k];
+        actual_mean += actual[k];
+    }
+    for (int c = 0; c < 3; ++c) {
+        INFO("channel " << c);
+        REQUIRE(std::abs(actual_mean[c] - expected_mean[c]) <= 0.02F * expected_mean[c]);
+    }
+
+    // 快照截断第一轮时，像素仍要补足最少采样数后才判断收敛，采样分布与没有快照时相同
+    for (const int snapshot : {1, 2}) {
+        INFO("snapshot at " << snapshot);
+        rt::SoftTracer snapshotted(SIZE, SIZE, SPP, 8);
+        snapshotted.set_integrator(mode);
+        snapshotted.set_adaptive_sampling(0.05F);
+        snapshotted.set_snapshots({snapshot});
+        std::vector<int> snapshot_counts;
+        snapshotted.render_framebuffers(world, lights, cam,
+                                        [&](const int samples, const auto& /*images*/) {
+                                            snapshot_counts.push_back(samples);
+                                        });
+        REQUIRE(snapshot_counts == std::vector<int>{snapshot});
+        REQUIRE(*std::min_element(snapshotted.sample_counts().begin(), snapshotted.sample_counts().end()) ==
+                rt::SoftTracer::ADAPTIVE_MIN_SAMPLES);
+        REQUIRE(snapshotted.sample_counts() == counts);
+    }
+}
+
+TEST_CASE("Progressive rendering resumes from a checkpoint", "[checkpoint]") {
+    const auto mode = GENERATE(rt::IntegratorMode::RECURSIVE, rt::IntegratorMode::WAVEFRONT);
+    constexpr int SIZE = 16;
+    const CornellScene scene;
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto resumed_path = dir / "rt_test_resumed.ckpt";
+    const auto reference_path = dir / "rt_test_reference.ckpt";
+    std::filesystem::remove(resumed_path);
+    std::filesystem::remove(reference_path);
+
+    const auto make_tracer = [&](const int spp, const std::filesystem::path& path) {
+        auto tracer = std::make_unique<rt::SoftTracer>(SIZE, SIZE, spp, 8);
+        tracer->set_integrator(mode);
+        tracer->set_sampler(rt::SamplerType::SOBOL);
+        tracer->set_background(glm::vec3(0, 0, 0), false);
+        tracer->set_checkpoint(path);
+        return tracer;
+    };
+
+    // 先渲染 16 spp 并写入检查点，再以 40 spp 从检查点继续，结果与一次渲染 40 spp 逐位相同
+    const auto first = make_tracer(16, resumed_path);
+    first->render_framebuffer(scene.world, scene.lights, scene.cam);
+    REQUIRE(std::filesystem::exists(resumed_path));
+    REQUIRE(first->sample_counts() == std::vector<int>(SIZE * SIZE, 16));
+
+    const auto resumed = make_tracer(40, resumed_path);
+    const std::vector<glm::vec3> actual = resumed->render_framebuffer(scene.world, scene.lights, scene.cam);
+    REQUIRE(resumed->sample_counts() == std::vector<int>(SIZE * SIZE, 40));
+    const auto reference = make_tracer(40, reference_path);
+    const std::vector<glm::vec3> expected = reference->render_framebuffer(scene.world, scene.lights, scene.cam);
+    REQUIRE(actual == expected);
+
+    // 时间预算用完时在一轮之后停止
+    rt::SoftTracer budgeted(SIZE, SIZE, 64, 8);
+    budgeted.set_time_budget(1e-9);
+    budgeted.render_framebuffer(scene.world, scene.lights, scene.cam);
+    REQUIRE(budgeted.sample_counts() == std::vector<int>(SIZE * SIZE, rt::SoftTracer::PROGRESSIVE_BATCH));
+
+    // 收到 SIGTERM 时在当前一轮之后停止并写入检查点；信号只作用于这一次渲染，之后的渲染照常完成
+    std::filesystem::remove(resumed_path);
+    std::filesystem::remove(reference_path);
+    const auto interrupted = make_tracer(64, resumed_path);
+    interrupted->set_snapshots({16});
+    interrupted->render_framebuffers(scene.world, scene.lights, scene.cam,
+                                     [](int /*samples*/, const auto& /*images*/) { std::raise(SIGTERM); });
+    REQUIRE(interrupted->sample_counts() == std::vector<int>(SIZE * SIZE, 16));
+    const auto next = make_tracer(32, reference_path);
+    next->render_framebuffer(scene.world, scene.lights, scene.cam);
+    REQUIRE(next->sample_counts() == std::vector<int>(SIZE * SIZE, 32));
+
+    // 图像尺寸不同的检查点不能继续
+    rt::SoftTracer mismatched(SIZE / 2, SIZE / 2, 16, 8);
+    mismatched.set_checkpoint(resumed_path);
+    REQUIRE_THROWS_AS(mismatched.render_framebuffer(scene.world, scene.lights, scene.cam), std::runtime_error);
+
+    std::filesystem::remove(resumed_path);
+    std::filesystem::remove(reference_path);
+}
+
+TEST_CASE("HDR images round-trip through PFM and EXR", "[hdr]") {
+    rt::HDRImage image{37, 21, {}};
+    for (int y = 0; y < image.height; ++y)
+        for (int x = 0; x < image.width; ++x)
+            image.pixels.emplace_back(static_cast<float>(x) / 8.0F, std::exp2(static_cast<float>(y) - 10.0F),
+                                      static_cast<float>(x * y % 7) * 0.3F);
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto pfm = dir / "rt_test_image.pfm";
+    const auto exr_zip = dir / "rt_test_zip.exr";
+    const auto exr_raw = dir / "rt_test_raw.exr";
+
+    // 32 位浮点读回后逐位相同
+    REQUIRE(image.write(pfm, rt::HDRFormat::PFM));
+    REQUIRE(image.write_exr(exr_zip, rt::ExrCompression::ZIP));
+    REQUIRE(image.write_exr(exr_raw, rt::ExrCompression::NONE));
+    for (const auto& path : {pfm, exr_zip, exr_raw}) {
+        const rt::HDRImage loaded = rt::HDRImage::read(path);
+        REQUIRE(loaded.width == image.width);
+        REQUIRE(loaded.height == image.height);
+        REQUIRE(loaded.pixels == image.pixels);
+    }
+    REQUIRE(std::filesystem::file_size(exr_zip) < std::filesystem::file_size(exr_raw));
+
+    // 大端序的单通道 PFM：比例为正，从最下一行开始
+    const auto gray = dir / "rt_test_gray.pfm";
+    {
+        std::ofstream out(gray, std::ios::binary);
+        out << "Pf\n1 2\n1.0\n";
+        out.write("\x3f\x80\x00\x00\x40\x00\x00\x00", 8); // 1.0、2.0
+    }
+    const rt::HDRImage loaded = rt::HDRImage::read(gray);
+    REQUIRE(loaded.pixels == std::vector<glm::vec3>{glm::vec3(2.0F), glm::vec3(1.0F)});
+    REQUIRE_THROWS_AS(rt::HDRImage::read(dir / "rt_test_missing.exr"), std::runtime_error);
+
+    for (const auto& path : {pfm, exr_zip, exr_raw, gray})
+        std::filesystem::remove(path);
+}
+
+TEST_CASE("Tone mapping defaults match gamma 2 with clamping", "[hdr]") {
+    const std::vector<glm::vec3> pixels = {glm::vec3(0.0F), glm::vec3(0.25F, 0.5F, 1.0F), glm::vec3(4.0F, 0.01F, 0.7F)};
+    const std::vector<unsigned char> ldr = rt::tone_map(pixels);
+    for (size_t k = 0; k < pixels.size(); ++k)
+        for (int c = 0; c < 3; ++c)
+            REQUIRE(ldr[k * 3 + c] ==
+                    static_cast<unsigned char>(256 * std::clamp(std::sqrt(pixels[k][c]), 0.0F, 0.999F)));
+
+    // 曝光 +1 档等于辐射度加倍；Reinhard 与 ACES 把高光压缩到 1 以内而不截断
+    rt::ToneMapSettings brighter;
+    brighter.exposure = 1.0F;
+    REQUIRE(rt::tone_map(std::vector<glm::vec3>{glm::vec3(0.125F)}, brighter) ==
+            rt::tone_map(std::vector<glm::vec3>{glm::vec3(0.25F)}));
+    for (const auto op : {rt::ToneMapOperator::REINHARD, rt::ToneMapOperator::ACES}) {
+        rt::ToneMapSettings settings;
+        settings.tone_operator = op;
+        settings.transfer = rt::TransferFunction::SRGB;
+        const std::vector<unsigned char> mapped =
+            rt::tone_map(std::vector<glm::vec3>{glm::vec3(2.0F), glm::vec3(8.0F)}, settings);
+        REQUIRE(mapped[0] < mapped[3]);
+        REQUIRE(mapped[3] < 255);
+    }
+}
+
+TEST_CASE("Tile scheduler covers every pixel once and matches scanlines", "[schedule]") {
+    // 非 2 的幂的尺寸，边缘有不完整的图块；多个队列之间互相窃取
+    constexpr int WIDTH = 45;
+    constexpr int HEIGHT = 19;
+    rt::TileScheduler scheduler(WIDTH, HEIGHT, 12);
+    std::vector<std::uint32_t> subset;
+    for (std::uint32_t k = 0; k < WIDTH * HEIGHT; k += 3)
+        subset.push_back(k);
+
+    std::vector<std::uint32_t> all(WIDTH * HEIGHT);
+    std::iota(all.begin(), all.end(), 0U);
+    for (const auto& pixels : {all, subset}) {
+        scheduler.assign(pixels, 3);
+        std::vector<int> visits(WIDTH * HEIGHT, 0);
+        std::span<const std::uint32_t> tile;
+        for (int round = 0; scheduler.next(round % 2, tile); ++round) {
+            for (const std::uint32_t pixel : tile)
+                ++visits[pixel];
+            scheduler.finish(round % 2, tile.size());
+        }
+        REQUIRE(scheduler.finished() == pixels.size());
+        for (std::uint32_t k = 0; k < WIDTH * HEIGHT; ++k)
+            REQUIRE(visits[k] == (std::ranges::find(pixels, k) != pixels.end() ? 1 : 0));
+    }
+
+    // 图块内按 Morton 顺序：前四个像素是左上角的 2x2 块
+    const auto order = scheduler.order();
+    REQUIRE(std::vector<std::uint32_t>(order.begin(), order.begin() + 4) ==
+            std::vector<std::uint32_t>{0, 1, WIDTH, WIDTH + 1});
+
+    // 随机数只取决于像素与采样序号，两种调度的渲染结果逐位相同
+    const CornellScene scene;
+    const auto render = [&](const rt::RenderSchedule schedule) {
+        rt::SoftTracer tracer(WIDTH, HEIGHT, 4, 6);
+        tracer.set_background(glm::vec3(0, 0, 0), false);
+        tracer.set_schedule(schedule, 8);
+        return tracer.render_framebuffer(scene.world, scene.lights, scene.cam);
+    };
+    REQUIRE(render(rt::RenderSchedule::TILES) == render(rt::RenderSchedule::SCANLINES));
+}
+
+TEST_CASE("Single-pass strategies match separate renders", "[strategy]") {
+    constexpr int SIZE = 16;
+    const CornellScene scene;
+    const std::array<rt::SamplingStrategy, 3> strategies = {rt::SamplingStrategy::MIS, rt::SamplingStrategy::LIGHT,
+                                                            rt::SamplingStrategy::MATERIAL};
+    const auto sampler = GENERATE(rt::SamplerType::INDEPENDENT, rt::SamplerType::SOBOL);
+
+    // 各策略共用路径与样本，逐位等于用迭代积分器分别渲染
+    rt::SoftTracer combined(SIZE, SIZE, 8, 10);
+    combined.set_background(glm::vec3(0, 0, 0), false);
+    combined.set_sampler(sampler);
+    combined.set_sampling_strategies(strategies);
+    const std::vector<std::vector<glm::vec3>> images =
+        combined.render_framebuffers(scene.world, scene.lights, scene.cam);
+    REQUIRE(images.size() == strategies.size());
+
+    for (size_t k = 0; k < strategies.size(); ++k) {
+        rt::SoftTracer separate(SIZE, SIZE, 8, 10);
+        separate.set_background(glm::vec3(0, 0, 0), false);
+        separate.set_sampler(sampler);
+        separate.set_integrator(rt::IntegratorMode::ITERATIVE);
+        separate.set_sampling_strategy(strategies[k]);
+        REQUIRE(images[k] == separate.render_framebuffer(scene.world, scene.lights, scene.cam));
+    }
+
+    REQUIRE_THROWS_AS(combined.set_sampling_strategies({}), std::invalid_argument);
+}
+
+TEST_CASE("Snapshots match renders stopped at the same sample count", "[snapshot]") {
+    constexpr int SIZE = 16;
+    const CornellScene scene;
+
+    // 超出目标采样数与非正的快照被忽略
+    rt::SoftTracer tracer(SIZE, SIZE, 12, 10);
+    tracer.set_background(glm::vec3(0, 0, 0), false);
+    tracer.set_snapshots({12, 4, 0, 20, 4});
+    std::vector<int> counts;
+    std::vector<std::vector<glm::vec3>> snapshots;
+    const std::vector<std::vector<glm::vec3>> images =
+        tracer.render_framebuffers(scene.world, scene.lights, scene.cam, [&](const int samples, const auto& images) {
+            counts.push_back(samples);
+            snapshots.push_back(images.front());
+        });
+    REQUIRE(counts == std::vector<int>{4, 12});
+    REQUIRE(snapshots.back() == images.front());
+
+    // 快照是渲染途中的累积结果，逐位等于只渲染到该采样数
+    rt::SoftTracer stopped(SIZE, SIZE, 4, 10);
+    stopped.set_background(glm::vec3(0, 0, 0), false);
+    REQUIRE(snapshots.front() == stopped.render_framebuffer(scene.world, scene.lights, scene.cam));
+}
+
+namespace {
+
+std::atomic<std::size_t> allocation_count{0}; ///< 全局 operator new 的调用次数。
+
+} // namespace
+
+// 替换整组可替换的分配函数（含数组与对齐形式），全部经 malloc / aligned_alloc 分配、free 释放。
+// GCC 把 operator new 的结果视为 new 分配的指针，内联替换后的 operator delete 时会对其中的 free 误报
+// -Wmismatched-new-delete，这里局部关闭该警告
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    ++allocation_count;
+    const auto alignment = static_cast<std::size_t>(align);
+    // aligned_alloc 要求大小是对齐的整数倍
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void* ptr = std::aligned_alloc(alignment, rounded)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) { return ::operator new(size, align); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t /*size*/) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t /*align*/) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t /*size*/, std::align_val_t /*align*/) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::align_val_t /*align*/) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t /*size*/, std::align_val_t /*align*/) noexcept { std::free(ptr); }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+TEST_CASE("Path tracing does not allocate per sample", "[integrator]") {
+    const auto mode = GENERATE(rt::IntegratorMode::RECURSIVE, rt::IntegratorMode::ITERATIVE,
+                               rt::IntegratorMode::WAVEFRONT);
+    const auto layout = GENERATE(rt::BVHLayout::BINARY, rt::BVHLayout::WIDE8);
+    constexpr int SIZE = 8;
+    const CornellScene scene;
+    const rt::BVH bvh(scene.world, rt::BVHBuildMode::BINNED_SAH, layout);
+
+    // 帧缓冲等固定开销与采样数无关，两次渲染的分配次数之差即为逐采样的分配；
+    // 每个顶点的临时数据都是栈上的定长数组，场景本身与 BVH 遍历也都不访问堆
+    for (const rt::Hittable* world : {static_cast<const rt::Hittable*>(&scene.world),
+                                      static_cast<const rt::Hittable*>(&bvh)}) {
+        std::array<std::size_t, 2> allocations{};
+        for (int k = 0; k < 2; ++k) {
+            rt::SoftTracer tracer(SIZE, SIZE, k == 0 ? 1 : 16, 8);
+            tracer.set_integrator(mode);
+            const std::size_t before = allocation_count;
+            tracer.render_framebuffer(*world, scene.lights, scene.cam);
+            allocations[k] = allocation_count - before;
+        }
+        REQUIRE(allocations[1] == allocations[0]);
+    }
+}
+
+namespace {
+
+/**
+ * @brief 覆盖了 emitted 的 Lambertian 子类，材质表不能把它当作内置的 Lambertian。
+ */
+class GlowingLambertian : public rt::Lambertian {
+public:
+    using rt::Lambertian::Lambertian;
+
+    [[nodiscard]] glm::vec3 emitted(const rt::Ray& /*r_in*/, const rt::HitRecord& /*rec*/) const override {
+        return albedo();
+    }
+};
+
+} // namespace
+
+TEST_CASE("Material table dispatch matches virtual materials", "[material]") {
+    const std::array<std::shared_ptr<rt::Material>, 6> materials = {
+        std::make_shared<rt::Lambertian>(glm::vec3(0.7, 0.2, 0.1)),
+        std::make_shared<rt::Metal>(glm::vec3(0.8, 0.8, 0.9), 0.3),
+        std::make_shared<rt::Metal>(glm::vec3(0.9, 0.6, 0.2), 0.0),
+        std::make_shared<rt::DiffuseLight>(glm::vec3(4, 3, 2)),
+        std::make_shared<rt::WrongLambertian>(glm::vec3(0.5, 0.5, 0.5)),
+        std::make_shared<GlowingLambertian>(glm::vec3(0.3, 0.6, 0.9)),
+    };
+    // 内置材质的子类可能覆盖了虚函数，按 CUSTOM 处理
+    const std::array<rt::MaterialTable::Kind, 6> kinds = {
+        rt::MaterialTable::Kind::LAMBERTIAN,    rt::MaterialTable::Kind::METAL,  rt::MaterialTable::Kind::METAL,
+        rt::MaterialTable::Kind::DIFFUSE_LIGHT, rt::MaterialTable::Kind::CUSTOM, rt::MaterialTable::Kind::CUSTOM};
+
+    rt::Scene world;
+    for (size_t i = 0; i < materials.size(); ++i)
+        world.add(std::make_shared<rt::Sphere>(glm::vec3(3.0F * static_cast<float>(i), 0, -5), 1.0, materials[i]));
+    // 同一材质被多个图元引用时只注册一次
+    world.add(std::make_shared<rt::Quad>(glm::vec3(-10, -1, -10), glm::vec3(30, 0, 0), glm::vec3(0, 0, 20),
+                                         materials[0]));
+
+    rt::MaterialTable table;
+    world.bind_materials(table);
+    REQUIRE(table.size() == materials.size());
+
+    for (size_t i = 0; i < materials.size(); ++i) {
+        INFO("material " << i);
+        const glm::vec3 target(3.0F * static_cast<float>(i), 0.3F, -4.0F);
+        const glm::vec3 origin(3.0F * static_cast<float>(i) - 0.5F, 0.5F, 0);
+        const rt::Ray r_in(origin, target - origin);
+        rt::HitRecord rec;
+        REQUIRE(world.hit(r_in, 0.001, std::numeric_limits<double>::infinity(), rec));
+        REQUIRE(rec.mat_ptr == materials[i].get());
+        REQUIRE(rec.material_id != rt::HitRecord::NO_MATERIAL_ID);
+        REQUIRE(rt::MaterialTable::kind(rec.material_id) == kinds[i]);
+
+        REQUIRE(table.emitted(r_in, rec) == rec.mat_ptr->emitted(r_in, rec));
+
+        rt::ScatterRecord expected;
+        rt::ScatterRecord actual;
+        const bool scatters = rec.mat_ptr->scatter(r_in, rec, expected);
+        REQUIRE(table.scatter(r_in, rec, actual) == scatters);
+        if (!scatters) continue;
+        REQUIRE(actual.attenuation == expected.attenuation);
+        REQUIRE(actual.is_specular == expected.is_specular);
+
+        // 比较固定方向上的 pdf 与 BRDF，避免依赖随机采样
+        const glm::vec3 reflected = glm::reflect(glm::normalize(r_in.direction()), rec.normal);
+        for (const glm::vec3& dir : {reflected, glm::normalize(reflected + 0.2F * rec.normal), rec.normal}) {
+            const rt::Ray scattered(rec.p, dir);
+            REQUIRE(actual.pdf.value(dir) == expected.pdf.value(dir));
+            REQUIRE(table.brdf(r_in, rec, scattered) == rec.mat_ptr->brdf(r_in, rec, scattered));
+        }
+    }
+
+    // 未绑定的击中记录回退到虚函数
+    rt::HitRecord unbound;
+    unbound.mat_ptr = materials[3].get();
+    const rt::Ray r(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1));
+    REQUIRE(table.emitted(r, unbound) == glm::vec3(4, 3, 2));
+}